@@ -0,0 +1,118 @@
+"""CQ and ITU zones as cty.csv gives them, for update_prefixes.py --offline.
+
+A header regenerated offline has no cty.csv to read zones from; entries
+whose zones are still 0 take them from here instead. ENTITY_ZONES is each
+entity's default (CQ, ITU) pair; PREFIX_ZONES are the call-area overrides
+cty.csv writes as (CQ)[ITU] after a prefix, for the entities that have
+them by call area. Other per-prefix and per-call overrides are not
+repeated here: a fetch from cty.csv replaces all of this.
+"""
+import re
+
+# DXCC entity -> (CQ zone, ITU zone).
+ENTITY_ZONES = {
+    1: (5, 9), 3: (21, 40), 4: (39, 53), 5: (15, 18), 6: (1, 1), 7: (15, 28),
+    9: (32, 62), 10: (39, 68), 11: (26, 49), 12: (8, 11), 13: (13, 74),
+    14: (21, 29), 15: (17, 30), 16: (32, 60), 17: (8, 11), 18: (21, 29),
+    20: (31, 61), 21: (14, 37), 22: (27, 64), 24: (38, 67), 27: (16, 29),
+    29: (33, 36), 31: (31, 62), 32: (33, 37), 33: (39, 41), 34: (32, 60),
+    35: (29, 54), 36: (7, 10), 37: (7, 11), 38: (29, 54), 40: (20, 28),
+    41: (39, 68), 43: (8, 11), 45: (20, 28), 46: (28, 54), 47: (12, 63),
+    48: (31, 61), 49: (36, 47), 50: (6, 10), 51: (37, 48), 52: (15, 29),
+    53: (37, 48), 54: (16, 29), 56: (11, 13), 60: (8, 11), 61: (40, 75),
+    62: (8, 11), 63: (9, 12), 64: (5, 11), 65: (8, 11), 66: (7, 11),
+    69: (8, 11), 70: (8, 11), 71: (10, 12), 72: (8, 11), 74: (7, 11),
+    75: (21, 29), 76: (7, 11), 77: (8, 11), 78: (8, 11), 79: (8, 11),
+    80: (7, 11), 82: (8, 11), 84: (8, 11), 86: (7, 11), 88: (7, 11),
+    89: (8, 11), 90: (9, 11), 91: (9, 11), 94: (8, 11), 95: (8, 11),
+    96: (8, 11), 97: (8, 11), 98: (8, 11), 99: (39, 53), 100: (13, 14),
+    103: (27, 64), 104: (10, 12), 105: (8, 11), 106: (14, 27), 107: (35, 46),
+    108: (11, 15), 109: (35, 46), 110: (31, 61), 111: (39, 68), 112: (12, 14),
+    114: (14, 27), 116: (9, 12), 117: (14, 28), 118: (40, 18), 120: (10, 12),
+    122: (14, 27), 123: (31, 61), 124: (39, 53), 125: (12, 14), 126: (15, 29),
+    129: (9, 12), 130: (17, 30), 131: (39, 68), 132: (11, 14), 133: (32, 60),
+    135: (17, 30), 136: (10, 12), 137: (25, 44), 138: (31, 61), 140: (9, 12),
+    141: (13, 16), 142: (22, 41), 143: (26, 49), 144: (13, 14), 145: (15, 29),
+    146: (15, 29), 147: (30, 60), 148: (9, 12), 149: (14, 36), 150: (30, 59),
+    152: (24, 44), 153: (30, 60), 157: (31, 65), 158: (32, 56), 159: (22, 41),
+    160: (32, 62), 161: (9, 12), 162: (32, 56), 163: (28, 51), 165: (39, 53),
+    166: (27, 64), 167: (15, 18), 168: (31, 65), 169: (39, 53), 170: (32, 60),
+    171: (30, 56), 172: (32, 63), 173: (27, 65), 174: (31, 61), 175: (32, 63),
+    176: (32, 56), 177: (27, 90), 179: (16, 29), 180: (20, 28), 181: (37, 53),
+    182: (8, 11), 185: (28, 51), 187: (35, 46), 188: (32, 62), 189: (32, 60),
+    190: (32, 62), 191: (32, 62), 192: (27, 45), 195: (36, 52), 197: (31, 61),
+    199: (12, 72), 201: (38, 57), 202: (8, 11), 203: (14, 27), 204: (6, 10),
+    205: (36, 66), 206: (15, 28), 207: (39, 53), 209: (14, 27), 211: (5, 9),
+    212: (20, 28), 213: (8, 11), 214: (15, 28), 215: (20, 39), 216: (7, 11),
+    217: (12, 14), 219: (36, 47), 221: (14, 18), 222: (14, 18), 223: (14, 27),
+    224: (15, 18), 225: (15, 28), 227: (14, 27), 230: (14, 28), 232: (37, 48),
+    233: (14, 37), 234: (32, 62), 235: (13, 73), 236: (20, 28), 237: (40, 5),
+    238: (13, 73), 239: (15, 28), 240: (13, 73), 241: (13, 73), 242: (40, 17),
+    245: (14, 27), 246: (15, 28), 247: (26, 50), 248: (15, 28), 249: (8, 11),
+    250: (36, 66), 251: (14, 28), 252: (5, 9), 253: (11, 13), 254: (14, 27),
+    256: (33, 36), 257: (15, 28), 259: (40, 18), 260: (14, 27), 262: (17, 30),
+    263: (14, 27), 265: (14, 27), 266: (14, 18), 269: (15, 28), 270: (31, 62),
+    272: (14, 37), 273: (11, 15), 274: (38, 66), 275: (20, 28), 276: (39, 53),
+    277: (5, 9), 278: (15, 28), 279: (14, 27), 280: (17, 30), 281: (14, 37),
+    282: (31, 65), 283: (20, 39), 284: (14, 18), 285: (8, 11), 286: (37, 48),
+    287: (14, 28), 288: (16, 29), 289: (5, 8), 291: (5, 8), 292: (17, 30),
+    293: (26, 49), 294: (14, 27), 295: (15, 28), 296: (15, 28), 297: (31, 65),
+    298: (32, 62), 299: (28, 54), 301: (31, 65), 302: (33, 46), 303: (30, 55),
+    304: (21, 39), 305: (22, 41), 306: (22, 41), 308: (7, 11), 309: (26, 49),
+    312: (26, 49), 315: (22, 41), 318: (24, 44), 321: (24, 44), 324: (22, 41),
+    327: (28, 51), 330: (21, 40), 333: (21, 39), 336: (20, 39), 339: (25, 45),
+    342: (20, 39), 344: (25, 44), 345: (28, 54), 348: (21, 39), 354: (20, 39),
+    363: (23, 32), 369: (22, 42), 370: (21, 39), 372: (21, 41), 375: (27, 50),
+    376: (21, 39), 378: (21, 39), 379: (39, 53), 381: (28, 54), 382: (37, 48),
+    384: (20, 39), 386: (24, 44), 387: (26, 49), 390: (20, 39), 391: (21, 39),
+    400: (33, 37), 401: (36, 52), 402: (38, 57), 404: (36, 52), 406: (36, 47),
+    408: (36, 47), 409: (35, 46), 410: (36, 47), 411: (39, 53), 412: (36, 52),
+    414: (36, 52), 416: (35, 46), 420: (36, 52), 422: (35, 46), 424: (35, 46),
+    428: (35, 46), 430: (37, 48), 432: (38, 57), 434: (35, 46), 436: (34, 38),
+    438: (39, 53), 440: (37, 53), 442: (35, 46), 444: (35, 46), 446: (33, 37),
+    450: (35, 46), 452: (38, 53), 453: (39, 53), 454: (36, 52), 456: (35, 46),
+    458: (35, 46), 460: (32, 56), 462: (38, 57), 464: (38, 57), 466: (34, 48),
+    468: (38, 57), 470: (37, 53), 474: (33, 37), 478: (34, 38), 480: (35, 46),
+    482: (36, 53), 483: (35, 46), 489: (32, 56), 490: (31, 65), 492: (21, 39),
+    497: (15, 28), 499: (15, 28), 501: (15, 28), 502: (15, 28), 503: (15, 28),
+    504: (15, 28), 505: (24, 44), 506: (27, 50), 507: (32, 51), 508: (32, 63),
+    509: (31, 63), 510: (20, 39), 511: (28, 54), 512: (30, 56), 513: (32, 63),
+    514: (15, 28), 515: (32, 62), 516: (8, 11), 517: (9, 11), 518: (8, 11),
+    519: (8, 11), 520: (9, 11), 521: (34, 48), 522: (15, 28),
+}
+
+# Series that take the call area after two letters, by entity.
+_US = r"^(A[A-L]|[KNW][A-Z]?)"
+_VE = r"^(C[FGJK]|V[ABCEGX]|X[LM])"  # VE1 .. VE9
+_VO = r"^(C[HIYZ]|V[DFO]|X[JKNO])"  # VO1, VO2 and VY0 alike
+_VK = r"^(AX|V[IJKL])"
+_CE = r"^(3G|C[A-E]|X[QR])"
+
+# DXCC entity -> [(pattern on the prefix or call, (CQ zone, ITU zone))];
+# the first match wins.
+PREFIX_ZONES = {
+    1: [
+        (_VE + "2", (5, 4)), (_VE + "3", (4, 4)), (_VE + "[45]", (4, 3)),
+        (_VE + "6", (4, 2)), (_VE + "7", (3, 2)), (_VE + "8", (1, 4)),
+        (_VO + "0", (2, 4)), (_VO + "2", (2, 9)),
+        (r"^VY0", (2, 4)), (r"^VY1", (1, 2)),
+    ],
+    100: [(r"^(A[YZ]|L[0-9O-W])[0-9][V-Y]", (13, 16))],
+    112: [(_CE + "[78]", (12, 16))],
+    150: [
+        (_VK + "4", (30, 55)), (_VK + "6", (29, 58)), (_VK + "8", (29, 55)),
+    ],
+    291: [
+        (_US + "[05]", (4, 7)), (_US + "[67]", (3, 6)), (_US + "[89]", (4, 8)),
+    ],
+}
+
+
+def zones(prefix, dxcc):
+    """(CQ zone, ITU zone) for a prefix or '='-marked call of 'dxcc', or
+    (0, 0) for an entity not listed."""
+    p = prefix.lstrip("=*")
+    for pattern, z in PREFIX_ZONES.get(dxcc, []):
+        if re.match(pattern, p):
+            return z
+    return ENTITY_ZONES.get(dxcc, (0, 0))
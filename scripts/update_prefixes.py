@@ -1,16 +1,32 @@
 #!/usr/bin/env python3
+"""Regenerates src/core/PrefixData.h from the Big CTY list.
+
+The header holds a read-only trie over all prefixes and exact calls, so
+PrefixManager can look calls up without locks or heap allocation.
+
+  scripts/update_prefixes.py            fetch cty.csv and regenerate
+  scripts/update_prefixes.py --offline  regenerate from the current header,
+                                        e.g. after changing the layout; zones
+                                        still 0 come from cty_zones.py
+"""
 import csv
 import io
 import re
 import os
 import subprocess
+import sys
+
+import cty_zones
 
 # Official Big CTY CSV from country-files.com
 URL = "https://www.country-files.com/bigcty/cty.csv"
 OUT_H = "src/core/PrefixData.h"
 
+# Trie nodes per line in the generated header.
+NODES_PER_LINE = 4
+
 
-def update():
+def fetch():
     print(f"Fetching {URL}...")
     try:
         # Using curl for robustness
@@ -19,13 +35,14 @@ def update():
         )
         if result.returncode != 0:
             print(f"Curl failed with code {result.returncode}")
-            return
+            return None
         content = result.stdout
     except Exception as e:
         print(f"Error fetching: {e}")
-        return
+        return None
 
-    # Store results: prefix -> {lat, lon, dxcc}
+    # Store results: prefix -> (lat, lon, dxcc, cq zone, itu zone). Exact
+    # calls keep their leading '='.
     db = {}
 
     # CSV Format (official):
@@ -47,6 +64,8 @@ def update():
 
         primary = row[0]
         dxcc = int(row[2])
+        cq = int(row[4])
+        itu = int(row[5])
         lat = float(row[6])
         # CSV uses positive West. Our application uses positive East.
         lon = -float(row[7])
@@ -57,6 +76,12 @@ def update():
             prefix_list.append(primary)
 
         for p in prefix_list:
+            # Zone overrides for this prefix: (CQ) and [ITU].
+            m = re.search(r"\((\d+)\)", p)
+            p_cq = int(m.group(1)) if m else cq
+            m = re.search(r"\[(\d+)\]", p)
+            p_itu = int(m.group(1)) if m else itu
+
             # Remove overrides: (CQ), [ITU], <CONT>, {LAT/LON}
             p = re.sub(r"\(.*?\)", "", p)
             p = re.sub(r"\[.*?\]", "", p)
@@ -71,40 +96,178 @@ def update():
             # but standard cty.csv seems to avoid them or uses separate entries.
             # In bigcty, many entries are already separate rows.
 
-            db[p] = (lat, lon, dxcc)
+            db[p] = (lat, lon, dxcc, p_cq, p_itu)
+
+    return db
+
+
+def read_header():
+    """Recovers prefix -> (lat, lon, dxcc, cq, itu) from an existing header,
+    either the trie written by this script or the older flat g_PrefixData
+    table. Headers from before the zone columns give zones of 0."""
+    with open(OUT_H) as f:
+        text = f.read()
 
-    # Flatten into sorted list
-    entries = []
-    for p, (lat, lon, dxcc) in db.items():
-        entries.append({"prefix": p, "lat": lat, "lon": lon, "dxcc": dxcc})
+    db = {}
+    flat = re.findall(
+        r'\{"([^"]*)", (-?[\d.]+)f, (-?[\d.]+)f, (-?\d+)\}', text
+    )
+    if flat:
+        for p, lat, lon, dxcc in flat:
+            db[p] = (float(lat), float(lon), int(dxcc), 0, 0)
+        return db
+
+    def table(name):
+        body = re.search(name + r"\[\] = \{(.*?)\n\};", text, re.S).group(1)
+        return re.findall(r"\{([^{}]*)\}", body)
+
+    locs = [None]
+    for row in table("g_PrefixLocations"):
+        fields = [v.strip().rstrip("f") for v in row.split(",")]
+        lat, lon, dxcc = fields[:3]
+        cq, itu = fields[3:5] if len(fields) >= 5 else (0, 0)
+        locs.append((float(lat), float(lon), int(dxcc), int(cq), int(itu)))
+
+    nodes = []
+    for row in table("g_PrefixTrie"):
+        m = re.match(r"(\d+), (\d+), '(\\.|.)', (\d+), (\d+)", row.strip())
+        first, count, label, ploc, eloc = m.groups()
+        nodes.append((int(first), int(count), label.replace("\\", ""),
+                      int(ploc), int(eloc)))
 
-    # Sort entries by prefix string for binary search compatibility
-    entries.sort(key=lambda x: x["prefix"])
+    def walk(index, path):
+        first, count, _, ploc, eloc = nodes[index]
+        if ploc:
+            db[path] = locs[ploc]
+        if eloc:
+            db["=" + path] = locs[eloc]
+        for child in range(first, first + count):
+            walk(child, path + nodes[child][2])
 
-    print(f"Writing {len(entries)} entries to {OUT_H}...")
+    walk(0, "")
+    return db
+
+
+def build_trie(db):
+    """Returns (locations, nodes, entry count). Node 0 is the root; each
+    node's children are contiguous and sorted by label."""
+    entries = {}
+    for p, (lat, lon, dxcc, cq, itu) in sorted(db.items()):
+        # '*' marks WAE-only entities; they are ordinary prefixes here unless
+        # the DXCC list has the same prefix.
+        wae = p.startswith("*")
+        key = p.lstrip("=*")
+        # Lower-case pseudo prefixes such as "3D2/c" never match a call.
+        if not key or any(c.islower() for c in key):
+            continue
+        slot = (key, p.startswith("="))
+        if wae and slot in entries:
+            continue
+        entries[slot] = (round(lat, 2), round(lon, 2), dxcc, cq, itu)
+    items = [(key, exact, loc) for (key, exact), loc in entries.items()]
+
+    # Sorted so regenerating from the same data gives the same header.
+    locations = sorted({loc for _, _, loc in items},
+                       key=lambda l: (l[2], l[0], l[1], l[3], l[4]))
+    loc_index = {loc: i + 1 for i, loc in enumerate(locations)}  # 0 = none
+
+    root = {"children": {}, "prefix": 0, "exact": 0}
+    for key, exact, loc in items:
+        node = root
+        for c in key:
+            node = node["children"].setdefault(
+                c, {"children": {}, "prefix": 0, "exact": 0}
+            )
+        node["exact" if exact else "prefix"] = loc_index[loc]
+
+    # Breadth-first layout keeps every node's children contiguous.
+    nodes = []
+    queue = [("", root)]
+    nodes.append(None)
+    head = 0
+    while head < len(queue):
+        label, node = queue[head]
+        first = len(queue)
+        children = sorted(node["children"].items())
+        queue.extend(children)
+        nodes[head] = (first if children else 0, len(children), label,
+                       node["prefix"], node["exact"])
+        nodes.extend([None] * len(children))
+        head += 1
+
+    if len(locations) >= 65536 or len(nodes) >= 2**32:
+        raise SystemExit("Trie too large for the node layout")
+    return locations, nodes, len(items)
+
+
+def write_header(db):
+    locations, nodes, count = build_trie(db)
+    print(f"Writing {count} entries as {len(nodes)} trie nodes and "
+          f"{len(locations)} locations to {OUT_H}...")
+
+    def char_lit(c):
+        return "'\\''" if c == "'" else ("'\\\\'" if c == "\\" else f"'{c}'")
 
     with open(OUT_H, "w") as f:
         f.write("#pragma once\n\n")
+        f.write("// Generated by scripts/update_prefixes.py. Do not edit.\n\n")
         f.write("#include <cstdint>\n")
         f.write("#include <cstddef>\n\n")
-        f.write("struct StaticPrefixEntry {\n")
-        f.write("    const char* prefix;\n")
+        f.write("struct StaticPrefixLocation {\n")
         f.write("    float lat;\n")
         f.write("    float lon;\n")
         f.write("    int16_t dxcc;\n")
+        f.write("    uint8_t cqZone;  // 0 = unknown\n")
+        f.write("    uint8_t ituZone; // 0 = unknown\n")
         f.write("};\n\n")
-        f.write(f"static const StaticPrefixEntry g_PrefixData[] = {{\n")
-        for e in entries:
-            safe_p = e["prefix"].replace('"', '\\"')
-            f.write(
-                f'    {{"{safe_p}", {e["lat"]:.2f}f, {e["lon"]:.2f}f, {e["dxcc"]}}},\n'
-            )
+        f.write("// Trie over prefixes and exact calls. Node 0 is the root; "
+                "a node's children\n")
+        f.write("// are g_PrefixTrie[firstChild .. firstChild + numChildren), "
+                "sorted by label.\n")
+        f.write("// prefixLoc / exactLoc are 1-based indexes into "
+                "g_PrefixLocations, 0 = none.\n")
+        f.write("struct StaticPrefixNode {\n")
+        f.write("    uint32_t firstChild;\n")
+        f.write("    uint8_t numChildren;\n")
+        f.write("    char label;\n")
+        f.write("    uint16_t prefixLoc; // calls starting with this path\n")
+        f.write("    uint16_t exactLoc;  // the call equal to this path\n")
+        f.write("};\n\n")
+
+        f.write("static const StaticPrefixLocation g_PrefixLocations[] = {\n")
+        for lat, lon, dxcc, cq, itu in locations:
+            f.write(f"    {{{lat:.2f}f, {lon:.2f}f, {dxcc}, {cq}, {itu}}},\n")
         f.write("};\n\n")
-        f.write(f"static const size_t g_PrefixDataSize = {len(entries)};\n")
+        f.write(f"static const size_t g_PrefixLocationCount = "
+                f"{len(locations)};\n\n")
+
+        f.write("static const StaticPrefixNode g_PrefixTrie[] = {\n")
+        for i in range(0, len(nodes), NODES_PER_LINE):
+            row = []
+            for first, n, label, ploc, eloc in nodes[i:i + NODES_PER_LINE]:
+                lit = char_lit(label) if label else "'\\0'"
+                row.append(f"{{{first}, {n}, {lit}, {ploc}, {eloc}}}")
+            f.write("    " + ", ".join(row) + ",\n")
+        f.write("};\n\n")
+        f.write(f"static const size_t g_PrefixTrieSize = {len(nodes)};\n")
+        f.write(f"static const size_t g_PrefixDataSize = {count};\n")
+
+
+def fill_zones(db):
+    """Gives entries without zones the ones cty_zones.py has for them."""
+    for p, (lat, lon, dxcc, cq, itu) in db.items():
+        if cq == 0 and itu == 0:
+            db[p] = (lat, lon, dxcc) + cty_zones.zones(p, dxcc)
 
 
 if __name__ == "__main__":
     if not os.path.exists("src/core"):
         print("Run from project root!")
+        sys.exit(1)
+    if "--offline" in sys.argv[1:]:
+        db = read_header()
+        fill_zones(db)
     else:
-        update()
+        db = fetch()
+    if db:
+        write_header(db)
@@ -5,6 +5,9 @@
 #include <string>
 #include <vector>
 
+#include "SnapshotStore.h"
+#include "Tracer.h"
+
 struct ADIFStats {
   int totalQSOs = 0;
   std::map<std::string, int> modeCounts;
@@ -14,19 +17,12 @@ struct ADIFStats {
   bool valid = false;
 };
 
-class ADIFStore {
+class ADIFStore : public SnapshotStore<ADIFStats> {
 public:
-  void update(const ADIFStats &stats) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    stats_ = stats;
-  }
+  ADIFStore() : SnapshotStore(ChangeBus::Topic::ADIF) {}
 
-  ADIFStats get() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return stats_;
+  void update(const ADIFStats &stats) {
+    TRACE_SCOPE("store", "ADIFStore::update");
+    publish(stats);
   }
-
-private:
-  mutable std::mutex mutex_;
-  ADIFStats stats_;
 };
@@ -3,8 +3,12 @@
 #include <chrono>
 #include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "SnapshotStore.h"
+#include "Tracer.h"
+
 struct DXPedition {
   std::string call;
   std::string location;
@@ -32,19 +36,20 @@ struct ActivityData {
   bool valid = false;
 };
 
-class ActivityDataStore {
+class ActivityDataStore : public SnapshotStore<ActivityData> {
 public:
-  ActivityData get() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return data_;
-  }
+  ActivityDataStore() : SnapshotStore(ChangeBus::Topic::Activity) {}
 
   void set(const ActivityData &data) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    data_ = data;
+    TRACE_SCOPE("store", "ActivityDataStore::set");
+    publish(data);
   }
 
-private:
-  mutable std::mutex mutex_;
-  ActivityData data_;
+  // Applies 'fn' to the current value and publishes the result as one step.
+  // Writers that own only some of the fields must use this rather than
+  // get()/set(), or overlapping fetches overwrite each other with stale data.
+  template <typename Fn> void update(Fn &&fn) {
+    TRACE_SCOPE("store", "ActivityDataStore::update");
+    modify(std::forward<Fn>(fn));
+  }
 };
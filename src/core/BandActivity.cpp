@@ -0,0 +1,171 @@
+#include "BandActivity.h"
+#include "LiveSpotData.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+static_assert(kNumBands == BandActivityMatrix::kNumBandSlots,
+              "BandActivityMatrix has a row per band");
+static_assert(static_cast<int>(Continent::Count) ==
+                  BandActivityMatrix::kConts + 1,
+              "BandActivityMatrix has a column per known continent");
+
+BandActivityMatrix::BandActivityMatrix(int64_t nowSecs)
+    : head_(bucketOf(nowSecs)) {}
+
+int BandActivityMatrix::cellOf(int band, Continent from, Continent to) {
+  int f = static_cast<int>(from) - 1;
+  int t = static_cast<int>(to) - 1;
+  if (band < 0 || band >= kNumBandSlots || f < 0 || f >= kConts || t < 0 ||
+      t >= kConts)
+    return -1;
+  return (band * kConts + f) * kConts + t;
+}
+
+int64_t BandActivityMatrix::bucketOf(int64_t unixSecs) {
+  return unixSecs >= 0 ? unixSecs / kBucketSecs
+                       : (unixSecs - kBucketSecs + 1) / kBucketSecs;
+}
+
+int BandActivityMatrix::slotOf(int64_t bucket) {
+  int64_t slot = bucket % kBuckets;
+  return static_cast<int>(slot < 0 ? slot + kBuckets : slot);
+}
+
+void BandActivityMatrix::add(int band, Continent from, Continent to,
+                             int64_t unixSecs) {
+  int cell = cellOf(band, from, to);
+  int64_t bucket = bucketOf(unixSecs);
+  // Counted before head_ is read, so advance() can wait for this call to
+  // finish before clearing a slot it may be about to count into.
+  adding_.fetch_add(1, std::memory_order_seq_cst);
+  int64_t head = head_.load(std::memory_order_seq_cst);
+  bool take =
+      cell >= 0 && bucket <= head + 1 && bucket >= head - kAcceptBuckets;
+  if (take) {
+    counts_[cell * kBuckets + slotOf(bucket)].fetch_add(
+        1, std::memory_order_relaxed);
+  }
+  adding_.fetch_sub(1, std::memory_order_release);
+  (take ? added_ : ignored_).fetch_add(1, std::memory_order_relaxed);
+}
+
+void BandActivityMatrix::advance(int64_t nowSecs,
+                                 std::vector<BandOpening> *started) {
+  int64_t target = bucketOf(nowSecs);
+  int64_t head = head_.load(std::memory_order_relaxed);
+  if (target <= head)
+    return;
+
+  // Buckets from head + 2 on become writable once head_ moves, so their
+  // slots are cleared first. Under the old head add() still takes every
+  // slot but that of head + 2; a longer step parks head_ where add() takes
+  // nothing, and calls that read the old head are let finish, so no spot
+  // lands in a slot being cleared. Spots meanwhile are ignored; this only
+  // happens after the owner thread was held up.
+  int64_t clearFrom = head + 2;
+  int64_t clearTo = std::min(target + 1, clearFrom + kBuckets - 1);
+  if (clearTo > clearFrom) {
+    head_.store(kParked, std::memory_order_seq_cst);
+    while (adding_.load(std::memory_order_seq_cst) != 0)
+      std::this_thread::yield();
+  }
+  for (int64_t b = clearFrom; b <= clearTo; ++b) {
+    int slot = slotOf(b);
+    for (int cell = 0; cell < kCells; ++cell)
+      counts_[cell * kBuckets + slot].store(0, std::memory_order_relaxed);
+  }
+
+  // Only the last few finished buckets are judged: a longer gap means the
+  // clock was stopped or jumped, and zeros from it are not observations.
+  for (int64_t b = std::max(head, target - 3); b < target; ++b)
+    evaluate(b, started);
+
+  head_.store(target, std::memory_order_release);
+}
+
+void BandActivityMatrix::evaluate(int64_t bucket,
+                                  std::vector<BandOpening> *started) {
+  int slot = slotOf(bucket);
+  bool warm = evaluated_ >= kWarmupBuckets;
+  // A plain running mean until there are enough buckets for the EWMA, so
+  // the baseline does not start out biased towards zero.
+  float alpha = std::max(kAlpha, 1.0f / static_cast<float>(evaluated_ + 1));
+  for (int cell = 0; cell < kCells; ++cell) {
+    Baseline &c = base_[cell];
+    uint32_t n =
+        counts_[cell * kBuckets + slot].load(std::memory_order_relaxed);
+    float x = static_cast<float>(n);
+    // Spot counts are roughly Poisson, so never trust a variance below the
+    // mean; the +1 keeps near-empty cells from firing on a couple of spots.
+    float sd = std::sqrt(std::max(c.var, c.mean) + 1.0f);
+    c.z = (x - c.mean) / sd;
+    c.last = n;
+
+    if (!c.open) {
+      if (c.pending && c.z >= kConfirmZ) {
+        c.open = true;
+        c.pending = false;
+        c.quiet = 0;
+        if (started)
+          started->push_back(openingOf(cell));
+        continue;
+      }
+      c.pending = warm && c.z >= kOpenZ && n >= kMinSpots;
+      if (c.pending) {
+        // Judged against the baseline from before it.
+        c.since = bucket * kBucketSecs;
+        continue;
+      }
+      float d = x - c.mean;
+      c.mean += alpha * d;
+      c.var = (1.0f - alpha) * (c.var + alpha * d * d);
+    } else if (c.z < kCloseZ) {
+      if (++c.quiet >= kCloseBuckets)
+        c.open = false;
+    } else {
+      c.quiet = 0;
+    }
+  }
+  if (evaluated_ < 1000)
+    evaluated_++;
+}
+
+BandOpening BandActivityMatrix::openingOf(int cell) const {
+  const Baseline &c = base_[cell];
+  BandOpening o;
+  o.band = cell / (kConts * kConts);
+  o.from = static_cast<Continent>(cell / kConts % kConts + 1);
+  o.to = static_cast<Continent>(cell % kConts + 1);
+  o.since = c.since;
+  o.count = c.last;
+  o.baseline = c.mean;
+  o.z = c.z;
+  return o;
+}
+
+std::vector<BandOpening> BandActivityMatrix::openings() const {
+  std::vector<BandOpening> out;
+  for (int cell = 0; cell < kCells; ++cell) {
+    if (base_[cell].open)
+      out.push_back(openingOf(cell));
+  }
+  std::sort(out.begin(), out.end(),
+            [](const BandOpening &a, const BandOpening &b) {
+              return a.z > b.z;
+            });
+  return out;
+}
+
+void BandActivityMatrix::copyCounts(std::vector<uint32_t> &out) const {
+  out.resize(static_cast<size_t>(kCells) * kHistory);
+  int64_t head = head_.load(std::memory_order_acquire);
+  for (int i = 0; i < kHistory; ++i) {
+    int slot = slotOf(head - kHistory + 1 + i);
+    for (int cell = 0; cell < kCells; ++cell) {
+      out[static_cast<size_t>(cell) * kHistory + i] =
+          counts_[cell * kBuckets + slot].load(std::memory_order_relaxed);
+    }
+  }
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "SpotFilter.h"
+
+// A band and continent pair carrying clearly more spots than usual.
+struct BandOpening {
+  int band = -1;
+  Continent from = Continent::Unknown; // transmitting station
+  Continent to = Continent::Unknown;   // spotter / receiver
+  int64_t since = 0;                   // Unix seconds, start of first bucket
+  uint32_t count = 0;                  // spots in the last finished bucket
+  float baseline = 0;                  // usual spots per bucket
+  float z = 0;                         // how unusual 'count' is
+};
+
+// Rolling spot counts per band, continent pair and 5-minute bucket, fed by
+// every cluster spot and PSK Reporter report, with a baseline per cell to
+// tell a band opening from the usual traffic.
+//
+// The counts are a fixed ring of atomics, so add() is an index computation
+// and a few atomic increments: safe from any thread, and it never allocates,
+// locks or waits. advance() belongs to one owner thread
+// (BandActivityProvider). It clears buckets ahead of use, and for every
+// finished bucket compares each cell against an EWMA of its mean and
+// variance. A bucket at z >= kOpenZ with at least kMinSpots spots opens the
+// cell if the next one is still at kConfirmZ; a single busy bucket is too
+// common on a few hundred cells. An open cell closes after kCloseBuckets
+// quiet buckets, and its baseline is frozen meanwhile.
+class BandActivityMatrix {
+public:
+  static constexpr int kBucketSecs = 300;
+  static constexpr int kBuckets = 48;      // 4 hours
+  static constexpr int kNumBandSlots = 12; // kBands in LiveSpotData.h
+  static constexpr int kConts = 7;         // Continent::NA .. AN
+  static constexpr int kCells = kNumBandSlots * kConts * kConts;
+  // add() accepts the current and next bucket and this many before them;
+  // the rest of the ring is being cleared for reuse.
+  static constexpr int kAcceptBuckets = kBuckets - 3;
+  static constexpr int kHistory = kAcceptBuckets + 1; // see copyCounts()
+
+  static constexpr float kAlpha = 0.05f;    // ~3 hour memory
+  static constexpr int kWarmupBuckets = 12; // no openings in the first hour
+  static constexpr float kOpenZ = 4.0f;
+  static constexpr uint32_t kMinSpots = 5;
+  static constexpr float kConfirmZ = 2.0f;
+  static constexpr float kCloseZ = 1.0f;
+  static constexpr int kCloseBuckets = 2;
+
+  explicit BandActivityMatrix(int64_t nowSecs);
+
+  // Cell index, or -1 when the band or either continent is unknown.
+  static int cellOf(int band, Continent from, Continent to);
+  static int64_t bucketOf(int64_t unixSecs);
+
+  // Counts one spot. Spots outside the ring's window are ignored.
+  void add(int band, Continent from, Continent to, int64_t unixSecs);
+
+  // Moves the ring forward to 'nowSecs' and runs the detector over every
+  // bucket finished since the last call. Openings detected in the process
+  // are appended to 'started'. Owner thread only.
+  void advance(int64_t nowSecs, std::vector<BandOpening> *started = nullptr);
+
+  // The open cells, strongest first. Owner thread only.
+  std::vector<BandOpening> openings() const;
+
+  // Counts in 'out', kHistory per cell in cellOf() order, oldest first; the
+  // last one is the bucket in progress.
+  void copyCounts(std::vector<uint32_t> &out) const;
+
+  // Bucket in progress (Unix seconds / kBucketSecs).
+  int64_t head() const { return head_.load(std::memory_order_acquire); }
+  uint64_t added() const { return added_.load(std::memory_order_relaxed); }
+  uint64_t ignored() const { return ignored_.load(std::memory_order_relaxed); }
+
+private:
+  struct Baseline {
+    float mean = 0;
+    float var = 0;
+    float z = 0;          // of the last finished bucket
+    uint32_t last = 0;    // spots in the last finished bucket
+    bool pending = false; // last bucket was at kOpenZ
+    bool open = false;
+    uint8_t quiet = 0; // finished buckets below kCloseZ while open
+    int64_t since = 0;
+  };
+
+  // head_ while advance() clears more than one slot: add() takes no bucket.
+  static constexpr int64_t kParked = INT64_MIN / 2;
+
+  static int slotOf(int64_t bucket);
+  void evaluate(int64_t bucket, std::vector<BandOpening> *started);
+  BandOpening openingOf(int cell) const;
+
+  std::array<std::atomic<uint32_t>, kCells * kBuckets> counts_{};
+  std::atomic<int64_t> head_;
+  std::atomic<uint64_t> added_{0};
+  std::atomic<uint64_t> ignored_{0};
+  std::atomic<int> adding_{0}; // add() calls in progress
+
+  std::array<Baseline, kCells> base_{};
+  int evaluated_ = 0; // finished buckets seen, up to 1000
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "BandActivity.h"
+#include "SnapshotStore.h"
+#include "Tracer.h"
+
+// What BandActivityProvider last read from the BandActivityMatrix.
+struct BandActivityData {
+  // BandActivityMatrix::kHistory counts per cell, oldest first.
+  std::vector<uint32_t> counts;
+  int64_t head = 0;                  // bucket of the newest count
+  std::vector<BandOpening> openings; // strongest first
+  uint64_t spots = 0;                // counted since start
+  bool valid = false;
+
+  // Spots in bucket 'age' (0 = in progress) on 'band' from 'from' heard in
+  // 'to'; Continent::Unknown sums over all continents.
+  uint32_t count(int band, Continent from, Continent to, int age) const {
+    constexpr int kHistory = BandActivityMatrix::kHistory;
+    if (counts.empty() || age < 0 || age >= kHistory ||
+        BandActivityMatrix::cellOf(band, Continent::NA, Continent::NA) < 0)
+      return 0;
+    uint32_t n = 0;
+    for (int f = 1; f <= BandActivityMatrix::kConts; ++f) {
+      if (from != Continent::Unknown && f != static_cast<int>(from))
+        continue;
+      for (int t = 1; t <= BandActivityMatrix::kConts; ++t) {
+        if (to != Continent::Unknown && t != static_cast<int>(to))
+          continue;
+        int cell = BandActivityMatrix::cellOf(band, static_cast<Continent>(f),
+                                              static_cast<Continent>(t));
+        n += counts[static_cast<size_t>(cell) * kHistory + kHistory - 1 - age];
+      }
+    }
+    return n;
+  }
+};
+
+class BandActivityStore : public SnapshotStore<BandActivityData> {
+public:
+  BandActivityStore() : SnapshotStore(ChangeBus::Topic::BandActivity) {}
+
+  void set(BandActivityData data) {
+    TRACE_SCOPE("store", "BandActivityStore::set");
+    publish(std::move(data));
+  }
+};
@@ -5,6 +5,9 @@
 #include <string>
 #include <vector>
 
+#include "SnapshotStore.h"
+#include "Tracer.h"
+
 enum class BandCondition { POOR, FAIR, GOOD, EXCELLENT, UNKNOWN };
 
 struct BandStatus {
@@ -19,19 +22,12 @@ struct BandConditionsData {
   bool valid = false;
 };
 
-class BandConditionsStore {
+class BandConditionsStore : public SnapshotStore<BandConditionsData> {
 public:
-  void update(const BandConditionsData &data) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    data_ = data;
-  }
+  BandConditionsStore() : SnapshotStore(ChangeBus::Topic::BandConditions) {}
 
-  BandConditionsData get() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return data_;
+  void update(const BandConditionsData &data) {
+    TRACE_SCOPE("store", "BandConditionsStore::update");
+    publish(data);
   }
-
-private:
-  mutable std::mutex mutex_;
-  BandConditionsData data_;
 };
@@ -0,0 +1,118 @@
+#include "ChangeBus.h"
+#include "Tracer.h"
+
+#include <algorithm>
+
+void ChangeBus::Subscription::reset() {
+  if (id_ != 0) {
+    ChangeBus::instance().unsubscribe(id_);
+    id_ = 0;
+  }
+}
+
+void ChangeBus::publish(Topic topic) {
+  if (topic >= Topic::Count)
+    return;
+  published_[static_cast<size_t>(topic)].fetch_add(1,
+                                                   std::memory_order_release);
+  pending_.store(true, std::memory_order_release);
+}
+
+uint64_t ChangeBus::version(Topic topic) const {
+  if (topic >= Topic::Count)
+    return 0;
+  return published_[static_cast<size_t>(topic)].load(std::memory_order_acquire);
+}
+
+ChangeBus::Subscription ChangeBus::subscribe(Topic topic, Callback cb) {
+  uint64_t id = nextId_++;
+  subscribers_.push_back({id, topic, std::move(cb)});
+  return Subscription(id);
+}
+
+void ChangeBus::unsubscribe(uint64_t id) {
+  auto it = std::find_if(subscribers_.begin(), subscribers_.end(),
+                         [id](const Subscriber &s) { return s.id == id; });
+  if (it == subscribers_.end())
+    return;
+  if (dispatching_)
+    it->cb = nullptr; // compacted once the current dispatch finishes
+  else
+    subscribers_.erase(it);
+}
+
+bool ChangeBus::dispatch() {
+  if (!pending_.exchange(false, std::memory_order_acq_rel))
+    return false;
+  TRACE_SCOPE("frame", "ChangeBus::dispatch");
+
+  std::array<uint64_t, kNumTopics> changed{};
+  bool any = false;
+  for (size_t t = 0; t < kNumTopics; ++t) {
+    uint64_t v = published_[t].load(std::memory_order_acquire);
+    if (v != delivered_[t]) {
+      delivered_[t] = v;
+      changed[t] = v;
+      any = true;
+    }
+  }
+  if (!any)
+    return false;
+
+  dispatching_ = true;
+  // Index loop: callbacks may subscribe, which can grow the vector.
+  size_t count = subscribers_.size();
+  for (size_t i = 0; i < count; ++i) {
+    Topic topic = subscribers_[i].topic;
+    uint64_t v = changed[static_cast<size_t>(topic)];
+    if (v != 0 && subscribers_[i].cb) {
+      Callback cb = subscribers_[i].cb; // survives unsubscribe from inside
+      cb(topic, v);
+    }
+  }
+  dispatching_ = false;
+
+  subscribers_.erase(std::remove_if(subscribers_.begin(), subscribers_.end(),
+                                    [](const Subscriber &s) { return !s.cb; }),
+                     subscribers_.end());
+  return true;
+}
+
+const char *ChangeBus::topicName(Topic topic) {
+  switch (topic) {
+  case Topic::Solar:
+    return "solar";
+  case Topic::LiveSpots:
+    return "live_spots";
+  case Topic::DXCluster:
+    return "dx_cluster";
+  case Topic::Activity:
+    return "activity";
+  case Topic::Contest:
+    return "contests";
+  case Topic::BandConditions:
+    return "band_conditions";
+  case Topic::Weather:
+    return "weather";
+  case Topic::Moon:
+    return "moon";
+  case Topic::RSS:
+    return "rss";
+  case Topic::ADIF:
+    return "adif";
+  case Topic::Watchlist:
+    return "watchlist";
+  case Topic::WatchlistHits:
+    return "watchlist_hits";
+  case Topic::SpotHistory:
+    return "spot_history";
+  case Topic::BandActivity:
+    return "band_activity";
+  case Topic::Wsjtx:
+    return "wsjtx";
+  case Topic::ContestLog:
+    return "contest_log";
+  default:
+    return "none";
+  }
+}
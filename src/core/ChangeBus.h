@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// Store change notifications.
+//
+// Stores publish their topic from whatever thread changed them; that is a
+// single atomic increment, so providers never block on the UI. The bus
+// numbers each topic's publishes itself rather than trusting the stores'
+// own counters, since several stores may share a topic (the DE and DX
+// weather stores do). Once per frame the main loop calls dispatch(), which
+// delivers at most one notification per changed topic (carrying its newest
+// number) to the subscribers. Several publishes between two frames
+// coalesce into one.
+//
+// subscribe(), Subscription destruction and dispatch() must all happen on
+// the main thread; callbacks therefore run on the main thread too and may
+// touch widget state directly.
+class ChangeBus {
+public:
+  enum class Topic : uint8_t {
+    Solar,
+    LiveSpots,
+    DXCluster,
+    Activity,
+    Contest,
+    BandConditions,
+    Weather,
+    Moon,
+    RSS,
+    ADIF,
+    Watchlist,
+    WatchlistHits,
+    SpotHistory,
+    BandActivity,
+    Wsjtx,
+    ContestLog,
+    Count,
+    None = Count, // stores that do not publish
+  };
+  static constexpr size_t kNumTopics = static_cast<size_t>(Topic::Count);
+
+  using Callback = std::function<void(Topic topic, uint64_t version)>;
+
+  // Unsubscribes when destroyed. Keep it as a member of whatever owns the
+  // state the callback touches.
+  class Subscription {
+  public:
+    Subscription() = default;
+    ~Subscription() { reset(); }
+    Subscription(Subscription &&other) noexcept : id_(other.id_) {
+      other.id_ = 0;
+    }
+    Subscription &operator=(Subscription &&other) noexcept {
+      if (this != &other) {
+        reset();
+        id_ = other.id_;
+        other.id_ = 0;
+      }
+      return *this;
+    }
+    Subscription(const Subscription &) = delete;
+    Subscription &operator=(const Subscription &) = delete;
+
+    void reset();
+
+  private:
+    friend class ChangeBus;
+    explicit Subscription(uint64_t id) : id_(id) {}
+    uint64_t id_ = 0;
+  };
+
+  static ChangeBus &instance() {
+    static ChangeBus bus;
+    return bus;
+  }
+
+  // Any thread. version() counts the topic's publishes so far.
+  void publish(Topic topic);
+  uint64_t version(Topic topic) const;
+
+  // Main thread only.
+  [[nodiscard]] Subscription subscribe(Topic topic, Callback cb);
+  // Delivers pending changes. Returns true if any topic changed since the
+  // previous call.
+  bool dispatch();
+
+  static const char *topicName(Topic topic);
+
+private:
+  ChangeBus() = default;
+
+  void unsubscribe(uint64_t id);
+
+  struct Subscriber {
+    uint64_t id;
+    Topic topic;
+    Callback cb; // empty once unsubscribed during dispatch
+  };
+
+  std::array<std::atomic<uint64_t>, kNumTopics> published_{};
+  std::array<uint64_t, kNumTopics> delivered_{};
+  std::atomic<bool> pending_{false};
+
+  std::vector<Subscriber> subscribers_;
+  uint64_t nextId_ = 1;
+  bool dispatching_ = false;
+};
@@ -140,6 +140,35 @@ bool ConfigManager::load(AppConfig &config) const {
     config.dxClusterPort = dxc.value("port", 7300);
     config.dxClusterLogin = dxc.value("login", "");
     config.dxClusterUseWSJTX = dxc.value("use_wsjtx", false);
+    config.dxClusterExtraSources.clear();
+    if (dxc.contains("extra_sources") && dxc["extra_sources"].is_array()) {
+      for (const auto &src : dxc["extra_sources"]) {
+        DXClusterSource s;
+        s.name = src.value("name", "");
+        s.host = src.value("host", "");
+        s.port = src.value("port", 7300);
+        s.login = src.value("login", "");
+        s.useWSJTX = src.value("use_wsjtx", false);
+        if (s.host.empty() && !s.useWSJTX)
+          continue;
+        config.dxClusterExtraSources.push_back(s);
+      }
+    }
+  }
+
+  // Spot filters
+  if (json.contains("filters")) {
+    auto &f = json["filters"];
+    config.spotFilterCluster = f.value("cluster", "");
+    config.spotFilterPsk = f.value("psk", "");
+    config.spotFilterAlerts = f.value("alerts", "");
+    config.spotFilterOpenings = f.value("openings", "");
+  }
+
+  // Band activity
+  if (json.contains("band_activity")) {
+    auto &ba = json["band_activity"];
+    config.openingAlerts = ba.value("alerts", false);
   }
 
   // PSK Reporter
@@ -210,6 +239,22 @@ bool ConfigManager::save(const AppConfig &config) const {
   json["dx_cluster"]["port"] = config.dxClusterPort;
   json["dx_cluster"]["login"] = config.dxClusterLogin;
   json["dx_cluster"]["use_wsjtx"] = config.dxClusterUseWSJTX;
+  auto extras = nlohmann::json::array();
+  for (const auto &s : config.dxClusterExtraSources) {
+    extras.push_back({{"name", s.name},
+                      {"host", s.host},
+                      {"port", s.port},
+                      {"login", s.login},
+                      {"use_wsjtx", s.useWSJTX}});
+  }
+  json["dx_cluster"]["extra_sources"] = extras;
+
+  json["filters"]["cluster"] = config.spotFilterCluster;
+  json["filters"]["psk"] = config.spotFilterPsk;
+  json["filters"]["alerts"] = config.spotFilterAlerts;
+  json["filters"]["openings"] = config.spotFilterOpenings;
+
+  json["band_activity"]["alerts"] = config.openingAlerts;
 
   json["psk_reporter"]["of_de"] = config.pskOfDe;
   json["psk_reporter"]["use_call"] = config.pskUseCall;
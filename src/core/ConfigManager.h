@@ -8,6 +8,15 @@
 
 #include <SDL.h>
 
+// An additional DX cluster connection, see AppConfig::dxClusterExtraSources.
+struct DXClusterSource {
+  std::string name; // short label shown in the DX Cluster panel
+  std::string host;
+  int port = 7300;
+  std::string login;    // empty = use dxClusterLogin
+  bool useWSJTX = false; // UDP listener on 'port' instead of telnet
+};
+
 struct AppConfig {
   // Identity
   std::string callsign;
@@ -39,6 +48,18 @@ struct AppConfig {
   int dxClusterPort = 7300;
   std::string dxClusterLogin = "";
   bool dxClusterUseWSJTX = false; // If true, ignore host and use UDP port
+  // Further clusters connected alongside the one above; spots reported by
+  // more than one of them are shown once.
+  std::vector<DXClusterSource> dxClusterExtraSources;
+
+  // Spot filter expressions (see SpotFilter.h); empty = show everything.
+  std::string spotFilterCluster;  // DX cluster list
+  std::string spotFilterPsk;      // PSK Reporter counts and map overlay
+  std::string spotFilterAlerts;   // watchlist alerts from the cluster
+  std::string spotFilterOpenings; // band opening alerts; band, cont, decont
+
+  // Band activity: list detected band openings with the watchlist hits.
+  bool openingAlerts = false;
 
   // SDO Widget settings
   std::string sdoWavelength = "0193";
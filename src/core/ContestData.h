@@ -5,6 +5,9 @@
 #include <string>
 #include <vector>
 
+#include "SnapshotStore.h"
+#include "Tracer.h"
+
 struct Contest {
   std::string title;
   std::chrono::system_clock::time_point startTime;
@@ -18,19 +21,12 @@ struct ContestData {
   bool valid = false;
 };
 
-class ContestStore {
+class ContestStore : public SnapshotStore<ContestData> {
 public:
-  void update(const ContestData &data) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    data_ = data;
-  }
+  ContestStore() : SnapshotStore(ChangeBus::Topic::Contest) {}
 
-  ContestData get() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return data_;
+  void update(const ContestData &data) {
+    TRACE_SCOPE("store", "ContestStore::update");
+    publish(data);
   }
-
-private:
-  mutable std::mutex mutex_;
-  ContestData data_;
 };
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "SnapshotStore.h"
+#include "Tracer.h"
+
+// A QSO broadcast by a contest logger (N1MM Logger+ and compatibles).
+struct ContestQso {
+  enum class Op : uint8_t { Add, Replace, Delete };
+
+  Op op = Op::Add;
+  std::string id;   // the logger's, stays the same when the QSO is edited
+  int64_t time = 0; // Unix seconds, when it reached us
+  std::string call;
+  double freqKhz = 0;
+  std::string mode;
+  std::string contest;
+  std::string station; // the logging computer in a multi-op network
+  std::string operatorCall;
+};
+
+// One radio of one station, as its last RadioInfo described it.
+struct ContestRadio {
+  std::string station;
+  int radioNr = 0;
+  double rxKhz = 0;
+  double txKhz = 0;
+  int band = -1; // index into kBands
+  std::string mode;
+  std::string opCall;
+  std::string radioName;
+  bool running = false;
+  bool transmitting = false;
+  bool connected = false;
+  std::chrono::system_clock::time_point updated;
+};
+
+struct ContestScore {
+  std::string contest;
+  std::string call;
+  int64_t score = 0;
+  int qsos = 0;
+  int points = 0;
+  int mults = 0;
+  std::chrono::system_clock::time_point updated;
+};
+
+struct ContestLogData {
+  static constexpr int kWindowMinutes = 60;
+
+  // QSOs of the last kWindowMinutes by every station, oldest first: the
+  // time and a hash of the logger's id, all the rates need.
+  struct Entry {
+    int64_t time;
+    uint64_t id;
+  };
+  std::vector<Entry> recent;
+  // New and edited QSOs, oldest first, and how many there ever were, so a
+  // reader can tell which ones it has not seen.
+  std::vector<ContestQso> logged;
+  uint64_t loggedTotal = 0;
+  int qsos = 0; // logged since start, less deletions
+  std::string contest;
+
+  std::vector<ContestRadio> radios;
+  ContestScore score;
+  bool hasScore = false;
+
+  int countSince(int64_t since) const {
+    auto it = std::lower_bound(
+        recent.begin(), recent.end(), since,
+        [](const Entry &e, int64_t t) { return e.time < t; });
+    return static_cast<int>(recent.end() - it);
+  }
+  // QSOs per hour over the last 'minutes', ending at 'now'.
+  double rate(int64_t now, int minutes) const {
+    return countSince(now - minutes * 60) * 60.0 / minutes;
+  }
+};
+
+// What the provider collected from one burst of datagrams; applied in one
+// step so a multi-op burst is one snapshot, not one per QSO.
+struct ContestLogUpdate {
+  std::vector<ContestQso> qsos; // in the order they arrived
+  std::vector<ContestRadio> radios;
+  ContestScore score;
+  bool hasScore = false;
+
+  bool empty() const { return qsos.empty() && radios.empty() && !hasScore; }
+  void clear() {
+    qsos.clear();
+    radios.clear();
+    hasScore = false;
+  }
+};
+
+// Written by DXClusterProvider's UDP sources, read on the main thread.
+class ContestLogStore : public SnapshotStore<ContestLogData> {
+public:
+  static constexpr size_t kMaxLogged = 64;
+  // A 24-hour multi-multi peaks near 1000 QSOs an hour.
+  static constexpr size_t kMaxRecent = 4096;
+
+  ContestLogStore() : SnapshotStore(ChangeBus::Topic::ContestLog) {}
+
+  void apply(const ContestLogUpdate &u, int64_t now) {
+    TRACE_SCOPE("store", "ContestLogStore::apply");
+    modify([&](ContestLogData &d) {
+      for (const ContestQso &q : u.qsos)
+        applyQso(d, q);
+      int64_t cutoff = now - ContestLogData::kWindowMinutes * 60;
+      auto keep = std::lower_bound(
+          d.recent.begin(), d.recent.end(), cutoff,
+          [](const ContestLogData::Entry &e, int64_t t) { return e.time < t; });
+      if (d.recent.end() - keep > static_cast<ptrdiff_t>(kMaxRecent))
+        keep = d.recent.end() - kMaxRecent;
+      d.recent.erase(d.recent.begin(), keep);
+      if (d.logged.size() > kMaxLogged)
+        d.logged.erase(d.logged.begin(), d.logged.end() - kMaxLogged);
+
+      for (const ContestRadio &r : u.radios) {
+        auto it = std::find_if(
+            d.radios.begin(), d.radios.end(), [&](const ContestRadio &x) {
+              return x.station == r.station && x.radioNr == r.radioNr;
+            });
+        if (it == d.radios.end())
+          d.radios.push_back(r);
+        else
+          *it = r;
+      }
+      if (u.hasScore) {
+        d.score = u.score;
+        d.hasScore = true;
+      }
+    });
+  }
+
+  static uint64_t hashId(std::string_view id) {
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : id) {
+      h ^= c;
+      h *= 1099511628211ULL;
+    }
+    return h;
+  }
+
+private:
+  static void applyQso(ContestLogData &d, const ContestQso &q) {
+    uint64_t id = hashId(q.id);
+    auto found = q.id.empty()
+                     ? d.recent.end()
+                     : std::find_if(d.recent.begin(), d.recent.end(),
+                                    [&](const ContestLogData::Entry &e) {
+                                      return e.id == id;
+                                    });
+    bool known = found != d.recent.end();
+    // An edit leaves the QSO where it was in time.
+    int64_t time = known ? found->time : q.time;
+    if (known)
+      d.recent.erase(found);
+
+    if (q.op == ContestQso::Op::Delete) {
+      if (known)
+        d.qsos--;
+      return;
+    }
+    // An edit of a QSO older than the window moves nothing.
+    if (q.op == ContestQso::Op::Add || known) {
+      ContestLogData::Entry e{time, id};
+      auto at = std::upper_bound(
+          d.recent.begin(), d.recent.end(), e,
+          [](const ContestLogData::Entry &a, const ContestLogData::Entry &b) {
+            return a.time < b.time;
+          });
+      d.recent.insert(at, e);
+    }
+    // A repeated broadcast of a QSO we have is not another QSO.
+    if (q.op == ContestQso::Op::Add) {
+      if (known)
+        return;
+      d.qsos++;
+    }
+    if (!q.contest.empty())
+      d.contest = q.contest;
+    d.logged.push_back(q);
+    d.loggedTotal++;
+  }
+};
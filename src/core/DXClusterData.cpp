@@ -1,170 +1,422 @@
 #include "DXClusterData.h"
 #include "DatabaseManager.h"
+#include "LiveSpotData.h"
 #include "Logger.h"
+#include "SpotArchive.h"
+#include "SpotEnricher.h"
+#include "Tracer.h"
 #include <algorithm>
 #include <chrono>
 #include <cmath>
-#include <sstream>
 
 namespace {
-std::string sqlEscape(const std::string &s) {
-  std::string out;
-  out.reserve(s.size());
-  for (char c : s) {
-    if (c == '\'')
-      out += "''";
-    else
-      out += c;
-  }
-  return out;
+int64_t toUnixSeconds(std::chrono::system_clock::time_point tp) {
+  return std::chrono::duration_cast<std::chrono::seconds>(
+             tp.time_since_epoch())
+      .count();
+}
+
+int64_t steadyMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
 }
 } // namespace
 
-DXClusterDataStore::DXClusterDataStore() { loadPersisted(); }
+void DXClusterSpot::classify() {
+  band = static_cast<int8_t>(freqToBandIndex(freqKhz));
+  modeId = spotModeFromName(mode);
+  if (modeId == SpotMode::Unknown)
+    modeId = SpotEnricher::guessMode(freqKhz);
+  txCont = continentAt(txLat, txLon);
+  rxCont = continentAt(rxLat, rxLon);
+}
+
+SpotFilter::Fields DXClusterSpot::filterFields() const {
+  SpotFilter::Fields f;
+  f.band = band;
+  f.mode = modeId;
+  f.dxCont = txCont;
+  f.deCont = rxCont;
+  f.dxcc = txDxcc;
+  f.need = need;
+  f.freqKhz = freqKhz;
+  f.spottedAt = toUnixSeconds(spottedAt);
+  f.call = txCall;
+  f.spotter = rxCall;
+  return f;
+}
+
+SpotFilter::Fields DXSpotRef::filterFields() const {
+  const DXSpotTable &t = *table_;
+  SpotFilter::Fields f;
+  f.band = t.band[index_];
+  f.mode = t.modeId[index_];
+  f.dxCont = t.txCont[index_];
+  f.deCont = t.rxCont[index_];
+  f.dxcc = t.txDxcc[index_];
+  f.need = t.need[index_];
+  f.freqKhz = t.freqKhz[index_];
+  f.spottedAt = t.spottedAt[index_];
+  f.call = txCall();
+  f.spotter = rxCall();
+  return f;
+}
+
+DXClusterSpot DXSpotRef::toSpot() const {
+  DXClusterSpot s;
+  s.txCall = txCall();
+  s.txGrid = txGrid();
+  s.rxCall = rxCall();
+  s.rxGrid = rxGrid();
+  s.txDxcc = txDxcc();
+  s.rxDxcc = rxDxcc();
+  s.txCqZone = static_cast<uint8_t>(txCqZone());
+  s.txItuZone = static_cast<uint8_t>(txItuZone());
+  s.mode = mode();
+  s.freqKhz = freqKhz();
+  s.snr = snr();
+  s.dtSecs = dtSecs();
+  s.txLat = txLat();
+  s.txLon = txLon();
+  s.rxLat = rxLat();
+  s.rxLon = rxLon();
+  s.spottedAt = spottedAt();
+  s.sources = sources();
+  s.band = static_cast<int8_t>(band());
+  s.modeId = modeId();
+  s.txCont = txCont();
+  s.rxCont = rxCont();
+  s.distanceKm = distanceKm();
+  s.bearingDeg = bearingDeg();
+  s.need = need();
+  return s;
+}
+
+void DXSpotTable::push_back(const DXClusterSpot &spot) {
+  Interner &strings = Interner::instance();
+  freqKhz.push_back(spot.freqKhz);
+  spottedAt.push_back(toUnixSeconds(spot.spottedAt));
+  snr.push_back(static_cast<float>(spot.snr));
+  dtSecs.push_back(spot.dtSecs);
+  txLat.push_back(static_cast<float>(spot.txLat));
+  txLon.push_back(static_cast<float>(spot.txLon));
+  rxLat.push_back(static_cast<float>(spot.rxLat));
+  rxLon.push_back(static_cast<float>(spot.rxLon));
+  txCall.push_back(strings.intern(spot.txCall));
+  txGrid.push_back(strings.intern(spot.txGrid));
+  rxCall.push_back(strings.intern(spot.rxCall));
+  rxGrid.push_back(strings.intern(spot.rxGrid));
+  mode.push_back(strings.intern(spot.mode));
+  txDxcc.push_back(static_cast<int16_t>(spot.txDxcc));
+  rxDxcc.push_back(static_cast<int16_t>(spot.rxDxcc));
+  txCqZone.push_back(spot.txCqZone);
+  txItuZone.push_back(spot.txItuZone);
+  sources.push_back(spot.sources);
+  band.push_back(spot.band);
+  modeId.push_back(spot.modeId);
+  txCont.push_back(spot.txCont);
+  rxCont.push_back(spot.rxCont);
+  distanceKm.push_back(spot.distanceKm);
+  bearingDeg.push_back(spot.bearingDeg);
+  need.push_back(spot.need);
+}
+
+void DXSpotTable::reserve(size_t n) {
+  forEachColumn([n](auto &column) { column.reserve(n); });
+}
+
+void DXSpotTable::clear() {
+  forEachColumn([](auto &column) { column.clear(); });
+}
 
-DXClusterDataStore::~DXClusterDataStore() {}
+DXClusterDataStore::DXClusterDataStore(std::shared_ptr<SpotArchive> archive)
+    : SnapshotStore(ChangeBus::Topic::DXCluster), archive_(std::move(archive)) {
+  loadPersisted();
+  writer_ = std::thread(&DXClusterDataStore::writerLoop, this);
+}
+
+DXClusterDataStore::~DXClusterDataStore() {
+  {
+    std::lock_guard<std::mutex> lock(wakeMutex_);
+    stopWriter_ = true;
+  }
+  wakeCv_.notify_one();
+  if (writer_.joinable())
+    writer_.join(); // flushes whatever is still queued
+}
 
 void DXClusterDataStore::loadPersisted() {
   auto &db = DatabaseManager::instance();
-  auto now = std::chrono::system_clock::now();
-  auto cutoff = now - std::chrono::minutes(60);
-  int64_t cutoffTs = std::chrono::duration_cast<std::chrono::seconds>(
-                         cutoff.time_since_epoch())
-                         .count();
+  auto cutoff = std::chrono::system_clock::now() - std::chrono::minutes(60);
+  int64_t cutoffTs = toUnixSeconds(cutoff);
 
-  std::string sql =
+  DXSpotTable spots;
+  db.query(
       "SELECT tx_call, tx_grid, rx_call, rx_grid, mode, freq_khz, snr, tx_lat, "
-      "tx_lon, rx_lat, rx_lon, spotted_at FROM dx_spots WHERE spotted_at > " +
-      std::to_string(cutoffTs);
-
-  std::lock_guard<std::mutex> lock(mutex_);
-  data_.spots.clear();
-
-  db.query(sql, [this](const DatabaseManager::Row &row) {
-    if (row.size() < 12)
-      return true;
-    DXClusterSpot s;
-    s.txCall = row[0];
-    s.txGrid = row[1];
-    s.rxCall = row[2];
-    s.rxGrid = row[3];
-    s.mode = row[4];
-    try {
-      s.freqKhz = std::stod(row[5]);
-      s.snr = std::stod(row[6]);
-      s.txLat = std::stod(row[7]);
-      s.txLon = std::stod(row[8]);
-      s.rxLat = std::stod(row[9]);
-      s.rxLon = std::stod(row[10]);
-      int64_t ts = std::stoll(row[11]);
-      s.spottedAt =
-          std::chrono::system_clock::time_point(std::chrono::seconds(ts));
-    } catch (...) {
-      return true; // convert error, skip
-    }
-    data_.spots.push_back(s);
-    return true;
-  });
+      "tx_lon, rx_lat, rx_lon, spotted_at FROM dx_spots WHERE spotted_at > ?",
+      {cutoffTs}, [&spots](const DatabaseManager::Cursor &row) {
+        DXClusterSpot s;
+        s.txCall = row.getText(0);
+        s.txGrid = row.getText(1);
+        s.rxCall = row.getText(2);
+        s.rxGrid = row.getText(3);
+        s.mode = row.getText(4);
+        s.freqKhz = row.getDouble(5);
+        s.snr = row.getDouble(6);
+        s.txLat = row.getDouble(7);
+        s.txLon = row.getDouble(8);
+        s.rxLat = row.getDouble(9);
+        s.rxLon = row.getDouble(10);
+        s.spottedAt = std::chrono::system_clock::time_point(
+            std::chrono::seconds(row.getInt(11)));
+        s.classify();
+        spots.push_back(s);
+        return true;
+      });
 
-  LOG_I("DXClusterDataStore", "Loaded {} persisted spots", data_.spots.size());
+  LOG_I("DXClusterDataStore", "Loaded {} persisted spots", spots.size());
+  modify([&](DXClusterData &data) { data.spots = std::move(spots); });
 }
 
-DXClusterData DXClusterDataStore::get() const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return data_;
+void DXClusterDataStore::refreshNeed(const SpotEnricher &enricher) {
+  TRACE_SCOPE("store", "DXClusterDataStore::refreshNeed");
+  // Spots read back from the database keep their stored position, which was
+  // worked out (and jittered) before they were first stored.
+  modify([&](DXClusterData &data) {
+    DXSpotTable &t = data.spots;
+    for (size_t i = 0; i < t.size(); ++i) {
+      if (t.txDxcc[i] == 0) {
+        SpotStation st = enricher.locate(t[i].txCall(), {});
+        t.txDxcc[i] = static_cast<int16_t>(st.dxcc);
+        t.txCqZone[i] = static_cast<uint8_t>(st.cqZone);
+        t.txItuZone[i] = static_cast<uint8_t>(st.ituZone);
+        if (t.txLat[i] != 0 || t.txLon[i] != 0)
+          enricher.measure(t.txLat[i], t.txLon[i], t.distanceKm[i],
+                           t.bearingDeg[i]);
+      }
+      t.need[i] = enricher.need(t.txDxcc[i], t.band[i], t.modeId[i]);
+    }
+    if (data.hasSelection) {
+      DXClusterSpot &s = data.selectedSpot;
+      if (s.txDxcc == 0) {
+        SpotStation st = enricher.locate(s.txCall, {});
+        s.txDxcc = st.dxcc;
+        s.txCqZone = static_cast<uint8_t>(st.cqZone);
+        s.txItuZone = static_cast<uint8_t>(st.ituZone);
+        if (s.txLat != 0 || s.txLon != 0)
+          enricher.measure(s.txLat, s.txLon, s.distanceKm, s.bearingDeg);
+      }
+      s.need = enricher.need(s.txDxcc, s.band, s.modeId);
+    }
+  });
 }
 
 void DXClusterDataStore::set(const DXClusterData &data) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  data_ = data;
+  TRACE_SCOPE("store", "DXClusterDataStore::set");
+  publish(data);
   // TODO: Full replace in DB? Usually we just add spots incrementally.
 }
 
 void DXClusterDataStore::addSpot(const DXClusterSpot &spot) {
-  std::lock_guard<std::mutex> lock(mutex_);
+  if (!ring_.tryPush(spot)) {
+    // The writer is far behind; shedding spots beats blocking the socket.
+    if (dropped_.fetch_add(1, std::memory_order_relaxed) % 1000 == 0)
+      LOG_W("DXClusterDataStore", "Spot ring full, dropping spots");
+    return;
+  }
+  queued_.fetch_add(1, std::memory_order_relaxed);
+  if (oldestQueuedUs_.load(std::memory_order_relaxed) == 0)
+    oldestQueuedUs_.store(steadyMicros(), std::memory_order_relaxed);
+  if (ring_.size() >= kBatchSpots)
+    wakeCv_.notify_one();
+}
 
-  // Create a copy to modify (dithering)
-  DXClusterSpot s = spot;
+void DXClusterDataStore::addSourceReport(const std::string &txCall,
+                                         double freqKhz, uint32_t sources) {
+  // Losing one just leaves a source tag off a row; not worth counting.
+  reports_.tryPush({txCall, freqKhz, sources});
+}
 
-  // Apply dithering to prevent stacking
-  // +/- ~0.5 degree (approx 2 pixels on 800px wide map)
-  if (s.txLat != 0 || s.txLon != 0) {
-    s.txLat += (static_cast<float>(rand() % 100) / 50.0f - 1.0f) * 0.5f;
-    s.txLon += (static_cast<float>(rand() % 100) / 50.0f - 1.0f) * 0.5f;
-  }
-  if (s.rxLat != 0 || s.rxLon != 0) {
-    s.rxLat += (static_cast<float>(rand() % 100) / 50.0f - 1.0f) * 0.5f;
-    s.rxLon += (static_cast<float>(rand() % 100) / 50.0f - 1.0f) * 0.5f;
+void DXClusterDataStore::writerLoop() {
+  if (Tracer::enabled())
+    Tracer::instance().setThreadName("dx spot writer");
+  auto lastPrune = std::chrono::steady_clock::now();
+  for (;;) {
+    bool stop;
+    {
+      std::unique_lock<std::mutex> lock(wakeMutex_);
+      wakeCv_.wait_for(lock, kFlushInterval, [this] {
+        return stopWriter_ || ring_.size() >= kBatchSpots;
+      });
+      stop = stopWriter_;
+    }
+
+    flush();
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastPrune >= kPruneInterval) {
+      lastPrune = now;
+      pruneExpired();
+    }
+    if (stop)
+      return;
   }
+}
 
-  // Add to memory
-  data_.spots.push_back(s);
-  data_.lastUpdate = std::chrono::system_clock::now();
+void DXClusterDataStore::flush() {
+  // Taken before draining: a spot queued in between is counted again with
+  // the next batch, which errs on the high side.
+  int64_t oldestUs = oldestQueuedUs_.exchange(0, std::memory_order_relaxed);
+  std::vector<DXClusterSpot> batch;
+  DXClusterSpot spot;
+  while (ring_.tryPop(spot))
+    batch.push_back(std::move(spot));
+  // Drained after the spots, so each report's spot is already in the batch
+  // or the store.
+  std::vector<SourceReport> reports;
+  SourceReport report;
+  while (reports_.tryPop(report))
+    reports.push_back(std::move(report));
+  if (batch.empty() && reports.empty())
+    return;
 
-  // Persist to DB
-  auto &db = DatabaseManager::instance();
-  int64_t ts = std::chrono::duration_cast<std::chrono::seconds>(
-                   s.spottedAt.time_since_epoch())
-                   .count();
+  TRACE_SCOPE("store", "DXClusterDataStore::flush");
+  auto started = std::chrono::steady_clock::now();
 
-  std::stringstream ss;
-  ss << "INSERT OR IGNORE INTO dx_spots (tx_call, tx_grid, rx_call, rx_grid, "
-        "mode, "
-        "freq_khz, snr, tx_lat, tx_lon, rx_lat, rx_lon, spotted_at) VALUES ('"
-     << sqlEscape(s.txCall) << "', '" << sqlEscape(s.txGrid) << "', '"
-     << sqlEscape(s.rxCall) << "', '" << sqlEscape(s.rxGrid) << "', '"
-     << sqlEscape(s.mode) << "', " << s.freqKhz << ", " << s.snr << ", "
-     << s.txLat << ", " << s.txLon << ", " << s.rxLat << ", " << s.rxLon << ", "
-     << ts << ")";
+  // One publish for the whole batch; readers keep whatever snapshot they
+  // already hold.
+  modify([&](DXClusterData &data) {
+    for (const auto &s : batch)
+      data.spots.push_back(s);
+    for (const auto &r : reports)
+      applyReport(data, r);
+    data.lastUpdate = std::chrono::system_clock::now();
+    pruneOldSpots(data);
+  });
+  if (batch.empty())
+    return;
+  if (oldestUs != 0) {
+    auto latencyUs = static_cast<uint32_t>(steadyMicros() - oldestUs);
+    lastLatencyUs_.store(latencyUs, std::memory_order_relaxed);
+    if (latencyUs > maxLatencyUs_.load(std::memory_order_relaxed))
+      maxLatencyUs_.store(latencyUs, std::memory_order_relaxed);
+  }
 
-  db.exec(ss.str());
+  // Persist in one transaction, after the store is already updated.
+  std::vector<DatabaseManager::Params> rows;
+  rows.reserve(batch.size());
+  for (const auto &s : batch) {
+    rows.push_back({s.txCall, s.txGrid, s.rxCall, s.rxGrid, s.mode, s.freqKhz,
+                    s.snr, s.txLat, s.txLon, s.rxLat, s.rxLon,
+                    toUnixSeconds(s.spottedAt)});
+  }
+  DatabaseManager::instance().execMany(
+      "INSERT OR IGNORE INTO dx_spots (tx_call, tx_grid, rx_call, rx_grid, "
+      "mode, freq_khz, snr, tx_lat, tx_lon, rx_lat, rx_lon, spotted_at) "
+      "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)",
+      rows);
+  if (archive_)
+    archive_->append(batch);
 
-  pruneOldSpots();
+  written_.fetch_add(batch.size(), std::memory_order_relaxed);
+  batches_.fetch_add(1, std::memory_order_relaxed);
+  lastBatchUs_.store(static_cast<uint32_t>(
+                         std::chrono::duration_cast<std::chrono::microseconds>(
+                             std::chrono::steady_clock::now() - started)
+                             .count()),
+                     std::memory_order_relaxed);
+  TRACE_COUNTER("store", "dx_spot_batch", batch.size());
+}
+
+void DXClusterDataStore::pruneExpired() {
+  TRACE_SCOPE("store", "DXClusterDataStore::pruneExpired");
+  // Only publish when something actually aged out.
+  int64_t cutoff =
+      toUnixSeconds(std::chrono::system_clock::now() - kMaxSpotAge);
+  auto snap = snapshot();
+  const auto &times = snap->spots.spottedAt;
+  bool stale = std::any_of(times.begin(), times.end(),
+                           [&](int64_t t) { return t < cutoff; });
+  if (stale)
+    modify([](DXClusterData &data) { pruneOldSpots(data); });
+  pruneDb();
+}
+
+DXSpotIngestStats DXClusterDataStore::ingestStats() const {
+  DXSpotIngestStats st;
+  st.queued = queued_.load(std::memory_order_relaxed);
+  st.dropped = dropped_.load(std::memory_order_relaxed);
+  st.written = written_.load(std::memory_order_relaxed);
+  st.batches = batches_.load(std::memory_order_relaxed);
+  st.pending = ring_.size();
+  st.lastBatchMs = lastBatchUs_.load(std::memory_order_relaxed) / 1000.0;
+  st.lastLatencyMs = lastLatencyUs_.load(std::memory_order_relaxed) / 1000.0;
+  st.maxLatencyMs = maxLatencyUs_.load(std::memory_order_relaxed) / 1000.0;
+  return st;
 }
 
 void DXClusterDataStore::setConnected(bool connected,
                                       const std::string &status) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  data_.connected = connected;
-  data_.statusMsg = status;
-  data_.lastUpdate = std::chrono::system_clock::now();
+  modify([&](DXClusterData &data) {
+    data.connected = connected;
+    data.statusMsg = status;
+    data.lastUpdate = std::chrono::system_clock::now();
+  });
+}
+
+void DXClusterDataStore::setSources(
+    std::vector<DXClusterSourceStatus> sources) {
+  modify([&](DXClusterData &data) { data.sources = std::move(sources); });
 }
 
 void DXClusterDataStore::clear() {
-  std::lock_guard<std::mutex> lock(mutex_);
-  data_.spots.clear();
-  data_.lastUpdate = std::chrono::system_clock::now();
+  modify([](DXClusterData &data) {
+    data.spots.clear();
+    data.lastUpdate = std::chrono::system_clock::now();
+  });
   DatabaseManager::instance().exec("DELETE FROM dx_spots");
 }
 
-void DXClusterDataStore::pruneOldSpots() {
-  auto now = std::chrono::system_clock::now();
-  auto maxAge = std::chrono::minutes(60); // Default 60 mins
+void DXClusterDataStore::pruneOldSpots(DXClusterData &data) {
+  int64_t cutoff =
+      toUnixSeconds(std::chrono::system_clock::now() - kMaxSpotAge);
+  const auto &times = data.spots.spottedAt;
+  data.spots.eraseIf([&](DXSpotRef s) { return times[s.index()] < cutoff; });
+}
 
-  // Prune memory
-  data_.spots.erase(std::remove_if(data_.spots.begin(), data_.spots.end(),
-                                   [&](const DXClusterSpot &s) {
-                                     return (now - s.spottedAt) > maxAge;
-                                   }),
-                    data_.spots.end());
+void DXClusterDataStore::applyReport(DXClusterData &data,
+                                     const SourceReport &report) {
+  // Same match as SpotDeduper: the newest spot of this call whose
+  // frequency, rounded to a kHz, is within one kHz of the report's.
+  Interner::Id call = Interner::instance().find(report.txCall);
+  if (call == Interner::kEmpty)
+    return;
+  int64_t khz = std::llround(report.freqKhz);
+  DXSpotTable &t = data.spots;
+  for (size_t i = t.size(); i-- > 0;) {
+    if (t.txCall[i] == call &&
+        std::llabs(std::llround(t.freqKhz[i]) - khz) <= 1) {
+      t.sources[i] |= report.sources;
+      return;
+    }
+  }
+}
 
-  // Prune DB (occasionally? or every time? Let's do it every time for correct
-  // sync)
-  int64_t cutoffTs = std::chrono::duration_cast<std::chrono::seconds>(
-                         (now - maxAge).time_since_epoch())
-                         .count();
-  std::string sql =
-      "DELETE FROM dx_spots WHERE spotted_at <= " + std::to_string(cutoffTs);
-  DatabaseManager::instance().exec(sql);
+void DXClusterDataStore::pruneDb() {
+  auto cutoff = std::chrono::system_clock::now() - kMaxSpotAge;
+  int64_t cutoffTs = toUnixSeconds(cutoff);
+  DatabaseManager::instance().exec(
+      "DELETE FROM dx_spots WHERE spotted_at <= ?", {cutoffTs});
 }
 
 void DXClusterDataStore::selectSpot(const DXClusterSpot &spot) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  data_.hasSelection = true;
-  data_.selectedSpot = spot;
+  modify([&](DXClusterData &data) {
+    data.hasSelection = true;
+    data.selectedSpot = spot;
+  });
 }
 
 void DXClusterDataStore::clearSelection() {
-  std::lock_guard<std::mutex> lock(mutex_);
-  data_.hasSelection = false;
+  modify([](DXClusterData &data) { data.hasSelection = false; });
 }
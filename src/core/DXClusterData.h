@@ -1,12 +1,26 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <cstdlib>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
 
+#include "Interner.h"
+#include "SnapshotStore.h"
+#include "SpotFilter.h"
+#include "SpscRing.h"
+
+class SpotArchive;
+class SpotEnricher;
+
 struct DXClusterSpot {
   std::string txCall;
   std::string txGrid;
@@ -15,10 +29,14 @@ struct DXClusterSpot {
 
   int txDxcc = 0;
   int rxDxcc = 0;
+  uint8_t txCqZone = 0; // 0 = unknown
+  uint8_t txItuZone = 0;
 
   std::string mode;
   double freqKhz = 0.0;
   double snr = 0.0;
+  // Clock offset of a WSJT-X decode; NaN for other spots. Not persisted.
+  float dtSecs = std::numeric_limits<float>::quiet_NaN();
 
   double txLat = 0.0;
   double txLon = 0.0;
@@ -26,26 +44,292 @@ struct DXClusterSpot {
   double rxLon = 0.0;
 
   std::chrono::system_clock::time_point spottedAt;
+
+  // Bit i is set once cluster source i reported this spot (0 for spots
+  // loaded from the database).
+  uint32_t sources = 0;
+
+  // Derived once at ingest by SpotEnricher, so filters and panels only
+  // read small ints.
+  int8_t band = -1;
+  SpotMode modeId = SpotMode::Unknown; // guessed from the band plan if unnamed
+  Continent txCont = Continent::Unknown;
+  Continent rxCont = Continent::Unknown;
+  float distanceKm = 0; // from DE; 0 if the DX has no position
+  float bearingDeg = 0;
+  // Refreshed when the log changes.
+  SpotNeed need = SpotNeed::None;
+
+  // Fills band, modeId and the continents from freqKhz, mode and the stored
+  // positions, for spots read back from the database.
+  void classify();
+  SpotFilter::Fields filterFields() const;
+};
+
+class DXSpotTable;
+
+// Non-owning view of one row of a DXSpotTable: a pointer and an index, so
+// it is free to copy. Valid for as long as the table is, which for a store
+// snapshot is as long as the snapshot is held.
+class DXSpotRef {
+public:
+  DXSpotRef(const DXSpotTable &table, size_t index)
+      : table_(&table), index_(index) {}
+
+  size_t index() const { return index_; }
+
+  std::string_view txCall() const;
+  std::string_view txGrid() const;
+  std::string_view rxCall() const;
+  std::string_view rxGrid() const;
+  std::string_view mode() const;
+  double freqKhz() const;
+  float snr() const;
+  float dtSecs() const;
+  float txLat() const;
+  float txLon() const;
+  float rxLat() const;
+  float rxLon() const;
+  std::chrono::system_clock::time_point spottedAt() const;
+  int txDxcc() const;
+  int rxDxcc() const;
+  int txCqZone() const;
+  int txItuZone() const;
+  uint32_t sources() const;
+  int band() const;
+  SpotMode modeId() const;
+  Continent txCont() const;
+  Continent rxCont() const;
+  float distanceKm() const;
+  float bearingDeg() const;
+  SpotNeed need() const;
+
+  SpotFilter::Fields filterFields() const;
+  // An owning copy, e.g. to keep as the selected spot.
+  DXClusterSpot toSpot() const;
+
+private:
+  const DXSpotTable *table_;
+  size_t index_;
+};
+
+// Spots stored column by column (structure of arrays), oldest first. Every
+// column holds size() entries. Strings are Interner ids and positions are
+// floats, so a spot takes about 80 bytes in one place instead of a 256-byte
+// DXClusterSpot, and copying the table for a store update is a couple of
+// dozen memcpy-like vector copies however many spots it holds.
+//
+// Rows are added with push_back() and removed with eraseIf(); the columns
+// are public so loops that need one field can scan just that array.
+class DXSpotTable {
+public:
+  std::vector<double> freqKhz;
+  std::vector<int64_t> spottedAt; // unix seconds
+  std::vector<float> snr;
+  std::vector<float> dtSecs;
+  std::vector<float> txLat;
+  std::vector<float> txLon;
+  std::vector<float> rxLat;
+  std::vector<float> rxLon;
+  std::vector<Interner::Id> txCall;
+  std::vector<Interner::Id> txGrid;
+  std::vector<Interner::Id> rxCall;
+  std::vector<Interner::Id> rxGrid;
+  std::vector<Interner::Id> mode;
+  std::vector<int16_t> txDxcc;
+  std::vector<int16_t> rxDxcc;
+  std::vector<uint8_t> txCqZone;
+  std::vector<uint8_t> txItuZone;
+  std::vector<uint32_t> sources;
+  std::vector<int8_t> band;
+  std::vector<SpotMode> modeId;
+  std::vector<Continent> txCont;
+  std::vector<Continent> rxCont;
+  std::vector<float> distanceKm;
+  std::vector<float> bearingDeg;
+  std::vector<SpotNeed> need;
+
+  class Iterator {
+  public:
+    Iterator(const DXSpotTable &table, size_t index)
+        : table_(&table), index_(index) {}
+    DXSpotRef operator*() const { return {*table_, index_}; }
+    Iterator &operator++() {
+      ++index_;
+      return *this;
+    }
+    bool operator==(const Iterator &o) const { return index_ == o.index_; }
+
+  private:
+    const DXSpotTable *table_;
+    size_t index_;
+  };
+
+  size_t size() const { return freqKhz.size(); }
+  bool empty() const { return freqKhz.empty(); }
+  DXSpotRef operator[](size_t i) const { return {*this, i}; }
+  DXSpotRef back() const { return {*this, size() - 1}; }
+  Iterator begin() const { return {*this, 0}; }
+  Iterator end() const { return {*this, size()}; }
+
+  void push_back(const DXClusterSpot &spot);
+  void reserve(size_t n);
+  void clear();
+  // Removes every row 'remove' returns true for, keeping the order.
+  template <typename Pred> void eraseIf(Pred remove);
+
+private:
+  // Calls fn(column) for every column.
+  template <typename Fn> void forEachColumn(Fn &&fn);
+};
+
+template <typename Pred> void DXSpotTable::eraseIf(Pred remove) {
+  std::vector<uint8_t> keep(size());
+  size_t kept = 0;
+  for (size_t i = 0; i < keep.size(); ++i) {
+    keep[i] = !remove(DXSpotRef(*this, i));
+    kept += keep[i];
+  }
+  if (kept == keep.size())
+    return;
+  forEachColumn([&](auto &column) {
+    size_t out = 0;
+    for (size_t i = 0; i < keep.size(); ++i) {
+      if (keep[i])
+        column[out++] = column[i];
+    }
+    column.resize(out);
+  });
+}
+
+template <typename Fn> void DXSpotTable::forEachColumn(Fn &&fn) {
+  fn(freqKhz);
+  fn(spottedAt);
+  fn(snr);
+  fn(dtSecs);
+  fn(txLat);
+  fn(txLon);
+  fn(rxLat);
+  fn(rxLon);
+  fn(txCall);
+  fn(txGrid);
+  fn(rxCall);
+  fn(rxGrid);
+  fn(mode);
+  fn(txDxcc);
+  fn(rxDxcc);
+  fn(txCqZone);
+  fn(txItuZone);
+  fn(sources);
+  fn(band);
+  fn(modeId);
+  fn(txCont);
+  fn(rxCont);
+  fn(distanceKm);
+  fn(bearingDeg);
+  fn(need);
+}
+
+inline std::string_view DXSpotRef::txCall() const {
+  return Interner::instance().view(table_->txCall[index_]);
+}
+inline std::string_view DXSpotRef::txGrid() const {
+  return Interner::instance().view(table_->txGrid[index_]);
+}
+inline std::string_view DXSpotRef::rxCall() const {
+  return Interner::instance().view(table_->rxCall[index_]);
+}
+inline std::string_view DXSpotRef::rxGrid() const {
+  return Interner::instance().view(table_->rxGrid[index_]);
+}
+inline std::string_view DXSpotRef::mode() const {
+  return Interner::instance().view(table_->mode[index_]);
+}
+inline double DXSpotRef::freqKhz() const { return table_->freqKhz[index_]; }
+inline float DXSpotRef::snr() const { return table_->snr[index_]; }
+inline float DXSpotRef::dtSecs() const { return table_->dtSecs[index_]; }
+inline float DXSpotRef::txLat() const { return table_->txLat[index_]; }
+inline float DXSpotRef::txLon() const { return table_->txLon[index_]; }
+inline float DXSpotRef::rxLat() const { return table_->rxLat[index_]; }
+inline float DXSpotRef::rxLon() const { return table_->rxLon[index_]; }
+inline std::chrono::system_clock::time_point DXSpotRef::spottedAt() const {
+  return std::chrono::system_clock::time_point(
+      std::chrono::seconds(table_->spottedAt[index_]));
+}
+inline int DXSpotRef::txDxcc() const { return table_->txDxcc[index_]; }
+inline int DXSpotRef::rxDxcc() const { return table_->rxDxcc[index_]; }
+inline int DXSpotRef::txCqZone() const { return table_->txCqZone[index_]; }
+inline int DXSpotRef::txItuZone() const { return table_->txItuZone[index_]; }
+inline uint32_t DXSpotRef::sources() const { return table_->sources[index_]; }
+inline int DXSpotRef::band() const { return table_->band[index_]; }
+inline SpotMode DXSpotRef::modeId() const { return table_->modeId[index_]; }
+inline Continent DXSpotRef::txCont() const { return table_->txCont[index_]; }
+inline Continent DXSpotRef::rxCont() const { return table_->rxCont[index_]; }
+inline float DXSpotRef::distanceKm() const {
+  return table_->distanceKm[index_];
+}
+inline float DXSpotRef::bearingDeg() const {
+  return table_->bearingDeg[index_];
+}
+inline SpotNeed DXSpotRef::need() const { return table_->need[index_]; }
+
+// Per-connection counters published by DXClusterProvider.
+struct DXClusterSourceStatus {
+  std::string name;
+  bool connected = false;
+  uint64_t received = 0;   // spot lines parsed
+  uint64_t duplicates = 0; // already reported by this or another source
+  double spotsPerMin = 0;  // received, over the last stats interval
+
+  double dupRatio() const {
+    return received ? static_cast<double>(duplicates) / received : 0.0;
+  }
 };
 
 struct DXClusterData {
-  std::vector<DXClusterSpot> spots;
+  DXSpotTable spots;
   bool connected = false;
   std::string statusMsg;
   std::chrono::system_clock::time_point lastUpdate;
 
   bool hasSelection = false;
   DXClusterSpot selectedSpot;
+
+  // One entry per configured cluster; bit i of DXClusterSpot::sources refers
+  // to sources[i].
+  std::vector<DXClusterSourceStatus> sources;
 };
 
-class DXClusterDataStore {
+// Spot ingest counters, for debugging a busy cluster.
+struct DXSpotIngestStats {
+  uint64_t queued = 0;
+  uint64_t dropped = 0; // ring was full
+  uint64_t written = 0;
+  uint64_t batches = 0;
+  size_t pending = 0;
+  double lastBatchMs = 0; // memory publish + DB transaction
+  // Oldest spot of a batch, from addSpot() until it was published.
+  double lastLatencyMs = 0;
+  double maxLatencyMs = 0;
+};
+
+class DXClusterDataStore : public SnapshotStore<DXClusterData> {
 public:
-  DXClusterDataStore();
+  // With an archive, every spot is also appended to it after the batch is
+  // persisted.
+  explicit DXClusterDataStore(std::shared_ptr<SpotArchive> archive = nullptr);
   ~DXClusterDataStore();
 
-  DXClusterData get() const;
   void set(const DXClusterData &data);
+  // Queues a spot for the writer thread, which publishes and persists spots
+  // in batches. Lock-free; must only be called from one thread at a time
+  // (DXClusterProvider serialises its connection threads).
   void addSpot(const DXClusterSpot &spot);
+  // Another source reported a spot already passed to addSpot(): merge its
+  // bits into that spot's 'sources'. Same threading rules as addSpot().
+  void addSourceReport(const std::string &txCall, double freqKhz,
+                       uint32_t sources);
+  void setSources(std::vector<DXClusterSourceStatus> sources);
   void setConnected(bool connected, const std::string &status = "");
   void clear();
 
@@ -55,10 +339,51 @@ public:
   // Load persisted spots from DB.
   void loadPersisted();
 
+  // Re-evaluates every stored spot against the log, after WorkedMatrix
+  // changed. Spots loaded from the database get their DXCC entity, zones,
+  // distance and bearing here.
+  void refreshNeed(const SpotEnricher &enricher);
+
+  DXSpotIngestStats ingestStats() const;
+
 private:
-  void pruneOldSpots();
-  // We'll keep DB interaction strictly inside implementation for now.
+  static constexpr auto kMaxSpotAge = std::chrono::minutes(60);
+  static constexpr size_t kRingSize = 4096;
+  static constexpr size_t kReportRingSize = 1024;
+  static constexpr size_t kBatchSpots = 256; // flush early at this backlog
+  static constexpr auto kFlushInterval = std::chrono::milliseconds(250);
+  static constexpr auto kPruneInterval = std::chrono::seconds(60);
+
+  struct SourceReport {
+    std::string txCall;
+    double freqKhz = 0;
+    uint32_t sources = 0;
+  };
+
+  static void pruneOldSpots(DXClusterData &data);
+  static void applyReport(DXClusterData &data, const SourceReport &report);
+  static void pruneDb();
+
+  void writerLoop();
+  void flush();
+  void pruneExpired();
+
+  std::shared_ptr<SpotArchive> archive_;
+  SpscRing<DXClusterSpot, kRingSize> ring_;
+  SpscRing<SourceReport, kReportRingSize> reports_;
+  std::thread writer_;
+  std::mutex wakeMutex_; // only for sleeping; never held during I/O
+  std::condition_variable wakeCv_;
+  bool stopWriter_ = false;
 
-  mutable std::mutex mutex_;
-  DXClusterData data_;
+  std::atomic<uint64_t> queued_{0};
+  std::atomic<uint64_t> dropped_{0};
+  std::atomic<uint64_t> written_{0};
+  std::atomic<uint64_t> batches_{0};
+  std::atomic<uint32_t> lastBatchUs_{0};
+  // steady_clock microseconds when the oldest unflushed spot was queued,
+  // 0 = none.
+  std::atomic<int64_t> oldestQueuedUs_{0};
+  std::atomic<uint32_t> lastLatencyUs_{0};
+  std::atomic<uint32_t> maxLatencyUs_{0};
 };
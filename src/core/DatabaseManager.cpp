@@ -8,7 +8,22 @@ DatabaseManager &DatabaseManager::instance() {
 }
 
 DatabaseManager::~DatabaseManager() {
+  {
+    std::lock_guard<std::mutex> lock(checkpointMutex_);
+    stopCheckpoint_ = true;
+  }
+  checkpointCv_.notify_all();
+  if (checkpointThread_.joinable())
+    checkpointThread_.join();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto &[sql, stmt] : stmtCache_)
+    sqlite3_finalize(stmt);
+  stmtCache_.clear();
   if (db_) {
+    // Fold the WAL back into the main file so it does not linger on disk.
+    sqlite3_wal_checkpoint_v2(db_, nullptr, SQLITE_CHECKPOINT_TRUNCATE,
+                              nullptr, nullptr);
     sqlite3_close(db_);
   }
 }
@@ -28,6 +43,25 @@ bool DatabaseManager::init(const std::filesystem::path &dbPath) {
     return false;
   }
 
+  // WAL lets readers run alongside the spot writer, and NORMAL sync is still
+  // crash-safe in WAL mode (only the last commits can be lost on power
+  // failure). Checkpointing is moved off the commit path to our own thread.
+  const char *pragmas = R"(
+    PRAGMA journal_mode=WAL;
+    PRAGMA synchronous=NORMAL;
+    PRAGMA cache_size=-8192;
+    PRAGMA mmap_size=67108864;
+    PRAGMA temp_store=MEMORY;
+    PRAGMA wal_autocheckpoint=0;
+  )";
+  char *pragmaErr = nullptr;
+  if (sqlite3_exec(db_, pragmas, nullptr, nullptr, &pragmaErr) != SQLITE_OK) {
+    // Not fatal: the database still works in its default journal mode.
+    LOG_W("DatabaseManager", "Failed to apply PRAGMAs: {}", pragmaErr);
+    sqlite3_free(pragmaErr);
+  }
+  sqlite3_busy_timeout(db_, 2000);
+
   // Create tables if they don't exist
   const char *schema = R"(
     CREATE TABLE IF NOT EXISTS dx_spots (
@@ -47,6 +81,89 @@ bool DatabaseManager::init(const std::filesystem::path &dbPath) {
     );
     CREATE INDEX IF NOT EXISTS idx_dx_spotted_at ON dx_spots(spotted_at);
     CREATE UNIQUE INDEX IF NOT EXISTS idx_dx_unique ON dx_spots(tx_call, rx_call, freq_khz, spotted_at);
+
+    -- Spot archive (SpotArchive). Raw spots are kept for a few weeks and
+    -- partitioned by UTC day: 'day' leads the index every rollup, expiry and
+    -- hourly query walks.
+    CREATE TABLE IF NOT EXISTS spot_archive (
+      day INTEGER NOT NULL,
+      spotted_at INTEGER NOT NULL,
+      tx_call TEXT NOT NULL,
+      rx_call TEXT,
+      freq_khz REAL,
+      band INTEGER,
+      mode INTEGER,
+      tx_cont INTEGER,
+      rx_cont INTEGER,
+      tx_dxcc INTEGER
+    );
+    CREATE INDEX IF NOT EXISTS idx_archive_day ON spot_archive(day, band, tx_cont, rx_cont, spotted_at);
+    CREATE INDEX IF NOT EXISTS idx_archive_call ON spot_archive(tx_call, spotted_at);
+
+    -- Completed days, one row per band and continent pair with the 24 hourly
+    -- counts packed into 'hours' (little-endian uint32).
+    CREATE TABLE IF NOT EXISTS spot_hourly (
+      band INTEGER,
+      tx_cont INTEGER,
+      rx_cont INTEGER,
+      day INTEGER,
+      hours BLOB NOT NULL,
+      PRIMARY KEY (band, tx_cont, rx_cont, day)
+    ) WITHOUT ROWID;
+    -- The same counts summed over every continent pair, for queries that
+    -- ask for any path.
+    CREATE TABLE IF NOT EXISTS spot_band_hourly (
+      band INTEGER,
+      day INTEGER,
+      hours BLOB NOT NULL,
+      PRIMARY KEY (band, day)
+    ) WITHOUT ROWID;
+
+    -- Kept up to date by the trigger below, so they cover the whole
+    -- summary window, not just the raw one.
+    CREATE TABLE IF NOT EXISTS call_days (
+      tx_call TEXT,
+      day INTEGER,
+      spots INTEGER,
+      bands INTEGER,
+      first_at INTEGER,
+      last_at INTEGER,
+      PRIMARY KEY (tx_call, day)
+    ) WITHOUT ROWID;
+    CREATE INDEX IF NOT EXISTS idx_call_days_day ON call_days(day);
+    CREATE TABLE IF NOT EXISTS entity_last (
+      dxcc INTEGER,
+      band INTEGER,
+      spotted_at INTEGER,
+      tx_call TEXT,
+      freq_khz REAL,
+      PRIMARY KEY (dxcc, band)
+    ) WITHOUT ROWID;
+    CREATE TABLE IF NOT EXISTS archive_meta (
+      key TEXT PRIMARY KEY,
+      value INTEGER
+    );
+
+    CREATE TRIGGER IF NOT EXISTS spot_archive_summary AFTER INSERT ON spot_archive
+    BEGIN
+      INSERT INTO call_days (tx_call, day, spots, bands, first_at, last_at)
+        VALUES (NEW.tx_call, NEW.day, 1,
+                CASE WHEN NEW.band >= 0 THEN 1 << NEW.band ELSE 0 END,
+                NEW.spotted_at, NEW.spotted_at)
+        ON CONFLICT (tx_call, day) DO UPDATE SET
+          spots = spots + 1,
+          bands = bands | excluded.bands,
+          first_at = MIN(first_at, excluded.first_at),
+          last_at = MAX(last_at, excluded.last_at);
+      INSERT INTO entity_last (dxcc, band, spotted_at, tx_call, freq_khz)
+        SELECT NEW.tx_dxcc, NEW.band, NEW.spotted_at, NEW.tx_call, NEW.freq_khz
+        WHERE NEW.tx_dxcc > 0
+        ON CONFLICT (dxcc, band) DO UPDATE SET
+          spotted_at = excluded.spotted_at,
+          tx_call = excluded.tx_call,
+          freq_khz = excluded.freq_khz
+        WHERE excluded.spotted_at >= entity_last.spotted_at;
+    END;
   )";
 
   char *errMsg = nullptr;
@@ -58,10 +175,35 @@ bool DatabaseManager::init(const std::filesystem::path &dbPath) {
     return false;
   }
 
+  checkpointThread_ = std::thread(&DatabaseManager::checkpointLoop, this);
+
   LOG_I("DatabaseManager", "Database initialized at {}", dbPath.string());
   return true;
 }
 
+void DatabaseManager::checkpointLoop() {
+  std::unique_lock<std::mutex> lock(checkpointMutex_);
+  while (!checkpointCv_.wait_for(lock, kCheckpointInterval,
+                                 [this] { return stopCheckpoint_; })) {
+    lock.unlock();
+    {
+      // PASSIVE never waits on readers, so holding mutex_ here is brief.
+      std::lock_guard<std::mutex> dbLock(mutex_);
+      int logFrames = 0, checkpointed = 0;
+      int rc = sqlite3_wal_checkpoint_v2(db_, nullptr,
+                                         SQLITE_CHECKPOINT_PASSIVE,
+                                         &logFrames, &checkpointed);
+      if (rc != SQLITE_OK && rc != SQLITE_BUSY)
+        LOG_W("DatabaseManager", "WAL checkpoint failed: {}",
+              sqlite3_errmsg(db_));
+      else if (logFrames > 0)
+        LOG_D("DatabaseManager", "WAL checkpoint: {}/{} frames", checkpointed,
+              logFrames);
+    }
+    lock.lock();
+  }
+}
+
 bool DatabaseManager::exec(const std::string &sql) {
   std::lock_guard<std::mutex> lock(mutex_);
   if (!db_)
@@ -103,3 +245,155 @@ bool DatabaseManager::query(const std::string &sql, QueryCallback callback) {
   }
   return true;
 }
+
+std::string_view DatabaseManager::Cursor::getText(int col) const {
+  const auto *text =
+      reinterpret_cast<const char *>(sqlite3_column_text(stmt_, col));
+  if (!text)
+    return {};
+  return {text, static_cast<size_t>(sqlite3_column_bytes(stmt_, col))};
+}
+
+std::basic_string_view<uint8_t>
+DatabaseManager::Cursor::getBlob(int col) const {
+  const auto *data =
+      static_cast<const uint8_t *>(sqlite3_column_blob(stmt_, col));
+  if (!data)
+    return {};
+  return {data, static_cast<size_t>(sqlite3_column_bytes(stmt_, col))};
+}
+
+sqlite3_stmt *DatabaseManager::prepareLocked(const std::string &sql) {
+  auto it = stmtCache_.find(sql);
+  if (it != stmtCache_.end()) {
+    sqlite3_reset(it->second);
+    sqlite3_clear_bindings(it->second);
+    return it->second;
+  }
+
+  sqlite3_stmt *stmt = nullptr;
+  if (sqlite3_prepare_v3(db_, sql.c_str(), static_cast<int>(sql.size()) + 1,
+                         SQLITE_PREPARE_PERSISTENT, &stmt,
+                         nullptr) != SQLITE_OK) {
+    LOG_E("DatabaseManager", "Prepare failed: {}\nSQL: {}", sqlite3_errmsg(db_),
+          sql);
+    sqlite3_finalize(stmt);
+    return nullptr;
+  }
+  stmtCache_.emplace(sql, stmt);
+  return stmt;
+}
+
+bool DatabaseManager::bindLocked(sqlite3_stmt *stmt, const Params &params) {
+  if (static_cast<int>(params.size()) != sqlite3_bind_parameter_count(stmt)) {
+    LOG_E("DatabaseManager", "Bind count mismatch: {} given, {} expected\n"
+          "SQL: {}", params.size(), sqlite3_bind_parameter_count(stmt),
+          sqlite3_sql(stmt));
+    return false;
+  }
+  for (size_t i = 0; i < params.size(); ++i) {
+    int idx = static_cast<int>(i) + 1;
+    const Value &v = params[i];
+    int rc = SQLITE_OK;
+    if (const auto *n = std::get_if<int64_t>(&v))
+      rc = sqlite3_bind_int64(stmt, idx, *n);
+    else if (const auto *d = std::get_if<double>(&v))
+      rc = sqlite3_bind_double(stmt, idx, *d);
+    else if (const auto *s = std::get_if<std::string>(&v))
+      // The Params outlive the step, so SQLite need not copy the text.
+      rc = sqlite3_bind_text(stmt, idx, s->data(), static_cast<int>(s->size()),
+                             SQLITE_STATIC);
+    else if (const auto *b = std::get_if<Blob>(&v))
+      rc = sqlite3_bind_blob(stmt, idx, b->data(), static_cast<int>(b->size()),
+                             SQLITE_STATIC);
+    else
+      rc = sqlite3_bind_null(stmt, idx);
+    if (rc != SQLITE_OK) {
+      LOG_E("DatabaseManager", "Bind {} failed: {}", idx, sqlite3_errmsg(db_));
+      return false;
+    }
+  }
+  return true;
+}
+
+bool DatabaseManager::stepToDoneLocked(sqlite3_stmt *stmt,
+                                       const std::string &sql) {
+  int rc;
+  while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+  }
+  bool ok = rc == SQLITE_DONE;
+  if (!ok)
+    LOG_E("DatabaseManager", "Exec failed: {}\nSQL: {}", sqlite3_errmsg(db_),
+          sql);
+  // Drop the text pointers and release any read lock straight away.
+  sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+  return ok;
+}
+
+bool DatabaseManager::exec(const std::string &sql, const Params &params) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!db_)
+    return false;
+  sqlite3_stmt *stmt = prepareLocked(sql);
+  if (!stmt || !bindLocked(stmt, params))
+    return false;
+  return stepToDoneLocked(stmt, sql);
+}
+
+bool DatabaseManager::execMany(const std::string &sql,
+                               const std::vector<Params> &rows) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!db_)
+    return false;
+  sqlite3_stmt *stmt = prepareLocked(sql);
+  if (!stmt)
+    return false;
+
+  char *errMsg = nullptr;
+  if (sqlite3_exec(db_, "BEGIN", nullptr, nullptr, &errMsg) != SQLITE_OK) {
+    LOG_E("DatabaseManager", "BEGIN failed: {}", errMsg);
+    sqlite3_free(errMsg);
+    return false;
+  }
+  for (const auto &params : rows) {
+    if (!bindLocked(stmt, params) || !stepToDoneLocked(stmt, sql)) {
+      sqlite3_reset(stmt);
+      sqlite3_exec(db_, "ROLLBACK", nullptr, nullptr, nullptr);
+      return false;
+    }
+  }
+  if (sqlite3_exec(db_, "COMMIT", nullptr, nullptr, &errMsg) != SQLITE_OK) {
+    LOG_E("DatabaseManager", "COMMIT failed: {}", errMsg);
+    sqlite3_free(errMsg);
+    sqlite3_exec(db_, "ROLLBACK", nullptr, nullptr, nullptr);
+    return false;
+  }
+  return true;
+}
+
+bool DatabaseManager::query(const std::string &sql, const Params &params,
+                            CursorCallback callback) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!db_)
+    return false;
+  sqlite3_stmt *stmt = prepareLocked(sql);
+  if (!stmt || !bindLocked(stmt, params))
+    return false;
+
+  Cursor cursor(stmt);
+  int rc;
+  while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+    if (!callback(cursor)) {
+      rc = SQLITE_DONE;
+      break;
+    }
+  }
+  bool ok = rc == SQLITE_DONE;
+  if (!ok)
+    LOG_E("DatabaseManager", "Query failed: {}\nSQL: {}", sqlite3_errmsg(db_),
+          sql);
+  sqlite3_reset(stmt);
+  sqlite3_clear_bindings(stmt);
+  return ok;
+}
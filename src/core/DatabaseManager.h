@@ -1,10 +1,17 @@
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <filesystem>
 #include <functional>
 #include <mutex>
 #include <sqlite3.h>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <variant>
 #include <vector>
 
 class DatabaseManager {
@@ -25,8 +32,44 @@ public:
   // Callback should return true to continue, false to stop.
   bool query(const std::string &sql, QueryCallback callback);
 
-  // Prepared statement helper could be added here, but for now simple
-  // exec/query is enough.
+  // --- Prepared statements ---
+  //
+  // The SQL text is the cache key: each distinct string is prepared once and
+  // reused, and values are bound with '?' placeholders instead of being
+  // spliced into the SQL.
+
+  using Blob = std::vector<uint8_t>;
+  using Value =
+      std::variant<std::monostate, int64_t, double, std::string, Blob>;
+  using Params = std::vector<Value>;
+
+  // Typed read access to the current result row.
+  class Cursor {
+  public:
+    explicit Cursor(sqlite3_stmt *stmt) : stmt_(stmt) {}
+    int columns() const { return sqlite3_column_count(stmt_); }
+    bool isNull(int col) const {
+      return sqlite3_column_type(stmt_, col) == SQLITE_NULL;
+    }
+    int64_t getInt(int col) const { return sqlite3_column_int64(stmt_, col); }
+    double getDouble(int col) const {
+      return sqlite3_column_double(stmt_, col);
+    }
+    // Valid until the next row.
+    std::string_view getText(int col) const;
+    std::basic_string_view<uint8_t> getBlob(int col) const;
+
+  private:
+    sqlite3_stmt *stmt_;
+  };
+  using CursorCallback = std::function<bool(const Cursor &row)>;
+
+  bool exec(const std::string &sql, const Params &params);
+  // Runs 'sql' once per parameter set, all in one transaction. Rolls back
+  // if any row fails.
+  bool execMany(const std::string &sql, const std::vector<Params> &rows);
+  bool query(const std::string &sql, const Params &params,
+             CursorCallback callback);
 
 private:
   DatabaseManager() = default;
@@ -35,6 +78,21 @@ private:
   DatabaseManager(const DatabaseManager &) = delete;
   DatabaseManager &operator=(const DatabaseManager &) = delete;
 
+  // Caller holds mutex_.
+  sqlite3_stmt *prepareLocked(const std::string &sql);
+  bool bindLocked(sqlite3_stmt *stmt, const Params &params);
+  bool stepToDoneLocked(sqlite3_stmt *stmt, const std::string &sql);
+
+  void checkpointLoop();
+
   sqlite3 *db_ = nullptr;
   std::mutex mutex_;
+  std::unordered_map<std::string, sqlite3_stmt *> stmtCache_;
+
+  // WAL checkpoints run here rather than inline on a committing writer.
+  static constexpr auto kCheckpointInterval = std::chrono::seconds(30);
+  std::thread checkpointThread_;
+  std::mutex checkpointMutex_;
+  std::condition_variable checkpointCv_;
+  bool stopCheckpoint_ = false;
 };
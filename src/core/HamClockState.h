@@ -2,16 +2,8 @@
 
 #include "Astronomy.h"
 
-#include <chrono>
-#include <map>
 #include <string>
 
-struct ServiceStatus {
-  bool ok = false;
-  std::string lastError;
-  std::chrono::system_clock::time_point lastSuccess{};
-};
-
 struct HamClockState {
   // DE (home) station — set from config
   LatLon deLocation = {0, 0};
@@ -25,5 +17,4 @@ struct HamClockState {
 
   // Telemetry
   float fps = 0.0f;
-  std::map<std::string, ServiceStatus> services;
 };
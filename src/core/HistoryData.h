@@ -6,6 +6,8 @@
 #include <string>
 #include <vector>
 
+#include "Tracer.h"
+
 struct HistoryPoint {
   std::chrono::system_clock::time_point time;
   float value;
@@ -26,6 +28,7 @@ struct HistorySeries {
 class HistoryStore {
 public:
   void update(const std::string &name, const HistorySeries &series) {
+    TRACE_SCOPE("store", "HistoryStore::update");
     std::lock_guard<std::mutex> lock(mutex_);
     series_[name] = series;
   }
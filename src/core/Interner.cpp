@@ -0,0 +1,86 @@
+#include "Interner.h"
+#include "Logger.h"
+
+#include <cstring>
+
+Interner &Interner::instance() {
+  static Interner interner;
+  return interner;
+}
+
+Interner::Interner() {
+  // Id 0 is the empty string, so a default-constructed id reads as "".
+  ownedBlocks_.push_back(std::make_unique<Entry[]>(kBlockSize));
+  ownedBlocks_[0][kEmpty] = {"", 0};
+  blocks_[0].store(ownedBlocks_[0].get(), std::memory_order_release);
+  count_.store(1, std::memory_order_relaxed);
+  bytes_.store(kBlockSize * sizeof(Entry), std::memory_order_relaxed);
+}
+
+Interner::Id Interner::find(std::string_view s) const {
+  if (s.empty())
+    return kEmpty;
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  auto it = ids_.find(s);
+  return it == ids_.end() ? kEmpty : it->second;
+}
+
+Interner::Id Interner::intern(std::string_view s) {
+  if (s.empty())
+    return kEmpty;
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = ids_.find(s);
+    if (it != ids_.end())
+      return it->second;
+  }
+
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  auto it = ids_.find(s); // another thread may have added it meanwhile
+  if (it != ids_.end())
+    return it->second;
+
+  size_t n = count_.load(std::memory_order_relaxed);
+  if (n >= kMaxBlocks * kBlockSize) {
+    static bool warned = false;
+    if (!warned) {
+      warned = true;
+      LOG_E("Interner", "String table full at {} entries", n);
+    }
+    return kEmpty;
+  }
+  size_t block = n >> kBlockBits;
+  if (block == ownedBlocks_.size()) {
+    ownedBlocks_.push_back(std::make_unique<Entry[]>(kBlockSize));
+    blocks_[block].store(ownedBlocks_.back().get(), std::memory_order_release);
+    bytes_.fetch_add(kBlockSize * sizeof(Entry), std::memory_order_relaxed);
+  }
+
+  const char *data = store(s);
+  ownedBlocks_[block][n & (kBlockSize - 1)] = {
+      data, static_cast<uint32_t>(s.size())};
+  auto id = static_cast<Id>(n);
+  ids_.emplace(std::string_view(data, s.size()), id);
+  count_.store(n + 1, std::memory_order_release);
+  return id;
+}
+
+const char *Interner::store(std::string_view s) {
+  if (s.size() > kArenaSize / 4) {
+    // Too big to share an arena; keep it on its own.
+    arenas_.push_back(std::make_unique<char[]>(s.size()));
+    std::memcpy(arenas_.back().get(), s.data(), s.size());
+    bytes_.fetch_add(s.size(), std::memory_order_relaxed);
+    return arenas_.back().get();
+  }
+  if (kArenaSize - arenaUsed_ < s.size()) {
+    arenas_.push_back(std::make_unique<char[]>(kArenaSize));
+    current_ = arenas_.back().get();
+    arenaUsed_ = 0;
+    bytes_.fetch_add(kArenaSize, std::memory_order_relaxed);
+  }
+  char *dst = current_ + arenaUsed_;
+  std::memcpy(dst, s.data(), s.size());
+  arenaUsed_ += s.size();
+  return dst;
+}
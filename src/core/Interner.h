@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Process-wide table of the short strings spots repeat over and over
+// (callsigns, grids, mode names), so a stored spot holds 32-bit ids instead
+// of its own std::string per field.
+//
+// Strings are copied once into 64 KB arenas and never move or go away, so
+// view() hands out a string_view that stays valid for the life of the
+// process, and does so without taking a lock. intern() takes a shared lock
+// for strings already known and the exclusive one only to add a new string.
+//
+// Nothing is ever removed: memory follows the number of distinct calls and
+// grids heard since start-up (some tens of bytes each), not the spot rate.
+class Interner {
+public:
+  using Id = uint32_t;
+  static constexpr Id kEmpty = 0; // the empty string; also "table full"
+
+  static Interner &instance();
+
+  Interner(const Interner &) = delete;
+  Interner &operator=(const Interner &) = delete;
+
+  Id intern(std::string_view s);
+  // Id of 's' if it was interned before, kEmpty otherwise. Never adds.
+  Id find(std::string_view s) const;
+  // 'id' must come from intern() or find().
+  std::string_view view(Id id) const {
+    const Entry &e = blocks_[id >> kBlockBits].load(
+        std::memory_order_acquire)[id & (kBlockSize - 1)];
+    return {e.data, e.size};
+  }
+
+  size_t size() const { return count_.load(std::memory_order_relaxed); }
+  // Bytes held in arenas and id blocks, for the debug API.
+  size_t bytes() const { return bytes_.load(std::memory_order_relaxed); }
+
+private:
+  Interner();
+
+  struct Entry {
+    const char *data;
+    uint32_t size;
+  };
+
+  static constexpr int kBlockBits = 12;
+  static constexpr size_t kBlockSize = size_t{1} << kBlockBits;
+  static constexpr size_t kMaxBlocks = 4096; // 16M strings
+  static constexpr size_t kArenaSize = 64 * 1024;
+
+  const char *store(std::string_view s);
+
+  // Entries are only written before their id is handed out, and blocks only
+  // ever appear, so readers index them without the mutex.
+  std::array<std::atomic<Entry *>, kMaxBlocks> blocks_{};
+  std::atomic<size_t> count_{0};
+  std::atomic<size_t> bytes_{0};
+
+  mutable std::shared_mutex mutex_;
+  std::unordered_map<std::string_view, Id> ids_; // views into the arenas
+  std::vector<std::unique_ptr<Entry[]>> ownedBlocks_;
+  std::vector<std::unique_ptr<char[]>> arenas_;
+  char *current_ = nullptr; // arena being filled; oversized strings skip it
+  size_t arenaUsed_ = kArenaSize;
+};
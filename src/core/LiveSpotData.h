@@ -4,10 +4,16 @@
 #include <cstring>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <SDL.h>
 
+#include "Interner.h"
+#include "SnapshotStore.h"
+#include "SpotFilter.h"
+#include "Tracer.h"
+
 // Ham radio band definitions for spot aggregation.
 struct BandDef {
   const char *name;
@@ -43,16 +49,39 @@ inline int freqToBandIndex(double freqKhz) {
   return -1;
 }
 
-// Individual spot record for map plotting.
-struct SpotRecord {
-  double freqKhz;
-  std::string receiverGrid; // Maidenhead locator of receiving station
-  std::string senderCallsign;
+// Individual spots for map plotting, one entry per spot in every column
+// (structure of arrays). Each is about the mapped station: its call and
+// grid as Interner ids, and the grid's position, worked out once when the
+// spot is parsed.
+struct LiveSpotTable {
+  std::vector<float> freqKhz;
+  std::vector<int8_t> band; // index into kBands
+  std::vector<float> lat;
+  std::vector<float> lon;
+  std::vector<Interner::Id> call;
+  std::vector<Interner::Id> grid;
+  std::vector<SpotNeed> need;
+
+  size_t size() const { return freqKhz.size(); }
+  bool empty() const { return freqKhz.empty(); }
+
+  void push_back(double khz, int bandIdx, double latDeg, double lonDeg,
+                 std::string_view callsign, std::string_view locator,
+                 SpotNeed spotNeed) {
+    Interner &strings = Interner::instance();
+    freqKhz.push_back(static_cast<float>(khz));
+    band.push_back(static_cast<int8_t>(bandIdx));
+    lat.push_back(static_cast<float>(latDeg));
+    lon.push_back(static_cast<float>(lonDeg));
+    call.push_back(strings.intern(callsign));
+    grid.push_back(strings.intern(locator));
+    need.push_back(spotNeed);
+  }
 };
 
 struct LiveSpotData {
   int bandCounts[kNumBands] = {};
-  std::vector<SpotRecord> spots; // individual spots for map overlay
+  LiveSpotTable spots; // individual spots for map overlay
   bool selectedBands[kNumBands] =
       {};           // which bands are toggled on for map display
   std::string grid; // queried grid square, e.g. "EL87"
@@ -61,46 +90,44 @@ struct LiveSpotData {
   bool valid = false;
 };
 
-class LiveSpotDataStore {
+class LiveSpotDataStore : public SnapshotStore<LiveSpotData> {
 public:
-  LiveSpotData get() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return data_;
-  }
+  LiveSpotDataStore() : SnapshotStore(ChangeBus::Topic::LiveSpots) {}
 
   // Set provider data, preserving UI-driven selectedBands state.
   void set(const LiveSpotData &data) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    bool saved[kNumBands];
-    std::memcpy(saved, data_.selectedBands, sizeof(saved));
-    data_ = data;
-    std::memcpy(data_.selectedBands, saved, sizeof(saved));
+    TRACE_SCOPE("store", "LiveSpotDataStore::set");
+    modify([&](LiveSpotData &cur) {
+      bool saved[kNumBands];
+      std::memcpy(saved, cur.selectedBands, sizeof(saved));
+      cur = data;
+      std::memcpy(cur.selectedBands, saved, sizeof(saved));
+    });
   }
 
   void setSelectedBandsMask(uint32_t mask) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    for (int i = 0; i < kNumBands; ++i) {
-      data_.selectedBands[i] = (mask & (1 << i)) != 0;
-    }
+    modify([mask](LiveSpotData &cur) {
+      for (int i = 0; i < kNumBands; ++i) {
+        cur.selectedBands[i] = (mask & (1 << i)) != 0;
+      }
+    });
   }
 
   uint32_t getSelectedBandsMask() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto snap = snapshot();
     uint32_t mask = 0;
     for (int i = 0; i < kNumBands; ++i) {
-      if (data_.selectedBands[i])
+      if (snap->selectedBands[i])
         mask |= (1 << i);
     }
     return mask;
   }
 
   void toggleBand(int idx) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (idx >= 0 && idx < kNumBands)
-      data_.selectedBands[idx] = !data_.selectedBands[idx];
+    if (idx < 0 || idx >= kNumBands)
+      return;
+    modify([idx](LiveSpotData &cur) {
+      cur.selectedBands[idx] = !cur.selectedBands[idx];
+    });
   }
-
-private:
-  mutable std::mutex mutex_;
-  LiveSpotData data_;
 };
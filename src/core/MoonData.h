@@ -3,6 +3,9 @@
 #include <mutex>
 #include <string>
 
+#include "SnapshotStore.h"
+#include "Tracer.h"
+
 struct MoonData {
   double phase;        // 0.0 to 1.0
   double illumination; // 0 to 100
@@ -22,19 +25,12 @@ struct MoonData {
   bool valid = false;
 };
 
-class MoonStore {
+class MoonStore : public SnapshotStore<MoonData> {
 public:
-  void update(const MoonData &data) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    data_ = data;
-  }
+  MoonStore() : SnapshotStore(ChangeBus::Topic::Moon) {}
 
-  MoonData get() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return data_;
+  void update(const MoonData &data) {
+    TRACE_SCOPE("store", "MoonStore::update");
+    publish(data);
   }
-
-private:
-  mutable std::mutex mutex_;
-  MoonData data_;
 };
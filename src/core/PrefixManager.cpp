@@ -1,74 +1,188 @@
 #include "PrefixManager.h"
 #include "Logger.h"
 #include "PrefixData.h"
-#include <algorithm>
-#include <cctype>
-#include <cstdio>
 
-PrefixManager::PrefixManager() {}
+#include <iterator>
+#include <utility>
 
-void PrefixManager::init() {
-  std::lock_guard<std::mutex> lock(mutex_);
-  entries_.clear();
-  entries_.reserve(g_PrefixDataSize);
-
-  for (size_t i = 0; i < g_PrefixDataSize; ++i) {
-    PrefixEntry entry;
-    entry.call = g_PrefixData[i].prefix;
-    entry.lat = g_PrefixData[i].lat;
-    entry.lon = g_PrefixData[i].lon;
-    entry.dxcc = g_PrefixData[i].dxcc;
-    entries_.push_back(entry);
+namespace {
+
+constexpr size_t kMaxCall = 31;
+
+uint64_t fnv1a(std::string_view s) {
+  uint64_t h = 14695981039346656037ULL;
+  for (unsigned char c : s) {
+    h ^= c;
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+// Suffixes that say how, not where, a station operates.
+bool isOperatingSuffix(std::string_view s) {
+  static constexpr std::string_view kSuffixes[] = {
+      "P", "M", "A", "B", "QRP", "QRPP", "LH", "J", "R", "T", "X"};
+  if (s.size() == 1 && s[0] >= '0' && s[0] <= '9')
+    return true; // call area inside the same entity, e.g. K1ABC/4
+  for (auto suffix : kSuffixes) {
+    if (s == suffix)
+      return true;
   }
+  return false;
+}
 
-  // g_PrefixData is already sorted by prefix string in the generation script,
-  // so entries_ is also sorted and ready for upper_bound binary searching.
-  LOG_I("PrefixManager", "Initialized with {} STATIC DATA prefixes.",
-        entries_.size());
+bool toUpper(std::string_view call, char (&buf)[kMaxCall]) {
+  if (call.empty() || call.size() > kMaxCall)
+    return false;
+  for (size_t i = 0; i < call.size(); ++i) {
+    char c = call[i];
+    buf[i] = c >= 'a' && c <= 'z' ? static_cast<char>(c - 'a' + 'A') : c;
+  }
+  return true;
 }
 
-bool PrefixManager::findLocation(const std::string &call, LatLong &ll) {
-  if (call.empty())
+bool fill(uint16_t loc, LatLong &ll, int *dxcc) {
+  if (loc == 0)
     return false;
+  const StaticPrefixLocation &where = g_PrefixLocations[loc - 1];
+  ll.lat = where.lat;
+  ll.lon = where.lon;
+  if (dxcc)
+    *dxcc = where.dxcc;
+  return true;
+}
+
+} // namespace
+
+PrefixManager::PrefixManager() {}
 
-  // Normalize call (uppercase)
-  std::string upperCall = call;
-  for (auto &c : upperCall)
-    c = std::toupper(static_cast<unsigned char>(c));
-
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (!entries_.empty()) {
-      PrefixEntry searchKey;
-      searchKey.call = upperCall;
-
-      auto it =
-          std::upper_bound(entries_.begin(), entries_.end(), searchKey,
-                           [](const PrefixEntry &a, const PrefixEntry &b) {
-                             return a.call < b.call;
-                           });
-
-      while (it != entries_.begin()) {
-        --it;
-        const std::string &entCall = it->call;
-
-        if (entCall.length() > upperCall.length()) {
-          if (entCall[0] != upperCall[0])
-            break;
-          continue;
-        }
-
-        if (upperCall.compare(0, entCall.length(), entCall) == 0) {
-          ll.lat = it->lat;
-          ll.lon = it->lon;
-          return true;
-        }
-
-        if (!entCall.empty() && entCall[0] != upperCall[0])
-          break;
-      }
+void PrefixManager::init() {
+  LOG_I("PrefixManager",
+        "Prefix trie ready: {} prefixes and calls, {} nodes, {} locations",
+        g_PrefixDataSize, g_PrefixTrieSize, g_PrefixLocationCount);
+}
+
+uint16_t PrefixManager::longestPrefix(std::string_view key,
+                                      uint16_t *exactLoc) {
+  const StaticPrefixNode *node = &g_PrefixTrie[0];
+  uint16_t best = 0;
+  size_t depth = 0;
+  for (; depth < key.size(); ++depth) {
+    // Children are sorted by label; binary search them.
+    const StaticPrefixNode *first = &g_PrefixTrie[node->firstChild];
+    const StaticPrefixNode *lo = first;
+    const StaticPrefixNode *hi = first + node->numChildren;
+    char c = key[depth];
+    while (lo < hi) {
+      const StaticPrefixNode *mid = lo + (hi - lo) / 2;
+      if (mid->label < c)
+        lo = mid + 1;
+      else
+        hi = mid;
     }
+    if (lo == first + node->numChildren || lo->label != c)
+      break;
+    node = lo;
+    if (node->prefixLoc)
+      best = node->prefixLoc;
   }
+  if (exactLoc)
+    *exactLoc = depth == key.size() ? node->exactLoc : 0;
+  return best;
+}
 
-  return false;
+uint16_t PrefixManager::lookupCall(std::string_view call) {
+  uint16_t exact = 0;
+  uint16_t prefix = longestPrefix(call, &exact);
+  return exact ? exact : prefix;
+}
+
+uint16_t PrefixManager::resolve(std::string_view call) {
+  if (call.find('/') == std::string_view::npos)
+    return lookupCall(call);
+
+  // A listed portable call ("2E0GWD/P/LH") is taken as is.
+  uint16_t exact = 0;
+  longestPrefix(call, &exact);
+  if (exact)
+    return exact;
+
+  // Split on '/', dropping operating suffixes.
+  std::string_view parts[4];
+  size_t n = 0;
+  std::string_view rest = call;
+  while (!rest.empty()) {
+    size_t slash = rest.find('/');
+    std::string_view part = rest.substr(0, slash);
+    rest = slash == std::string_view::npos ? std::string_view()
+                                           : rest.substr(slash + 1);
+    if (part == "MM" || part == "AM")
+      return 0; // maritime or aeronautical mobile: no entity
+    if (part.empty() || (n > 0 && isOperatingSuffix(part)))
+      continue;
+    if (n < std::size(parts))
+      parts[n++] = part;
+  }
+  if (n == 0)
+    return 0;
+  if (n == 1)
+    return lookupCall(parts[0]);
+
+  // With a location designator, the shorter part is the designator:
+  // "VP2E/K1ABC", "K1ABC/VP2E", "DL/K1ABC".
+  std::string_view base = parts[0], where = parts[1];
+  if (where.size() > base.size())
+    std::swap(base, where);
+  if (uint16_t loc = longestPrefix(where))
+    return loc;
+  return lookupCall(base);
+}
+
+bool PrefixManager::findLocationUncached(std::string_view call, LatLong &ll,
+                                         int *dxcc) {
+  char buf[kMaxCall];
+  if (!toUpper(call, buf))
+    return false;
+  return fill(resolve({buf, call.size()}), ll, dxcc);
+}
+
+bool PrefixManager::findLocation(const std::string &call, LatLong &ll,
+                                 int *dxcc) {
+  return fill(lookup(call), ll, dxcc);
+}
+
+bool PrefixManager::findEntity(std::string_view call, PrefixInfo &info) {
+  uint16_t loc = lookup(call);
+  if (loc == 0)
+    return false;
+  const StaticPrefixLocation &where = g_PrefixLocations[loc - 1];
+  info.ll.lat = where.lat;
+  info.ll.lon = where.lon;
+  info.dxcc = where.dxcc;
+  info.cqZone = where.cqZone;
+  info.ituZone = where.ituZone;
+  return true;
+}
+
+uint16_t PrefixManager::lookup(std::string_view call) {
+  char buf[kMaxCall];
+  if (!toUpper(call, buf))
+    return 0;
+  std::string_view upper(buf, call.size());
+
+  // The low bits pick the slot; the tag keeps the rest, with the top bit
+  // set so a used slot is never 0.
+  uint64_t h = fnv1a(upper);
+  uint64_t tag = (h & ~uint64_t{0xFFFF}) | (uint64_t{1} << 63);
+  auto &slot = cache_[h & (kCacheSlots - 1)];
+
+  uint16_t loc;
+  uint64_t cached = slot.load(std::memory_order_relaxed);
+  if ((cached & ~uint64_t{0xFFFF}) == tag) {
+    loc = static_cast<uint16_t>(cached & 0xFFFF);
+  } else {
+    loc = resolve(upper);
+    slot.store(tag | loc, std::memory_order_relaxed);
+  }
+  return loc;
 }
@@ -1,8 +1,10 @@
 #pragma once
 
-#include <mutex>
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <string>
-#include <vector>
+#include <string_view>
 
 struct LatLong {
   double lat;
@@ -21,26 +23,58 @@ struct LatLong {
   }
 };
 
+// Everything the prefix table says about a call.
+struct PrefixInfo {
+  LatLong ll{};
+  int dxcc = 0;
+  int cqZone = 0;  // 0 = unknown
+  int ituZone = 0; // 0 = unknown
+};
+
+// Callsign -> DXCC entity, zones and location, from the trie that
+// scripts/update_prefixes.py compiles into PrefixData.h.
+//
+// Lookups take no locks and do not allocate: the trie is static read-only
+// data, and recent answers sit in a small direct-mapped cache of atomic
+// words, so any number of threads can call findLocation() at once.
 class PrefixManager {
 public:
   PrefixManager();
 
-  // Initialize: load from static data
+  // Logs the table size. Lookups work without it.
   void init();
 
-  // Find location for a callsign. Returns true if found.
+  // Find location for a callsign, and optionally its DXCC entity. Returns
+  // true if found. Exact-call entries win over prefixes; portable calls
+  // such as "VP2E/K1ABC", "K1ABC/VP2E" and "K1ABC/P" are resolved by
+  // their location designator, and /MM and /AM have no entity.
   // Thread-safe.
-  bool findLocation(const std::string &call, LatLong &ll);
+  bool findLocation(const std::string &call, LatLong &ll,
+                    int *dxcc = nullptr);
+  // The same lookup, with the CQ and ITU zones as well.
+  bool findEntity(std::string_view call, PrefixInfo &info);
 
-  // Helper structure for internal storage
-  struct PrefixEntry {
-    std::string call;
-    float lat;
-    float lon;
-    int dxcc;
-  };
+  // The same, without the cache; for tests and benchmarks.
+  static bool findLocationUncached(std::string_view call, LatLong &ll,
+                                   int *dxcc = nullptr);
 
 private:
-  std::vector<PrefixEntry> entries_;
-  std::mutex mutex_;
+  static constexpr size_t kCacheSlots = 1024;
+
+  // Cached resolve() of any-case 'call'; same return value.
+  uint16_t lookup(std::string_view call);
+
+  // These return an index into g_PrefixLocations plus one, 0 = not found,
+  // and expect upper-case input.
+  static uint16_t resolve(std::string_view call);
+  // The exact-call entry for 'call' if listed, else its longest prefix.
+  static uint16_t lookupCall(std::string_view call);
+  // Longest prefix of 'key' in the trie. 'exactLoc' receives the
+  // exact-call entry for the whole of 'key', or 0.
+  static uint16_t longestPrefix(std::string_view key,
+                                uint16_t *exactLoc = nullptr);
+
+  // Slot i holds a tag from the call's hash in the upper 48 bits and the
+  // answer in the low 16; 0 = empty.
+  std::array<std::atomic<uint64_t>, kCacheSlots> cache_{};
 };
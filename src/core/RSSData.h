@@ -5,25 +5,21 @@
 #include <string>
 #include <vector>
 
+#include "SnapshotStore.h"
+#include "Tracer.h"
+
 struct RSSData {
     std::vector<std::string> headlines;
     std::chrono::system_clock::time_point lastUpdated{};
     bool valid = false;
 };
 
-class RSSDataStore {
+class RSSDataStore : public SnapshotStore<RSSData> {
 public:
-    RSSData get() const {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return data_;
-    }
+    RSSDataStore() : SnapshotStore(ChangeBus::Topic::RSS) {}
 
     void set(const RSSData& data) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        data_ = data;
+        TRACE_SCOPE("store", "RSSDataStore::set");
+        publish(data);
     }
-
-private:
-    mutable std::mutex mutex_;
-    RSSData data_;
 };
@@ -1,5 +1,6 @@
 #include "SatelliteManager.h"
 #include "Logger.h"
+#include "Tracer.h"
 
 #include <algorithm>
 #include <cctype>
@@ -27,16 +28,17 @@ void SatelliteManager::fetch(bool force) {
 
   LOG_I("SatelliteManager", "Fetching TLE data from celestrak...");
 
-  net_.fetchAsync(
+  fetches_.add(net_.fetchAsync(
       TLE_URL,
       [this](std::string response) {
+        TRACE_SCOPE("provider", "SatelliteManager::parseTLE");
         if (response.empty()) {
           LOG_E("SatelliteManager", "Fetch failed (empty response)");
           return;
         }
         parse(response);
       },
-      86400); // 24 hour cache age
+      86400)); // 24 hour cache age
 }
 
 void SatelliteManager::parse(const std::string &raw) {
@@ -47,4 +47,6 @@ private:
     std::vector<SatelliteTLE> satellites_;
     bool dataValid_ = false;
     std::chrono::steady_clock::time_point lastFetch_;
+
+    FetchGroup fetches_;
 };
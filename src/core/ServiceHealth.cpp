@@ -0,0 +1,133 @@
+#include "ServiceHealth.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <thread>
+
+int64_t ServiceHealth::nowMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+void ServiceHealth::markSuccess(std::chrono::milliseconds latency) {
+  latencyMs_.store(static_cast<uint32_t>(latency.count()),
+                   std::memory_order_relaxed);
+  lastSuccessMs_.store(nowMs(), std::memory_order_relaxed);
+  consecutiveFailures_.store(0, std::memory_order_relaxed);
+  successes_.fetch_add(1, std::memory_order_relaxed);
+  writeText({});
+  ok_.store(true, std::memory_order_relaxed);
+  reported_.store(true, std::memory_order_release);
+}
+
+void ServiceHealth::markFailure(std::string_view error) {
+  lastFailureMs_.store(nowMs(), std::memory_order_relaxed);
+  consecutiveFailures_.fetch_add(1, std::memory_order_relaxed);
+  failures_.fetch_add(1, std::memory_order_relaxed);
+  writeText(error);
+  ok_.store(false, std::memory_order_relaxed);
+  reported_.store(true, std::memory_order_release);
+}
+
+void ServiceHealth::setNote(std::string_view note) { writeText(note); }
+
+void ServiceHealth::writeText(std::string_view text) {
+  // Writers take the sequence from even to odd; a second writer spins until
+  // the first is done, which only happens if two threads report at once.
+  uint32_t seq = textSeq_.load(std::memory_order_relaxed);
+  for (;;) {
+    if ((seq & 1) == 0 &&
+        textSeq_.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire,
+                                       std::memory_order_relaxed))
+      break;
+    std::this_thread::yield();
+    seq = textSeq_.load(std::memory_order_relaxed);
+  }
+  // Orders the odd sequence before the text stores below, so a reader that
+  // sees any new byte also sees the sequence change.
+  std::atomic_thread_fence(std::memory_order_release);
+
+  size_t n = std::min(text.size(), kTextSize - 1);
+  for (size_t i = 0; i < n; ++i)
+    text_[i].store(text[i], std::memory_order_relaxed);
+  text_[n].store('\0', std::memory_order_relaxed);
+
+  textSeq_.store(seq + 2, std::memory_order_release);
+}
+
+std::string ServiceHealth::readText() const {
+  char buf[kTextSize];
+  for (;;) {
+    uint32_t before = textSeq_.load(std::memory_order_acquire);
+    if (before & 1) {
+      std::this_thread::yield();
+      continue;
+    }
+    size_t n = 0;
+    for (; n < kTextSize - 1; ++n) {
+      buf[n] = text_[n].load(std::memory_order_relaxed);
+      if (buf[n] == '\0')
+        break;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (textSeq_.load(std::memory_order_relaxed) == before)
+      return std::string(buf, n);
+  }
+}
+
+ServiceHealthSnapshot ServiceHealth::snapshot() const {
+  ServiceHealthSnapshot s;
+  s.name = name_;
+  s.reported = reported_.load(std::memory_order_acquire);
+  s.ok = ok_.load(std::memory_order_relaxed);
+  s.consecutiveFailures = consecutiveFailures_.load(std::memory_order_relaxed);
+  s.successes = successes_.load(std::memory_order_relaxed);
+  s.failures = failures_.load(std::memory_order_relaxed);
+  s.latencyMs = latencyMs_.load(std::memory_order_relaxed);
+  auto toTime = [](int64_t ms) {
+    return std::chrono::system_clock::time_point(std::chrono::milliseconds(ms));
+  };
+  if (int64_t ms = lastSuccessMs_.load(std::memory_order_relaxed))
+    s.lastSuccess = toTime(ms);
+  if (int64_t ms = lastFailureMs_.load(std::memory_order_relaxed))
+    s.lastFailure = toTime(ms);
+  s.lastError = readText();
+  return s;
+}
+
+ServiceHealth *ServiceHealthRegistry::find(std::string_view name) const {
+  size_t n = count_.load(std::memory_order_acquire);
+  for (size_t i = 0; i < n; ++i) {
+    if (services_[i].name_ == name)
+      return const_cast<ServiceHealth *>(&services_[i]);
+  }
+  return nullptr;
+}
+
+ServiceHealth &ServiceHealthRegistry::get(std::string_view name) {
+  if (ServiceHealth *h = find(name))
+    return *h;
+
+  std::lock_guard<std::mutex> lock(registerMutex_);
+  if (ServiceHealth *h = find(name))
+    return *h;
+
+  size_t n = count_.load(std::memory_order_relaxed);
+  if (n >= kMaxServices) {
+    LOG_W("ServiceHealth", "Too many services, not tracking '{}'", name);
+    return overflow_;
+  }
+  services_[n].name_ = std::string(name);
+  count_.store(n + 1, std::memory_order_release); // publishes the name
+  return services_[n];
+}
+
+std::vector<ServiceHealthSnapshot> ServiceHealthRegistry::snapshot() const {
+  size_t n = count_.load(std::memory_order_acquire);
+  std::vector<ServiceHealthSnapshot> out;
+  out.reserve(n);
+  for (size_t i = 0; i < n; ++i)
+    out.push_back(services_[i].snapshot());
+  return out;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Point-in-time copy of one service's health, safe to keep and format.
+struct ServiceHealthSnapshot {
+  std::string name;
+  bool ok = false;
+  bool reported = false; // false until the first success or failure
+  uint32_t consecutiveFailures = 0;
+  uint64_t successes = 0;
+  uint64_t failures = 0;
+  uint32_t latencyMs = 0; // of the last successful call
+  std::chrono::system_clock::time_point lastSuccess{};
+  std::chrono::system_clock::time_point lastFailure{};
+  std::string lastError; // or a status note such as "Connecting..."
+};
+
+// Health of one upstream. Every field is an atomic so provider threads can
+// report without locks; the error text sits behind a seqlock so readers never
+// block writers and never see a half-written message.
+class ServiceHealth {
+public:
+  void markSuccess(std::chrono::milliseconds latency = {});
+  void markFailure(std::string_view error);
+  // Updates the status text without counting a success or failure.
+  void setNote(std::string_view note);
+
+  ServiceHealthSnapshot snapshot() const;
+  const std::string &name() const { return name_; }
+
+private:
+  friend class ServiceHealthRegistry;
+
+  static int64_t nowMs();
+  void writeText(std::string_view text);
+  std::string readText() const;
+
+  std::string name_; // written once before the slot is published
+
+  std::atomic<bool> ok_{false};
+  std::atomic<bool> reported_{false};
+  std::atomic<uint32_t> consecutiveFailures_{0};
+  std::atomic<uint64_t> successes_{0};
+  std::atomic<uint64_t> failures_{0};
+  std::atomic<uint32_t> latencyMs_{0};
+  std::atomic<int64_t> lastSuccessMs_{0};
+  std::atomic<int64_t> lastFailureMs_{0};
+
+  static constexpr size_t kTextSize = 128;
+  std::atomic<uint32_t> textSeq_{0}; // odd while a writer is busy
+  std::array<std::atomic<char>, kTextSize> text_{};
+};
+
+// Process-wide list of services. Lookups and snapshots are lock-free; only
+// registering a new name takes a mutex. Entries are never removed.
+class ServiceHealthRegistry {
+public:
+  static constexpr size_t kMaxServices = 64;
+
+  static ServiceHealthRegistry &instance() {
+    static ServiceHealthRegistry registry;
+    return registry;
+  }
+
+  // Returns the entry for 'name', registering it on first use. Callers on a
+  // hot path should keep the reference.
+  ServiceHealth &get(std::string_view name);
+
+  std::vector<ServiceHealthSnapshot> snapshot() const;
+
+private:
+  ServiceHealthRegistry() = default;
+  ServiceHealth *find(std::string_view name) const;
+
+  std::array<ServiceHealth, kMaxServices> services_;
+  std::atomic<size_t> count_{0};
+  std::mutex registerMutex_;
+  ServiceHealth overflow_; // shared by names past kMaxServices
+};
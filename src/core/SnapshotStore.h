@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "ChangeBus.h"
+
+// Base for data stores that hand out immutable, versioned snapshots.
+//
+// Readers call snapshot() to get a shared_ptr to the current value: one
+// pointer copy instead of a deep copy of the payload, and the value never
+// changes underneath them. version() increases every time a new value is
+// published, so a widget can remember the version it last rendered and skip
+// all work while it is unchanged.
+//
+// Writers build a complete new value and publish it. Writes are serialised
+// among themselves but never block readers for longer than a pointer swap.
+// Every publish is also announced on the ChangeBus under the store's topic.
+template <typename T> class SnapshotStore {
+public:
+  using Snapshot = std::shared_ptr<const T>;
+
+  explicit SnapshotStore(ChangeBus::Topic topic = ChangeBus::Topic::None)
+      : topic_(topic), current_(std::make_shared<const T>()) {}
+
+  SnapshotStore(const SnapshotStore &) = delete;
+  SnapshotStore &operator=(const SnapshotStore &) = delete;
+
+  Snapshot snapshot() const {
+    // A plain mutex around the pointer copy: std::atomic<std::shared_ptr>
+    // is not available in every standard library we build against.
+    std::lock_guard<std::mutex> lock(ptrMutex_);
+    return current_;
+  }
+
+  uint64_t version() const { return version_.load(std::memory_order_acquire); }
+
+  // Copying accessor for callers that want to own a value.
+  T get() const { return *snapshot(); }
+
+protected:
+  void publish(T value) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    publishLocked(std::move(value));
+  }
+
+  // Copies the current value, lets 'fn' mutate it and publishes the result
+  // as one step, so concurrent writers cannot lose each other's changes.
+  template <typename Fn> void modify(Fn &&fn) {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    T next = *snapshot();
+    fn(next);
+    publishLocked(std::move(next));
+  }
+
+  // Held by publish()/modify(); derived stores may take it to keep extra
+  // writer-side state consistent with the published value.
+  std::mutex writeMutex_;
+
+private:
+  void publishLocked(T value) {
+    auto next = std::make_shared<const T>(std::move(value));
+    {
+      std::lock_guard<std::mutex> lock(ptrMutex_);
+      current_ = std::move(next);
+      version_.fetch_add(1, std::memory_order_acq_rel);
+    }
+    ChangeBus::instance().publish(topic_);
+  }
+
+  const ChangeBus::Topic topic_;
+  mutable std::mutex ptrMutex_;
+  Snapshot current_;
+  std::atomic<uint64_t> version_{1}; // 0 never published: "nothing seen yet"
+};
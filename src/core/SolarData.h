@@ -2,6 +2,10 @@
 
 #include <chrono>
 #include <mutex>
+#include <utility>
+
+#include "SnapshotStore.h"
+#include "Tracer.h"
 
 struct SolarData {
   int sfi = 0;
@@ -19,19 +23,20 @@ struct SolarData {
   bool valid = false;
 };
 
-class SolarDataStore {
+class SolarDataStore : public SnapshotStore<SolarData> {
 public:
-  SolarData get() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return data_;
-  }
+  SolarDataStore() : SnapshotStore(ChangeBus::Topic::Solar) {}
 
   void set(const SolarData &data) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    data_ = data;
+    TRACE_SCOPE("store", "SolarDataStore::set");
+    publish(data);
   }
 
-private:
-  mutable std::mutex mutex_;
-  SolarData data_;
+  // Applies 'fn' to the current value and publishes the result as one step.
+  // Writers that own only some of the fields must use this rather than
+  // get()/set(), or overlapping fetches overwrite each other with stale data.
+  template <typename Fn> void update(Fn &&fn) {
+    TRACE_SCOPE("store", "SolarDataStore::update");
+    modify(std::forward<Fn>(fn));
+  }
 };
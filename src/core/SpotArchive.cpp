@@ -0,0 +1,344 @@
+#include "SpotArchive.h"
+#include "DXClusterData.h"
+#include "DatabaseManager.h"
+#include "LiveSpotData.h"
+#include "Logger.h"
+#include "Tracer.h"
+
+#include <algorithm>
+#include <map>
+#include <tuple>
+
+namespace {
+
+constexpr int64_t kSecsPerDay = 86400;
+
+int64_t toUnixSeconds(std::chrono::system_clock::time_point tp) {
+  return std::chrono::duration_cast<std::chrono::seconds>(
+             tp.time_since_epoch())
+      .count();
+}
+
+// [lo, hi] matching 'v', or everything when v is the wildcard.
+std::pair<int64_t, int64_t> rangeOf(int v, bool any) {
+  if (any)
+    return {-1, 255};
+  return {v, v};
+}
+
+// 'column = ?' for one value, else every value it can hold in [lo, hi] as
+// a list: SQLite then seeks each one and still narrows on the key columns
+// after it, where a range would end the key prefix and scan the rest.
+std::string keyTerm(const char *column, int v, bool any, int lo, int hi,
+                    std::vector<int64_t> &params) {
+  std::string term = column;
+  if (!any) {
+    params.push_back(v);
+    return term + " = ?";
+  }
+  term += " IN (";
+  for (int i = lo; i <= hi; ++i)
+    term += std::to_string(i) + (i < hi ? "," : ")");
+  return term;
+}
+
+using Hours = std::array<uint32_t, 24>;
+
+// 'hours' blob layout: 24 little-endian uint32.
+DatabaseManager::Blob packHours(const Hours &hours) {
+  DatabaseManager::Blob blob(hours.size() * 4);
+  for (size_t h = 0; h < hours.size(); ++h) {
+    for (int b = 0; b < 4; ++b)
+      blob[h * 4 + b] = static_cast<uint8_t>(hours[h] >> (8 * b));
+  }
+  return blob;
+}
+
+template <typename Sum>
+void addHours(std::basic_string_view<uint8_t> blob, Sum &hours) {
+  for (size_t h = 0; h < 24 && h * 4 + 3 < blob.size(); ++h) {
+    hours[h] += blob[h * 4] | blob[h * 4 + 1] << 8 | blob[h * 4 + 2] << 16 |
+                static_cast<uint32_t>(blob[h * 4 + 3]) << 24;
+  }
+}
+
+// One day's all-path totals, per band.
+void writeBandRows(int64_t day, const std::map<int64_t, Hours> &bands) {
+  std::vector<DatabaseManager::Params> rows;
+  rows.reserve(bands.size());
+  for (const auto &[band, hours] : bands)
+    rows.push_back({band, day, packHours(hours)});
+  DatabaseManager::instance().execMany(
+      "INSERT OR REPLACE INTO spot_band_hourly (band, day, hours) "
+      "VALUES (?, ?, ?)",
+      rows);
+}
+
+} // namespace
+
+int64_t SpotArchive::dayOf(int64_t unixSecs) {
+  return unixSecs >= 0 ? unixSecs / kSecsPerDay
+                       : (unixSecs - kSecsPerDay + 1) / kSecsPerDay;
+}
+
+void SpotArchive::append(const std::vector<DXClusterSpot> &spots) {
+  if (spots.empty())
+    return;
+  TRACE_SCOPE("store", "SpotArchive::append");
+  std::vector<DatabaseManager::Params> rows;
+  rows.reserve(spots.size());
+  for (const auto &s : spots) {
+    int64_t t = toUnixSeconds(s.spottedAt);
+    rows.push_back({dayOf(t), t, s.txCall, s.rxCall, s.freqKhz,
+                    static_cast<int64_t>(s.band),
+                    static_cast<int64_t>(s.modeId),
+                    static_cast<int64_t>(s.txCont),
+                    static_cast<int64_t>(s.rxCont),
+                    static_cast<int64_t>(s.txDxcc)});
+  }
+  DatabaseManager::instance().execMany(
+      "INSERT INTO spot_archive (day, spotted_at, tx_call, rx_call, freq_khz, "
+      "band, mode, tx_cont, rx_cont, tx_dxcc) "
+      "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)",
+      rows);
+}
+
+int64_t SpotArchive::rolledThrough() {
+  int64_t cached = rolledThrough_.load(std::memory_order_relaxed);
+  if (cached != INT64_MIN)
+    return cached;
+  int64_t day = -1;
+  DatabaseManager::instance().query(
+      "SELECT value FROM archive_meta WHERE key = 'rolled_through'", {},
+      [&day](const DatabaseManager::Cursor &row) {
+        day = row.getInt(0);
+        return false;
+      });
+  rolledThrough_.store(day, std::memory_order_relaxed);
+  return day;
+}
+
+int SpotArchive::maintain(TimePoint now) {
+  auto &db = DatabaseManager::instance();
+  if (!bandRollupReady_.load(std::memory_order_acquire))
+    backfillBandRollup();
+  int64_t nowSecs = toUnixSeconds(now);
+  int64_t lastDay = dayOf(nowSecs - kRollupGraceSecs) - 1;
+  int64_t from = rolledThrough() + 1;
+  if (rolledThrough() < 0) {
+    // First run: start with the oldest day there is.
+    from = lastDay + 1;
+    db.query("SELECT MIN(day) FROM spot_archive", {},
+             [&from](const DatabaseManager::Cursor &row) {
+               if (!row.isNull(0))
+                 from = row.getInt(0);
+               return false;
+             });
+  }
+  if (from > lastDay)
+    return 0;
+
+  TRACE_SCOPE("store", "SpotArchive::maintain");
+  auto started = std::chrono::steady_clock::now();
+  // Days before the raw window have nothing left to roll up.
+  from = std::max(from, dayOf(nowSecs) - kRawDays);
+  for (int64_t day = from; day <= lastDay; ++day)
+    rollDay(day);
+  db.exec("INSERT OR REPLACE INTO archive_meta (key, value) "
+          "VALUES ('rolled_through', ?)",
+          {lastDay});
+  rolledThrough_.store(lastDay, std::memory_order_relaxed);
+
+  int64_t today = dayOf(nowSecs);
+  db.exec("DELETE FROM spot_archive WHERE day <= ?",
+          {std::min(today - kRawDays, lastDay)});
+  db.exec("DELETE FROM spot_hourly WHERE day <= ?", {today - kSummaryDays});
+  db.exec("DELETE FROM spot_band_hourly WHERE day <= ?",
+          {today - kSummaryDays});
+  db.exec("DELETE FROM call_days WHERE day <= ?", {today - kSummaryDays});
+
+  int rolled = static_cast<int>(lastDay - from + 1);
+  LOG_I("SpotArchive", "Rolled up {} day(s) in {} ms", rolled,
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - started)
+            .count());
+  return rolled;
+}
+
+void SpotArchive::rollDay(int64_t day) {
+  using Path = std::tuple<int64_t, int64_t, int64_t>; // band, tx/rx cont
+  std::map<Path, Hours> paths;
+  int64_t dayStart = day * kSecsPerDay;
+  DatabaseManager::instance().query(
+      "SELECT band, tx_cont, rx_cont, spotted_at FROM spot_archive "
+      "WHERE day = ?",
+      {day}, [&](const DatabaseManager::Cursor &row) {
+        auto &hours = paths.try_emplace({row.getInt(0), row.getInt(1),
+                                         row.getInt(2)})
+                          .first->second;
+        int64_t hour = (row.getInt(3) - dayStart) / 3600;
+        hours[std::clamp<int64_t>(hour, 0, 23)]++;
+        return true;
+      });
+  if (paths.empty())
+    return;
+
+  std::vector<DatabaseManager::Params> rows;
+  std::map<int64_t, Hours> bands;
+  rows.reserve(paths.size());
+  for (const auto &[path, hours] : paths) {
+    auto &band = bands[std::get<0>(path)];
+    for (size_t h = 0; h < hours.size(); ++h)
+      band[h] += hours[h];
+    rows.push_back({std::get<0>(path), std::get<1>(path), std::get<2>(path),
+                    day, packHours(hours)});
+  }
+  DatabaseManager::instance().execMany(
+      "INSERT OR REPLACE INTO spot_hourly (band, tx_cont, rx_cont, day, hours) "
+      "VALUES (?, ?, ?, ?, ?)",
+      rows);
+  writeBandRows(day, bands);
+}
+
+void SpotArchive::backfillBandRollup() {
+  auto &db = DatabaseManager::instance();
+  bool done = false;
+  db.query("SELECT value FROM archive_meta WHERE key = 'band_rollup'", {},
+           [&done](const DatabaseManager::Cursor &row) {
+             done = row.getInt(0) != 0;
+             return false;
+           });
+  if (!done) {
+    // Days rolled up before spot_band_hourly existed: sum their paths.
+    TRACE_SCOPE("store", "SpotArchive::backfillBandRollup");
+    std::map<int64_t, std::map<int64_t, Hours>> days; // day -> band -> hours
+    db.query("SELECT day, band, hours FROM spot_hourly", {},
+             [&days](const DatabaseManager::Cursor &row) {
+               addHours(row.getBlob(2), days[row.getInt(0)][row.getInt(1)]);
+               return true;
+             });
+    for (const auto &[day, bands] : days)
+      writeBandRows(day, bands);
+    db.exec("INSERT OR REPLACE INTO archive_meta (key, value) "
+            "VALUES ('band_rollup', 1)");
+    if (!days.empty())
+      LOG_I("SpotArchive", "Built band totals for {} rolled-up day(s)",
+            days.size());
+  }
+  bandRollupReady_.store(true, std::memory_order_release);
+}
+
+CallHistory SpotArchive::callHistory(const std::string &call, int days,
+                                     size_t limit, TimePoint now) {
+  TRACE_SCOPE("store", "SpotArchive::callHistory");
+  auto &db = DatabaseManager::instance();
+  CallHistory out;
+  int64_t firstDay = dayOf(toUnixSeconds(now)) - std::max(days, 1) + 1;
+
+  db.query("SELECT rx_call, freq_khz, band, mode, spotted_at "
+           "FROM spot_archive WHERE tx_call = ? AND spotted_at >= ? "
+           "ORDER BY spotted_at DESC LIMIT ?",
+           {call, firstDay * kSecsPerDay, static_cast<int64_t>(limit)},
+           [&out](const DatabaseManager::Cursor &row) {
+             ArchivedSpot s;
+             s.spotter = row.getText(0);
+             s.freqKhz = row.getDouble(1);
+             s.band = static_cast<int>(row.getInt(2));
+             s.mode = static_cast<SpotMode>(row.getInt(3));
+             s.spottedAt = row.getInt(4);
+             out.spots.push_back(std::move(s));
+             return true;
+           });
+
+  db.query("SELECT spots, bands, first_at, last_at FROM call_days "
+           "WHERE tx_call = ? AND day >= ?",
+           {call, firstDay}, [&out](const DatabaseManager::Cursor &row) {
+             out.daysHeard++;
+             out.totalSpots += static_cast<uint64_t>(row.getInt(0));
+             out.bands |= static_cast<uint32_t>(row.getInt(1));
+             int64_t first = row.getInt(2), last = row.getInt(3);
+             if (out.firstAt == 0 || first < out.firstAt)
+               out.firstAt = first;
+             out.lastAt = std::max(out.lastAt, last);
+             return true;
+           });
+  return out;
+}
+
+HourlyActivity SpotArchive::hourlyActivity(int band, Continent from,
+                                           Continent to, int days,
+                                           TimePoint now) {
+  TRACE_SCOPE("store", "SpotArchive::hourlyActivity");
+  auto &db = DatabaseManager::instance();
+  HourlyActivity out;
+  int64_t today = dayOf(toUnixSeconds(now));
+  int64_t firstDay = today - std::max(days, 1) + 1;
+  int64_t rolled = rolledThrough();
+  auto [bandLo, bandHi] = rangeOf(band, band < 0);
+  auto [txLo, txHi] = rangeOf(static_cast<int>(from),
+                              from == Continent::Unknown);
+  auto [rxLo, rxHi] = rangeOf(static_cast<int>(to), to == Continent::Unknown);
+
+  // Finished days from the rollup: per band when every path is asked for,
+  // which is a row per band and day instead of one per continent pair too.
+  if (firstDay <= rolled) {
+    bool anyPath = from == Continent::Unknown && to == Continent::Unknown &&
+                   bandRollupReady_.load(std::memory_order_acquire);
+    std::vector<int64_t> params;
+    std::string sql =
+        std::string("SELECT hours FROM ") +
+        (anyPath ? "spot_band_hourly" : "spot_hourly") + " WHERE " +
+        keyTerm("band", band, band < 0, -1, kNumBands - 1, params);
+    if (!anyPath) {
+      int lastCont = static_cast<int>(Continent::Count) - 1;
+      sql += " AND " + keyTerm("tx_cont", static_cast<int>(from),
+                               from == Continent::Unknown, 0, lastCont,
+                               params);
+      sql += " AND " + keyTerm("rx_cont", static_cast<int>(to),
+                               to == Continent::Unknown, 0, lastCont, params);
+    }
+    sql += " AND day BETWEEN ? AND ?";
+    params.push_back(firstDay);
+    params.push_back(rolled);
+    db.query(sql, DatabaseManager::Params(params.begin(), params.end()),
+             [&out](const DatabaseManager::Cursor &row) {
+               addHours(row.getBlob(0), out.hours);
+               return true;
+             });
+    for (uint64_t n : out.hours)
+      out.total += n;
+  }
+  // ... and the rest, today at least, from raw spots.
+  int64_t rawFrom = std::max(firstDay, rolled + 1);
+  if (rawFrom <= today) {
+    db.query("SELECT spotted_at FROM spot_archive "
+             "WHERE day BETWEEN ? AND ? AND band BETWEEN ? AND ? "
+             "AND tx_cont BETWEEN ? AND ? AND rx_cont BETWEEN ? AND ?",
+             {rawFrom, today, bandLo, bandHi, txLo, txHi, rxLo, rxHi},
+             [&out](const DatabaseManager::Cursor &row) {
+               int64_t secs = row.getInt(0) % kSecsPerDay;
+               out.hours[std::clamp<int64_t>(secs / 3600, 0, 23)]++;
+               out.total++;
+               return true;
+             });
+  }
+  return out;
+}
+
+std::vector<EntitySighting> SpotArchive::lastSpotted(int dxcc) {
+  std::vector<EntitySighting> out;
+  DatabaseManager::instance().query(
+      "SELECT band, spotted_at, tx_call, freq_khz FROM entity_last "
+      "WHERE dxcc = ? ORDER BY spotted_at DESC",
+      {static_cast<int64_t>(dxcc)},
+      [&out](const DatabaseManager::Cursor &row) {
+        EntitySighting e;
+        e.band = static_cast<int>(row.getInt(0));
+        e.spottedAt = row.getInt(1);
+        e.call = row.getText(2);
+        e.freqKhz = row.getDouble(3);
+        out.push_back(std::move(e));
+        return true;
+      });
+  return out;
+}
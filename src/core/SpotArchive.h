@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "SpotFilter.h"
+
+struct DXClusterSpot;
+
+struct ArchivedSpot {
+  std::string spotter;
+  double freqKhz = 0;
+  int band = -1;
+  SpotMode mode = SpotMode::Unknown;
+  int64_t spottedAt = 0; // Unix seconds
+};
+
+// What the archive knows about one call over a window of days.
+struct CallHistory {
+  std::vector<ArchivedSpot> spots; // newest first; only the raw window
+  int daysHeard = 0;
+  uint64_t totalSpots = 0;
+  uint32_t bands = 0; // bit per band index
+  int64_t firstAt = 0;
+  int64_t lastAt = 0;
+};
+
+// Spots per UTC hour of day, summed over a window of days.
+struct HourlyActivity {
+  std::array<uint64_t, 24> hours{};
+  uint64_t total = 0;
+};
+
+// Most recent spot of an entity on one band.
+struct EntitySighting {
+  int band = -1;
+  int64_t spottedAt = 0;
+  std::string call;
+  double freqKhz = 0;
+};
+
+// Long-term DX cluster spot history in the SQLite database.
+//
+// Raw spots go into 'spot_archive', keyed by UTC day, and are kept for
+// kRawDays. Once a day is over, maintain() rolls it into 'spot_hourly': one
+// small row per band and continent pair holding that day's 24 hourly
+// counts, plus one per band in 'spot_band_hourly' for the all-path
+// queries, which would otherwise sum every pair. 'call_days' (per call and day) and 'entity_last' (per entity and
+// band) are kept current by a trigger on insert. Every query below is an
+// index range scan, so its cost depends on the window asked for, not on
+// how much history is stored. The schema lives in DatabaseManager.
+class SpotArchive {
+public:
+  using TimePoint = std::chrono::system_clock::time_point;
+
+  static constexpr int kRawDays = 30;
+  static constexpr int kSummaryDays = 400;
+  // A day is rolled up this long after it ended, so spots that arrive
+  // late still make it in.
+  static constexpr int kRollupGraceSecs = 3600;
+
+  // Called by DXClusterDataStore's writer thread with each batch.
+  void append(const std::vector<DXClusterSpot> &spots);
+
+  // Rolls up finished days and drops expired rows. Returns the number of
+  // days rolled up. Cheap when there is nothing to do.
+  int maintain(TimePoint now = std::chrono::system_clock::now());
+
+  // Spots of 'call' over the last 'days' days. The list is capped at
+  // 'limit' and covers at most kRawDays; the totals cover the whole window.
+  CallHistory callHistory(const std::string &call, int days,
+                          size_t limit = 200,
+                          TimePoint now = std::chrono::system_clock::now());
+
+  // Hourly spot counts on 'band' (-1 = all) from stations in 'from' heard
+  // in 'to' (Unknown = anywhere) over the last 'days' days.
+  HourlyActivity
+  hourlyActivity(int band, Continent from, Continent to, int days,
+                 TimePoint now = std::chrono::system_clock::now());
+
+  // When the entity was last spotted, one entry per band, newest first.
+  std::vector<EntitySighting> lastSpotted(int dxcc);
+
+  // Last UTC day (days since 1970-01-01) rolled into spot_hourly, or -1.
+  int64_t rolledThrough();
+
+  static int64_t dayOf(int64_t unixSecs);
+
+private:
+  void rollDay(int64_t day);
+  // Fills spot_band_hourly for days rolled before it existed; once.
+  void backfillBandRollup();
+
+  // Cached copy of archive_meta's 'rolled_through'; INT64_MIN = not read.
+  std::atomic<int64_t> rolledThrough_{INT64_MIN};
+  // Until the backfill has run, all-path queries read spot_hourly.
+  std::atomic<bool> bandRollupReady_{false};
+};
@@ -0,0 +1,110 @@
+#include "SpotDeduper.h"
+
+#include <cctype>
+#include <cmath>
+
+namespace {
+constexpr size_t kInitialSlots = 1024; // power of two
+
+uint64_t mix(uint64_t h) {
+  // splitmix64 finaliser
+  h ^= h >> 30;
+  h *= 0xbf58476d1ce4e5b9ULL;
+  h ^= h >> 27;
+  h *= 0x94d049bb133111ebULL;
+  h ^= h >> 31;
+  return h;
+}
+} // namespace
+
+SpotDeduper::SpotDeduper(std::chrono::seconds window)
+    : window_(static_cast<uint32_t>(window.count())), epoch_(Clock::now()),
+      slots_(kInitialSlots) {}
+
+uint64_t SpotDeduper::makeKey(std::string_view call, int64_t khz) {
+  // FNV-1a over the upper-cased call, then the frequency.
+  uint64_t h = 0xcbf29ce484222325ULL;
+  for (char c : call) {
+    auto uc = static_cast<unsigned char>(c);
+    h ^= static_cast<unsigned char>(std::toupper(uc));
+    h *= 0x100000001b3ULL;
+  }
+  h = mix(h ^ static_cast<uint64_t>(khz));
+  return h ? h : 1; // 0 marks an empty slot
+}
+
+bool SpotDeduper::expired(const Slot &slot, uint32_t now) const {
+  return now - slot.seenAt > window_;
+}
+
+SpotDeduper::Slot *SpotDeduper::findLive(uint64_t key, uint32_t now) {
+  size_t mask = slots_.size() - 1;
+  for (size_t i = key & mask;; i = (i + 1) & mask) {
+    Slot &slot = slots_[i];
+    if (slot.key == 0)
+      return nullptr;
+    if (slot.key == key && !expired(slot, now))
+      return &slot;
+  }
+}
+
+void SpotDeduper::insert(uint64_t key, uint32_t seenAt, uint32_t sources,
+                         uint32_t now) {
+  size_t mask = slots_.size() - 1;
+  for (size_t i = key & mask;; i = (i + 1) & mask) {
+    Slot &slot = slots_[i];
+    if (slot.key == 0) {
+      used_++;
+    } else if (!expired(slot, now)) {
+      continue;
+    }
+    slot = {key, seenAt, sources};
+    live_++;
+    return;
+  }
+}
+
+void SpotDeduper::rebuild(uint32_t now) {
+  std::vector<Slot> old;
+  old.swap(slots_);
+  size_t live = 0;
+  for (const Slot &s : old)
+    live += (s.key != 0 && !expired(s, now));
+
+  // Keep the table at most half full with live entries.
+  size_t cap = kInitialSlots;
+  while (cap < live * 2)
+    cap *= 2;
+  slots_.assign(cap, Slot{});
+  used_ = live_ = 0;
+  for (const Slot &s : old) {
+    if (s.key != 0 && !expired(s, now))
+      insert(s.key, s.seenAt, s.sources, now);
+  }
+}
+
+SpotDeduper::Result SpotDeduper::check(std::string_view call, double freqKhz,
+                                       uint32_t sourceBit,
+                                       Clock::time_point now) {
+  uint32_t t = static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::seconds>(now - epoch_).count());
+  int64_t khz = std::llround(freqKhz);
+
+  Result res;
+  // Clusters round differently, so 14025.4 and 14025.6 must still match.
+  for (int64_t k : {khz, khz - 1, khz + 1}) {
+    if (Slot *slot = findLive(makeKey(call, k), t)) {
+      res.duplicate = true;
+      res.newSource = (slot->sources & sourceBit) == 0;
+      slot->sources |= sourceBit;
+      res.sources = slot->sources;
+      return res;
+    }
+  }
+
+  if ((used_ + 1) * 4 > slots_.size() * 3)
+    rebuild(t);
+  insert(makeKey(call, khz), t, sourceBit, t);
+  res.sources = sourceBit;
+  return res;
+}
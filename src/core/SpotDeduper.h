@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Remembers recently seen (call, frequency) pairs so the same spot relayed by
+// several DX clusters is only shown once.
+//
+// Entries live in a flat open-addressing table of 16-byte slots keyed by a
+// hash of the call and the frequency rounded to 1 kHz. A spot counts as a
+// duplicate if the same call was seen within one kHz either side during the
+// last 'window'. Expired slots are reused in place and purged when the table
+// is rebuilt, so memory follows the spot rate over one window rather than
+// growing with uptime.
+//
+// Not thread-safe; the caller serialises access.
+class SpotDeduper {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Result {
+    bool duplicate = false;
+    bool newSource = false; // duplicate, but the first from 'sourceBit'
+    uint32_t sources = 0;   // every source that reported it in the window
+  };
+
+  explicit SpotDeduper(std::chrono::seconds window);
+
+  // Records the spot and reports whether it was already seen. 'sourceBit' is
+  // the caller's bit for the reporting source.
+  Result check(std::string_view call, double freqKhz, uint32_t sourceBit,
+               Clock::time_point now = Clock::now());
+
+  size_t size() const { return live_; }
+  size_t capacity() const { return slots_.size(); }
+
+private:
+  struct Slot {
+    uint64_t key = 0; // 0 = never used
+    uint32_t seenAt = 0;
+    uint32_t sources = 0;
+  };
+  static_assert(sizeof(Slot) == 16);
+
+  static uint64_t makeKey(std::string_view call, int64_t khz);
+  bool expired(const Slot &slot, uint32_t now) const;
+  Slot *findLive(uint64_t key, uint32_t now);
+  void insert(uint64_t key, uint32_t seenAt, uint32_t sources, uint32_t now);
+  void rebuild(uint32_t now);
+
+  uint32_t window_; // seconds
+  Clock::time_point epoch_;
+  std::vector<Slot> slots_;
+  size_t used_ = 0; // slots with a key, live or expired
+  size_t live_ = 0; // approximate; exact after a rebuild
+};
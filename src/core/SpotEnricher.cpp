@@ -0,0 +1,195 @@
+#include "SpotEnricher.h"
+#include "Astronomy.h"
+#include "DXClusterData.h"
+#include "LiveSpotData.h"
+
+#include <algorithm>
+#include <string>
+
+namespace {
+
+// Furthest a centroid position is moved, in degrees: about two pixels on an
+// 800-pixel map.
+constexpr double kJitterDeg = 0.5;
+
+struct ModeRange {
+  double minKhz;
+  double maxKhz;
+  SpotMode mode;
+};
+
+// Checked in order, so the FT8/FT4 channels win over the segments around
+// them. Each channel is its dial frequency plus the 3 kHz passband.
+constexpr ModeRange kModePlan[] = {
+    // FT8
+    {1840, 1843, SpotMode::FT8},
+    {3573, 3576, SpotMode::FT8},
+    {5357, 5360, SpotMode::FT8},
+    {7074, 7077, SpotMode::FT8},
+    {10136, 10139, SpotMode::FT8},
+    {14074, 14077, SpotMode::FT8},
+    {18100, 18103, SpotMode::FT8},
+    {21074, 21077, SpotMode::FT8},
+    {24915, 24918, SpotMode::FT8},
+    {28074, 28077, SpotMode::FT8},
+    {50313, 50316, SpotMode::FT8},
+    {144174, 144177, SpotMode::FT8},
+    // FT4
+    {3575.5, 3578.5, SpotMode::FT4},
+    {7047.5, 7050.5, SpotMode::FT4},
+    {10140, 10143, SpotMode::FT4},
+    {14080, 14083, SpotMode::FT4},
+    {18104, 18107, SpotMode::FT4},
+    {21140, 21143, SpotMode::FT4},
+    {24919, 24922, SpotMode::FT4},
+    {28180, 28183, SpotMode::FT4},
+    {50318, 50321, SpotMode::FT4},
+    {144170, 144173, SpotMode::FT4},
+    // Segments
+    {1800, 1838, SpotMode::CW},
+    {1838, 1843, SpotMode::DIGI},
+    {1843, 2000, SpotMode::SSB},
+    {3500, 3570, SpotMode::CW},
+    {3570, 3600, SpotMode::DIGI},
+    {3600, 4000, SpotMode::SSB},
+    {7000, 7040, SpotMode::CW},
+    {7040, 7060, SpotMode::DIGI},
+    {7060, 7300, SpotMode::SSB},
+    {10100, 10130, SpotMode::CW},
+    {10130, 10150, SpotMode::DIGI},
+    {14000, 14070, SpotMode::CW},
+    {14070, 14100, SpotMode::DIGI},
+    {14100, 14350, SpotMode::SSB},
+    {18068, 18095, SpotMode::CW},
+    {18095, 18110, SpotMode::DIGI},
+    {18110, 18168, SpotMode::SSB},
+    {21000, 21070, SpotMode::CW},
+    {21070, 21150, SpotMode::DIGI},
+    {21150, 21450, SpotMode::SSB},
+    {24890, 24915, SpotMode::CW},
+    {24915, 24930, SpotMode::DIGI},
+    {24930, 24990, SpotMode::SSB},
+    {28000, 28070, SpotMode::CW},
+    {28070, 28300, SpotMode::DIGI},
+    {28300, 29500, SpotMode::SSB},
+    {29500, 29700, SpotMode::FM},
+    {50000, 50100, SpotMode::CW},
+    {50100, 50500, SpotMode::SSB},
+    {144000, 144150, SpotMode::CW},
+    {144150, 144400, SpotMode::SSB},
+    {144400, 148000, SpotMode::FM},
+};
+
+uint64_t fnv1a(std::string_view s) {
+  uint64_t h = 14695981039346656037ULL;
+  for (unsigned char c : s) {
+    h ^= c;
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+// Maps 16 bits of 'h' to [-kJitterDeg, kJitterDeg).
+double jitter(uint64_t h) {
+  return (static_cast<double>(h & 0xFFFF) / 32768.0 - 1.0) * kJitterDeg;
+}
+
+} // namespace
+
+SpotEnricher::SpotEnricher(PrefixManager &pm, double homeLat, double homeLon,
+                           std::shared_ptr<const WorkedMatrix> worked)
+    : pm_(pm), homeLat_(homeLat), homeLon_(homeLon),
+      worked_(std::move(worked)) {}
+
+SpotStation SpotEnricher::locate(std::string_view call,
+                                 std::string_view grid) const {
+  SpotStation st;
+  PrefixInfo info;
+  bool known = !call.empty() && pm_.findEntity(call, info);
+  if (known) {
+    st.dxcc = info.dxcc;
+    st.cqZone = info.cqZone;
+    st.ituZone = info.ituZone;
+  }
+
+  double lat = 0, lon = 0;
+  if (grid.size() >= 4 &&
+      Astronomy::gridToLatLon(std::string(grid), lat, lon)) {
+    st.lat = lat;
+    st.lon = lon;
+    st.from = SpotStation::From::Grid;
+  } else if (known && (info.ll.lat != 0 || info.ll.lon != 0)) {
+    // The same call always lands on the same spot.
+    uint64_t h = fnv1a(call);
+    st.lat = std::clamp(info.ll.lat + jitter(h), -90.0, 90.0);
+    st.lon = info.ll.lon + jitter(h >> 16);
+    if (st.lon > 180)
+      st.lon -= 360;
+    else if (st.lon < -180)
+      st.lon += 360;
+    st.from = SpotStation::From::Prefix;
+  }
+  if (st.from != SpotStation::From::None)
+    st.cont = continentAt(st.lat, st.lon);
+  return st;
+}
+
+SpotMode SpotEnricher::guessMode(double freqKhz) {
+  for (const auto &r : kModePlan) {
+    if (freqKhz >= r.minKhz && freqKhz < r.maxKhz)
+      return r.mode;
+  }
+  return SpotMode::Unknown;
+}
+
+void SpotEnricher::measure(double lat, double lon, float &distanceKm,
+                           float &bearingDeg) const {
+  LatLon home{homeLat_, homeLon_};
+  distanceKm =
+      static_cast<float>(Astronomy::calculateDistance(home, {lat, lon}));
+  bearingDeg =
+      static_cast<float>(Astronomy::calculateBearing(home, {lat, lon}));
+}
+
+SpotNeed SpotEnricher::need(int dxcc, int band, SpotMode mode) const {
+  return worked_ ? worked_->need(dxcc, band, mode) : SpotNeed::None;
+}
+
+SpotEnricher::Result SpotEnricher::enrich(const Input &in) const {
+  Result r;
+  r.tx = locate(in.txCall, in.txGrid);
+  r.rx = locate(in.rxCall, in.rxGrid);
+
+  r.band = freqToBandIndex(in.freqKhz);
+  r.mode = spotModeFromName(in.mode);
+  if (r.mode == SpotMode::Unknown) {
+    r.mode = guessMode(in.freqKhz);
+    r.modeGuessed = r.mode != SpotMode::Unknown;
+  }
+
+  if (r.tx.from != SpotStation::From::None)
+    measure(r.tx.lat, r.tx.lon, r.distanceKm, r.bearingDeg);
+
+  r.need = need(r.tx.dxcc, r.band, r.mode);
+  return r;
+}
+
+void SpotEnricher::enrich(DXClusterSpot &spot) const {
+  Result r = enrich({spot.txCall, spot.txGrid, spot.rxCall, spot.rxGrid,
+                     spot.mode, spot.freqKhz});
+  spot.txLat = r.tx.lat;
+  spot.txLon = r.tx.lon;
+  spot.rxLat = r.rx.lat;
+  spot.rxLon = r.rx.lon;
+  spot.txDxcc = r.tx.dxcc;
+  spot.rxDxcc = r.rx.dxcc;
+  spot.txCqZone = static_cast<uint8_t>(r.tx.cqZone);
+  spot.txItuZone = static_cast<uint8_t>(r.tx.ituZone);
+  spot.txCont = r.tx.cont;
+  spot.rxCont = r.rx.cont;
+  spot.band = static_cast<int8_t>(r.band);
+  spot.modeId = r.mode;
+  spot.distanceKm = r.distanceKm;
+  spot.bearingDeg = r.bearingDeg;
+  spot.need = r.need;
+}
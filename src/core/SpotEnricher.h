@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+#include "PrefixManager.h"
+#include "SpotFilter.h"
+#include "WorkedMatrix.h"
+
+struct DXClusterSpot;
+
+// Where one end of a spot is, and which entity it belongs to.
+struct SpotStation {
+  enum class From : uint8_t { None, Grid, Prefix };
+
+  double lat = 0;
+  double lon = 0;
+  int dxcc = 0;    // 0 = unknown
+  int cqZone = 0;  // 0 = unknown
+  int ituZone = 0; // 0 = unknown
+  Continent cont = Continent::Unknown;
+  From from = From::None; // what the position came from
+};
+
+// Works out everything the stores, filters and panels need from a raw spot,
+// once, on the thread that ingests it, in four stages:
+//
+//   locate    DXCC entity and CQ/ITU zones from the call; the position from
+//             the grid when there is one, else the entity's centroid, moved
+//             a little per call so one entity's stations do not stack up
+//   classify  band from the frequency; mode from the spot, or guessed from
+//             the band plan when it names none
+//   measure   great-circle distance and bearing from DE to the DX
+//   need      what the DX would add to the log, given a WorkedMatrix
+//
+// Each stage only reads the prefix table, the WorkedMatrix and the home
+// position, so one enricher serves every ingest thread at once: cluster
+// and RBN spots, PSK Reporter reports and WSJT-X decodes alike.
+class SpotEnricher {
+public:
+  // A spot as a source reports it; every field may be empty.
+  struct Input {
+    std::string_view txCall; // the DX
+    std::string_view txGrid;
+    std::string_view rxCall; // the spotter
+    std::string_view rxGrid;
+    std::string_view mode;
+    double freqKhz = 0;
+  };
+
+  struct Result {
+    SpotStation tx;
+    SpotStation rx;
+    int band = -1; // index into kBands
+    SpotMode mode = SpotMode::Unknown;
+    bool modeGuessed = false; // 'mode' is from the band plan
+    float distanceKm = 0;     // DE to tx; 0 if tx has no position
+    float bearingDeg = 0;
+    SpotNeed need = SpotNeed::None;
+  };
+
+  SpotEnricher(PrefixManager &pm, double homeLat, double homeLon,
+               std::shared_ptr<const WorkedMatrix> worked = nullptr);
+
+  Result enrich(const Input &in) const;
+  // Fills every derived field of a cluster spot from its calls, grids,
+  // mode and frequency.
+  void enrich(DXClusterSpot &spot) const;
+
+  SpotStation locate(std::string_view call, std::string_view grid) const;
+  // CW, FT8, FT4, SSB, FM or DIGI for where 'freqKhz' falls in the IARU
+  // band plan and the usual FT8/FT4 channels; Unknown outside the bands.
+  static SpotMode guessMode(double freqKhz);
+  void measure(double lat, double lon, float &distanceKm,
+               float &bearingDeg) const;
+  SpotNeed need(int dxcc, int band, SpotMode mode) const;
+
+private:
+  PrefixManager &pm_;
+  double homeLat_;
+  double homeLon_;
+  std::shared_ptr<const WorkedMatrix> worked_;
+};
@@ -0,0 +1,673 @@
+#include "SpotFilter.h"
+#include "LiveSpotData.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <iterator>
+
+namespace {
+
+char upper(char c) {
+  return c >= 'a' && c <= 'z' ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+bool iequals(std::string_view a, std::string_view b) {
+  if (a.size() != b.size())
+    return false;
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (upper(a[i]) != upper(b[i]))
+      return false;
+  }
+  return true;
+}
+
+std::string toUpper(std::string_view s) {
+  std::string out(s);
+  for (auto &c : out)
+    c = upper(c);
+  return out;
+}
+
+// Glob match with '*' and '?'; 'pattern' is upper case, 'text' any case.
+bool globMatch(std::string_view pattern, std::string_view text) {
+  size_t p = 0, t = 0;
+  size_t star = std::string_view::npos, mark = 0;
+  while (t < text.size()) {
+    if (p < pattern.size() &&
+        (pattern[p] == '?' || pattern[p] == upper(text[t]))) {
+      ++p;
+      ++t;
+    } else if (p < pattern.size() && pattern[p] == '*') {
+      star = p++;
+      mark = t;
+    } else if (star != std::string_view::npos) {
+      p = star + 1;
+      t = ++mark;
+    } else {
+      return false;
+    }
+  }
+  while (p < pattern.size() && pattern[p] == '*')
+    ++p;
+  return p == pattern.size();
+}
+
+struct ModeName {
+  std::string_view name;
+  SpotMode mode;
+};
+
+constexpr ModeName kModeNames[] = {
+    {"CW", SpotMode::CW},       {"SSB", SpotMode::SSB},
+    {"USB", SpotMode::SSB},     {"LSB", SpotMode::SSB},
+    {"AM", SpotMode::AM},       {"FM", SpotMode::FM},
+    {"RTTY", SpotMode::RTTY},   {"PSK", SpotMode::PSK},
+    {"PSK31", SpotMode::PSK},   {"PSK63", SpotMode::PSK},
+    {"BPSK", SpotMode::PSK},    {"FT8", SpotMode::FT8},
+    {"FT4", SpotMode::FT4},     {"JT", SpotMode::JT},
+    {"JT65", SpotMode::JT},     {"JT9", SpotMode::JT},
+    {"Q65", SpotMode::JT},      {"MSK144", SpotMode::JT},
+    {"DIGI", SpotMode::DIGI},   {"DATA", SpotMode::DIGI},
+    {"OLIVIA", SpotMode::DIGI}, {"SSTV", SpotMode::DIGI},
+};
+
+constexpr const char *kContinentNames[] = {"?",  "NA", "SA", "EU",
+                                           "AF", "AS", "OC", "AN"};
+static_assert(std::size(kContinentNames) ==
+              static_cast<size_t>(Continent::Count));
+
+constexpr const char *kNeedNames[] = {"none", "mode", "band", "dxcc"};
+static_assert(std::size(kNeedNames) == static_cast<size_t>(SpotNeed::Count));
+
+} // namespace
+
+SpotMode spotModeFromName(std::string_view name) {
+  for (const auto &m : kModeNames) {
+    if (iequals(name, m.name))
+      return m.mode;
+  }
+  return SpotMode::Unknown;
+}
+
+const char *spotModeName(SpotMode mode) {
+  for (const auto &m : kModeNames) {
+    if (m.mode == mode)
+      return m.name.data();
+  }
+  return "?";
+}
+
+Continent continentFromName(std::string_view name) {
+  for (size_t i = 1; i < std::size(kContinentNames); ++i) {
+    if (iequals(name, kContinentNames[i]))
+      return static_cast<Continent>(i);
+  }
+  return Continent::Unknown;
+}
+
+const char *continentName(Continent cont) {
+  return kContinentNames[static_cast<size_t>(cont)];
+}
+
+SpotNeed spotNeedFromName(std::string_view name) {
+  for (size_t i = 0; i < std::size(kNeedNames); ++i) {
+    if (iequals(name, kNeedNames[i]))
+      return static_cast<SpotNeed>(i);
+  }
+  return SpotNeed::Count;
+}
+
+const char *spotNeedName(SpotNeed need) {
+  auto i = static_cast<size_t>(need);
+  return i < std::size(kNeedNames) ? kNeedNames[i] : "?";
+}
+
+Continent continentAt(double lat, double lon) {
+  if (lat == 0 && lon == 0)
+    return Continent::Unknown;
+  if (lat <= -60)
+    return Continent::AN;
+  // Pacific islands either side of the date line, Hawaii included.
+  if ((lon >= 160 || lon <= -130) && lat < 30)
+    return Continent::OC;
+  if (lon < -30) {
+    if (lat >= 15 || (lon < -77 && lat >= 7))
+      return Continent::NA;
+    return Continent::SA;
+  }
+  // East Greenland, north of Iceland.
+  if (lon < -10 && lat >= 67)
+    return Continent::NA;
+  // Europe up to the Urals, Azores and Iceland included.
+  if (lat >= 36 && lon < 45 && !(lat < 42 && lon >= 27))
+    return Continent::EU;
+  if (lat >= 45 && lon < 60)
+    return Continent::EU;
+  // Africa, without the Arabian peninsula.
+  if (lon < 52 && lat < 36 && lat > -40 && !(lon >= 35 && lat >= 12))
+    return Continent::AF;
+  // Australia, New Zealand, Indonesia east of Java, the Philippines and
+  // Micronesia.
+  if ((lon >= 110 && lat < 0) || (lon >= 117 && lon < 130 && lat < 21) ||
+      (lon >= 130 && lat < 25))
+    return Continent::OC;
+  return Continent::AS;
+}
+
+// Recursive descent parser that emits SpotFilter bytecode directly.
+//
+//   expr  := and ('or' and)*
+//   and   := unary ('and' unary)*
+//   unary := 'not' unary | '(' expr ')' | field op value
+//          | field 'in' '(' value (',' value)* ')'
+class SpotFilterCompiler {
+public:
+  SpotFilterCompiler(std::string_view src, SpotFilter &out)
+      : src_(src), out_(out) {}
+
+  bool run(std::string &error) {
+    advance();
+    if (tok_.kind != Tok::End) {
+      parseOr();
+      if (ok_ && tok_.kind != Tok::End)
+        fail("expected 'and', 'or' or end of filter");
+    }
+    if (!ok_)
+      error = error_;
+    return ok_;
+  }
+
+private:
+  using Op = SpotFilter::Op;
+  using Cmp = SpotFilter::Cmp;
+
+  enum class Tok { Word, Cmp, LParen, RParen, Comma, End, Bad };
+  struct Token {
+    Tok kind = Tok::End;
+    std::string_view text;
+    size_t pos = 0;
+    Cmp cmp = Cmp::Eq;
+  };
+  enum class Field {
+    Band,
+    Mode,
+    Cont,
+    DeCont,
+    Need,
+    Dxcc,
+    Freq,
+    Age,
+    Call,
+    Spotter
+  };
+
+  static bool wordChar(char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
+           (c >= '0' && c <= '9') || std::strchr("._*?/#-+", c);
+  }
+
+  void advance() {
+    size_t i = next_;
+    while (i < src_.size() && (src_[i] == ' ' || src_[i] == '\t'))
+      ++i;
+    tok_ = Token{};
+    tok_.pos = i;
+    if (i == src_.size()) {
+      next_ = i;
+      return;
+    }
+    char c = src_[i];
+    char n = i + 1 < src_.size() ? src_[i + 1] : '\0';
+    size_t len = 1;
+    if (c == '(') {
+      tok_.kind = Tok::LParen;
+    } else if (c == ')') {
+      tok_.kind = Tok::RParen;
+    } else if (c == ',') {
+      tok_.kind = Tok::Comma;
+    } else if (c == '=' || c == '!' || c == '<' || c == '>') {
+      tok_.kind = Tok::Cmp;
+      if (c == '=') {
+        tok_.cmp = Cmp::Eq;
+        len = n == '=' ? 2 : 1;
+      } else if (c == '!') {
+        if (n != '=')
+          tok_.kind = Tok::Bad;
+        tok_.cmp = Cmp::Ne;
+        len = n == '=' ? 2 : 1;
+      } else {
+        tok_.cmp = c == '<' ? (n == '=' ? Cmp::Le : Cmp::Lt)
+                            : (n == '=' ? Cmp::Ge : Cmp::Gt);
+        len = n == '=' ? 2 : 1;
+      }
+    } else if (wordChar(c)) {
+      tok_.kind = Tok::Word;
+      while (i + len < src_.size() && wordChar(src_[i + len]))
+        ++len;
+    } else {
+      tok_.kind = Tok::Bad;
+    }
+    len = std::min(len, src_.size() - i);
+    tok_.text = src_.substr(i, len);
+    next_ = i + len;
+  }
+
+  bool isKeyword(const char *kw) const {
+    return tok_.kind == Tok::Word && iequals(tok_.text, kw);
+  }
+
+  void fail(const std::string &what) {
+    if (!ok_)
+      return;
+    ok_ = false;
+    error_ = "column " + std::to_string(tok_.pos + 1) + ": " + what;
+    if (tok_.kind != Tok::End)
+      error_ += " at '" + std::string(tok_.text) + "'";
+  }
+
+  size_t emit(Op op, Cmp cmp = Cmp::Eq, uint32_t a = 0, uint32_t b = 0,
+              double num = 0) {
+    out_.code_.push_back({op, cmp, a, b, num});
+    return out_.code_.size() - 1;
+  }
+
+  void patch(const std::vector<size_t> &jumps) {
+    for (size_t j : jumps)
+      out_.code_[j].a = static_cast<uint32_t>(out_.code_.size());
+  }
+
+  void parseOr() {
+    std::vector<size_t> jumps;
+    parseAnd();
+    while (ok_ && isKeyword("or")) {
+      advance();
+      jumps.push_back(emit(Op::JumpIfTrue));
+      parseAnd();
+    }
+    patch(jumps);
+  }
+
+  void parseAnd() {
+    std::vector<size_t> jumps;
+    parseUnary();
+    while (ok_ && isKeyword("and")) {
+      advance();
+      jumps.push_back(emit(Op::JumpIfFalse));
+      parseUnary();
+    }
+    patch(jumps);
+  }
+
+  void parseUnary() {
+    if (!ok_)
+      return;
+    if (isKeyword("not")) {
+      advance();
+      parseUnary();
+      emit(Op::Not);
+    } else if (tok_.kind == Tok::LParen) {
+      advance();
+      parseOr();
+      if (ok_ && tok_.kind != Tok::RParen)
+        fail("expected ')'");
+      advance();
+    } else {
+      parseTerm();
+    }
+  }
+
+  bool parseField(Field &field) {
+    static constexpr struct {
+      const char *name;
+      Field field;
+    } kFields[] = {
+        {"band", Field::Band},       {"mode", Field::Mode},
+        {"cont", Field::Cont},       {"dxcont", Field::Cont},
+        {"decont", Field::DeCont},   {"dxcc", Field::Dxcc},
+        {"freq", Field::Freq},       {"age", Field::Age},
+        {"call", Field::Call},       {"dx", Field::Call},
+        {"spotter", Field::Spotter}, {"de", Field::Spotter},
+        {"need", Field::Need},
+    };
+    if (tok_.kind == Tok::Word) {
+      for (const auto &f : kFields) {
+        if (iequals(tok_.text, f.name)) {
+          field = f.field;
+          advance();
+          return true;
+        }
+      }
+    }
+    fail(tok_.kind == Tok::Word ? "unknown field" : "expected a field name");
+    return false;
+  }
+
+  // Values for one term: a single word, or a parenthesised list after 'in'.
+  std::vector<Token> parseValues(bool list) {
+    std::vector<Token> values;
+    if (!list) {
+      if (tok_.kind != Tok::Word) {
+        fail("expected a value");
+        return values;
+      }
+      values.push_back(tok_);
+      advance();
+      return values;
+    }
+    if (tok_.kind != Tok::LParen) {
+      fail("expected '(' after 'in'");
+      return values;
+    }
+    advance();
+    for (;;) {
+      if (tok_.kind != Tok::Word) {
+        fail("expected a value");
+        return values;
+      }
+      values.push_back(tok_);
+      advance();
+      if (tok_.kind == Tok::Comma) {
+        advance();
+        continue;
+      }
+      if (tok_.kind != Tok::RParen)
+        fail("expected ',' or ')'");
+      advance();
+      return values;
+    }
+  }
+
+  // "20m" / "20M" / "20" -> band index
+  static int bandIndex(std::string_view v) {
+    for (int i = 0; i < kNumBands; ++i) {
+      std::string_view name = kBands[i].name;
+      if (iequals(v, name) || iequals(v, name.substr(0, name.size() - 1)))
+        return i;
+    }
+    return -1;
+  }
+
+  static bool parseNumber(std::string_view v, double &out) {
+    // Integer from_chars plus a hand-rolled fraction, as in the cluster
+    // parser, to stay independent of locale and libc++ version.
+    long long whole = 0;
+    const char *p = v.data();
+    const char *end = v.data() + v.size();
+    auto [next, ec] = std::from_chars(p, end, whole);
+    if (ec != std::errc())
+      return false;
+    double frac = 0, scale = 0.1;
+    if (next != end && *next == '.') {
+      for (++next; next != end && *next >= '0' && *next <= '9'; ++next) {
+        frac += (*next - '0') * scale;
+        scale *= 0.1;
+      }
+    }
+    if (next != end)
+      return false;
+    out = static_cast<double>(whole) + frac;
+    return true;
+  }
+
+  // "30s", "15m", "2h", "1d"; a bare number is minutes.
+  static bool parseDuration(std::string_view v, double &seconds) {
+    double unit = 60;
+    if (!v.empty()) {
+      switch (upper(v.back())) {
+      case 'S':
+        unit = 1;
+        break;
+      case 'M':
+        unit = 60;
+        break;
+      case 'H':
+        unit = 3600;
+        break;
+      case 'D':
+        unit = 86400;
+        break;
+      default:
+        unit = 0;
+      }
+      if (unit != 0)
+        v.remove_suffix(1);
+      else
+        unit = 60;
+    }
+    if (!parseNumber(v, seconds))
+      return false;
+    seconds *= unit;
+    return true;
+  }
+
+  void parseTerm() {
+    Field field;
+    if (!parseField(field))
+      return;
+
+    bool list = false;
+    Cmp cmp = Cmp::Eq;
+    Token opTok = tok_;
+    if (isKeyword("in")) {
+      list = true;
+      advance();
+    } else if (tok_.kind == Tok::Cmp) {
+      cmp = tok_.cmp;
+      advance();
+    } else {
+      fail("expected '=', '!=', '<', '>' or 'in'");
+      return;
+    }
+
+    bool ordered = field == Field::Freq || field == Field::Age;
+    if (ordered && list) {
+      fail("'in' does not apply to this field");
+      return;
+    }
+    if (!ordered && cmp != Cmp::Eq && cmp != Cmp::Ne) {
+      tok_ = opTok;
+      fail("only '=', '!=' and 'in' apply to this field");
+      return;
+    }
+
+    auto values = parseValues(list);
+    if (!ok_)
+      return;
+    auto badValue = [&](const Token &v, const char *what) {
+      tok_ = v;
+      fail(what);
+    };
+
+    switch (field) {
+    case Field::Band:
+    case Field::Mode:
+    case Field::Cont:
+    case Field::DeCont:
+    case Field::Need: {
+      uint32_t mask = 0;
+      for (const auto &v : values) {
+        int bit = -1;
+        if (field == Field::Band) {
+          bit = bandIndex(v.text);
+        } else if (field == Field::Mode) {
+          auto m = spotModeFromName(v.text);
+          bit = m == SpotMode::Unknown ? -1 : static_cast<int>(m);
+        } else if (field == Field::Need) {
+          auto n = spotNeedFromName(v.text);
+          bit = n == SpotNeed::Count ? -1 : static_cast<int>(n);
+        } else {
+          auto c = continentFromName(v.text);
+          bit = c == Continent::Unknown ? -1 : static_cast<int>(c);
+        }
+        if (bit < 0)
+          return badValue(v, field == Field::Band   ? "unknown band"
+                             : field == Field::Mode ? "unknown mode"
+                             : field == Field::Need
+                                 ? "expected none, mode, band or dxcc"
+                                 : "unknown continent");
+        mask |= 1u << bit;
+      }
+      if (cmp == Cmp::Ne)
+        mask = ~mask;
+      Op op = field == Field::Band   ? Op::MaskBand
+              : field == Field::Mode ? Op::MaskMode
+              : field == Field::Cont ? Op::MaskDxCont
+              : field == Field::Need ? Op::MaskNeed
+                                     : Op::MaskDeCont;
+      emit(op, Cmp::Eq, mask);
+      break;
+    }
+    case Field::Dxcc: {
+      auto start = static_cast<uint32_t>(out_.ints_.size());
+      for (const auto &v : values) {
+        int n = 0;
+        auto [next, ec] =
+            std::from_chars(v.text.data(), v.text.data() + v.text.size(), n);
+        if (ec != std::errc() || next != v.text.data() + v.text.size() ||
+            n <= 0)
+          return badValue(v, "expected a DXCC entity number");
+        out_.ints_.push_back(n);
+      }
+      std::sort(out_.ints_.begin() + start, out_.ints_.end());
+      emit(Op::DxccIn, Cmp::Eq, start,
+           static_cast<uint32_t>(out_.ints_.size() - start));
+      if (cmp == Cmp::Ne)
+        emit(Op::Not);
+      break;
+    }
+    case Field::Freq:
+    case Field::Age: {
+      double num = 0;
+      const Token &v = values.front();
+      bool okValue = field == Field::Freq ? parseNumber(v.text, num)
+                                          : parseDuration(v.text, num);
+      if (!okValue)
+        return badValue(v, field == Field::Freq
+                               ? "expected a frequency in kHz"
+                               : "expected an age like 30s, 15m or 2h");
+      emit(field == Field::Freq ? Op::CmpFreq : Op::CmpAge, cmp, 0, 0, num);
+      break;
+    }
+    case Field::Call:
+    case Field::Spotter: {
+      auto start = static_cast<uint32_t>(out_.patterns_.size());
+      for (const auto &v : values)
+        out_.patterns_.push_back(toUpper(v.text));
+      emit(field == Field::Call ? Op::CallIn : Op::SpotterIn, Cmp::Eq, start,
+           static_cast<uint32_t>(values.size()));
+      if (cmp == Cmp::Ne)
+        emit(Op::Not);
+      break;
+    }
+    }
+  }
+
+  std::string_view src_;
+  SpotFilter &out_;
+  Token tok_;
+  size_t next_ = 0;
+  bool ok_ = true;
+  std::string error_;
+};
+
+bool SpotFilter::compile(std::string_view expr, std::string *error) {
+  code_.clear();
+  ints_.clear();
+  patterns_.clear();
+  expr_.assign(expr);
+
+  std::string err;
+  if (!SpotFilterCompiler(expr_, *this).run(err)) {
+    code_.clear();
+    ints_.clear();
+    patterns_.clear();
+    if (error)
+      *error = err;
+    return false;
+  }
+  if (error)
+    error->clear();
+  return true;
+}
+
+std::string SpotFilter::validate(std::string_view expr) {
+  SpotFilter f;
+  std::string err;
+  f.compile(expr, &err);
+  return err;
+}
+
+bool SpotFilter::matches(const Fields &f, int64_t now) const {
+  auto compare = [](double lhs, Cmp cmp, double rhs) {
+    switch (cmp) {
+    case Cmp::Eq:
+      return lhs == rhs;
+    case Cmp::Ne:
+      return lhs != rhs;
+    case Cmp::Lt:
+      return lhs < rhs;
+    case Cmp::Le:
+      return lhs <= rhs;
+    case Cmp::Gt:
+      return lhs > rhs;
+    case Cmp::Ge:
+      return lhs >= rhs;
+    }
+    return false;
+  };
+
+  bool acc = true;
+  const size_t n = code_.size();
+  for (size_t pc = 0; pc < n;) {
+    const Insn &in = code_[pc++];
+    switch (in.op) {
+    case Op::MaskBand:
+      acc = (in.a >> (f.band < 0 ? 31 : f.band)) & 1;
+      break;
+    case Op::MaskMode:
+      acc = (in.a >> static_cast<unsigned>(f.mode)) & 1;
+      break;
+    case Op::MaskDxCont:
+      acc = (in.a >> static_cast<unsigned>(f.dxCont)) & 1;
+      break;
+    case Op::MaskDeCont:
+      acc = (in.a >> static_cast<unsigned>(f.deCont)) & 1;
+      break;
+    case Op::MaskNeed:
+      acc = (in.a >> static_cast<unsigned>(f.need)) & 1;
+      break;
+    case Op::DxccIn: {
+      auto first = ints_.begin() + in.a;
+      acc = std::binary_search(first, first + in.b, f.dxcc);
+      break;
+    }
+    case Op::CmpFreq:
+      acc = compare(f.freqKhz, in.cmp, in.num);
+      break;
+    case Op::CmpAge:
+      acc = compare(static_cast<double>(now - f.spottedAt), in.cmp, in.num);
+      break;
+    case Op::CallIn:
+    case Op::SpotterIn: {
+      std::string_view text = in.op == Op::CallIn ? f.call : f.spotter;
+      acc = false;
+      for (uint32_t i = 0; i < in.b && !acc; ++i)
+        acc = globMatch(patterns_[in.a + i], text);
+      break;
+    }
+    case Op::Not:
+      acc = !acc;
+      break;
+    case Op::JumpIfFalse:
+      if (!acc)
+        pc = in.a;
+      break;
+    case Op::JumpIfTrue:
+      if (acc)
+        pc = in.a;
+      break;
+    }
+  }
+  return acc;
+}
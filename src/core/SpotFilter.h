@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Operating mode of a spot, as far as it can be told from the cluster
+// comment or the PSK Reporter record.
+enum class SpotMode : uint8_t {
+  Unknown,
+  CW,
+  SSB,
+  AM,
+  FM,
+  RTTY,
+  PSK,
+  FT8,
+  FT4,
+  JT,   // JT65, JT9, Q65, MSK144
+  DIGI, // any other data mode
+  Count
+};
+
+enum class Continent : uint8_t { Unknown, NA, SA, EU, AF, AS, OC, AN, Count };
+
+// What a spot would add to the log, from WorkedMatrix.
+enum class SpotNeed : uint8_t {
+  None,    // slot already worked, or unknown
+  NewMode, // entity and band worked, but not in this mode class
+  NewBand, // entity worked, but not on this band
+  NewDxcc, // entity never worked
+  Count
+};
+
+SpotMode spotModeFromName(std::string_view name);
+const char *spotModeName(SpotMode mode);
+Continent continentFromName(std::string_view name);
+const char *continentName(Continent cont);
+SpotNeed spotNeedFromName(std::string_view name);
+const char *spotNeedName(SpotNeed need);
+
+// Coarse continent for a position, from a handful of lat/lon boxes. Good
+// enough to tell EU from NA for filtering; wrong near some borders and for
+// a few island entities. (0, 0) is taken to mean "no position".
+Continent continentAt(double lat, double lon);
+
+// A spot filter expression compiled to a small bytecode program, e.g.
+//
+//   band in (20m,17m) and mode=CW and not cont=EU and age<15m
+//
+// Terms are 'field op value' or 'field in (value, ...)', combined with
+// 'and', 'or', 'not' and parentheses; keywords are case-insensitive.
+//
+//   band     160m .. 2m           = != in
+//   mode     CW SSB FT8 ...       = != in
+//   cont     DX continent         = != in   (NA SA EU AF AS OC AN)
+//   decont   spotter continent    = != in
+//   dxcc     entity number        = != in
+//   freq     kHz                  = != < <= > >=
+//   age      30s 15m 2h (bare = minutes)   = != < <= > >=
+//   call     DX call, * and ? wildcards    = != in
+//   spotter  spotter call, same            = != in
+//   need     none mode band dxcc (what the log lacks)   = != in
+//
+// The expression is parsed once; matches() then runs a few table lookups
+// and compares over precomputed Fields without allocating. An empty
+// expression matches everything.
+class SpotFilter {
+public:
+  // Everything a filter can look at, precomputed once per spot.
+  struct Fields {
+    int band = -1; // index into kBands, -1 = out of band
+    SpotMode mode = SpotMode::Unknown;
+    Continent dxCont = Continent::Unknown;
+    Continent deCont = Continent::Unknown;
+    int dxcc = 0; // 0 = unknown
+    SpotNeed need = SpotNeed::None;
+    double freqKhz = 0;
+    int64_t spottedAt = 0; // unix seconds
+    std::string_view call;
+    std::string_view spotter;
+  };
+
+  SpotFilter() = default;
+
+  // Replaces the program. On a syntax error the filter is left empty
+  // (matching everything), false is returned and 'error' says what and
+  // where.
+  bool compile(std::string_view expr, std::string *error = nullptr);
+
+  // 'now' is unix seconds, for 'age'.
+  bool matches(const Fields &f, int64_t now) const;
+
+  bool empty() const { return code_.empty(); }
+  const std::string &expression() const { return expr_; }
+  size_t instructionCount() const { return code_.size(); }
+
+  // Checks an expression without keeping it; returns the error or "".
+  static std::string validate(std::string_view expr);
+
+private:
+  friend class SpotFilterCompiler;
+
+  enum class Op : uint8_t {
+    MaskBand,   // acc = mask bit for the band
+    MaskMode,   // acc = mask bit for the mode
+    MaskDxCont, // acc = mask bit for the DX continent
+    MaskDeCont, // acc = mask bit for the spotter continent
+    MaskNeed,   // acc = mask bit for the need
+    DxccIn,     // acc = dxcc in ints_[a, a + b)
+    CmpFreq,    // acc = freqKhz <cmp> num
+    CmpAge,     // acc = (now - spottedAt) <cmp> num
+    CallIn,     // acc = call matches any of patterns_[a, a + b)
+    SpotterIn,  // acc = spotter matches any of patterns_[a, a + b)
+    Not,        // acc = !acc
+    JumpIfFalse,
+    JumpIfTrue,
+  };
+  enum class Cmp : uint8_t { Eq, Ne, Lt, Le, Gt, Ge };
+
+  struct Insn {
+    Op op;
+    Cmp cmp = Cmp::Eq;
+    uint32_t a = 0; // mask, list start or jump target
+    uint32_t b = 0; // list length
+    double num = 0;
+  };
+
+  std::string expr_;
+  std::vector<Insn> code_;
+  std::vector<int> ints_;             // sorted runs, one per DxccIn
+  std::vector<std::string> patterns_; // upper-cased call patterns
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "SnapshotStore.h"
+#include "SpotArchive.h"
+#include "Tracer.h"
+
+// Archive lookups for the spot selected in the DX cluster list.
+struct SpotHistoryData {
+  std::string call;
+  int dxcc = 0;
+  int band = -1;
+  Continent from = Continent::Unknown; // the DX station's continent
+  Continent to = Continent::Unknown;   // ours
+  int days = 0;
+
+  CallHistory history;
+  HourlyActivity activity; // on 'band', from -> to
+  std::vector<EntitySighting> entity;
+  double queryMs = 0;
+
+  bool valid = false;
+};
+
+class SpotHistoryStore : public SnapshotStore<SpotHistoryData> {
+public:
+  SpotHistoryStore() : SnapshotStore(ChangeBus::Topic::SpotHistory) {}
+
+  void set(SpotHistoryData data) {
+    TRACE_SCOPE("store", "SpotHistoryStore::set");
+    publish(std::move(data));
+  }
+};
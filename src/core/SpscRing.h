@@ -0,0 +1,60 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. Neither side ever blocks: tryPush() fails when the ring is full and
+// tryPop() fails when it is empty.
+template <typename T, size_t Capacity> class SpscRing {
+  static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                "SpscRing capacity must be a power of two");
+
+public:
+  SpscRing() : slots_(std::make_unique<T[]>(Capacity)) {}
+
+  SpscRing(const SpscRing &) = delete;
+  SpscRing &operator=(const SpscRing &) = delete;
+
+  // Producer thread only.
+  bool tryPush(T value) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) == Capacity)
+      return false;
+    slots_[head & kMask] = std::move(value);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Consumer thread only.
+  bool tryPop(T &out) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire))
+      return false;
+    out = std::move(slots_[tail & kMask]);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Any thread; approximate while either side is active. The tail is read
+  // first so a pop between the two loads cannot make the difference wrap,
+  // and the result is capped because the producer may refill the slots
+  // freed after that read.
+  size_t size() const {
+    size_t tail = tail_.load(std::memory_order_acquire);
+    size_t head = head_.load(std::memory_order_acquire);
+    return std::min(head - tail, Capacity);
+  }
+
+  static constexpr size_t capacity() { return Capacity; }
+
+private:
+  static constexpr size_t kMask = Capacity - 1;
+
+  // Separate cache lines so the two threads do not false-share.
+  alignas(64) std::atomic<size_t> head_{0}; // next slot to write
+  alignas(64) std::atomic<size_t> tail_{0}; // next slot to read
+  std::unique_ptr<T[]> slots_;
+};
@@ -3,6 +3,8 @@
 #include <SDL.h>
 #include <string>
 
+#include "SpotFilter.h"
+
 struct ThemeColors {
   SDL_Color bg;
   SDL_Color border;
@@ -43,3 +45,17 @@ inline ThemeColors getThemeColors(const std::string &theme) {
   }
   return colors;
 }
+
+// Highlight for a spot the log still needs; 'normal' when it needs nothing.
+inline SDL_Color spotNeedColor(SpotNeed need, SDL_Color normal) {
+  switch (need) {
+  case SpotNeed::NewDxcc:
+    return {255, 80, 80, 255}; // red
+  case SpotNeed::NewBand:
+    return {255, 170, 0, 255}; // orange
+  case SpotNeed::NewMode:
+    return {240, 230, 90, 255}; // yellow
+  default:
+    return normal;
+  }
+}
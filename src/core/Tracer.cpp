@@ -0,0 +1,156 @@
+#include "Tracer.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+Tracer::ThreadSlot::~ThreadSlot() {
+  if (buffer)
+    Tracer::instance().releaseBuffer(buffer);
+}
+
+Tracer::ThreadSlot &Tracer::slot() {
+  thread_local ThreadSlot s;
+  return s;
+}
+
+int64_t Tracer::nowMicros() const {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - epoch_)
+      .count();
+}
+
+bool Tracer::start() {
+  if (enabled_.exchange(true))
+    return false;
+  // Older events stay in the rings; export simply skips anything recorded
+  // before this point rather than racing the writers to clear them.
+  captureStart_.store(nowMicros(), std::memory_order_relaxed);
+  LOG_I("Tracer", "Trace capture started");
+  return true;
+}
+
+void Tracer::stop() {
+  if (enabled_.exchange(false))
+    LOG_I("Tracer", "Trace capture stopped");
+}
+
+Tracer::ThreadBuffer *Tracer::acquireBuffer() {
+  std::lock_guard<std::mutex> lock(registryMutex_);
+  if (!freeBuffers_.empty()) {
+    ThreadBuffer *buf = freeBuffers_.back();
+    freeBuffers_.pop_back();
+    return buf;
+  }
+  buffers_.push_back(std::make_unique<ThreadBuffer>());
+  return buffers_.back().get();
+}
+
+void Tracer::releaseBuffer(ThreadBuffer *buf) {
+  std::lock_guard<std::mutex> lock(registryMutex_);
+  freeBuffers_.push_back(buf);
+}
+
+void Tracer::record(Phase phase, const char *cat, const char *name,
+                    int64_t value) {
+  ThreadSlot &s = slot();
+  if (!s.buffer) {
+    s.buffer = acquireBuffer();
+    if (s.tid == 0)
+      s.tid = nextTid_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  ThreadBuffer *buf = s.buffer;
+  uint64_t idx = buf->head.load(std::memory_order_relaxed);
+  Event &e = buf->events[idx & (kRingSize - 1)];
+  e.ts = nowMicros();
+  e.cat = cat;
+  e.name = name;
+  e.value = value;
+  e.tid = s.tid;
+  e.phase = phase;
+  buf->head.store(idx + 1, std::memory_order_release);
+}
+
+void Tracer::setThreadName(const std::string &name) {
+  ThreadSlot &s = slot();
+  if (s.tid == 0)
+    s.tid = nextTid_.fetch_add(1, std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(registryMutex_);
+  threadNames_[s.tid] = name;
+}
+
+std::string Tracer::exportJson() {
+  int64_t since = captureStart_.load(std::memory_order_relaxed);
+  std::vector<Event> events;
+
+  {
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    for (const auto &buf : buffers_) {
+      uint64_t head = buf->head.load(std::memory_order_acquire);
+      uint64_t first = head > kRingSize ? head - kRingSize : 0;
+      size_t mark = events.size();
+      for (uint64_t i = first; i < head; ++i)
+        events.push_back(buf->events[i & (kRingSize - 1)]);
+
+      // A straggling writer may have lapped the slots we just copied; drop
+      // anything that could have been overwritten while we were reading,
+      // including the slot of index 'after', which it may be writing now.
+      uint64_t after = buf->head.load(std::memory_order_acquire);
+      if (after >= first + kRingSize) {
+        size_t torn = std::min<uint64_t>(after - kRingSize + 1 - first,
+                                         events.size() - mark);
+        events.erase(events.begin() + mark, events.begin() + mark + torn);
+      }
+    }
+  }
+
+  std::stable_sort(events.begin(), events.end(),
+                   [](const Event &a, const Event &b) { return a.ts < b.ts; });
+
+  nlohmann::json out;
+  nlohmann::json list = nlohmann::json::array();
+  for (const auto &e : events) {
+    if (e.ts < since)
+      continue;
+    nlohmann::json j;
+    j["name"] = e.name;
+    j["cat"] = e.cat;
+    j["ph"] = std::string(1, static_cast<char>(e.phase));
+    j["ts"] = e.ts;
+    j["pid"] = 1;
+    j["tid"] = e.tid;
+    if (e.phase == Phase::Counter)
+      j["args"] = {{"value", e.value}};
+    else if (e.phase == Phase::Instant)
+      j["s"] = "t";
+    list.push_back(std::move(j));
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    for (const auto &[tid, name] : threadNames_) {
+      list.push_back({{"name", "thread_name"},
+                      {"ph", "M"},
+                      {"pid", 1},
+                      {"tid", tid},
+                      {"args", {{"name", name}}}});
+    }
+  }
+
+  out["traceEvents"] = std::move(list);
+  out["displayTimeUnit"] = "ms";
+  return out.dump();
+}
+
+bool Tracer::writeJson(const std::filesystem::path &path) {
+  std::ofstream ofs(path, std::ios::binary);
+  if (!ofs) {
+    LOG_E("Tracer", "Cannot write trace to {}", path.string());
+    return false;
+  }
+  ofs << exportJson();
+  LOG_I("Tracer", "Trace written to {}", path.string());
+  return true;
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Lightweight event tracer that writes the Chrome trace event format
+// (chrome://tracing, ui.perfetto.dev).
+//
+// Every thread records into its own fixed-size ring buffer, so the hot path
+// is a relaxed atomic load when tracing is off and a couple of plain stores
+// when it is on. Category and event names must be string literals (or
+// otherwise outlive the capture) since only the pointers are stored.
+class Tracer {
+public:
+  enum class Phase : char {
+    Begin = 'B',
+    End = 'E',
+    Instant = 'i',
+    Counter = 'C',
+  };
+
+  static Tracer &instance() {
+    static Tracer tracer;
+    return tracer;
+  }
+
+  static bool enabled() { return enabled_.load(std::memory_order_relaxed); }
+
+  // Starts a capture. Returns false if one is already running.
+  bool start();
+  // Stops the current capture; recorded events stay available for export.
+  void stop();
+
+  void record(Phase phase, const char *cat, const char *name,
+              int64_t value = 0);
+
+  // Names the calling thread in the exported trace.
+  void setThreadName(const std::string &name);
+
+  // Serializes everything recorded since the last start() as Chrome JSON.
+  std::string exportJson();
+  bool writeJson(const std::filesystem::path &path);
+
+private:
+  Tracer() = default;
+
+  struct Event {
+    int64_t ts; // microseconds since the tracer epoch
+    const char *cat;
+    const char *name;
+    int64_t value;
+    uint32_t tid;
+    Phase phase;
+  };
+
+  static constexpr size_t kRingSize = 16384; // power of two
+  struct ThreadBuffer {
+    Event events[kRingSize];
+    std::atomic<uint64_t> head{0};
+  };
+
+  // Detached worker threads (e.g. curl fetches) come and go, so buffers are
+  // returned to a free list when their thread exits and handed to the next
+  // thread that records. Events carry their own tid so reuse is harmless.
+  struct ThreadSlot {
+    ThreadBuffer *buffer = nullptr;
+    uint32_t tid = 0;
+    ~ThreadSlot();
+  };
+
+  ThreadBuffer *acquireBuffer();
+  void releaseBuffer(ThreadBuffer *buf);
+  int64_t nowMicros() const;
+  static ThreadSlot &slot();
+
+  static inline std::atomic<bool> enabled_{false};
+  std::atomic<int64_t> captureStart_{0};
+  std::atomic<uint32_t> nextTid_{1};
+
+  std::mutex registryMutex_; // only taken on thread registration and export
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+  std::vector<ThreadBuffer *> freeBuffers_;
+  std::map<uint32_t, std::string> threadNames_;
+  const std::chrono::steady_clock::time_point epoch_ =
+      std::chrono::steady_clock::now();
+};
+
+// Records a Begin event now and the matching End event at scope exit.
+class TraceScope {
+public:
+  TraceScope(const char *cat, const char *name) {
+    if (Tracer::enabled()) {
+      cat_ = cat;
+      name_ = name;
+      Tracer::instance().record(Tracer::Phase::Begin, cat, name);
+    }
+  }
+  ~TraceScope() {
+    if (name_)
+      Tracer::instance().record(Tracer::Phase::End, cat_, name_);
+  }
+
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+  const char *cat_ = nullptr;
+  const char *name_ = nullptr;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#define TRACE_SCOPE(cat, name)                                                 \
+  ::TraceScope TRACE_CONCAT(traceScope_, __LINE__)(cat, name)
+
+// Explicit begin/end pair for phases that do not map onto a C++ scope.
+#define TRACE_BEGIN(cat, name)                                                 \
+  do {                                                                         \
+    if (::Tracer::enabled())                                                   \
+      ::Tracer::instance().record(::Tracer::Phase::Begin, cat, name);          \
+  } while (0)
+
+#define TRACE_END(cat, name)                                                   \
+  do {                                                                         \
+    if (::Tracer::enabled())                                                   \
+      ::Tracer::instance().record(::Tracer::Phase::End, cat, name);            \
+  } while (0)
+
+#define TRACE_INSTANT(cat, name)                                               \
+  do {                                                                         \
+    if (::Tracer::enabled())                                                   \
+      ::Tracer::instance().record(::Tracer::Phase::Instant, cat, name);        \
+  } while (0)
+
+#define TRACE_COUNTER(cat, name, value)                                        \
+  do {                                                                         \
+    if (::Tracer::enabled())                                                   \
+      ::Tracer::instance().record(::Tracer::Phase::Counter, cat, name,         \
+                                  static_cast<int64_t>(value));                \
+  } while (0)
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
-#include <mutex>
 #include <string>
 #include <vector>
 
+#include "SnapshotStore.h"
+#include "Tracer.h"
+
 struct WatchlistHit {
   std::string call;
   float freqKhz;
@@ -13,28 +16,26 @@ struct WatchlistHit {
   std::chrono::system_clock::time_point time;
 };
 
-class WatchlistHitStore {
+class WatchlistHitStore : public SnapshotStore<std::vector<WatchlistHit>> {
 public:
+  WatchlistHitStore() : SnapshotStore(ChangeBus::Topic::WatchlistHits) {}
+
   void addHit(const WatchlistHit &hit) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    hits_.insert(hits_.begin(), hit);
-    if (hits_.size() > 50)
-      hits_.pop_back();
-    lastUpdate_ = std::chrono::system_clock::now();
+    TRACE_SCOPE("store", "WatchlistHitStore::addHit");
+    modify([&](std::vector<WatchlistHit> &hits) {
+      hits.insert(hits.begin(), hit);
+      if (hits.size() > 50)
+        hits.pop_back();
+    });
+    lastUpdate_.store(std::chrono::system_clock::now());
   }
 
-  std::vector<WatchlistHit> getHits() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return hits_;
-  }
+  std::vector<WatchlistHit> getHits() const { return get(); }
 
   std::chrono::system_clock::time_point lastUpdate() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return lastUpdate_;
+    return lastUpdate_.load();
   }
 
 private:
-  mutable std::mutex mutex_;
-  std::vector<WatchlistHit> hits_;
-  std::chrono::system_clock::time_point lastUpdate_{};
+  std::atomic<std::chrono::system_clock::time_point> lastUpdate_{};
 };
@@ -1,11 +1,14 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
 #include <mutex>
 #include <set>
 #include <string>
 #include <vector>
 
+#include "ChangeBus.h"
+
 struct WatchlistData {
   std::set<std::string> calls;
 };
@@ -16,14 +19,16 @@ public:
     std::lock_guard<std::mutex> lock(mutex_);
     std::string c = call;
     std::transform(c.begin(), c.end(), c.begin(), ::toupper);
-    data_.calls.insert(c);
+    if (data_.calls.insert(c).second)
+      ChangeBus::instance().publish(ChangeBus::Topic::Watchlist);
   }
 
   void remove(const std::string &call) {
     std::lock_guard<std::mutex> lock(mutex_);
     std::string c = call;
     std::transform(c.begin(), c.end(), c.begin(), ::toupper);
-    data_.calls.erase(c);
+    if (data_.calls.erase(c) > 0)
+      ChangeBus::instance().publish(ChangeBus::Topic::Watchlist);
   }
 
   bool contains(const std::string &call) const {
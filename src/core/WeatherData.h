@@ -4,6 +4,9 @@
 #include <mutex>
 #include <string>
 
+#include "SnapshotStore.h"
+#include "Tracer.h"
+
 struct WeatherData {
   float temp = 0;      // Celsius
   float pressure = 0;  // hPa
@@ -18,19 +21,12 @@ struct WeatherData {
   std::chrono::system_clock::time_point lastUpdate;
 };
 
-class WeatherStore {
+class WeatherStore : public SnapshotStore<WeatherData> {
 public:
-  void update(const WeatherData &data) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    data_ = data;
-  }
+  WeatherStore() : SnapshotStore(ChangeBus::Topic::Weather) {}
 
-  WeatherData get() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return data_;
+  void update(const WeatherData &data) {
+    TRACE_SCOPE("store", "WeatherStore::update");
+    publish(data);
   }
-
-private:
-  mutable std::mutex mutex_;
-  WeatherData data_;
 };
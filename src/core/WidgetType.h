@@ -31,6 +31,10 @@ enum class WidgetType {
   WATCHLIST,
   EME_TOOL,
   SANTA_TRACKER,
+  SERVICE_HEALTH,
+  SPOT_HISTORY,
+  BAND_ACTIVITY,
+  CONTEST_RATE,
 };
 
 inline const char *widgetTypeToString(WidgetType t) {
@@ -89,6 +93,14 @@ inline const char *widgetTypeToString(WidgetType t) {
     return "eme_tool";
   case WidgetType::SANTA_TRACKER:
     return "santa_tracker";
+  case WidgetType::SERVICE_HEALTH:
+    return "service_health";
+  case WidgetType::SPOT_HISTORY:
+    return "spot_history";
+  case WidgetType::BAND_ACTIVITY:
+    return "band_activity";
+  case WidgetType::CONTEST_RATE:
+    return "contest_rate";
   }
   return "solar";
 }
@@ -149,6 +161,14 @@ inline const char *widgetTypeDisplayName(WidgetType t) {
     return "EME Tool";
   case WidgetType::SANTA_TRACKER:
     return "Santa Tracker";
+  case WidgetType::SERVICE_HEALTH:
+    return "Service Health";
+  case WidgetType::SPOT_HISTORY:
+    return "Spot History";
+  case WidgetType::BAND_ACTIVITY:
+    return "Band Activity";
+  case WidgetType::CONTEST_RATE:
+    return "Contest Rate";
   }
   return "Solar";
 }
@@ -209,6 +229,14 @@ inline WidgetType widgetTypeFromString(const std::string &s,
     return WidgetType::EME_TOOL;
   if (s == "santa_tracker")
     return WidgetType::SANTA_TRACKER;
+  if (s == "service_health")
+    return WidgetType::SERVICE_HEALTH;
+  if (s == "spot_history")
+    return WidgetType::SPOT_HISTORY;
+  if (s == "band_activity")
+    return WidgetType::BAND_ACTIVITY;
+  if (s == "contest_rate")
+    return WidgetType::CONTEST_RATE;
   std::fprintf(stderr, "WidgetType: unknown '%s', using fallback\n", s.c_str());
   return fallback;
 }
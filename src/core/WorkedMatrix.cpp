@@ -0,0 +1,70 @@
+#include "WorkedMatrix.h"
+#include "LiveSpotData.h"
+
+static_assert(kNumBands == 12, "WorkedMatrix packs 12 bands per word");
+
+int WorkedMatrix::modeClass(SpotMode mode) {
+  switch (mode) {
+  case SpotMode::Unknown:
+  case SpotMode::Count:
+    return -1;
+  case SpotMode::CW:
+    return CW;
+  case SpotMode::SSB:
+  case SpotMode::AM:
+  case SpotMode::FM:
+    return Phone;
+  default:
+    return Data;
+  }
+}
+
+void WorkedMatrix::record(int dxcc, int band, int modeCls) {
+  if (dxcc <= 0 || dxcc >= kMaxDxcc)
+    return;
+  uint64_t bits = kEntityBit;
+  if (band >= 0 && band < kNumBandSlots) {
+    int shift = band * kBitsPerBand;
+    bits |= uint64_t{1} << (shift + kAnyModeBit);
+    if (modeCls >= 0 && modeCls < NumModeClasses)
+      bits |= uint64_t{1} << (shift + modeCls);
+  }
+  words_[dxcc].fetch_or(bits, std::memory_order_relaxed);
+  qsos_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void WorkedMatrix::clear() {
+  for (auto &w : words_)
+    w.store(0, std::memory_order_relaxed);
+  qsos_.store(0, std::memory_order_relaxed);
+}
+
+SpotNeed WorkedMatrix::need(int dxcc, int band, SpotMode mode) const {
+  if (dxcc <= 0 || dxcc >= kMaxDxcc ||
+      qsos_.load(std::memory_order_relaxed) == 0)
+    return SpotNeed::None;
+  uint64_t w = words_[dxcc].load(std::memory_order_relaxed);
+  if (w == 0)
+    return SpotNeed::NewDxcc;
+  if (band < 0 || band >= kNumBandSlots)
+    return SpotNeed::None;
+  uint64_t slots = w >> (band * kBitsPerBand);
+  if (!(slots & (uint64_t{1} << kAnyModeBit)))
+    return SpotNeed::NewBand;
+  int cls = modeClass(mode);
+  if (cls >= 0 && !(slots & (uint64_t{1} << cls)))
+    return SpotNeed::NewMode;
+  return SpotNeed::None;
+}
+
+bool WorkedMatrix::worked(int dxcc) const {
+  return dxcc > 0 && dxcc < kMaxDxcc &&
+         words_[dxcc].load(std::memory_order_relaxed) != 0;
+}
+
+int WorkedMatrix::entityCount() const {
+  int n = 0;
+  for (const auto &w : words_)
+    n += w.load(std::memory_order_relaxed) != 0;
+  return n;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "SpotFilter.h"
+
+// Which DXCC entity / band / mode slots have been worked, built from the
+// ADIF log and consulted for every incoming spot.
+//
+// One 64-bit word per entity: four bits per band (CW, phone, data, any
+// mode) plus a bit for "worked at all", so need() is a single atomic load
+// and a few shifts. Words are only ever OR-ed into, so the log reader can
+// add QSOs while spot threads read without locks.
+class WorkedMatrix {
+public:
+  enum ModeClass : int { CW, Phone, Data, NumModeClasses };
+
+  static constexpr int kMaxDxcc = 1024;
+
+  // CW, SSB/AM/FM as phone, anything else as data; -1 for Unknown.
+  static int modeClass(SpotMode mode);
+
+  // Records a QSO. 'band' may be -1 and 'modeCls' -1 when the log does not
+  // say; the entity still counts as worked.
+  void record(int dxcc, int band, int modeCls);
+  // Forgets every QSO, e.g. before re-reading a rewritten log.
+  void clear();
+
+  // What working this entity on this band and mode would add. Unknown
+  // entities (0) are never needed, nor is anything before the first QSO
+  // is recorded; an unknown band or mode only checks the coarser slots.
+  SpotNeed need(int dxcc, int band, SpotMode mode) const;
+
+  bool worked(int dxcc) const;
+  int entityCount() const;
+  uint64_t qsoCount() const { return qsos_.load(std::memory_order_relaxed); }
+
+private:
+  static constexpr int kNumBandSlots = 12; // kBands in LiveSpotData.h
+  static constexpr int kBitsPerBand = 4;
+  static constexpr int kAnyModeBit = 3;
+  static constexpr uint64_t kEntityBit = uint64_t{1} << 63;
+  static_assert(kNumBandSlots * kBitsPerBand < 63);
+
+  std::array<std::atomic<uint64_t>, kMaxDxcc> words_{};
+  std::atomic<uint64_t> qsos_{0};
+};
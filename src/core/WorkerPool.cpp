@@ -0,0 +1,235 @@
+#include "WorkerPool.h"
+#include "Logger.h"
+#include "Tracer.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+constexpr WorkerPool::Queue kCpuQueues[] = {WorkerPool::Queue::Parse,
+                                            WorkerPool::Queue::Decode,
+                                            WorkerPool::Queue::Compute};
+
+// Tracer keeps the name pointer, so these must be string literals.
+const char *depthCounterName(WorkerPool::Queue q) {
+  switch (q) {
+  case WorkerPool::Queue::Parse:
+    return "parse_depth";
+  case WorkerPool::Queue::Decode:
+    return "decode_depth";
+  case WorkerPool::Queue::IO:
+    return "io_depth";
+  case WorkerPool::Queue::Compute:
+    return "compute_depth";
+  case WorkerPool::Queue::Resolve:
+    return "resolve_depth";
+  default:
+    return "depth";
+  }
+}
+
+bool isCpuQueue(WorkerPool::Queue q) {
+  return std::find(std::begin(kCpuQueues), std::end(kCpuQueues), q) !=
+         std::end(kCpuQueues);
+}
+
+uint64_t elapsedUs(std::chrono::steady_clock::time_point since) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - since)
+      .count();
+}
+
+} // namespace
+
+WorkerPool::WorkerPool() {
+  unsigned hw = std::thread::hardware_concurrency();
+  // Leave one core for the render loop, but always have at least two CPU
+  // workers so one long parse cannot hold up everything else.
+  size_t cpuWorkers = std::max(2u, hw > 1 ? hw - 1 : 1u);
+
+  for (size_t i = 0; i < cpuWorkers; ++i) {
+    Queue home = kCpuQueues[i % std::size(kCpuQueues)];
+    queues_[static_cast<size_t>(home)].workers++;
+    workers_.emplace_back(&WorkerPool::workerLoop, this, home,
+                          std::string("worker ") + queueName(home) + " " +
+                              std::to_string(i));
+  }
+  for (size_t i = 0; i < kIoWorkers; ++i) {
+    queues_[static_cast<size_t>(Queue::IO)].workers++;
+    workers_.emplace_back(&WorkerPool::workerLoop, this, Queue::IO,
+                          "worker io " + std::to_string(i));
+  }
+  for (size_t i = 0; i < kResolveWorkers; ++i) {
+    queues_[static_cast<size_t>(Queue::Resolve)].workers++;
+    workers_.emplace_back(&WorkerPool::workerLoop, this, Queue::Resolve,
+                          "worker resolve " + std::to_string(i));
+  }
+  LOG_I("WorkerPool", "Started {} CPU, {} IO and {} resolve workers",
+        cpuWorkers, kIoWorkers, kResolveWorkers);
+}
+
+bool WorkerPool::submit(Queue queue, Task task, Priority priority,
+                        CancelToken token) {
+  if (queue >= Queue::Count || !task)
+    return false;
+  size_t depth;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_)
+      return false;
+    auto &q = queues_[static_cast<size_t>(queue)];
+    q.tasks[static_cast<size_t>(priority)].push_back(
+        {std::move(task), std::move(token), std::chrono::steady_clock::now()});
+    depth = ++q.depth;
+    q.submitted++;
+  }
+  TRACE_COUNTER("pool", depthCounterName(queue), depth);
+  cvFor(queue).notify_one();
+  return true;
+}
+
+std::condition_variable &WorkerPool::cvFor(Queue queue) {
+  if (queue == Queue::IO)
+    return ioCv_;
+  if (queue == Queue::Resolve)
+    return resolveCv_;
+  return cpuCv_;
+}
+
+bool WorkerPool::takeLocked(Queue home, Entry &out, Queue &from) {
+  auto tryQueue = [&](Queue q, size_t prio) {
+    auto &state = queues_[static_cast<size_t>(q)];
+    auto &dq = state.tasks[prio];
+    if (dq.empty())
+      return false;
+    out = std::move(dq.front());
+    dq.pop_front();
+    state.depth--;
+    from = q;
+    return true;
+  };
+
+  for (size_t prio = 0; prio < static_cast<size_t>(Priority::Count); ++prio) {
+    if (tryQueue(home, prio))
+      return true;
+    if (!isCpuQueue(home))
+      continue;
+    // Steal from the other CPU queues before settling for lower priority
+    // work at home.
+    for (Queue q : kCpuQueues) {
+      if (q != home && tryQueue(q, prio))
+        return true;
+    }
+  }
+  return false;
+}
+
+void WorkerPool::workerLoop(Queue home, std::string threadName) {
+  if (Tracer::enabled())
+    Tracer::instance().setThreadName(threadName);
+  auto &cv = cvFor(home);
+
+  for (;;) {
+    Entry entry;
+    Queue from = home;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv.wait(lock,
+              [&] { return stopping_ || takeLocked(home, entry, from); });
+      if (!entry.fn)
+        return; // stopping
+
+      auto &q = queues_[static_cast<size_t>(from)];
+      if (entry.token.cancelled()) {
+        q.cancelled++;
+        continue;
+      }
+      uint64_t waitUs = elapsedUs(entry.enqueued);
+      q.started++;
+      q.waitUsTotal += waitUs;
+      q.maxWaitUs = std::max(q.maxWaitUs, waitUs);
+      q.running.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    auto &q = queues_[static_cast<size_t>(from)];
+    auto started = std::chrono::steady_clock::now();
+    try {
+      entry.fn();
+    } catch (const std::exception &e) {
+      LOG_E("WorkerPool", "Task on {} queue threw: {}", queueName(from),
+            e.what());
+    } catch (...) {
+      LOG_E("WorkerPool", "Task on {} queue threw", queueName(from));
+    }
+    q.runUsTotal.fetch_add(elapsedUs(started), std::memory_order_relaxed);
+    q.completed.fetch_add(1, std::memory_order_relaxed);
+    q.running.fetch_sub(1, std::memory_order_relaxed);
+  }
+}
+
+void WorkerPool::shutdown() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stopping_)
+      return;
+    stopping_ = true;
+    for (auto &q : queues_) {
+      for (auto &dq : q.tasks) {
+        q.cancelled += dq.size();
+        dq.clear();
+      }
+      q.depth = 0;
+    }
+  }
+  cpuCv_.notify_all();
+  ioCv_.notify_all();
+  resolveCv_.notify_all();
+  for (auto &t : workers_) {
+    if (t.joinable())
+      t.join();
+  }
+  workers_.clear();
+}
+
+std::vector<WorkerPool::QueueStats> WorkerPool::stats() const {
+  std::vector<QueueStats> out;
+  out.reserve(kNumQueues);
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t i = 0; i < kNumQueues; ++i) {
+    const auto &q = queues_[i];
+    QueueStats s;
+    s.name = queueName(static_cast<Queue>(i));
+    s.workers = q.workers;
+    s.depth = q.depth;
+    s.running = q.running.load(std::memory_order_relaxed);
+    s.submitted = q.submitted;
+    s.completed = q.completed.load(std::memory_order_relaxed);
+    s.cancelled = q.cancelled;
+    if (q.started > 0)
+      s.avgWaitMs = q.waitUsTotal / 1000.0 / q.started;
+    s.maxWaitMs = q.maxWaitUs / 1000.0;
+    if (s.completed > 0)
+      s.avgRunMs =
+          q.runUsTotal.load(std::memory_order_relaxed) / 1000.0 / s.completed;
+    out.push_back(s);
+  }
+  return out;
+}
+
+const char *WorkerPool::queueName(Queue queue) {
+  switch (queue) {
+  case Queue::Parse:
+    return "parse";
+  case Queue::Decode:
+    return "decode";
+  case Queue::IO:
+    return "io";
+  case Queue::Compute:
+    return "compute";
+  case Queue::Resolve:
+    return "resolve";
+  default:
+    return "none";
+  }
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Cooperative cancellation shared between whoever submits work and the
+// tasks themselves. A default-constructed token can never be cancelled and
+// costs nothing; call create() for one that can.
+class CancelToken {
+public:
+  CancelToken() = default;
+  static CancelToken create() {
+    CancelToken t;
+    t.flag_ = std::make_shared<std::atomic<bool>>(false);
+    return t;
+  }
+
+  void cancel() const {
+    if (flag_)
+      flag_->store(true, std::memory_order_relaxed);
+  }
+  bool cancelled() const {
+    return flag_ && flag_->load(std::memory_order_relaxed);
+  }
+
+private:
+  std::shared_ptr<std::atomic<bool>> flag_;
+};
+
+// Process-wide pool for background work.
+//
+// Work is submitted to a named queue. CPU-bound queues (Parse, Decode,
+// Compute) share a fixed set of workers sized from the core count: each
+// worker has a home queue but steals from the other CPU queues when its own
+// is empty. IO has its own small set of workers because its tasks block on
+// the network and must not starve parsing. Resolve has two more for short
+// blocking jobs (DNS lookups, archive maintenance), so a burst of HTTP
+// fetches holding every IO worker cannot stall a cluster connect. Within a
+// queue, higher-priority tasks run first.
+//
+// Tasks whose token is cancelled before they start are dropped. shutdown()
+// drops everything still queued and joins the workers after their current
+// task; submit() fails afterwards.
+class WorkerPool {
+public:
+  enum class Queue : uint8_t { Parse, Decode, IO, Compute, Resolve, Count };
+  enum class Priority : uint8_t { High, Normal, Low, Count };
+  static constexpr size_t kNumQueues = static_cast<size_t>(Queue::Count);
+  static constexpr size_t kIoWorkers = 6;
+  static constexpr size_t kResolveWorkers = 2;
+
+  using Task = std::function<void()>;
+
+  struct QueueStats {
+    const char *name = "";
+    size_t workers = 0; // home workers; CPU queues also get stolen cycles
+    size_t depth = 0;
+    size_t running = 0;
+    uint64_t submitted = 0;
+    uint64_t completed = 0;
+    uint64_t cancelled = 0;
+    double avgWaitMs = 0; // enqueue -> start
+    double maxWaitMs = 0;
+    double avgRunMs = 0;
+  };
+
+  static WorkerPool &instance() {
+    static WorkerPool pool;
+    return pool;
+  }
+
+  // Any thread. Returns false once the pool is shutting down.
+  bool submit(Queue queue, Task task, Priority priority = Priority::Normal,
+              CancelToken token = {});
+
+  void shutdown();
+
+  std::vector<QueueStats> stats() const;
+  static const char *queueName(Queue queue);
+
+private:
+  WorkerPool();
+  ~WorkerPool() { shutdown(); }
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+
+  struct Entry {
+    Task fn;
+    CancelToken token;
+    std::chrono::steady_clock::time_point enqueued;
+  };
+
+  struct QueueState {
+    std::array<std::deque<Entry>, static_cast<size_t>(Priority::Count)> tasks;
+    size_t depth = 0;
+    size_t workers = 0;
+    uint64_t submitted = 0;
+    uint64_t started = 0;
+    uint64_t cancelled = 0;
+    uint64_t waitUsTotal = 0;
+    uint64_t maxWaitUs = 0;
+    // Updated after the task ran, without the pool lock.
+    std::atomic<size_t> running{0};
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> runUsTotal{0};
+  };
+
+  void workerLoop(Queue home, std::string threadName);
+  // Pops the best task for a worker whose home is 'home'. Caller holds mutex_.
+  bool takeLocked(Queue home, Entry &out, Queue &from);
+  std::condition_variable &cvFor(Queue queue);
+
+  mutable std::mutex mutex_;
+  std::condition_variable cpuCv_; // Parse, Decode, Compute workers
+  std::condition_variable ioCv_;
+  std::condition_variable resolveCv_;
+  bool stopping_ = false;
+  std::array<QueueState, kNumQueues> queues_;
+  std::vector<std::thread> workers_;
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "SnapshotStore.h"
+#include "Tracer.h"
+
+// What one WSJT-X / JTDX instance last said in a Status message.
+struct WsjtxInstance {
+  std::string id; // e.g. "WSJT-X", "WSJT-X - IC7300", "JTDX"
+  uint64_t dialHz = 0;
+  int band = -1; // index into kBands
+  std::string mode;
+  std::string dxCall; // the station being worked, if any
+  std::string dxGrid;
+  std::string deCall;
+  std::string deGrid;
+  bool txEnabled = false;
+  bool transmitting = false;
+  std::chrono::system_clock::time_point updated;
+};
+
+struct WsjtxData {
+  std::vector<WsjtxInstance> instances;
+  std::string activeId; // instance whose Status changed last
+  // ADIF records from Logged ADIF messages, oldest first, and how many
+  // were ever received, so a reader can tell which ones it has not seen.
+  std::vector<std::string> loggedAdif;
+  uint64_t loggedTotal = 0;
+
+  const WsjtxInstance *active() const {
+    for (const auto &inst : instances) {
+      if (inst.id == activeId)
+        return &inst;
+    }
+    return nullptr;
+  }
+};
+
+// Written by DXClusterProvider's UDP sources, read on the main thread.
+class WsjtxStore : public SnapshotStore<WsjtxData> {
+public:
+  static constexpr size_t kMaxLogged = 32;
+
+  WsjtxStore() : SnapshotStore(ChangeBus::Topic::Wsjtx) {}
+
+  void updateInstance(const WsjtxInstance &inst) {
+    TRACE_SCOPE("store", "WsjtxStore::updateInstance");
+    modify([&](WsjtxData &d) {
+      auto it = std::find_if(
+          d.instances.begin(), d.instances.end(),
+          [&](const WsjtxInstance &i) { return i.id == inst.id; });
+      if (it == d.instances.end())
+        d.instances.push_back(inst);
+      else
+        *it = inst;
+      d.activeId = inst.id;
+    });
+  }
+
+  // The instance sent Close.
+  void removeInstance(const std::string &id) {
+    modify([&](WsjtxData &d) {
+      std::erase_if(d.instances,
+                    [&](const WsjtxInstance &i) { return i.id == id; });
+      if (d.activeId == id)
+        d.activeId = d.instances.empty() ? "" : d.instances.back().id;
+    });
+  }
+
+  void addLogged(std::string adif) {
+    TRACE_SCOPE("store", "WsjtxStore::addLogged");
+    modify([&](WsjtxData &d) {
+      d.loggedAdif.push_back(std::move(adif));
+      if (d.loggedAdif.size() > kMaxLogged)
+        d.loggedAdif.erase(d.loggedAdif.begin());
+      d.loggedTotal++;
+    });
+  }
+};
@@ -1,6 +1,9 @@
 #include "core/AuroraHistoryStore.h"
+#include "core/BandActivityData.h"
+#include "core/ChangeBus.h"
 #include "core/CitiesManager.h"
 #include "core/ConfigManager.h"
+#include "core/ContestLogData.h"
 #include "core/DXClusterData.h"
 #include "core/DatabaseManager.h"
 #include "core/HamClockState.h"
@@ -9,16 +12,24 @@
 #include "core/RSSData.h"
 #include "core/SatelliteManager.h"
 #include "core/SolarData.h"
+#include "core/SpotArchive.h"
+#include "core/SpotEnricher.h"
+#include "core/SpotHistoryData.h"
+#include "core/Tracer.h"
 #ifdef ENABLE_DEBUG_API
 #include "core/UIRegistry.h"
 #endif
 #include "core/WidgetType.h"
+#include "core/WorkedMatrix.h"
+#include "core/WorkerPool.h"
+#include "core/WsjtxData.h"
 
 #include "network/NetworkManager.h"
 #include "network/WebServer.h"
 #include "services/ADIFProvider.h"
 #include "services/ActivityProvider.h"
 #include "services/AuroraProvider.h"
+#include "services/BandActivityProvider.h"
 #include "services/BandConditionsProvider.h"
 #include "services/CallbookProvider.h"
 #include "services/ContestProvider.h"
@@ -32,16 +43,19 @@
 #include "services/RSSProvider.h"
 #include "services/SDOProvider.h"
 #include "services/SantaProvider.h"
+#include "services/SpotHistoryProvider.h"
 #include "services/WeatherProvider.h"
 #include "ui/ADIFPanel.h"
 #include "ui/ActivityPanels.h"
 #include "ui/AuroraGraphPanel.h"
 #include "ui/AuroraPanel.h"
+#include "ui/BandActivityPanel.h"
 #include "ui/BandConditionsPanel.h"
 #include "ui/BeaconPanel.h"
 #include "ui/CallbookPanel.h"
 #include "ui/ClockAuxPanel.h"
 #include "ui/ContestPanel.h"
+#include "ui/ContestRatePanel.h"
 #include "ui/CountdownPanel.h"
 #include "ui/DRAPPanel.h"
 #include "ui/DXClusterPanel.h"
@@ -65,8 +79,10 @@
 #include "ui/RSSBanner.h"
 #include "ui/SDOPanel.h"
 #include "ui/SantaPanel.h"
+#include "ui/ServiceHealthPanel.h"
 #include "ui/SetupScreen.h"
 #include "ui/SpaceWeatherPanel.h"
+#include "ui/SpotHistoryPanel.h"
 #include "ui/TextureManager.h"
 #include "ui/TimePanel.h"
 #include "ui/WatchlistPanel.h"
@@ -81,6 +97,7 @@
 #include <curl/curl.h>
 #include <nlohmann/json.hpp>
 
+#include <chrono>
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
@@ -119,23 +136,41 @@ int main(int argc, char *argv[]) {
 
   bool forceFullscreen = false;
   bool forceSoftware = false;
+  int traceSeconds = 0;
   for (int i = 1; i < argc; ++i) {
     std::string arg = argv[i];
     if (arg == "-f" || arg == "--fullscreen") {
       forceFullscreen = true;
     } else if (arg == "-s" || arg == "--software") {
       forceSoftware = true;
+    } else if (arg == "--trace" && i + 1 < argc) {
+      traceSeconds = std::atoi(argv[++i]);
     } else if (arg == "-h" || arg == "--help") {
       std::printf("Usage: hamclock-next [options]\n");
       std::printf("Options:\n");
       std::printf("  -f, --fullscreen  Force fullscreen mode\n");
       std::printf(
           "  -s, --software    Force software rendering (no OpenGL/MSAA)\n");
+      std::printf("  --trace N         Record a performance trace for N seconds "
+                  "to trace.json\n");
       std::printf("  -h, --help        Show this help message\n");
       return EXIT_SUCCESS;
     }
   }
 
+  Tracer::instance().setThreadName("main");
+  auto traceDeadline = std::chrono::steady_clock::time_point::max();
+  if (traceSeconds > 0 && Tracer::instance().start())
+    traceDeadline =
+        std::chrono::steady_clock::now() + std::chrono::seconds(traceSeconds);
+  auto pollTraceDeadline = [&]() {
+    if (std::chrono::steady_clock::now() < traceDeadline)
+      return;
+    traceDeadline = std::chrono::steady_clock::time_point::max();
+    Tracer::instance().stop();
+    Tracer::instance().writeJson(cfgMgr.configDir() / "trace.json");
+  };
+
   AppConfig appCfg;
   enum class SetupMode { None, Main, DXCluster };
   SetupMode activeSetup = SetupMode::None;
@@ -422,7 +457,11 @@ int main(int argc, char *argv[]) {
   auto spotStore = std::make_shared<LiveSpotDataStore>();
   spotStore->setSelectedBandsMask(appCfg.pskBands);
   auto activityStore = std::make_shared<ActivityDataStore>();
-  auto dxcStore = std::make_shared<DXClusterDataStore>();
+  auto spotArchive = std::make_shared<SpotArchive>();
+  auto dxcStore = std::make_shared<DXClusterDataStore>(spotArchive);
+  auto spotHistoryStore = std::make_shared<SpotHistoryStore>();
+  auto bandActivity = std::make_shared<BandActivityMatrix>(std::time(nullptr));
+  auto bandActivityStore = std::make_shared<BandActivityStore>();
   auto bandStore = std::make_shared<BandConditionsStore>();
   auto contestStore = std::make_shared<ContestStore>();
   auto moonStore = std::make_shared<MoonStore>();
@@ -432,6 +471,9 @@ int main(int argc, char *argv[]) {
   auto callbookStore = std::make_shared<CallbookStore>();
   auto dstStore = std::make_shared<DstStore>();
   auto adifStore = std::make_shared<ADIFStore>();
+  auto workedMatrix = std::make_shared<WorkedMatrix>();
+  auto wsjtxStore = std::make_shared<WsjtxStore>();
+  auto contestLogStore = std::make_shared<ContestLogStore>();
   auto santaStore = std::make_shared<SantaStore>();
   auto state = std::make_shared<HamClockState>();
 
@@ -443,7 +485,7 @@ int main(int argc, char *argv[]) {
 
   // --- Web Server (Persistent) ---
   WebServer webServer(renderer, appCfg, *state, cfgMgr, watchlistStore,
-                      solarStore, 8080);
+                      solarStore, spotArchive, 8080);
   webServer.start();
 
   bool appRunning = true;
@@ -546,6 +588,7 @@ int main(int argc, char *argv[]) {
 
         setupWidget->update();
         renderSetup();
+        pollTraceDeadline();
         SDL_Delay(FRAME_DELAY_MS);
       }
 
@@ -610,14 +653,21 @@ int main(int argc, char *argv[]) {
 
       // --- Data providers ---
       auto auroraHistoryStore = std::make_shared<AuroraHistoryStore>();
-      NOAAProvider noaaProvider(netManager, solarStore, auroraHistoryStore,
-                                state.get());
+      NOAAProvider noaaProvider(netManager, solarStore, auroraHistoryStore);
       noaaProvider.fetch();
 
       RSSProvider rssProvider(netManager, rssStore);
       rssProvider.fetch();
 
-      LiveSpotProvider spotProvider(netManager, spotStore, appCfg, state.get());
+      // The log goes first so spots are flagged against it from the start.
+      ADIFProvider adifProvider(adifStore, workedMatrix, &prefixMgr);
+      adifProvider.fetch(cfgMgr.configDir() / "logs.adif");
+      auto spotEnricher = std::make_shared<const SpotEnricher>(
+          prefixMgr, appCfg.lat, appCfg.lon, workedMatrix);
+      dxcStore->refreshNeed(*spotEnricher);
+
+      LiveSpotProvider spotProvider(netManager, spotStore, appCfg, spotEnricher,
+                                    bandActivity);
       spotProvider.fetch();
 
       SatelliteManager satMgr(netManager);
@@ -626,13 +676,77 @@ int main(int argc, char *argv[]) {
       ActivityProvider activityProvider(netManager, activityStore);
       activityProvider.fetch();
 
-      DXClusterProvider dxcProvider(dxcStore, prefixMgr, watchlistStore,
-                                    watchlistHitStore, state.get());
+      DXClusterProvider dxcProvider(dxcStore, spotEnricher, watchlistStore,
+                                    watchlistHitStore, bandActivity,
+                                    wsjtxStore, contestLogStore);
       dxcProvider.start(appCfg);
 
+      // WSJT-X / JTDX: the station being worked becomes DX, a band change
+      // selects that band on the live spot map, and logged QSOs count as
+      // worked right away instead of once they reach the log file.
+      uint64_t wsjtxLoggedSeen = wsjtxStore->snapshot()->loggedTotal;
+      std::string wsjtxDx;
+      int wsjtxBand = -1;
+      auto wsjtxSub = ChangeBus::instance().subscribe(
+          ChangeBus::Topic::Wsjtx, [&](ChangeBus::Topic, uint64_t) {
+            auto wsjtx = wsjtxStore->snapshot();
+            const auto &logged = wsjtx->loggedAdif;
+            size_t fresh = static_cast<size_t>(std::min<uint64_t>(
+                wsjtx->loggedTotal - wsjtxLoggedSeen, logged.size()));
+            int qsos = 0;
+            for (size_t i = logged.size() - fresh; i < logged.size(); ++i)
+              qsos += adifProvider.addLogged(logged[i]);
+            wsjtxLoggedSeen = wsjtx->loggedTotal;
+            if (qsos > 0)
+              dxcStore->refreshNeed(*spotEnricher);
+
+            const WsjtxInstance *active = wsjtx->active();
+            if (!active)
+              return;
+            std::string dx = active->dxCall + " " + active->dxGrid;
+            if (dx != wsjtxDx) {
+              wsjtxDx = dx;
+              SpotStation st =
+                  spotEnricher->locate(active->dxCall, active->dxGrid);
+              if (!active->dxCall.empty() &&
+                  st.from != SpotStation::From::None) {
+                state->dxLocation = {st.lat, st.lon};
+                state->dxGrid = Astronomy::latLonToGrid(st.lat, st.lon);
+                state->dxActive = true;
+              }
+            }
+            if (active->band != wsjtxBand) {
+              wsjtxBand = active->band;
+              if (wsjtxBand >= 0)
+                spotStore->setSelectedBandsMask(1u << wsjtxBand);
+            }
+          });
+
+      // N1MM Logger+: QSOs from every station of the network count as
+      // worked as soon as they are logged.
+      uint64_t contestLoggedSeen = contestLogStore->snapshot()->loggedTotal;
+      auto contestLogSub = ChangeBus::instance().subscribe(
+          ChangeBus::Topic::ContestLog, [&](ChangeBus::Topic, uint64_t) {
+            auto log = contestLogStore->snapshot();
+            const auto &logged = log->logged;
+            size_t fresh = static_cast<size_t>(std::min<uint64_t>(
+                log->loggedTotal - contestLoggedSeen, logged.size()));
+            for (size_t i = logged.size() - fresh; i < logged.size(); ++i) {
+              const ContestQso &q = logged[i];
+              adifProvider.addWorked(q.call, q.freqKhz, q.mode);
+            }
+            contestLoggedSeen = log->loggedTotal;
+            if (fresh > 0)
+              dxcStore->refreshNeed(*spotEnricher);
+          });
+
       BandConditionsProvider bandProvider(solarStore, bandStore);
       bandProvider.update();
 
+      BandActivityProvider bandActivityProvider(
+          bandActivity, bandActivityStore, watchlistHitStore, appCfg);
+      bandActivityProvider.update();
+
       ContestProvider contestProvider(netManager, contestStore);
       contestProvider.fetch();
 
@@ -661,12 +775,18 @@ int main(int argc, char *argv[]) {
       DstProvider dstProvider(netManager, dstStore);
       dstProvider.fetch();
 
-      ADIFProvider adifProvider(adifStore);
-      adifProvider.fetch(cfgMgr.configDir() / "logs.adif");
-
       SantaProvider santaProvider(santaStore);
       santaProvider.update();
 
+      SpotHistoryProvider spotHistoryProvider(spotArchive, spotHistoryStore);
+      auto maintainArchive = [spotArchive] {
+        WorkerPool::instance().submit(
+            WorkerPool::Queue::Resolve,
+            [spotArchive] { spotArchive->maintain(); },
+            WorkerPool::Priority::Low);
+      };
+      maintainArchive();
+
       // --- Top Bar widgets ---
       SDL_Color cyan = {0, 200, 255, 255};
 
@@ -689,10 +809,13 @@ int main(int argc, char *argv[]) {
           widgetPool[type] = std::make_unique<SpaceWeatherPanel>(
               0, 0, 0, 0, fontMgr, solarStore);
           break;
-        case WidgetType::DX_CLUSTER:
-          widgetPool[type] =
+        case WidgetType::DX_CLUSTER: {
+          auto panel =
               std::make_unique<DXClusterPanel>(0, 0, 0, 0, fontMgr, dxcStore);
+          panel->setFilter(appCfg.spotFilterCluster);
+          widgetPool[type] = std::move(panel);
           break;
+        }
         case WidgetType::LIVE_SPOTS:
           widgetPool[type] = std::make_unique<LiveSpotPanel>(
               0, 0, 0, 0, fontMgr, spotProvider, spotStore, appCfg, cfgMgr);
@@ -725,6 +848,23 @@ int main(int argc, char *argv[]) {
           widgetPool[type] =
               std::make_unique<SantaPanel>(0, 0, 0, 0, fontMgr, santaStore);
           break;
+        case WidgetType::SERVICE_HEALTH:
+          widgetPool[type] =
+              std::make_unique<ServiceHealthPanel>(0, 0, 0, 0, fontMgr);
+          break;
+        case WidgetType::SPOT_HISTORY:
+          widgetPool[type] = std::make_unique<SpotHistoryPanel>(
+              0, 0, 0, 0, fontMgr, spotHistoryProvider, spotHistoryStore,
+              dxcStore, appCfg);
+          break;
+        case WidgetType::BAND_ACTIVITY:
+          widgetPool[type] = std::make_unique<BandActivityPanel>(
+              0, 0, 0, 0, fontMgr, bandActivityStore, appCfg);
+          break;
+        case WidgetType::CONTEST_RATE:
+          widgetPool[type] = std::make_unique<ContestRatePanel>(
+              0, 0, 0, 0, fontMgr, contestLogStore);
+          break;
         case WidgetType::ON_THE_AIR:
           widgetPool[type] = std::make_unique<ONTAPanel>(
               0, 0, 0, 0, fontMgr, activityProvider, activityStore);
@@ -800,17 +940,19 @@ int main(int argc, char *argv[]) {
 
       // Populate pool with all types
       std::vector<WidgetType> allTypes = {
-          WidgetType::SOLAR,        WidgetType::DX_CLUSTER,
-          WidgetType::LIVE_SPOTS,   WidgetType::BAND_CONDITIONS,
-          WidgetType::CONTESTS,     WidgetType::ON_THE_AIR,
-          WidgetType::GIMBAL,       WidgetType::MOON,
-          WidgetType::CLOCK_AUX,    WidgetType::DX_PEDITIONS,
-          WidgetType::DE_WEATHER,   WidgetType::DX_WEATHER,
-          WidgetType::NCDXF,        WidgetType::SDO,
-          WidgetType::HISTORY_FLUX, WidgetType::HISTORY_KP,
-          WidgetType::HISTORY_SSN,  WidgetType::DRAP,
-          WidgetType::AURORA,       WidgetType::AURORA_GRAPH,
-          WidgetType::ADIF,         WidgetType::COUNTDOWN};
+          WidgetType::SOLAR,          WidgetType::DX_CLUSTER,
+          WidgetType::LIVE_SPOTS,     WidgetType::BAND_CONDITIONS,
+          WidgetType::CONTESTS,       WidgetType::ON_THE_AIR,
+          WidgetType::GIMBAL,         WidgetType::MOON,
+          WidgetType::CLOCK_AUX,      WidgetType::DX_PEDITIONS,
+          WidgetType::DE_WEATHER,     WidgetType::DX_WEATHER,
+          WidgetType::NCDXF,          WidgetType::SDO,
+          WidgetType::HISTORY_FLUX,   WidgetType::HISTORY_KP,
+          WidgetType::HISTORY_SSN,    WidgetType::DRAP,
+          WidgetType::AURORA,         WidgetType::AURORA_GRAPH,
+          WidgetType::ADIF,           WidgetType::COUNTDOWN,
+          WidgetType::SERVICE_HEALTH, WidgetType::SPOT_HISTORY,
+          WidgetType::BAND_ACTIVITY,  WidgetType::CONTEST_RATE};
       for (auto t : allTypes)
         addToPool(t);
 
@@ -971,6 +1113,7 @@ int main(int argc, char *argv[]) {
       // Helper: force an immediate frame (used after resize/expose to
       // prevent blank areas while the user is still dragging).
       auto renderFrame = [&]() {
+        TRACE_SCOPE("frame", "render");
         SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
         SDL_RenderClear(renderer);
 
@@ -1012,7 +1155,10 @@ int main(int argc, char *argv[]) {
                              r.x + 2, r.y + 2, {255, 128, 0, 255}, 10);
           }
         }
-        SDL_RenderPresent(renderer);
+        {
+          TRACE_SCOPE("frame", "present");
+          SDL_RenderPresent(renderer);
+        }
 
         if (FIDELITY_MODE) {
           SDL_RenderSetScale(renderer, 1.0f, 1.0f);
@@ -1021,11 +1167,15 @@ int main(int argc, char *argv[]) {
 
       // --- Dashboard Loop ---
       Uint32 lastFetchMs = SDL_GetTicks();
+      Uint32 lastAdifPollMs = SDL_GetTicks();
+      Uint32 lastActivityMs = SDL_GetTicks();
       Uint32 lastResizeMs = 0; // debounce timer for font re-rasterization
       bool running = true;
       Uint32 lastFpsUpdate = SDL_GetTicks();
+      std::time_t lastFrameSec = 0;
       int frames = 0;
       while (running) {
+        TRACE_BEGIN("frame", "frame");
         Uint32 now = SDL_GetTicks();
 
         // Background refresh every 15 minutes
@@ -1043,10 +1193,23 @@ int main(int argc, char *argv[]) {
           historyProvider.fetchFlux();
           historyProvider.fetchSSN();
           historyProvider.fetchKp();
-          adifProvider.fetch(cfgMgr.configDir() / "logs.adif");
+          maintainArchive();
           lastFetchMs = now;
         }
 
+        // The log only costs a stat() while nothing is appended, so new
+        // QSOs show up on the spots within seconds.
+        if (now - lastAdifPollMs > 5 * 1000) {
+          if (adifProvider.fetch(cfgMgr.configDir() / "logs.adif"))
+            dxcStore->refreshNeed(*spotEnricher);
+          lastAdifPollMs = now;
+        }
+
+        if (now - lastActivityMs > 30 * 1000) {
+          bandActivityProvider.update();
+          lastActivityMs = now;
+        }
+
         // Ensure layout metrics are always up to date with actual window state
         // This fixes issues where Resize events might report stale or
         // intermediate sizes, or where the renderer output size lags behind the
@@ -1056,8 +1219,13 @@ int main(int argc, char *argv[]) {
         static Uint32 lastMouseMotionMs = SDL_GetTicks();
         static bool cursorVisible = true;
 
+        TRACE_BEGIN("frame", "events");
+        // Anything that can change the picture: input, store updates or the
+        // clock ticking over to the next second.
+        bool frameDirty = false;
         SDL_Event event;
         while (SDL_PollEvent(&event)) {
+          frameDirty = true;
           // Any mouse activity resets the timer
           if (event.type == SDL_MOUSEMOTION ||
               event.type == SDL_MOUSEBUTTONDOWN ||
@@ -1286,12 +1454,27 @@ int main(int argc, char *argv[]) {
           cursorVisible = false;
         }
 
-        for (auto *w : widgets)
-          w->update();
+        TRACE_END("frame", "events");
+
+        // Deliver coalesced store changes before widgets look at their data
+        if (ChangeBus::instance().dispatch())
+          frameDirty = true;
+        std::time_t nowSec = std::time(nullptr);
+        if (nowSec != lastFrameSec) {
+          lastFrameSec = nowSec;
+          frameDirty = true;
+        }
+
+        {
+          TRACE_SCOPE("frame", "update");
+          for (auto *w : widgets)
+            w->update();
+        }
 
 #ifdef ENABLE_DEBUG_API
         // Update Semantic Debug Registry
         {
+          TRACE_SCOPE("frame", "ui registry");
           auto &reg = UIRegistry::getInstance();
           reg.setScale(layScale, layLogicalOffX, layLogicalOffY);
 
@@ -1311,22 +1494,27 @@ int main(int argc, char *argv[]) {
 #endif
 
         renderFrame();
-        webServer.updateFrame();
+        webServer.updateFrame(frameDirty);
 
         // Update FPS telemetry
         frames++;
         Uint32 nowMs = SDL_GetTicks();
         if (nowMs - lastFpsUpdate >= 1000) {
           state->fps = frames * 1000.0f / (nowMs - lastFpsUpdate);
+          TRACE_COUNTER("frame", "fps", state->fps);
           frames = 0;
           lastFpsUpdate = nowMs;
         }
+        TRACE_END("frame", "frame");
 
+        pollTraceDeadline();
         SDL_Delay(FRAME_DELAY_MS);
       }
     } // widgets/managers destroyed here
   }
 
+  // Join background work while the network manager and stores still exist.
+  WorkerPool::instance().shutdown();
   curl_global_cleanup();
   TTF_Quit();
   SDL_DestroyRenderer(renderer);
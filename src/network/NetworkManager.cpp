@@ -1,9 +1,12 @@
 #include "NetworkManager.h"
 #include "../core/Logger.h"
+#include "../core/ServiceHealth.h"
+#include "../core/Tracer.h"
+#include "../core/WorkerPool.h"
 
 #include <curl/curl.h>
 
-#include <thread>
+#include <chrono>
 
 #include <filesystem>
 #include <fstream>
@@ -12,6 +15,46 @@
 #include <sstream>
 #include <unordered_map> // For header parsing
 
+// "https://host:port/path" -> "host:port"; used to key per-host health.
+static std::string hostOf(const std::string &url) {
+  size_t start = url.find("://");
+  start = (start == std::string::npos) ? 0 : start + 3;
+  size_t end = url.find('/', start);
+  return url.substr(start, end == std::string::npos ? std::string::npos
+                                                    : end - start);
+}
+
+// Runs the caller's callback on the parse queue so the IO worker is free
+// for the next request while the body is being parsed. The callback runs
+// under the state's mutex and is skipped once the handle was cancelled.
+static void deliver(const std::shared_ptr<FetchState> &state,
+                    const std::function<void(std::string)> &callback,
+                    std::string body) {
+  if (state->cancelled.load(std::memory_order_relaxed)) {
+    state->done.store(true, std::memory_order_release);
+    return;
+  }
+  bool queued = WorkerPool::instance().submit(
+      WorkerPool::Queue::Parse,
+      [state, callback, body = std::move(body)]() mutable {
+        std::lock_guard<std::recursive_mutex> lock(state->callbackMutex);
+        if (!state->cancelled.load(std::memory_order_relaxed)) {
+          TRACE_SCOPE("net", "callback");
+          callback(std::move(body));
+        }
+        state->done.store(true, std::memory_order_release);
+      });
+  if (!queued)
+    state->done.store(true, std::memory_order_release);
+}
+
+// Aborts the transfer as soon as the owning FetchHandle is cancelled.
+static int xferInfoCallback(void *userdata, curl_off_t, curl_off_t,
+                            curl_off_t, curl_off_t) {
+  auto *state = static_cast<FetchState *>(userdata);
+  return state->cancelled.load(std::memory_order_relaxed) ? 1 : 0;
+}
+
 static size_t writeCallback(char *ptr, size_t size, size_t nmemb,
                             void *userdata) {
   auto *response = static_cast<std::string *>(userdata);
@@ -47,9 +90,12 @@ static size_t headerCallback(char *ptr, size_t size, size_t nmemb,
 }
 
 // Basic in-memory cache to prevent accidental tight-loop fetches
-void NetworkManager::fetchAsync(const std::string &url,
-                                std::function<void(std::string)> callback,
-                                int cacheAgeSeconds, bool force) {
+FetchHandle
+NetworkManager::fetchAsync(const std::string &url,
+                           std::function<void(std::string)> callback,
+                           int cacheAgeSeconds, bool force) {
+  auto state = std::make_shared<FetchState>();
+
   // Check memory cache first
   CacheEntry cached;
   bool hasCache = false;
@@ -67,16 +113,32 @@ void NetworkManager::fetchAsync(const std::string &url,
     std::time_t now = std::time(nullptr);
     if (now - cached.timestamp < cacheAgeSeconds) {
       LOG_T("NetworkManager", "Memory cache hit for {}", url);
-      callback(cached.data);
-      return;
+      deliver(state, callback, cached.data);
+      return FetchHandle(state);
     }
   }
 
-  std::thread([this, url, callback = std::move(callback), hasCache, cached]() {
+  auto fetch = [this, state, url, callback = std::move(callback), hasCache,
+                cached]() {
+    if (state->cancelled.load(std::memory_order_relaxed)) {
+      state->done.store(true, std::memory_order_release);
+      return;
+    }
+    TRACE_SCOPE("net", "NetworkManager::fetch");
+    int inFlight = ++inFlight_;
+    TRACE_COUNTER("net", "fetches_in_flight", inFlight);
+    struct InFlightGuard {
+      std::atomic<int> &n;
+      ~InFlightGuard() {
+        int left = --n;
+        TRACE_COUNTER("net", "fetches_in_flight", left);
+      }
+    } inFlightGuard{inFlight_};
+
     CURL *curl = curl_easy_init();
     if (!curl) {
       LOG_E("NetworkManager", "curl_easy_init failed");
-      callback("");
+      deliver(state, callback, "");
       return;
     }
 
@@ -87,6 +149,9 @@ void NetworkManager::fetchAsync(const std::string &url,
     curl_easy_setopt(curl, CURLOPT_USERAGENT, "HamClock-Next/1.0");
     curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, headerCallback);
     curl_easy_setopt(curl, CURLOPT_HEADERDATA, &headers);
+    curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+    curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, xferInfoCallback);
+    curl_easy_setopt(curl, CURLOPT_XFERINFODATA, state.get());
 
 // On Linux with static mbedTLS, we often need to point CURL to the CA
 // bundle. However, for system libcurl (dynamic), this is usually automatic.
@@ -106,7 +171,11 @@ void NetworkManager::fetchAsync(const std::string &url,
     // If we have cache, do a HEAD request first to verify
     if (hasCache && !cached.lastModified.empty()) {
       curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
-      CURLcode res = curl_easy_perform(curl);
+      CURLcode res;
+      {
+        TRACE_SCOPE("net", "curl HEAD");
+        res = curl_easy_perform(curl);
+      }
       if (res == CURLE_OK) {
         long responseCode = 0;
         curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode);
@@ -121,7 +190,7 @@ void NetworkManager::fetchAsync(const std::string &url,
               saveToDisk(url, cache_[url]);
             }
             curl_easy_cleanup(curl);
-            callback(cached.data);
+            deliver(state, callback, cached.data);
             return;
           }
         }
@@ -135,27 +204,47 @@ void NetworkManager::fetchAsync(const std::string &url,
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
 
     LOG_D("NetworkManager", "Fetching from network: {}", url);
-    CURLcode res = curl_easy_perform(curl);
+    auto &health = ServiceHealthRegistry::instance().get("net:" + hostOf(url));
+    auto started = std::chrono::steady_clock::now();
+    CURLcode res;
+    {
+      TRACE_SCOPE("net", "curl GET");
+      res = curl_easy_perform(curl);
+    }
+    auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - started);
 
     long responseCode = 0;
     curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &responseCode);
     curl_easy_cleanup(curl);
 
+    if (res == CURLE_ABORTED_BY_CALLBACK) {
+      LOG_D("NetworkManager", "Fetch cancelled for {}", url);
+      state->done.store(true, std::memory_order_release);
+      return;
+    }
+
     if (res != CURLE_OK) {
       LOG_E("NetworkManager", "Fetch failed for {}: {}", url,
             curl_easy_strerror(res));
-      callback("");
+      health.markFailure(curl_easy_strerror(res));
+      deliver(state, callback, "");
       return;
     }
 
     if (responseCode != 200) {
       LOG_E("NetworkManager", "HTTP error {} for {}", responseCode, url);
-      callback("");
+      health.markFailure("HTTP " + std::to_string(responseCode));
+      deliver(state, callback, "");
       return;
     }
 
+    TRACE_COUNTER("net", "last_response_bytes", response.size());
+    health.markSuccess(latency);
+
     // Update cache on success
     {
+      TRACE_SCOPE("net", "cache store");
       std::lock_guard<std::mutex> lock(cacheMutex_);
       std::time_t now = std::time(nullptr);
       CacheEntry entry;
@@ -172,8 +261,14 @@ void NetworkManager::fetchAsync(const std::string &url,
       }
     }
 
-    callback(std::move(response));
-  }).detach();
+    deliver(state, callback, std::move(response));
+  };
+
+  if (!WorkerPool::instance().submit(WorkerPool::Queue::IO, std::move(fetch))) {
+    LOG_W("NetworkManager", "Shutting down, dropped fetch of {}", url);
+    state->done.store(true, std::memory_order_release);
+  }
+  return FetchHandle(state);
 }
 
 NetworkManager::NetworkManager(const std::filesystem::path &cacheDir)
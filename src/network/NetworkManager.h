@@ -1,11 +1,93 @@
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <ctime>
 #include <filesystem>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
+
+// State shared between a FetchHandle and the fetch it controls.
+struct FetchState {
+  std::atomic<bool> cancelled{false};
+  std::atomic<bool> done{false};
+  // Held while the callback runs, so cancel() can wait it out. Recursive
+  // because a callback may start a follow-up fetch and replace the handle
+  // that owns it.
+  std::recursive_mutex callbackMutex;
+};
+
+// Owns one fetchAsync() request. Destroying or cancelling the handle aborts
+// the transfer if it is still running and guarantees the callback will not
+// run afterwards; if the callback is already running, cancel() waits for it
+// to return. Keep handles as members of whatever the callback captures.
+class FetchHandle {
+public:
+  FetchHandle() = default;
+  explicit FetchHandle(std::shared_ptr<FetchState> state)
+      : state_(std::move(state)) {}
+  ~FetchHandle() { cancel(); }
+
+  FetchHandle(FetchHandle &&other) noexcept = default;
+  FetchHandle &operator=(FetchHandle &&other) noexcept {
+    if (this != &other) {
+      cancel();
+      state_ = std::move(other.state_);
+    }
+    return *this;
+  }
+  FetchHandle(const FetchHandle &) = delete;
+  FetchHandle &operator=(const FetchHandle &) = delete;
+
+  void cancel() {
+    if (!state_)
+      return;
+    std::lock_guard<std::recursive_mutex> lock(state_->callbackMutex);
+    state_->cancelled.store(true, std::memory_order_relaxed);
+    state_.reset();
+  }
+
+  // True once the callback has run (or the request was cancelled).
+  bool done() const {
+    return !state_ || state_->done.load(std::memory_order_acquire);
+  }
+
+private:
+  std::shared_ptr<FetchState> state_;
+};
+
+// Several concurrent fetches owned by one provider or widget. Finished
+// handles are dropped as new ones are added.
+class FetchGroup {
+public:
+  void add(FetchHandle handle) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    handles_.erase(
+        std::remove_if(handles_.begin(), handles_.end(),
+                       [](const FetchHandle &h) { return h.done(); }),
+        handles_.end());
+    handles_.push_back(std::move(handle));
+  }
+
+  void cancelAll() {
+    std::vector<FetchHandle> handles;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      handles.swap(handles_);
+    }
+    handles.clear(); // cancels, outside the lock
+  }
+
+  ~FetchGroup() { cancelAll(); }
+
+private:
+  std::mutex mutex_;
+  std::vector<FetchHandle> handles_;
+};
 
 class NetworkManager {
 public:
@@ -15,13 +97,15 @@ public:
   NetworkManager(const NetworkManager &) = delete;
   NetworkManager &operator=(const NetworkManager &) = delete;
 
-  // Fetches URL content asynchronously.
+  // Fetches URL content asynchronously on the WorkerPool IO queue; the
+  // callback runs on the parse queue, never on the calling thread. The
+  // request lives as long as the returned handle.
   // If 'force' is false, it may return a cached response if within
   // 'cacheAgeSeconds'. Default cache age is 60 minutes (3600 seconds) to avoid
   // rate limits.
-  void fetchAsync(const std::string &url,
-                  std::function<void(std::string)> callback,
-                  int cacheAgeSeconds = 3600, bool force = false);
+  [[nodiscard]] FetchHandle
+  fetchAsync(const std::string &url, std::function<void(std::string)> callback,
+             int cacheAgeSeconds = 3600, bool force = false);
 
 private:
   struct CacheEntry {
@@ -33,6 +117,7 @@ private:
   std::unordered_map<std::string, CacheEntry> cache_;
   std::mutex cacheMutex_;
   std::filesystem::path cacheDir_;
+  std::atomic<int> inFlight_{0};
 
   // Helper to compute safe filename for a URL (e.g. simple hash)
   std::string hashUrl(const std::string &url);
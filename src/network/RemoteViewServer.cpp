@@ -0,0 +1,624 @@
+#include "RemoteViewServer.h"
+#include "../core/Logger.h"
+#include "../core/Tracer.h"
+#include "../ui/stb_image_write.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#define close closesocket
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+
+constexpr int kMaxClients = 4;
+// A client with more than this queued gets its backlog dropped and is
+// resynchronised with a keyframe once it catches up.
+constexpr size_t kMaxBacklogBytes = 2 * 1024 * 1024;
+constexpr int kPngMaxColors = 32;
+constexpr int kJpegQuality = 75;
+
+// --- SHA-1 / base64, just enough for the WebSocket handshake ---
+
+uint32_t rol(uint32_t v, int bits) { return (v << bits) | (v >> (32 - bits)); }
+
+std::string sha1(const std::string &msg) {
+  uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476,
+                   0xC3D2E1F0};
+  std::string data = msg;
+  uint64_t bitLen = static_cast<uint64_t>(msg.size()) * 8;
+  data.push_back(static_cast<char>(0x80));
+  while (data.size() % 64 != 56)
+    data.push_back('\0');
+  for (int i = 7; i >= 0; --i)
+    data.push_back(static_cast<char>((bitLen >> (i * 8)) & 0xFF));
+
+  for (size_t chunk = 0; chunk < data.size(); chunk += 64) {
+    uint32_t w[80];
+    for (int i = 0; i < 16; ++i) {
+      const auto *p =
+          reinterpret_cast<const unsigned char *>(data.data() + chunk + i * 4);
+      w[i] = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) |
+             (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+    }
+    for (int i = 16; i < 80; ++i)
+      w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+    for (int i = 0; i < 80; ++i) {
+      uint32_t f, k;
+      if (i < 20) {
+        f = (b & c) | (~b & d);
+        k = 0x5A827999;
+      } else if (i < 40) {
+        f = b ^ c ^ d;
+        k = 0x6ED9EBA1;
+      } else if (i < 60) {
+        f = (b & c) | (b & d) | (c & d);
+        k = 0x8F1BBCDC;
+      } else {
+        f = b ^ c ^ d;
+        k = 0xCA62C1D6;
+      }
+      uint32_t t = rol(a, 5) + f + e + k + w[i];
+      e = d;
+      d = c;
+      c = rol(b, 30);
+      b = a;
+      a = t;
+    }
+    h[0] += a;
+    h[1] += b;
+    h[2] += c;
+    h[3] += d;
+    h[4] += e;
+  }
+
+  std::string out;
+  for (uint32_t v : h)
+    for (int i = 3; i >= 0; --i)
+      out.push_back(static_cast<char>((v >> (i * 8)) & 0xFF));
+  return out;
+}
+
+std::string base64(const std::string &in) {
+  static const char *tbl =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string out;
+  size_t i = 0;
+  for (; i + 2 < in.size(); i += 3) {
+    uint32_t v = (uint8_t(in[i]) << 16) | (uint8_t(in[i + 1]) << 8) |
+                 uint8_t(in[i + 2]);
+    out += tbl[(v >> 18) & 63];
+    out += tbl[(v >> 12) & 63];
+    out += tbl[(v >> 6) & 63];
+    out += tbl[v & 63];
+  }
+  if (i + 1 == in.size()) {
+    uint32_t v = uint8_t(in[i]) << 16;
+    out += tbl[(v >> 18) & 63];
+    out += tbl[(v >> 12) & 63];
+    out += "==";
+  } else if (i + 2 == in.size()) {
+    uint32_t v = (uint8_t(in[i]) << 16) | (uint8_t(in[i + 1]) << 8);
+    out += tbl[(v >> 18) & 63];
+    out += tbl[(v >> 12) & 63];
+    out += tbl[(v >> 6) & 63];
+    out += '=';
+  }
+  return out;
+}
+
+// --- Message helpers ---
+
+void putU16(std::string &s, uint16_t v) {
+  s.push_back(static_cast<char>(v & 0xFF));
+  s.push_back(static_cast<char>(v >> 8));
+}
+
+void putU32(std::string &s, uint32_t v) {
+  for (int i = 0; i < 4; ++i)
+    s.push_back(static_cast<char>((v >> (i * 8)) & 0xFF));
+}
+
+// Wraps a payload in a single unmasked WebSocket frame.
+std::string wsFrame(uint8_t opcode, const std::string &payload) {
+  std::string f;
+  f.push_back(static_cast<char>(0x80 | opcode));
+  size_t n = payload.size();
+  if (n < 126) {
+    f.push_back(static_cast<char>(n));
+  } else if (n <= 0xFFFF) {
+    f.push_back(static_cast<char>(126));
+    f.push_back(static_cast<char>(n >> 8));
+    f.push_back(static_cast<char>(n & 0xFF));
+  } else {
+    f.push_back(static_cast<char>(127));
+    for (int i = 7; i >= 0; --i)
+      f.push_back(static_cast<char>((static_cast<uint64_t>(n) >> (i * 8)) &
+                                    0xFF));
+  }
+  f += payload;
+  return f;
+}
+
+struct TileBody {
+  uint16_t tx, ty;
+  uint8_t format;
+  const std::string *data;
+};
+
+std::string tileMessage(int frameW, int frameH,
+                        const std::vector<TileBody> &tiles) {
+  size_t total = 9;
+  for (const auto &t : tiles)
+    total += 9 + t.data->size();
+  std::string body;
+  body.reserve(total);
+  body.push_back(1);
+  putU16(body, static_cast<uint16_t>(frameW));
+  putU16(body, static_cast<uint16_t>(frameH));
+  putU16(body, RemoteViewServer::kTileSize);
+  putU16(body, static_cast<uint16_t>(tiles.size()));
+  for (const auto &t : tiles) {
+    putU16(body, t.tx);
+    putU16(body, t.ty);
+    body.push_back(static_cast<char>(t.format));
+    putU32(body, static_cast<uint32_t>(t.data->size()));
+    body += *t.data;
+  }
+  return wsFrame(0x2, body);
+}
+
+void appendToString(void *context, void *data, int size) {
+  static_cast<std::string *>(context)->append(static_cast<const char *>(data),
+                                              static_cast<size_t>(size));
+}
+
+// Few distinct colours means UI text or flat fills: PNG keeps those crisp
+// and small. Anything busier (map imagery, SDO) compresses better as JPEG.
+bool preferPng(const unsigned char *rgb, int count) {
+  uint32_t seen[kPngMaxColors];
+  int n = 0;
+  for (int i = 0; i < count; ++i, rgb += 3) {
+    uint32_t c = (uint32_t(rgb[0]) << 16) | (uint32_t(rgb[1]) << 8) | rgb[2];
+    bool found = false;
+    for (int j = 0; j < n; ++j) {
+      if (seen[j] == c) {
+        found = true;
+        break;
+      }
+    }
+    if (!found) {
+      if (n == kPngMaxColors)
+        return false;
+      seen[n++] = c;
+    }
+  }
+  return true;
+}
+
+bool setNonBlocking(int sock) {
+#ifdef _WIN32
+  unsigned long mode = 1;
+  return ioctlsocket(sock, FIONBIO, &mode) == 0;
+#else
+  return fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK) == 0;
+#endif
+}
+
+bool wouldBlock() {
+#ifdef _WIN32
+  return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+  return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
+} // namespace
+
+RemoteViewServer::RemoteViewServer(int port) : port_(port) {}
+
+RemoteViewServer::~RemoteViewServer() { stop(); }
+
+void RemoteViewServer::start() {
+  if (running_)
+    return;
+
+  listenSock_ = static_cast<int>(socket(AF_INET, SOCK_STREAM, 0));
+  if (listenSock_ < 0) {
+    LOG_E("RemoteView", "Failed to create socket");
+    return;
+  }
+  int yes = 1;
+  setsockopt(listenSock_, SOL_SOCKET, SO_REUSEADDR,
+             reinterpret_cast<const char *>(&yes), sizeof(yes));
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port = htons(static_cast<uint16_t>(port_));
+  if (bind(listenSock_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) <
+          0 ||
+      listen(listenSock_, 4) < 0) {
+    LOG_E("RemoteView", "Cannot listen on port {}: {}", port_,
+          std::strerror(errno));
+    close(listenSock_);
+    listenSock_ = -1;
+    return;
+  }
+  setNonBlocking(listenSock_);
+
+  running_ = true;
+  thread_ = std::thread(&RemoteViewServer::run, this);
+  LOG_I("RemoteView", "Tile WebSocket listening on port {}", port_);
+}
+
+void RemoteViewServer::stop() {
+  running_ = false;
+  if (thread_.joinable())
+    thread_.join();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto &c : clients_)
+    close(c->sock);
+  clients_.clear();
+  clientCount_ = 0;
+  if (listenSock_ >= 0) {
+    close(listenSock_);
+    listenSock_ = -1;
+  }
+}
+
+bool RemoteViewServer::wantsFrame(uint64_t pixelHash) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pixelHash != lastPixelHash_ || tiles_.empty();
+}
+
+void RemoteViewServer::submitFrame(const unsigned char *rgb, int w, int h,
+                                   uint64_t pixelHash) {
+  TRACE_SCOPE("web", "RemoteViewServer::submitFrame");
+  const int cols = (w + kTileSize - 1) / kTileSize;
+  const int rows = (h + kTileSize - 1) / kTileSize;
+
+  // Hash every tile first; only changed ones get encoded, and that happens
+  // outside the lock so the socket thread keeps streaming meanwhile.
+  std::vector<uint64_t> hashes(static_cast<size_t>(cols) * rows);
+  for (int ty = 0; ty < rows; ++ty) {
+    for (int tx = 0; tx < cols; ++tx) {
+      int x0 = tx * kTileSize, y0 = ty * kTileSize;
+      int tw = std::min(kTileSize, w - x0), th = std::min(kTileSize, h - y0);
+      uint64_t hsh = 1469598103934665603ULL;
+      for (int y = 0; y < th; ++y) {
+        const unsigned char *p = rgb + (static_cast<size_t>(y0 + y) * w + x0) * 3;
+        for (int i = 0; i < tw * 3; ++i)
+          hsh = (hsh ^ p[i]) * 1099511628211ULL;
+      }
+      hashes[static_cast<size_t>(ty) * cols + tx] = hsh;
+    }
+  }
+
+  std::vector<Tile> previous;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (frameW_ == w && frameH_ == h)
+      previous = tiles_;
+  }
+  bool resized = previous.empty();
+
+  std::vector<Tile> next(hashes.size());
+  std::vector<size_t> changed;
+  std::vector<unsigned char> tileRgb(kTileSize * kTileSize * 3);
+  for (int ty = 0; ty < rows; ++ty) {
+    for (int tx = 0; tx < cols; ++tx) {
+      size_t idx = static_cast<size_t>(ty) * cols + tx;
+      if (!resized && previous[idx].hash == hashes[idx]) {
+        next[idx] = previous[idx];
+        continue;
+      }
+
+      int x0 = tx * kTileSize, y0 = ty * kTileSize;
+      int tw = std::min(kTileSize, w - x0), th = std::min(kTileSize, h - y0);
+      for (int y = 0; y < th; ++y)
+        std::memcpy(tileRgb.data() + static_cast<size_t>(y) * tw * 3,
+                    rgb + (static_cast<size_t>(y0 + y) * w + x0) * 3,
+                    static_cast<size_t>(tw) * 3);
+
+      auto data = std::make_shared<std::string>();
+      Tile &t = next[idx];
+      t.hash = hashes[idx];
+      if (preferPng(tileRgb.data(), tw * th)) {
+        t.format = 1;
+        stbi_write_png_to_func(appendToString, data.get(), tw, th, 3,
+                               tileRgb.data(), tw * 3);
+      } else {
+        t.format = 0;
+        stbi_write_jpg_to_func(appendToString, data.get(), tw, th, 3,
+                               tileRgb.data(), kJpegQuality);
+      }
+      t.data = std::move(data);
+      changed.push_back(idx);
+    }
+  }
+
+  std::vector<TileBody> bodies;
+  bodies.reserve(changed.size());
+  for (size_t idx : changed)
+    bodies.push_back({static_cast<uint16_t>(idx % cols),
+                      static_cast<uint16_t>(idx / cols), next[idx].format,
+                      next[idx].data.get()});
+  std::shared_ptr<const std::string> delta;
+  if (!bodies.empty())
+    delta = std::make_shared<const std::string>(tileMessage(w, h, bodies));
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  tiles_ = std::move(next);
+  frameW_ = w;
+  frameH_ = h;
+  lastPixelHash_ = pixelHash;
+  if (!delta)
+    return;
+  for (auto &c : clients_) {
+    // Clients still waiting on a keyframe get a fresh one later instead
+    if (c->upgraded && !c->needsKeyframe)
+      enqueue(*c, delta);
+  }
+}
+
+std::shared_ptr<const std::string>
+RemoteViewServer::buildKeyframeLocked() const {
+  if (tiles_.empty())
+    return nullptr;
+  const int cols = (frameW_ + kTileSize - 1) / kTileSize;
+  std::vector<TileBody> bodies;
+  bodies.reserve(tiles_.size());
+  for (size_t i = 0; i < tiles_.size(); ++i)
+    bodies.push_back({static_cast<uint16_t>(i % cols),
+                      static_cast<uint16_t>(i / cols), tiles_[i].format,
+                      tiles_[i].data.get()});
+  return std::make_shared<const std::string>(
+      tileMessage(frameW_, frameH_, bodies));
+}
+
+void RemoteViewServer::enqueue(Client &c,
+                               std::shared_ptr<const std::string> msg) {
+  if (c.outBytes > kMaxBacklogBytes) {
+    // Too far behind: drop everything not yet started and resync later
+    while (c.out.size() > (c.outOffset > 0 ? 1u : 0u)) {
+      c.outBytes -= c.out.back()->size();
+      c.out.pop_back();
+    }
+    c.needsKeyframe = true;
+    return;
+  }
+  c.outBytes += msg->size();
+  c.out.push_back(std::move(msg));
+}
+
+bool RemoteViewServer::flush(Client &c) {
+  while (!c.out.empty()) {
+    const std::string &m = *c.out.front();
+    auto n = send(c.sock, m.data() + c.outOffset,
+                  static_cast<int>(m.size() - c.outOffset), MSG_NOSIGNAL);
+    if (n < 0)
+      return wouldBlock();
+    c.outOffset += static_cast<size_t>(n);
+    if (c.outOffset < m.size())
+      return true;
+    c.outBytes -= m.size();
+    c.outOffset = 0;
+    c.out.pop_front();
+  }
+  return !c.closing;
+}
+
+bool RemoteViewServer::handleHandshake(Client &c) {
+  size_t end = c.in.find("\r\n\r\n");
+  if (end == std::string::npos)
+    return c.in.size() < 8192;
+
+  std::string lower = c.in.substr(0, end);
+  for (auto &ch : lower)
+    ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+  size_t k = lower.find("sec-websocket-key:");
+  if (k == std::string::npos)
+    return false;
+  size_t vStart = c.in.find_first_not_of(" \t", k + 18);
+  size_t vEnd = c.in.find("\r\n", vStart);
+  std::string key = c.in.substr(vStart, vEnd - vStart);
+  c.in.erase(0, end + 4);
+
+  std::string accept =
+      base64(sha1(key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"));
+  auto resp = std::make_shared<const std::string>(
+      "HTTP/1.1 101 Switching Protocols\r\n"
+      "Upgrade: websocket\r\n"
+      "Connection: Upgrade\r\n"
+      "Sec-WebSocket-Accept: " +
+      accept + "\r\n\r\n");
+  c.outBytes += resp->size();
+  c.out.push_back(std::move(resp));
+  c.upgraded = true;
+  c.needsKeyframe = true;
+  return true;
+}
+
+bool RemoteViewServer::handleFrames(Client &c) {
+  // Clients only ever send control frames to us (close/ping); anything else
+  // is parsed and discarded.
+  while (c.in.size() >= 2) {
+    const auto *p = reinterpret_cast<const unsigned char *>(c.in.data());
+    uint8_t opcode = p[0] & 0x0F;
+    bool masked = p[1] & 0x80;
+    uint64_t len = p[1] & 0x7F;
+    size_t pos = 2;
+    if (len == 126) {
+      if (c.in.size() < 4)
+        return true;
+      len = (uint64_t(p[2]) << 8) | p[3];
+      pos = 4;
+    } else if (len == 127) {
+      if (c.in.size() < 10)
+        return true;
+      len = 0;
+      for (int i = 0; i < 8; ++i)
+        len = (len << 8) | p[2 + i];
+      pos = 10;
+    }
+    if (len > 65536)
+      return false;
+    size_t maskPos = pos;
+    if (masked)
+      pos += 4;
+    if (c.in.size() < pos + len)
+      return true;
+
+    std::string payload = c.in.substr(pos, static_cast<size_t>(len));
+    if (masked)
+      for (size_t i = 0; i < payload.size(); ++i)
+        payload[i] = static_cast<char>(payload[i] ^ c.in[maskPos + (i & 3)]);
+    c.in.erase(0, pos + static_cast<size_t>(len));
+
+    if (opcode == 0x8) {
+      enqueue(c, std::make_shared<const std::string>(wsFrame(0x8, "")));
+      c.closing = true;
+      return true;
+    }
+    if (opcode == 0x9)
+      enqueue(c, std::make_shared<const std::string>(wsFrame(0xA, payload)));
+  }
+  return true;
+}
+
+void RemoteViewServer::run() {
+  Tracer::instance().setThreadName("remote view");
+  std::vector<
+#ifdef _WIN32
+      WSAPOLLFD
+#else
+      pollfd
+#endif
+      >
+      fds;
+
+  while (running_) {
+    fds.clear();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      fds.push_back({});
+      fds.back().fd = listenSock_;
+      fds.back().events = POLLIN;
+      for (auto &c : clients_) {
+        fds.push_back({});
+        fds.back().fd = c->sock;
+        fds.back().events = POLLIN;
+        if (!c->out.empty())
+          fds.back().events |= POLLOUT;
+      }
+    }
+
+    // Short timeout: new tiles are queued by the encoder thread and picked
+    // up on the next pass.
+#ifdef _WIN32
+    int ret = WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), 20);
+#else
+    int ret = poll(fds.data(), fds.size(), 20);
+#endif
+    if (ret < 0)
+      continue;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (fds[0].revents & POLLIN) {
+      int s = static_cast<int>(accept(listenSock_, nullptr, nullptr));
+      if (s >= 0) {
+        if (static_cast<int>(clients_.size()) >= kMaxClients) {
+          close(s);
+        } else {
+          setNonBlocking(s);
+#ifdef SO_NOSIGPIPE
+          int one = 1;
+          setsockopt(s, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+          auto c = std::make_unique<Client>();
+          c->sock = s;
+          clients_.push_back(std::move(c));
+          LOG_I("RemoteView", "Client connected ({} total)", clients_.size());
+        }
+      }
+    }
+
+    // fds[i + 1] belongs to clients_[i] for the clients that existed before
+    // the poll; freshly accepted ones are handled next pass.
+    size_t polled = fds.size() - 1;
+    for (size_t i = 0; i < clients_.size();) {
+      Client &c = *clients_[i];
+      bool keep = true;
+      short rev = i < polled ? fds[i + 1].revents : 0;
+
+      if (rev & (POLLERR | POLLHUP))
+        keep = false;
+
+      if (keep && (rev & POLLIN)) {
+        char buf[4096];
+        auto n = recv(c.sock, buf, sizeof(buf), 0);
+        if (n <= 0) {
+          keep = false;
+        } else {
+          c.in.append(buf, static_cast<size_t>(n));
+          keep = c.upgraded ? handleFrames(c) : handleHandshake(c);
+          if (keep && c.upgraded && !c.in.empty())
+            keep = handleFrames(c);
+        }
+      }
+
+      if (keep && c.upgraded && c.needsKeyframe && c.outBytes == 0) {
+        if (auto key = buildKeyframeLocked()) {
+          c.needsKeyframe = false;
+          enqueue(c, std::move(key));
+        }
+      }
+
+      if (keep && !c.out.empty())
+        keep = flush(c);
+      if (keep && c.closing && c.out.empty())
+        keep = false;
+
+      if (!keep) {
+        close(c.sock);
+        clients_.erase(clients_.begin() + static_cast<long>(i));
+        if (i < polled) {
+          fds.erase(fds.begin() + static_cast<long>(i) + 1);
+          --polled;
+        }
+        LOG_I("RemoteView", "Client disconnected ({} left)", clients_.size());
+        continue;
+      }
+      ++i;
+    }
+
+    clientCount_ = static_cast<int>(std::count_if(
+        clients_.begin(), clients_.end(),
+        [](const std::unique_ptr<Client> &c) { return c->upgraded; }));
+    if (clients_.empty()) {
+      // Nobody watching: drop the tile cache so the next viewer starts clean
+      tiles_.clear();
+      lastPixelHash_ = 0;
+    }
+  }
+}
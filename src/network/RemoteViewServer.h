@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Tile-based delta remote view over WebSocket.
+//
+// Frames are scaled to the logical 800px width and cut into 32x32 tiles.
+// Only tiles whose contents changed since the previous frame are encoded
+// (PNG for flat/text tiles, JPEG for photographic ones) and pushed to every
+// connected client. New or lagging clients get a keyframe assembled from the
+// cached tiles, so nobody ever waits for a full-screen encode.
+//
+// cpp-httplib has no WebSocket support, so this runs its own tiny server on
+// a separate port. Input still goes through the regular /set_touch and
+// /set_char HTTP endpoints.
+//
+// Wire format (one binary WebSocket message per update, little endian):
+//   u8  type (1 = tiles)
+//   u16 frameWidth, u16 frameHeight, u16 tileSize, u16 tileCount
+//   tileCount x { u16 tileX, u16 tileY, u8 format (0 = JPEG, 1 = PNG),
+//                 u32 length, length bytes of image data }
+class RemoteViewServer {
+public:
+  static constexpr int kLogicalWidth = 800;
+  static constexpr int kTileSize = 32;
+
+  explicit RemoteViewServer(int port = 8081);
+  ~RemoteViewServer();
+
+  RemoteViewServer(const RemoteViewServer &) = delete;
+  RemoteViewServer &operator=(const RemoteViewServer &) = delete;
+
+  void start();
+  void stop();
+
+  int port() const { return port_; }
+  int clientCount() const { return clientCount_.load(); }
+
+  // True if a frame with this full-resolution pixel hash would be new to the
+  // tile cache (i.e. worth scaling and submitting).
+  bool wantsFrame(uint64_t pixelHash) const;
+
+  // Feeds a packed RGB24 frame already scaled to kLogicalWidth. Called from
+  // the web encoder thread.
+  void submitFrame(const unsigned char *rgb, int w, int h, uint64_t pixelHash);
+
+private:
+  struct Tile {
+    uint64_t hash = 0;
+    uint8_t format = 0;
+    std::shared_ptr<const std::string> data;
+  };
+
+  struct Client {
+    int sock = -1;
+    std::string in;
+    std::deque<std::shared_ptr<const std::string>> out;
+    size_t outOffset = 0; // bytes of out.front() already sent
+    size_t outBytes = 0;
+    bool upgraded = false;
+    bool needsKeyframe = false;
+    bool closing = false;
+  };
+
+  void run();
+  bool handleHandshake(Client &c);
+  bool handleFrames(Client &c);
+  bool flush(Client &c);
+  void enqueue(Client &c, std::shared_ptr<const std::string> msg);
+  std::shared_ptr<const std::string> buildKeyframeLocked() const;
+
+  int port_;
+  int listenSock_ = -1;
+  std::thread thread_;
+  std::atomic<bool> running_{false};
+  std::atomic<int> clientCount_{0};
+
+  mutable std::mutex mutex_; // guards everything below
+  std::vector<std::unique_ptr<Client>> clients_;
+  std::vector<Tile> tiles_;
+  int frameW_ = 0;
+  int frameH_ = 0;
+  uint64_t lastPixelHash_ = 0;
+};
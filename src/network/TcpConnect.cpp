@@ -0,0 +1,322 @@
+#include "TcpConnect.h"
+#include "../core/WorkerPool.h"
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#define close closesocket
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace TcpConnect {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr auto kAttemptDelay = std::chrono::milliseconds(250);
+// How often a blocked wait looks at the cancel flag.
+constexpr auto kCancelPoll = std::chrono::milliseconds(100);
+
+struct Address {
+  sockaddr_storage addr{};
+  socklen_t len = 0;
+  int family = 0;
+};
+
+// Shared with the resolver task, which may outlive a cancelled caller.
+struct Resolution {
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool done = false;
+  std::string error;
+  std::vector<Address> addrs;
+};
+
+int lastSocketError() {
+#ifdef _WIN32
+  return WSAGetLastError();
+#else
+  return errno;
+#endif
+}
+
+bool connectInProgress(int err) {
+#ifdef _WIN32
+  return err == WSAEWOULDBLOCK || err == WSAEINPROGRESS;
+#else
+  return err == EINPROGRESS;
+#endif
+}
+
+std::string errorText(int err) {
+#ifdef _WIN32
+  return "error " + std::to_string(err);
+#else
+  return std::strerror(err);
+#endif
+}
+
+void setNonBlocking(int fd) {
+#ifdef _WIN32
+  unsigned long mode = 1;
+  ioctlsocket(fd, FIONBIO, &mode);
+#else
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+#endif
+}
+
+std::string numericAddress(const Address &a) {
+  char buf[INET6_ADDRSTRLEN] = {};
+  const void *src =
+      a.family == AF_INET6
+          ? static_cast<const void *>(
+                &reinterpret_cast<const sockaddr_in6 *>(&a.addr)->sin6_addr)
+          : static_cast<const void *>(
+                &reinterpret_cast<const sockaddr_in *>(&a.addr)->sin_addr);
+  inet_ntop(a.family, src, buf, sizeof(buf));
+  return buf;
+}
+
+// getaddrinfo blocks for as long as DNS takes, so it runs on a resolve
+// worker while the caller keeps checking 'cancel'.
+bool resolve(const std::string &host, int port,
+             const std::atomic<bool> &cancel, Clock::time_point deadline,
+             std::vector<Address> &out, std::string &error) {
+  auto res = std::make_shared<Resolution>();
+  bool queued = WorkerPool::instance().submit(
+      WorkerPool::Queue::Resolve, [res, host, port] {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_ADDRCONFIG;
+        addrinfo *list = nullptr;
+        std::string service = std::to_string(port);
+        int rc = getaddrinfo(host.c_str(), service.c_str(), &hints, &list);
+
+        std::vector<Address> addrs;
+        for (addrinfo *ai = list; rc == 0 && ai; ai = ai->ai_next) {
+          if (ai->ai_family != AF_INET && ai->ai_family != AF_INET6)
+            continue;
+          Address a;
+          std::memcpy(&a.addr, ai->ai_addr, ai->ai_addrlen);
+          a.len = static_cast<socklen_t>(ai->ai_addrlen);
+          a.family = ai->ai_family;
+          addrs.push_back(a);
+        }
+        if (list)
+          freeaddrinfo(list);
+
+        std::lock_guard<std::mutex> lock(res->mutex);
+        if (rc != 0)
+          res->error = std::string("DNS failed: ") + gai_strerror(rc);
+        res->addrs = std::move(addrs);
+        res->done = true;
+        res->cv.notify_all();
+      },
+      WorkerPool::Priority::High);
+  if (!queued) {
+    error = "Shutting down";
+    return false;
+  }
+
+  std::unique_lock<std::mutex> lock(res->mutex);
+  while (!res->done) {
+    if (cancel) {
+      error = "Cancelled";
+      return false;
+    }
+    if (Clock::now() >= deadline) {
+      error = "DNS timed out";
+      return false;
+    }
+    res->cv.wait_for(lock, kCancelPoll);
+  }
+  if (!res->error.empty()) {
+    error = res->error;
+    return false;
+  }
+  if (res->addrs.empty()) {
+    error = "DNS failed: no addresses";
+    return false;
+  }
+
+  // Alternate families, starting with whichever the resolver preferred.
+  std::vector<Address> first, second;
+  for (const auto &a : res->addrs)
+    (a.family == res->addrs.front().family ? first : second).push_back(a);
+  out.clear();
+  for (size_t i = 0; i < std::max(first.size(), second.size()); ++i) {
+    if (i < first.size())
+      out.push_back(first[i]);
+    if (i < second.size())
+      out.push_back(second[i]);
+  }
+  return true;
+}
+
+} // namespace
+
+Result connect(const std::string &host, int port,
+               const std::atomic<bool> &cancel,
+               std::chrono::milliseconds timeout) {
+  Result result;
+  auto deadline = Clock::now() + timeout;
+
+  std::vector<Address> addrs;
+  if (!resolve(host, port, cancel, deadline, addrs, result.error))
+    return result;
+
+  struct Attempt {
+    int fd;
+    size_t addr;
+  };
+  std::vector<Attempt> pending;
+  size_t next = 0;
+  auto nextStart = Clock::now();
+  std::string lastError = "Connect failed";
+
+  auto closeAll = [&] {
+    for (auto &a : pending)
+      close(a.fd);
+    pending.clear();
+  };
+  auto win = [&](int fd, size_t addr) {
+    result.fd = fd;
+    result.address = numericAddress(addrs[addr]);
+    closeAll();
+    return result;
+  };
+
+  for (;;) {
+    if (cancel) {
+      closeAll();
+      result.error = "Cancelled";
+      return result;
+    }
+    auto now = Clock::now();
+
+    // Start the next address when its turn comes, or straight away when
+    // nothing else is in flight.
+    if (next < addrs.size() && (now >= nextStart || pending.empty())) {
+      size_t idx = next++;
+      nextStart = now + kAttemptDelay;
+      const Address &a = addrs[idx];
+      int fd = static_cast<int>(socket(a.family, SOCK_STREAM, 0));
+      if (fd < 0) {
+        lastError = "Socket error";
+        continue;
+      }
+      setNonBlocking(fd);
+#ifdef SO_NOSIGPIPE
+      // macOS has no MSG_NOSIGNAL; a write to a reset peer must not raise
+      // SIGPIPE in the caller either way.
+      int one = 1;
+      setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+      if (::connect(fd, reinterpret_cast<const sockaddr *>(&a.addr), a.len) ==
+          0)
+        return win(fd, idx);
+      int err = lastSocketError();
+      if (!connectInProgress(err)) {
+        lastError = "Connect failed: " + errorText(err);
+        close(fd);
+        continue;
+      }
+      pending.push_back({fd, idx});
+      continue;
+    }
+
+    if (pending.empty()) {
+      result.error = lastError;
+      return result;
+    }
+    if (now >= deadline) {
+      closeAll();
+      result.error = "Connect timed out";
+      return result;
+    }
+
+    auto wait = std::min<Clock::duration>(deadline - now, kCancelPoll);
+    if (next < addrs.size())
+      wait = std::min<Clock::duration>(wait, nextStart - now);
+    int waitMs = static_cast<int>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(wait).count());
+
+#ifdef _WIN32
+    std::vector<WSAPOLLFD> pfds(pending.size());
+#else
+    std::vector<pollfd> pfds(pending.size());
+#endif
+    for (size_t i = 0; i < pending.size(); ++i) {
+      pfds[i].fd = pending[i].fd;
+      pfds[i].events = POLLOUT;
+    }
+#ifdef _WIN32
+    int ret = WSAPoll(pfds.data(), static_cast<ULONG>(pfds.size()),
+                      std::max(waitMs, 1));
+#else
+    int ret = poll(pfds.data(), pfds.size(), std::max(waitMs, 1));
+#endif
+    if (ret <= 0)
+      continue;
+
+    for (size_t i = pfds.size(); i-- > 0;) {
+      if (pfds[i].revents == 0)
+        continue;
+      int soErr = 0;
+      socklen_t len = sizeof(soErr);
+      getsockopt(pending[i].fd, SOL_SOCKET, SO_ERROR,
+                 reinterpret_cast<char *>(&soErr), &len);
+      if (soErr == 0 && (pfds[i].revents & POLLOUT)) {
+        Attempt won = pending[i];
+        pending.erase(pending.begin() + i);
+        return win(won.fd, won.addr);
+      }
+      lastError = "Connect failed: " + errorText(soErr ? soErr : ECONNREFUSED);
+      close(pending[i].fd);
+      pending.erase(pending.begin() + i);
+    }
+  }
+}
+
+void enableKeepAlive(int fd, std::chrono::seconds idle) {
+  int on = 1;
+  setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, reinterpret_cast<const char *>(&on),
+             sizeof(on));
+#ifndef _WIN32
+  int idleS = static_cast<int>(idle.count());
+  int intervalS = 10;
+  int count = 3;
+#if defined(TCP_KEEPIDLE)
+  setsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE, &idleS, sizeof(idleS));
+#elif defined(TCP_KEEPALIVE) // macOS
+  setsockopt(fd, IPPROTO_TCP, TCP_KEEPALIVE, &idleS, sizeof(idleS));
+#endif
+#ifdef TCP_KEEPINTVL
+  setsockopt(fd, IPPROTO_TCP, TCP_KEEPINTVL, &intervalS, sizeof(intervalS));
+#endif
+#ifdef TCP_KEEPCNT
+  setsockopt(fd, IPPROTO_TCP, TCP_KEEPCNT, &count, sizeof(count));
+#endif
+#else
+  (void)idle;
+#endif
+}
+
+} // namespace TcpConnect
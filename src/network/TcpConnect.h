@@ -0,0 +1,31 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+
+namespace TcpConnect {
+
+struct Result {
+  int fd = -1;         // connected, non-blocking socket; -1 on failure
+  std::string address; // numeric address that won, for logging
+  std::string error;   // short reason when fd < 0
+};
+
+// Resolves 'host' (A and AAAA) on the resolve queue of the worker pool and
+// connects with happy eyeballs (RFC 8305): attempts alternate between
+// address families, a new one starts every 250 ms while earlier ones are
+// still pending, and the first to complete wins. Returns early once 'cancel'
+// becomes true, so a dead host never holds up shutdown. Where the platform
+// has SO_NOSIGPIPE the socket has it set; elsewhere, send with
+// MSG_NOSIGNAL.
+Result connect(const std::string &host, int port,
+               const std::atomic<bool> &cancel,
+               std::chrono::milliseconds timeout = std::chrono::seconds(10));
+
+// Turns on TCP keepalive probes after 'idle' without traffic, where the
+// platform allows tuning it.
+void enableKeepAlive(int fd,
+                     std::chrono::seconds idle = std::chrono::seconds(60));
+
+} // namespace TcpConnect
@@ -1,19 +1,28 @@
 #include "WebServer.h"
+#include "RemoteViewServer.h"
 
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "../ui/stb_image_write.h"
 
 #include "../core/ConfigManager.h"
 #include "../core/HamClockState.h"
+#include "../core/ServiceHealth.h"
 #include "../core/SolarData.h"
+#include "../core/SpotArchive.h"
 #include "../core/WatchlistStore.h"
+#include "../core/WorkerPool.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <httplib.h>
 #include <nlohmann/json.hpp>
 
 #include "../core/Logger.h"
+#include "../core/Tracer.h"
 
 #ifdef ENABLE_DEBUG_API
 #include "../core/Astronomy.h"
+#include "../core/LiveSpotData.h"
 #include "../core/UIRegistry.h"
 #include <iomanip>
 #include <iostream>
@@ -23,9 +32,23 @@
 WebServer::WebServer(SDL_Renderer *renderer, AppConfig &cfg,
                      HamClockState &state, ConfigManager &cfgMgr,
                      std::shared_ptr<WatchlistStore> watchlist,
-                     std::shared_ptr<SolarDataStore> solar, int port)
+                     std::shared_ptr<SolarDataStore> solar,
+                     std::shared_ptr<SpotArchive> archive, int port)
     : renderer_(renderer), cfg_(&cfg), state_(&state), cfgMgr_(&cfgMgr),
-      watchlist_(watchlist), solar_(solar), port_(port) {}
+      watchlist_(watchlist), solar_(solar), archive_(archive), port_(port),
+      remote_(std::make_unique<RemoteViewServer>(port + 1)) {
+  for (int i = 0; i < kPixelBuffers; ++i)
+    freeBuffers_.push_back(std::make_unique<PixelBuffer>());
+
+  auto &bus = ChangeBus::instance();
+  for (size_t t = 0; t < ChangeBus::kNumTopics; ++t) {
+    changeSubs_.push_back(
+        bus.subscribe(static_cast<ChangeBus::Topic>(t),
+                      [this](ChangeBus::Topic, uint64_t) {
+                        storesChanged_ = true;
+                      }));
+  }
+}
 
 WebServer::~WebServer() { stop(); }
 
@@ -34,58 +57,266 @@ void WebServer::start() {
     return;
   running_ = true;
   thread_ = std::thread(&WebServer::run, this);
+  encoderThread_ = std::thread(&WebServer::encodeLoop, this);
+  remote_->start();
 }
 
 void WebServer::stop() {
-  running_ = false;
+  {
+    // Flip under the locks so waiters cannot miss the wakeup
+    std::lock_guard<std::mutex> frameLock(jpegMutex_);
+    std::lock_guard<std::mutex> captureLock(captureMutex_);
+    running_ = false;
+  }
+  frameCv_.notify_all();
+  captureCv_.notify_all();
   if (svrPtr_) {
     static_cast<httplib::Server *>(svrPtr_)->stop();
   }
   if (thread_.joinable()) {
     thread_.join();
   }
+  if (encoderThread_.joinable()) {
+    encoderThread_.join();
+  }
+  remote_->stop();
   svrPtr_ = nullptr;
 }
 
+static int intParam(const httplib::Request &req, const char *name, int def,
+                    int lo, int hi) {
+  if (!req.has_param(name))
+    return def;
+  return std::clamp(std::atoi(req.get_param_value(name).c_str()), lo, hi);
+}
+
 static void stbi_write_to_vector(void *context, void *data, int size) {
   auto *vec = static_cast<std::vector<unsigned char> *>(context);
   auto *bytes = static_cast<unsigned char *>(data);
   vec->insert(vec->end(), bytes, bytes + size);
 }
 
-void WebServer::updateFrame() {
-  if (!needsCapture_)
+// Capture at the rate the most demanding stream client asked for, or every
+// 250ms when only /live.jpg pollers are around.
+uint32_t WebServer::captureIntervalMs() const {
+  int fps = streamDemandFps_.load();
+  if (remote_->clientCount() > 0)
+    fps = std::max(fps, kRemoteViewFps);
+  if (fps <= 0)
+    return 250;
+  return static_cast<uint32_t>(std::max(1000 / fps, 50));
+}
+
+void WebServer::setDemand(int id, int width, int quality,
+                          std::chrono::steady_clock::time_point expires) {
+  std::lock_guard<std::mutex> lock(jpegMutex_);
+  if (width <= 0)
+    demand_.erase(id);
+  else
+    demand_[id] = {width, quality, expires};
+}
+
+WebServer::ClientDemand WebServer::currentDemand() {
+  auto now = std::chrono::steady_clock::now();
+  ClientDemand d{0, 0, now};
+  std::lock_guard<std::mutex> lock(jpegMutex_);
+  for (auto it = demand_.begin(); it != demand_.end();) {
+    if (it->second.expires < now) {
+      it = demand_.erase(it);
+      continue;
+    }
+    d.width = std::max(d.width, it->second.width);
+    d.quality = std::max(d.quality, it->second.quality);
+    ++it;
+  }
+  if (d.width == 0) {
+    d.width = kDefaultWidth;
+    d.quality = kDefaultQuality;
+  }
+  return d;
+}
+
+void WebServer::updateFrame(bool frameDirty) {
+  if (!needsCapture_ && streamDemandFps_ == 0 && remote_->clientCount() == 0)
     return;
 
   uint32_t now = SDL_GetTicks();
-  // Throttle to 500ms (2 FPS) instead of 100ms (10 FPS) for lower CPU usage
-  if (now - lastCaptureTicks_ < 250)
+  if (now - lastCaptureTicks_ < captureIntervalMs())
     return;
+  // Nothing on screen changed: skip the GPU readback, but still refresh now
+  // and then in case something animated without telling us.
+  if (!frameDirty && !storesChanged_ &&
+      now - lastCaptureTicks_ < kIdleCaptureMs)
+    return;
+  TRACE_SCOPE("frame", "WebServer::updateFrame");
+
+  std::unique_ptr<PixelBuffer> buf;
+  {
+    std::lock_guard<std::mutex> lock(captureMutex_);
+    if (freeBuffers_.empty())
+      return; // encoder still busy with older frames; try next frame
+    buf = std::move(freeBuffers_.back());
+    freeBuffers_.pop_back();
+  }
   lastCaptureTicks_ = now;
+  storesChanged_ = false;
 
   int w, h;
   SDL_GetRendererOutputSize(renderer_, &w, &h);
+  buf->w = w;
+  buf->h = h;
+  buf->pixels.resize(static_cast<size_t>(w) * h * 3);
+
+  bool ok = SDL_RenderReadPixels(renderer_, NULL, SDL_PIXELFORMAT_RGB24,
+                                 buf->pixels.data(), w * 3) == 0;
 
-  SDL_Surface *surface =
-      SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_RGB24);
-  if (!surface)
+  std::lock_guard<std::mutex> lock(captureMutex_);
+  if (!ok) {
+    freeBuffers_.push_back(std::move(buf));
     return;
+  }
+  if (pendingBuffer_)
+    freeBuffers_.push_back(std::move(pendingBuffer_)); // drop the stale one
+  pendingBuffer_ = std::move(buf);
+  captureCv_.notify_one();
+}
 
-  if (SDL_RenderReadPixels(renderer_, NULL, SDL_PIXELFORMAT_RGB24,
-                           surface->pixels, surface->pitch) == 0) {
-    std::vector<unsigned char> jpeg;
-    stbi_write_jpg_to_func(stbi_write_to_vector, &jpeg, w, h, 3,
-                           surface->pixels, 70);
+namespace {
+
+uint64_t hashPixels(const std::vector<unsigned char> &px) {
+  // FNV-1a over 64-bit words; only used to spot identical frames.
+  uint64_t h = 1469598103934665603ULL;
+  size_t i = 0;
+  for (; i + 8 <= px.size(); i += 8) {
+    uint64_t word;
+    std::memcpy(&word, px.data() + i, 8);
+    h = (h ^ word) * 1099511628211ULL;
+  }
+  for (; i < px.size(); ++i)
+    h = (h ^ px[i]) * 1099511628211ULL;
+  return h;
+}
+
+// Box-filter downscale of a packed RGB24 image.
+void downscaleRGB(const unsigned char *src, int sw, int sh, unsigned char *dst,
+                  int dw, int dh) {
+  for (int y = 0; y < dh; ++y) {
+    int y0 = y * sh / dh;
+    int y1 = std::max(y0 + 1, (y + 1) * sh / dh);
+    for (int x = 0; x < dw; ++x) {
+      int x0 = x * sw / dw;
+      int x1 = std::max(x0 + 1, (x + 1) * sw / dw);
+      unsigned sum[3] = {0, 0, 0};
+      for (int sy = y0; sy < y1; ++sy) {
+        const unsigned char *p = src + (static_cast<size_t>(sy) * sw + x0) * 3;
+        for (int sx = x0; sx < x1; ++sx, p += 3) {
+          sum[0] += p[0];
+          sum[1] += p[1];
+          sum[2] += p[2];
+        }
+      }
+      unsigned n = static_cast<unsigned>((y1 - y0) * (x1 - x0));
+      unsigned char *d = dst + (static_cast<size_t>(y) * dw + x) * 3;
+      d[0] = static_cast<unsigned char>(sum[0] / n);
+      d[1] = static_cast<unsigned char>(sum[1] / n);
+      d[2] = static_cast<unsigned char>(sum[2] / n);
+    }
+  }
+}
+
+} // namespace
+
+void WebServer::encodeLoop() {
+  Tracer::instance().setThreadName("web encoder");
+  std::vector<unsigned char> scaled;
+  std::vector<unsigned char> tileFrame;
+  int lastWidth = 0;
+  int lastQuality = 0;
+
+  while (true) {
+    std::unique_ptr<PixelBuffer> buf;
+    {
+      std::unique_lock<std::mutex> lock(captureMutex_);
+      captureCv_.wait(lock, [&] { return pendingBuffer_ || !running_; });
+      if (!running_)
+        return;
+      buf = std::move(pendingBuffer_);
+    }
+
+    ClientDemand demand = currentDemand();
+    int outW = std::min(buf->w, demand.width);
+    int outH = std::max(1, buf->h * outW / std::max(1, buf->w));
+
+    uint64_t hash;
+    {
+      TRACE_SCOPE("web", "hash");
+      hash = hashPixels(buf->pixels);
+    }
+    bool unchanged = hash == lastPixelHash_ && outW == lastWidth &&
+                     demand.quality == lastQuality;
+    bool jpegWanted = needsCapture_ || streamDemandFps_ > 0;
+
+    if (remote_->clientCount() > 0 && remote_->wantsFrame(hash)) {
+      // Tile clients always work at the logical 800px width
+      int tw = RemoteViewServer::kLogicalWidth;
+      int th = std::max(1, buf->h * tw / std::max(1, buf->w));
+      tileFrame.resize(static_cast<size_t>(tw) * th * 3);
+      downscaleRGB(buf->pixels.data(), buf->w, buf->h, tileFrame.data(), tw,
+                   th);
+      remote_->submitFrame(tileFrame.data(), tw, th, hash);
+    }
+
+    JpegPtr jpeg;
+    if (jpegWanted && !unchanged) {
+      const unsigned char *src = buf->pixels.data();
+      if (outW != buf->w) {
+        TRACE_SCOPE("web", "downscale");
+        scaled.resize(static_cast<size_t>(outW) * outH * 3);
+        downscaleRGB(src, buf->w, buf->h, scaled.data(), outW, outH);
+        src = scaled.data();
+      }
+      auto out = std::make_shared<std::vector<unsigned char>>();
+      {
+        TRACE_SCOPE("web", "jpeg encode");
+        stbi_write_jpg_to_func(stbi_write_to_vector, out.get(), outW, outH, 3,
+                               src, demand.quality);
+      }
+      jpeg = std::move(out);
+      lastPixelHash_ = hash;
+      lastWidth = outW;
+      lastQuality = demand.quality;
+    }
 
-    std::lock_guard<std::mutex> lock(jpegMutex_);
-    latestJpeg_ = std::move(jpeg);
-    needsCapture_ = false;
+    {
+      std::lock_guard<std::mutex> lock(captureMutex_);
+      freeBuffers_.push_back(std::move(buf));
+    }
+    {
+      std::lock_guard<std::mutex> lock(jpegMutex_);
+      if (jpeg) {
+        latestJpeg_ = std::move(jpeg);
+        ++frameSeq_;
+      }
+      ++captureSeq_;
+      needsCapture_ = false;
+    }
+    frameCv_.notify_all();
   }
+}
 
-  SDL_FreeSurface(surface);
+WebServer::JpegPtr WebServer::waitForFrame(uint64_t &afterSeq,
+                                           std::chrono::milliseconds timeout,
+                                           bool anyCapture) {
+  std::unique_lock<std::mutex> lock(jpegMutex_);
+  uint64_t &seq = anyCapture ? captureSeq_ : frameSeq_;
+  frameCv_.wait_for(lock, timeout,
+                    [&] { return seq > afterSeq || !running_; });
+  afterSeq = seq;
+  return latestJpeg_;
 }
 
 void WebServer::run() {
+  Tracer::instance().setThreadName("http");
   httplib::Server svr;
   svrPtr_ = &svr;
 
@@ -118,7 +349,7 @@ void WebServer::run() {
 <body>
     <input type="text" id="kbd-hidden" autocomplete="off" autoconnect="off" autofocus>
     <div id="screen-container">
-        <img id="screen" src="/live.jpg" draggable="false">
+        <img id="screen" draggable="false">
     </div>
 
     <div class="status">v)HTML";
@@ -133,13 +364,27 @@ void WebServer::run() {
         // Change to 1000 for 1 FPS (lower CPU usage)
         // Change to 250 for 4 FPS (higher CPU usage)
         const REFRESH_RATE = 500;
-        
+        const STREAM_FPS = 5;
+        // Ask for no more pixels than this screen can show
+        const WANT_WIDTH = Math.round(window.innerWidth * (window.devicePixelRatio || 1));
+
         function refresh() {
             const nextImg = new Image();
             nextImg.onload = () => { img.src = nextImg.src; };
-            nextImg.src = '/live.jpg?t=' + Date.now();
+            nextImg.src = '/live.jpg?w=' + WANT_WIDTH + '&t=' + Date.now();
+        }
+
+        // Prefer the pushed MJPEG stream; if the browser or server refuses it
+        // (e.g. too many viewers), fall back to polling single frames.
+        let polling = false;
+        function startPolling() {
+            if (polling) return;
+            polling = true;
+            img.onerror = null;
+            setInterval(refresh, REFRESH_RATE);
         }
-        setInterval(refresh, REFRESH_RATE);
+        img.onerror = startPolling;
+        img.src = '/stream.mjpg?fps=' + STREAM_FPS + '&w=' + WANT_WIDTH;
 
         // Click anywhere to ensure input focus
         document.addEventListener('mousedown', function() {
@@ -182,21 +427,218 @@ void WebServer::run() {
     res.set_content(html, "text/html");
   });
 
-  svr.Get("/live.jpg", [this](const httplib::Request &,
+  // Tile-delta live view: a canvas fed by the RemoteViewServer WebSocket.
+  // Only changed 32x32 tiles travel over the wire, so it suits slow links.
+  svr.Get("/remote", [this](const httplib::Request &, httplib::Response &res) {
+    std::string html = R"HTML(
+<!DOCTYPE html>
+<html>
+<head>
+    <title>HamClock-Next Remote (v)HTML";
+    html += HAMCLOCK_VERSION;
+    html += R"HTML()</title>
+    <meta name="viewport" content="width=device-width, initial-scale=1">
+    <style>
+        body { background: #000; color: #00ff00; text-align: center; font-family: monospace; margin: 0; padding: 10px; overflow: hidden; }
+        #screen { max-width: 100vw; max-height: 85vh; border: 2px solid #333; background: #111; cursor: crosshair; image-rendering: auto; }
+        .status { margin-top: 15px; font-size: 0.8em; color: #666; }
+    </style>
+</head>
+<body>
+    <canvas id="screen" width="800" height="480"></canvas>
+    <div class="status" id="status">connecting...</div>
+    <script>
+        const WS_PORT = )HTML";
+    html += std::to_string(remote_->port());
+    html += R"HTML(;
+        const canvas = document.getElementById('screen');
+        const ctx = canvas.getContext('2d');
+        const statusEl = document.getElementById('status');
+        let bytes = 0;
+
+        async function applyUpdate(buf) {
+            const dv = new DataView(buf);
+            if (dv.getUint8(0) !== 1) return;
+            const w = dv.getUint16(1, true), h = dv.getUint16(3, true);
+            const ts = dv.getUint16(5, true), count = dv.getUint16(7, true);
+            if (canvas.width !== w || canvas.height !== h) {
+                canvas.width = w;
+                canvas.height = h;
+            }
+            let off = 9;
+            const pending = [];
+            for (let i = 0; i < count; i++) {
+                const tx = dv.getUint16(off, true), ty = dv.getUint16(off + 2, true);
+                const type = dv.getUint8(off + 4) === 1 ? 'image/png' : 'image/jpeg';
+                const len = dv.getUint32(off + 5, true);
+                off += 9;
+                const blob = new Blob([new Uint8Array(buf, off, len)], { type });
+                off += len;
+                pending.push(createImageBitmap(blob).then(bmp => ({ bmp, x: tx * ts, y: ty * ts })));
+            }
+            // Decode in parallel, draw together so a frame never tears
+            for (const t of await Promise.all(pending)) {
+                ctx.drawImage(t.bmp, t.x, t.y);
+                t.bmp.close();
+            }
+        }
+
+        function connect() {
+            const ws = new WebSocket('ws://' + location.hostname + ':' + WS_PORT + '/');
+            ws.binaryType = 'arraybuffer';
+            let chain = Promise.resolve();
+            ws.onopen = () => { statusEl.textContent = 'connected'; };
+            ws.onmessage = (ev) => {
+                bytes += ev.data.byteLength;
+                chain = chain.then(() => applyUpdate(ev.data)).catch(() => {});
+            };
+            ws.onclose = () => {
+                statusEl.textContent = 'disconnected, retrying...';
+                setTimeout(connect, 2000);
+            };
+        }
+        connect();
+
+        setInterval(() => {
+            statusEl.textContent = 'v)HTML";
+    html += HAMCLOCK_VERSION;
+    html += R"HTML( | ' + (bytes * 8 / 1000).toFixed(1) + ' kbit/s';
+            bytes = 0;
+        }, 1000);
+
+        canvas.addEventListener('mousedown', function(e) {
+            const rect = canvas.getBoundingClientRect();
+            const rx = (e.clientX - rect.left) / rect.width;
+            const ry = (e.clientY - rect.top) / rect.height;
+            fetch('/set_touch?rx=' + rx + '&ry=' + ry);
+        });
+        canvas.addEventListener('contextmenu', e => e.preventDefault());
+
+        function sendKey(k) {
+            fetch('/set_char?k=' + encodeURIComponent(k));
+        }
+        window.addEventListener('keydown', function(e) {
+            const named = ['Backspace', 'Tab', 'Enter', 'Escape', 'ArrowLeft', 'ArrowRight', 'ArrowUp', 'ArrowDown', 'Delete', 'Home', 'End'];
+            if (named.includes(e.key)) {
+                e.preventDefault();
+                sendKey(e.key);
+            }
+        });
+        window.addEventListener('keypress', function(e) {
+            e.preventDefault();
+            sendKey(e.key);
+        });
+    </script>
+</body>
+</html>
+)HTML";
+    res.set_content(html, "text/html");
+  });
+
+  // Optional ?w= (output width in pixels) and ?q= (JPEG quality) let clients
+  // ask for what they can actually display; the encoder serves the largest
+  // request and everyone shares that encode.
+  svr.Get("/live.jpg", [this](const httplib::Request &req,
                               httplib::Response &res) {
+    setDemand(kPollDemandId,
+              intParam(req, "w", kDefaultWidth, kMinWidth, kMaxWidth),
+              intParam(req, "q", kDefaultQuality, 20, 95),
+              std::chrono::steady_clock::now() + std::chrono::seconds(5));
+
+    uint64_t seq;
+    {
+      std::lock_guard<std::mutex> lock(jpegMutex_);
+      seq = captureSeq_;
+    }
     needsCapture_ = true;
-    for (int i = 0; i < 10; ++i) {
-      {
-        std::lock_guard<std::mutex> lock(jpegMutex_);
-        if (!latestJpeg_.empty()) {
-          res.set_content(reinterpret_cast<const char *>(latestJpeg_.data()),
-                          latestJpeg_.size(), "image/jpeg");
-          return;
-        }
+    // Prefer a fresh capture, but fall back to the last frame if the render
+    // loop is slow to pick up the request.
+    JpegPtr jpeg = waitForFrame(seq, std::chrono::milliseconds(300), true);
+    if (!jpeg) {
+      res.status = 503;
+      return;
+    }
+    res.set_content(reinterpret_cast<const char *>(jpeg->data()), jpeg->size(),
+                    "image/jpeg");
+  });
+
+  // Multipart MJPEG push stream. Each client gets the newest frame as soon as
+  // it is encoded, limited to its requested ?fps= (1-15, default 5). Frames
+  // that arrive while a client is still sending are skipped, never queued.
+  svr.Get("/stream.mjpg", [this](const httplib::Request &req,
+                                 httplib::Response &res) {
+    int fps = intParam(req, "fps", 5, 1, 15);
+    int width = intParam(req, "w", kDefaultWidth, kMinWidth, kMaxWidth);
+    int quality = intParam(req, "q", kDefaultQuality, 20, 95);
+
+    int id;
+    {
+      std::lock_guard<std::mutex> lock(jpegMutex_);
+      // Each stream pins one HTTP worker thread; keep some for everything else
+      if (static_cast<int>(streamFps_.size()) >= kMaxStreamClients) {
+        res.status = 503;
+        res.set_content("too many stream clients", "text/plain");
+        return;
       }
-      std::this_thread::sleep_for(std::chrono::milliseconds(30));
+      id = nextStreamId_++;
+      streamFps_[id] = fps;
+      int demand = 0;
+      for (const auto &[_, f] : streamFps_)
+        demand = std::max(demand, f);
+      streamDemandFps_ = demand;
     }
-    res.status = 503;
+    setDemand(id, width, quality, std::chrono::steady_clock::time_point::max());
+
+    struct ClientState {
+      uint64_t seq = 0;
+      std::chrono::steady_clock::time_point nextSend{};
+    };
+    auto client = std::make_shared<ClientState>();
+    auto interval = std::chrono::milliseconds(1000 / fps);
+
+    res.set_header("Cache-Control", "no-cache, no-store");
+    res.set_content_provider(
+        "multipart/x-mixed-replace; boundary=hamclockframe",
+        [this, client, interval](size_t, httplib::DataSink &sink) {
+          auto now = std::chrono::steady_clock::now();
+          if (now < client->nextSend)
+            std::this_thread::sleep_for(client->nextSend - now);
+
+          JpegPtr jpeg;
+          while (running_ && sink.is_writable()) {
+            uint64_t prev = client->seq;
+            jpeg = waitForFrame(client->seq, std::chrono::milliseconds(1000));
+            if (jpeg && client->seq != prev)
+              break;
+            jpeg.reset();
+          }
+          if (!jpeg)
+            return false;
+
+          char header[128];
+          int n = std::snprintf(header, sizeof(header),
+                                "--hamclockframe\r\n"
+                                "Content-Type: image/jpeg\r\n"
+                                "Content-Length: %zu\r\n\r\n",
+                                jpeg->size());
+          if (!sink.write(header, static_cast<size_t>(n)) ||
+              !sink.write(reinterpret_cast<const char *>(jpeg->data()),
+                          jpeg->size()) ||
+              !sink.write("\r\n", 2))
+            return false;
+
+          client->nextSend = std::chrono::steady_clock::now() + interval;
+          return true;
+        },
+        [this, id](bool) {
+          setDemand(id, 0, 0, {});
+          std::lock_guard<std::mutex> lock(jpegMutex_);
+          streamFps_.erase(id);
+          int demand = 0;
+          for (const auto &[_, f] : streamFps_)
+            demand = std::max(demand, f);
+          streamDemandFps_ = demand;
+        });
   });
 
   svr.Get("/set_touch",
@@ -478,6 +920,130 @@ void WebServer::run() {
     res.set_content(out, "text/plain");
   });
 
+  // Spot archive queries
+  svr.Get("/api/archive/call",
+          [this](const httplib::Request &req, httplib::Response &res) {
+            if (!archive_) {
+              res.status = 503;
+              return;
+            }
+            if (!req.has_param("call")) {
+              res.status = 400;
+              res.set_content("missing call", "text/plain");
+              return;
+            }
+            std::string call = req.get_param_value("call");
+            std::transform(call.begin(), call.end(), call.begin(), ::toupper);
+            int days = req.has_param("days")
+                           ? std::atoi(req.get_param_value("days").c_str())
+                           : SpotArchive::kRawDays;
+            int limit = req.has_param("limit")
+                            ? std::atoi(req.get_param_value("limit").c_str())
+                            : 50;
+            days = std::clamp(days, 1, SpotArchive::kSummaryDays);
+            limit = std::clamp(limit, 0, 1000);
+
+            auto started = std::chrono::steady_clock::now();
+            CallHistory h = archive_->callHistory(call, days, limit);
+            nlohmann::json j;
+            j["call"] = call;
+            j["days"] = days;
+            j["daysHeard"] = h.daysHeard;
+            j["totalSpots"] = h.totalSpots;
+            j["firstAt"] = h.firstAt;
+            j["lastAt"] = h.lastAt;
+            nlohmann::json bands = nlohmann::json::array();
+            for (int b = 0; b < kNumBands; ++b) {
+              if (h.bands & (1u << b))
+                bands.push_back(kBands[b].name);
+            }
+            j["bands"] = bands;
+            nlohmann::json spots = nlohmann::json::array();
+            for (const auto &s : h.spots) {
+              spots.push_back({{"spotter", s.spotter},
+                               {"freqKhz", s.freqKhz},
+                               {"mode", spotModeName(s.mode)},
+                               {"spottedAt", s.spottedAt}});
+            }
+            j["spots"] = spots;
+            j["queryMs"] = std::chrono::duration<double, std::milli>(
+                               std::chrono::steady_clock::now() - started)
+                               .count();
+            res.set_content(j.dump(), "application/json");
+          });
+
+  svr.Get("/api/archive/activity",
+          [this](const httplib::Request &req, httplib::Response &res) {
+            if (!archive_) {
+              res.status = 503;
+              return;
+            }
+            int band = -1;
+            if (req.has_param("band")) {
+              std::string name = req.get_param_value("band");
+              for (int b = 0; b < kNumBands; ++b) {
+                if (name == kBands[b].name)
+                  band = b;
+              }
+              if (band < 0) {
+                res.status = 400;
+                res.set_content("unknown band", "text/plain");
+                return;
+              }
+            }
+            // Unknown (or missing) continents match any.
+            Continent from = continentFromName(req.get_param_value("from"));
+            Continent to = continentFromName(req.get_param_value("to"));
+            int days = req.has_param("days")
+                           ? std::atoi(req.get_param_value("days").c_str())
+                           : SpotArchive::kRawDays;
+            days = std::clamp(days, 1, SpotArchive::kSummaryDays);
+
+            auto started = std::chrono::steady_clock::now();
+            HourlyActivity a = archive_->hourlyActivity(band, from, to, days);
+            nlohmann::json j;
+            j["band"] = band >= 0 ? kBands[band].name : "all";
+            j["from"] = continentName(from);
+            j["to"] = continentName(to);
+            j["days"] = days;
+            j["hours"] = a.hours;
+            j["total"] = a.total;
+            j["queryMs"] = std::chrono::duration<double, std::milli>(
+                               std::chrono::steady_clock::now() - started)
+                               .count();
+            res.set_content(j.dump(), "application/json");
+          });
+
+  svr.Get("/api/archive/entity",
+          [this](const httplib::Request &req, httplib::Response &res) {
+            if (!archive_) {
+              res.status = 503;
+              return;
+            }
+            int dxcc = req.has_param("dxcc")
+                           ? std::atoi(req.get_param_value("dxcc").c_str())
+                           : 0;
+            if (dxcc <= 0) {
+              res.status = 400;
+              res.set_content("missing dxcc", "text/plain");
+              return;
+            }
+            nlohmann::json bands = nlohmann::json::array();
+            for (const auto &e : archive_->lastSpotted(dxcc)) {
+              bands.push_back(
+                  {{"band", e.band >= 0 && e.band < kNumBands
+                                ? kBands[e.band].name
+                                : "?"},
+                   {"call", e.call},
+                   {"freqKhz", e.freqKhz},
+                   {"spottedAt", e.spottedAt}});
+            }
+            nlohmann::json j;
+            j["dxcc"] = dxcc;
+            j["bands"] = bands;
+            res.set_content(j.dump(), "application/json");
+          });
+
   // Programmatic set DE/DX via lat/lon
   svr.Get("/set_mappos",
           [this](const httplib::Request &req, httplib::Response &res) {
@@ -618,15 +1184,15 @@ void WebServer::run() {
   svr.Get("/debug/store/set_solar",
           [this](const httplib::Request &req, httplib::Response &res) {
             if (solar_) {
-              SolarData data = solar_->get();
-              if (req.has_param("sfi"))
-                data.sfi = std::stoi(req.get_param_value("sfi"));
-              if (req.has_param("k"))
-                data.k_index = std::stoi(req.get_param_value("k"));
-              if (req.has_param("sn"))
-                data.sunspot_number = std::stoi(req.get_param_value("sn"));
-              data.valid = true;
-              solar_->set(data);
+              solar_->update([&](SolarData &data) {
+                if (req.has_param("sfi"))
+                  data.sfi = std::stoi(req.get_param_value("sfi"));
+                if (req.has_param("k"))
+                  data.k_index = std::stoi(req.get_param_value("k"));
+                if (req.has_param("sn"))
+                  data.sunspot_number = std::stoi(req.get_param_value("sn"));
+                data.valid = true;
+              });
               res.set_content("ok", "text/plain");
             } else {
               res.status = 503;
@@ -643,6 +1209,27 @@ void WebServer::run() {
             res.set_content(j.dump(2), "application/json");
           });
 
+  svr.Get("/debug/trace", [](const httplib::Request &req,
+                             httplib::Response &res) {
+    int seconds = 5;
+    if (req.has_param("seconds"))
+      seconds = std::clamp(std::atoi(req.get_param_value("seconds").c_str()),
+                           1, 60);
+
+    auto &tracer = Tracer::instance();
+    if (!tracer.start()) {
+      res.status = 409;
+      res.set_content("trace capture already running", "text/plain");
+      return;
+    }
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    tracer.stop();
+
+    res.set_header("Content-Disposition",
+                   "attachment; filename=\"hamclock-trace.json\"");
+    res.set_content(tracer.exportJson(), "application/json");
+  });
+
   svr.Get("/debug/logs", [](const httplib::Request &, httplib::Response &res) {
     nlohmann::json j;
     j["status"] = "OK";
@@ -651,22 +1238,57 @@ void WebServer::run() {
     res.set_content(j.dump(2), "application/json");
   });
 
-  svr.Get("/debug/health", [this](const httplib::Request &,
-                                  httplib::Response &res) {
+  svr.Get("/debug/changes", [](const httplib::Request &,
+                               httplib::Response &res) {
+    // Per-topic store versions, so clients can poll cheaply and refetch only
+    // what changed.
     nlohmann::json j;
-    for (const auto &[name, status] : state_->services) {
+    auto &bus = ChangeBus::instance();
+    for (size_t t = 0; t < ChangeBus::kNumTopics; ++t) {
+      auto topic = static_cast<ChangeBus::Topic>(t);
+      j[ChangeBus::topicName(topic)] = bus.version(topic);
+    }
+    res.set_content(j.dump(2), "application/json");
+  });
+
+  svr.Get("/debug/workers", [](const httplib::Request &,
+                               httplib::Response &res) {
+    nlohmann::json j = nlohmann::json::object();
+    for (const auto &q : WorkerPool::instance().stats()) {
+      j[q.name] = {{"workers", q.workers},     {"depth", q.depth},
+                   {"running", q.running},     {"submitted", q.submitted},
+                   {"completed", q.completed}, {"cancelled", q.cancelled},
+                   {"avgWaitMs", q.avgWaitMs}, {"maxWaitMs", q.maxWaitMs},
+                   {"avgRunMs", q.avgRunMs}};
+    }
+    res.set_content(j.dump(2), "application/json");
+  });
+
+  svr.Get("/debug/health", [](const httplib::Request &,
+                              httplib::Response &res) {
+    auto fmtTime = [](std::chrono::system_clock::time_point tp) {
+      auto t = std::chrono::system_clock::to_time_t(tp);
+      std::tm tm_utc{};
+      Astronomy::portable_gmtime(&t, &tm_utc);
+      std::stringstream ss;
+      ss << std::put_time(&tm_utc, "%Y-%m-%d %H:%M:%S");
+      return ss.str();
+    };
+    nlohmann::json j = nlohmann::json::object();
+    for (const auto &h : ServiceHealthRegistry::instance().snapshot()) {
       nlohmann::json s;
-      s["ok"] = status.ok;
-      s["lastError"] = status.lastError;
-      if (status.lastSuccess.time_since_epoch().count() > 0) {
-        auto t = std::chrono::system_clock::to_time_t(status.lastSuccess);
-        std::tm tm_utc{};
-        Astronomy::portable_gmtime(&t, &tm_utc);
-        std::stringstream ss;
-        ss << std::put_time(&tm_utc, "%Y-%m-%d %H:%M:%S");
-        s["lastSuccess"] = ss.str();
-      }
-      j[name] = s;
+      s["ok"] = h.ok;
+      s["reported"] = h.reported;
+      s["lastError"] = h.lastError;
+      s["consecutiveFailures"] = h.consecutiveFailures;
+      s["successes"] = h.successes;
+      s["failures"] = h.failures;
+      s["latencyMs"] = h.latencyMs;
+      if (h.lastSuccess.time_since_epoch().count() > 0)
+        s["lastSuccess"] = fmtTime(h.lastSuccess);
+      if (h.lastFailure.time_since_epoch().count() > 0)
+        s["lastFailure"] = fmtTime(h.lastFailure);
+      j[h.name] = s;
     }
     res.set_content(j.dump(2), "application/json");
   });
@@ -2,33 +2,46 @@
 
 #include <SDL.h>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <thread>
 #include <vector>
 
+#include "../core/ChangeBus.h"
+
 struct AppConfig;
 struct HamClockState;
 class ConfigManager;
 class WatchlistStore;
 class SolarDataStore;
+class SpotArchive;
+class RemoteViewServer;
 
 class WebServer {
 public:
   WebServer(SDL_Renderer *renderer, AppConfig &cfg, HamClockState &state,
             ConfigManager &cfgMgr,
             std::shared_ptr<WatchlistStore> watchlist = nullptr,
-            std::shared_ptr<SolarDataStore> solar = nullptr, int port = 8080);
+            std::shared_ptr<SolarDataStore> solar = nullptr,
+            std::shared_ptr<SpotArchive> archive = nullptr, int port = 8080);
   ~WebServer();
 
   void start();
   void stop();
 
-  // Call this once per frame from main thread to update the web mirror
-  void updateFrame();
+  // Call this once per frame from main thread to update the web mirror.
+  // Only copies pixels out of the renderer; encoding happens on a worker.
+  // 'frameDirty' is false when neither input nor the clock changed anything;
+  // such idle frames are read back at most once a second unless a store
+  // announced new data in the meantime.
+  void updateFrame(bool frameDirty = true);
 
 private:
   void run();
+  void encodeLoop();
 
   SDL_Renderer *renderer_;
   AppConfig *cfg_;
@@ -36,16 +49,78 @@ private:
   ConfigManager *cfgMgr_;
   std::shared_ptr<WatchlistStore> watchlist_;
   std::shared_ptr<SolarDataStore> solar_;
+  std::shared_ptr<SpotArchive> archive_;
   int port_;
   std::thread thread_;
   std::atomic<bool> running_{false};
 
-  // The latest captured JPEG
-  std::vector<unsigned char> latestJpeg_;
+  using JpegPtr = std::shared_ptr<const std::vector<unsigned char>>;
+
+  // Waits until a frame newer than 'afterSeq' is available (or the timeout
+  // expires) and returns the latest one, updating 'afterSeq'. With
+  // 'anyCapture' set, an unchanged capture also counts as new.
+  JpegPtr waitForFrame(uint64_t &afterSeq, std::chrono::milliseconds timeout,
+                       bool anyCapture = false);
+  uint32_t captureIntervalMs() const;
+
+  // What connected clients asked for; the encoder serves the most demanding
+  // one and every client shares that single encode.
+  struct ClientDemand {
+    int width;
+    int quality;
+    std::chrono::steady_clock::time_point expires;
+  };
+  void setDemand(int id, int width, int quality,
+                 std::chrono::steady_clock::time_point expires);
+  ClientDemand currentDemand();
+
+  // The latest captured JPEG. Shared so streaming clients can write it out
+  // without holding the lock or copying.
+  JpegPtr latestJpeg_;
+  uint64_t frameSeq_ = 0;   // bumped when a changed frame is published
+  uint64_t captureSeq_ = 0; // bumped after every capture, changed or not
   std::mutex jpegMutex_;
+  std::condition_variable frameCv_;
+  std::map<int, ClientDemand> demand_;
+
+  // Active /stream.mjpg clients and the frame rate each one asked for.
+  static constexpr int kMaxStreamClients = 4;
+  static constexpr int kDefaultWidth = 1600;
+  static constexpr int kMinWidth = 200;
+  static constexpr int kMaxWidth = 7680;
+  static constexpr int kDefaultQuality = 70;
+  static constexpr int kRemoteViewFps = 5;
+  static constexpr int kPollDemandId = -1;
+  std::map<int, int> streamFps_;
+  int nextStreamId_ = 0;
+  std::atomic<int> streamDemandFps_{0};
+
+  // Pixel buffers cycle main thread -> pending -> encoder -> pool. With three
+  // of them the render loop never waits; if the encoder falls behind the
+  // pending frame is replaced and the stale one goes straight back.
+  struct PixelBuffer {
+    std::vector<unsigned char> pixels; // RGB24, tightly packed
+    int w = 0;
+    int h = 0;
+  };
+  static constexpr int kPixelBuffers = 3;
+  std::vector<std::unique_ptr<PixelBuffer>> freeBuffers_;
+  std::unique_ptr<PixelBuffer> pendingBuffer_;
+  std::mutex captureMutex_;
+  std::condition_variable captureCv_;
+  std::thread encoderThread_;
+  uint64_t lastPixelHash_ = 0; // encoder thread only
+
+  // Tile delta view over WebSocket, served on port_ + 1
+  std::unique_ptr<RemoteViewServer> remote_;
 
   // Timing to avoid capturing every single frame if no one is watching
   uint32_t lastCaptureTicks_ = 0;
   std::atomic<bool> needsCapture_{true};
+  static constexpr uint32_t kIdleCaptureMs = 1000;
+
+  // Any store change forces the next capture. Main thread only.
+  std::vector<ChangeBus::Subscription> changeSubs_;
+  bool storesChanged_ = true;
   void *svrPtr_ = nullptr; // httplib::Server*
 };
@@ -1,70 +1,226 @@
 #include "ADIFProvider.h"
-#include <fstream>
+#include "../core/LiveSpotData.h"
+#include "../core/Logger.h"
 
-ADIFProvider::ADIFProvider(std::shared_ptr<ADIFStore> store)
-    : store_(std::move(store)) {}
+#include <charconv>
+#include <cstdlib>
 
-void ADIFProvider::fetch(const std::filesystem::path &path) {
-  if (std::filesystem::exists(path)) {
-    processFile(path);
+namespace {
+
+constexpr size_t kReadChunk = 1 << 16;
+
+bool iequals(std::string_view a, std::string_view b) {
+  if (a.size() != b.size())
+    return false;
+  for (size_t i = 0; i < a.size(); ++i) {
+    char x = a[i], y = b[i];
+    if (x >= 'a' && x <= 'z')
+      x = static_cast<char>(x - 'a' + 'A');
+    if (y >= 'a' && y <= 'z')
+      y = static_cast<char>(y - 'a' + 'A');
+    if (x != y)
+      return false;
   }
+  return true;
 }
 
-static std::string getTagContent(const std::string &line,
-                                 const std::string &tag) {
-  size_t pos = line.find("<" + tag + ":");
-  if (pos == std::string::npos)
-    return "";
-
-  size_t colon = line.find(":", pos);
-  size_t close = line.find(">", colon);
-  if (colon == std::string::npos || close == std::string::npos)
-    return "";
-
-  try {
-    int len = std::stoi(line.substr(colon + 1, close - colon - 1));
-    return line.substr(close + 1, len);
-  } catch (...) {
-    return "";
+// BAND is e.g. "20m" or "20M"; without it, FREQ in MHz.
+int adifBandIndex(std::string_view band, std::string_view freq) {
+  for (int i = 0; i < kNumBands; ++i) {
+    if (iequals(band, kBands[i].name))
+      return i;
   }
+  if (freq.empty())
+    return -1;
+  double mhz = std::strtod(std::string(freq).c_str(), nullptr);
+  return freqToBandIndex(mhz * 1000.0);
 }
 
-void ADIFProvider::processFile(const std::filesystem::path &path) {
-  std::ifstream file(path);
+} // namespace
+
+ADIFProvider::ADIFProvider(std::shared_ptr<ADIFStore> store,
+                           std::shared_ptr<WorkedMatrix> worked,
+                           PrefixManager *pm)
+    : store_(std::move(store)), worked_(std::move(worked)), pm_(pm) {}
+
+void ADIFProvider::reset() {
+  offset_ = 0;
+  pending_.clear();
+  tail_.clear();
+  stats_ = ADIFStats();
+  if (worked_)
+    worked_->clear();
+}
+
+bool ADIFProvider::fetch(const std::filesystem::path &path) {
+  std::error_code ec;
+  uintmax_t size = std::filesystem::file_size(path, ec);
+  if (ec)
+    return false;
+
+  if (path == path_ && size == offset_ && stats_.valid)
+    return false;
+
+  std::ifstream file(path, std::ios::binary);
   if (!file.is_open())
-    return;
+    return false;
 
-  ADIFStats stats;
-  std::string line;
-  std::string record;
-
-  while (std::getline(file, line)) {
-    size_t eor = line.find("<EOR>");
-    if (eor != std::string::npos) {
-      record += line.substr(0, eor);
-
-      std::string call = getTagContent(record, "CALL");
-      std::string mode = getTagContent(record, "MODE");
-      std::string band = getTagContent(record, "BAND");
-
-      if (!call.empty()) {
-        stats.totalQSOs++;
-        if (!mode.empty())
-          stats.modeCounts[mode]++;
-        if (!band.empty())
-          stats.bandCounts[band]++;
-
-        stats.latestCalls.insert(stats.latestCalls.begin(), call);
-        if (stats.latestCalls.size() > 5)
-          stats.latestCalls.pop_back();
-      }
-
-      record = line.substr(eor + 5);
-    } else {
-      record += line + " ";
+  bool restarted = false;
+  if (path != path_ || size < offset_ || !sameTail(file)) {
+    if (!path_.empty())
+      LOG_I("ADIF", "{} was rewritten, reading it again", path.string());
+    reset();
+    path_ = path;
+    restarted = true;
+  }
+  file.clear();
+  file.seekg(static_cast<std::streamoff>(offset_));
+
+  int added = 0;
+  std::string chunk(kReadChunk, '\0');
+  while (file.read(chunk.data(), chunk.size()) || file.gcount() > 0) {
+    auto n = static_cast<size_t>(file.gcount());
+    pending_.append(chunk.data(), n);
+    offset_ += n;
+    tail_.append(chunk.data(), n);
+    if (tail_.size() > kTailBytes)
+      tail_.erase(0, tail_.size() - kTailBytes);
+    added += parsePending();
+  }
+
+  stats_.valid = true;
+  store_->update(stats_);
+  if (added > 0) {
+    LOG_I("ADIF", "Read {} QSOs from {}, {} in total, {} entities worked",
+          added, path.filename().string(), stats_.totalQSOs,
+          worked_ ? worked_->entityCount() : 0);
+  }
+  return added > 0 || restarted;
+}
+
+bool ADIFProvider::sameTail(std::ifstream &file) {
+  if (tail_.empty())
+    return true;
+  std::string now(tail_.size(), '\0');
+  file.seekg(static_cast<std::streamoff>(offset_ - tail_.size()));
+  return file.read(now.data(), now.size()) && now == tail_;
+}
+
+template <typename Fn>
+size_t ADIFProvider::parseRecords(std::string_view text, Fn &&fn) {
+  // Values of the record being read; they point into 'text'.
+  Record rec;
+  size_t pos = 0;
+  size_t consumed = 0; // end of the last complete record or header
+
+  // <NAME:LENGTH[:TYPE]>value ... <EOR>. Lengths are honoured, so values
+  // may contain '<'.
+  for (;;) {
+    size_t lt = text.find('<', pos);
+    if (lt == std::string_view::npos)
+      break;
+    size_t gt = text.find('>', lt);
+    if (gt == std::string_view::npos)
+      break; // tag not complete yet
+    std::string_view spec = text.substr(lt + 1, gt - lt - 1);
+    size_t colon = spec.find(':');
+    std::string_view name = spec.substr(0, colon);
+    size_t len = 0;
+    if (colon != std::string_view::npos) {
+      std::string_view lenText = spec.substr(colon + 1);
+      lenText = lenText.substr(0, lenText.find(':'));
+      if (std::from_chars(lenText.data(), lenText.data() + lenText.size(),
+                          len)
+              .ec != std::errc())
+        len = 0;
+    }
+    size_t valueStart = gt + 1;
+    if (valueStart + len > text.size())
+      break; // value not complete yet
+    std::string_view value = text.substr(valueStart, len);
+    pos = valueStart + len;
+
+    bool eor = iequals(name, "EOR");
+    if (eor || iequals(name, "EOH")) {
+      if (eor && !rec.call.empty())
+        fn(rec);
+      rec = Record();
+      consumed = pos;
+    } else if (iequals(name, "CALL")) {
+      rec.call = value;
+    } else if (iequals(name, "BAND")) {
+      rec.band = value;
+    } else if (iequals(name, "FREQ")) {
+      rec.freq = value;
+    } else if (iequals(name, "MODE")) {
+      rec.mode = value;
+    } else if (iequals(name, "DXCC")) {
+      rec.dxcc = value;
     }
   }
+  return consumed;
+}
+
+int ADIFProvider::parsePending() {
+  int added = 0;
+  size_t consumed = parseRecords(pending_, [&](const Record &rec) {
+    addRecord(rec);
+    added++;
+  });
+  pending_.erase(0, consumed);
+  return added;
+}
+
+int ADIFProvider::addLogged(std::string_view adif) {
+  int added = 0;
+  parseRecords(adif, [&](const Record &rec) {
+    recordWorked(rec);
+    added++;
+  });
+  return added;
+}
+
+void ADIFProvider::addWorked(std::string_view call, double freqKhz,
+                             std::string_view mode) {
+  int band = freqToBandIndex(freqKhz);
+  Record rec;
+  rec.call = call;
+  if (band >= 0)
+    rec.band = kBands[band].name;
+  rec.mode = mode;
+  recordWorked(rec);
+}
+
+void ADIFProvider::addRecord(const Record &rec) {
+  stats_.totalQSOs++;
+  if (!rec.mode.empty())
+    stats_.modeCounts[std::string(rec.mode)]++;
+  if (!rec.band.empty())
+    stats_.bandCounts[std::string(rec.band)]++;
+  stats_.latestCalls.insert(stats_.latestCalls.begin(),
+                            std::string(rec.call));
+  if (stats_.latestCalls.size() > 5)
+    stats_.latestCalls.pop_back();
+  recordWorked(rec);
+}
 
-  stats.valid = true;
-  store_->update(stats);
+void ADIFProvider::recordWorked(const Record &rec) {
+  if (!worked_)
+    return;
+  // DXCC 0 is logged for QSOs with no entity, e.g. /MM.
+  int entity = 0;
+  std::from_chars(rec.dxcc.data(), rec.dxcc.data() + rec.dxcc.size(),
+                  entity);
+  if (rec.dxcc.empty() && pm_) {
+    LatLong ll;
+    pm_->findLocation(std::string(rec.call), ll, &entity);
+  }
+  int modeCls = -1;
+  if (!rec.mode.empty()) {
+    SpotMode m = spotModeFromName(rec.mode);
+    // Modes spots never name (MFSK, PKT, ...) are all data.
+    modeCls = m == SpotMode::Unknown ? WorkedMatrix::Data
+                                     : WorkedMatrix::modeClass(m);
+  }
+  worked_->record(entity, adifBandIndex(rec.band, rec.freq), modeCls);
 }
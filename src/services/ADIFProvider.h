@@ -1,17 +1,65 @@
 #pragma once
 
 #include "../core/ADIFData.h"
+#include "../core/PrefixManager.h"
+#include "../core/WorkedMatrix.h"
+#include <cstdint>
 #include <filesystem>
+#include <fstream>
 #include <memory>
+#include <string>
+#include <string_view>
 
+// Reads the ADIF log into ADIFStats and, optionally, a WorkedMatrix.
+//
+// The file is read incrementally: fetch() only parses bytes appended since
+// the last call, so it is cheap enough to poll every few seconds while a
+// logger appends QSOs. A file that shrank, or whose last bytes read have
+// changed, was rewritten and is read again from the start.
 class ADIFProvider {
 public:
-  ADIFProvider(std::shared_ptr<ADIFStore> store);
+  // 'pm' resolves the entity of QSOs that carry no DXCC field.
+  ADIFProvider(std::shared_ptr<ADIFStore> store,
+               std::shared_ptr<WorkedMatrix> worked = nullptr,
+               PrefixManager *pm = nullptr);
 
-  void fetch(const std::filesystem::path &path);
+  // Returns true if new QSOs were read or the log was read from scratch.
+  bool fetch(const std::filesystem::path &path);
+  // Marks the QSOs in an ADIF snippet, e.g. from a WSJT-X Logged ADIF
+  // message, as worked before they reach the log file. The stats are left
+  // to the file. Returns the number of QSOs.
+  int addLogged(std::string_view adif);
+  // The same for one QSO already taken apart, e.g. from a contest logger's
+  // broadcast.
+  void addWorked(std::string_view call, double freqKhz, std::string_view mode);
 
 private:
-  void processFile(const std::filesystem::path &path);
+  static constexpr size_t kTailBytes = 64;
+
+  struct Record {
+    std::string_view call, band, freq, mode, dxcc;
+  };
+
+  // Calls 'fn' for each complete record in 'text' and returns how many
+  // bytes the complete records and header took.
+  template <typename Fn> static size_t parseRecords(std::string_view text,
+                                                    Fn &&fn);
+  // Parses complete records at the front of pending_ and drops them.
+  // Returns the number of QSOs added.
+  int parsePending();
+  void addRecord(const Record &rec);
+  void recordWorked(const Record &rec);
+  void reset();
+  // Whether the bytes before offset_ are still the ones read last time.
+  bool sameTail(std::ifstream &file);
 
   std::shared_ptr<ADIFStore> store_;
+  std::shared_ptr<WorkedMatrix> worked_;
+  PrefixManager *pm_;
+
+  std::filesystem::path path_;
+  uintmax_t offset_ = 0;
+  std::string pending_; // bytes after the last complete record
+  std::string tail_;    // the last bytes read, up to kTailBytes
+  ADIFStats stats_;
 };
@@ -1,4 +1,5 @@
 #include "ActivityProvider.h"
+#include "../core/Tracer.h"
 #include <iostream>
 #include <nlohmann/json.hpp>
 
@@ -15,14 +16,14 @@ void ActivityProvider::fetch() {
 }
 
 void ActivityProvider::fetchDXPeds() {
-  net_.fetchAsync(DX_PEDS_URL, [this](std::string data) {
+  fetches_.add(net_.fetchAsync(DX_PEDS_URL, [this](std::string data) {
+    TRACE_SCOPE("provider", "ActivityProvider::parseDXPeds");
     if (data.empty()) {
       std::cerr << "Failed to fetch DXPeditions from NG3K" << std::endl;
       return;
     }
 
-    ActivityData current = store_->get();
-    current.dxpeds.clear();
+    std::vector<DXPedition> dxpeds;
 
     // Lightweight HTML scraping
     size_t pos = 0;
@@ -101,21 +102,24 @@ void ActivityProvider::fetchDXPeds() {
 
           auto yesterday = now - std::chrono::hours(24);
           if (de.endTime > yesterday) {
-            current.dxpeds.push_back(de);
+            dxpeds.push_back(de);
           }
         }
       }
       pos += 16;
     }
 
-    current.lastUpdated = now;
-    current.valid = true;
-    store_->set(current);
-  });
+    store_->update([&](ActivityData &current) {
+      current.dxpeds = std::move(dxpeds);
+      current.lastUpdated = now;
+      current.valid = true;
+    });
+  }));
 }
 
 void ActivityProvider::fetchPOTA() {
-  net_.fetchAsync(POTA_API_URL, [this](std::string data) {
+  fetches_.add(net_.fetchAsync(POTA_API_URL, [this](std::string data) {
+    TRACE_SCOPE("provider", "ActivityProvider::parsePOTA");
     if (data.empty())
       return;
     try {
@@ -123,20 +127,7 @@ void ActivityProvider::fetchPOTA() {
       if (!j.is_array())
         return;
 
-      ActivityData current = store_->get();
-      // Only clear ONTA spots if this is the first one or we want to merge them
-      // carefully
-      // For now, let's keep it simple and just clear and re-add from both SOTA
-      // and POTA
-      // Actually, we should probably have separate lists or clear only when
-      // starting a full cycle
-
-      // Let's filter existing spots to remove POTA ones and re-add fresh
-      auto it =
-          std::remove_if(current.ontaSpots.begin(), current.ontaSpots.end(),
-                         [](const ONTASpot &s) { return s.program == "POTA"; });
-      current.ontaSpots.erase(it, current.ontaSpots.end());
-
+      std::vector<ONTASpot> spots;
       for (const auto &spot : j) {
         ONTASpot os;
         os.program = "POTA";
@@ -152,18 +143,27 @@ void ActivityProvider::fetchPOTA() {
         os.spottedAt = std::chrono::system_clock::now();
 
         if (!os.call.empty()) {
-          current.ontaSpots.push_back(os);
+          spots.push_back(os);
         }
       }
-      current.lastUpdated = std::chrono::system_clock::now();
-      store_->set(current);
+      // SOTA and POTA share ontaSpots: swap out only this program's entries.
+      store_->update([&](ActivityData &current) {
+        auto it = std::remove_if(
+            current.ontaSpots.begin(), current.ontaSpots.end(),
+            [](const ONTASpot &s) { return s.program == "POTA"; });
+        current.ontaSpots.erase(it, current.ontaSpots.end());
+        current.ontaSpots.insert(current.ontaSpots.end(), spots.begin(),
+                                 spots.end());
+        current.lastUpdated = std::chrono::system_clock::now();
+      });
     } catch (...) {
     }
-  });
+  }));
 }
 
 void ActivityProvider::fetchSOTA() {
-  net_.fetchAsync(SOTA_API_URL, [this](std::string data) {
+  fetches_.add(net_.fetchAsync(SOTA_API_URL, [this](std::string data) {
+    TRACE_SCOPE("provider", "ActivityProvider::parseSOTA");
     if (data.empty())
       return;
     try {
@@ -171,12 +171,7 @@ void ActivityProvider::fetchSOTA() {
       if (!j.is_array())
         return;
 
-      ActivityData current = store_->get();
-      auto it =
-          std::remove_if(current.ontaSpots.begin(), current.ontaSpots.end(),
-                         [](const ONTASpot &s) { return s.program == "SOTA"; });
-      current.ontaSpots.erase(it, current.ontaSpots.end());
-
+      std::vector<ONTASpot> spots;
       for (const auto &spot : j) {
         ONTASpot os;
         os.program = "SOTA";
@@ -193,12 +188,20 @@ void ActivityProvider::fetchSOTA() {
         os.spottedAt = std::chrono::system_clock::now();
 
         if (!os.call.empty()) {
-          current.ontaSpots.push_back(os);
+          spots.push_back(os);
         }
       }
-      current.lastUpdated = std::chrono::system_clock::now();
-      store_->set(current);
+      // SOTA and POTA share ontaSpots: swap out only this program's entries.
+      store_->update([&](ActivityData &current) {
+        auto it = std::remove_if(
+            current.ontaSpots.begin(), current.ontaSpots.end(),
+            [](const ONTASpot &s) { return s.program == "SOTA"; });
+        current.ontaSpots.erase(it, current.ontaSpots.end());
+        current.ontaSpots.insert(current.ontaSpots.end(), spots.begin(),
+                                 spots.end());
+        current.lastUpdated = std::chrono::system_clock::now();
+      });
     } catch (...) {
     }
-  });
+  }));
 }
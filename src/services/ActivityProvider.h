@@ -24,4 +24,6 @@ private:
   static constexpr const char *POTA_API_URL = "https://api.pota.app/spot";
   static constexpr const char *SOTA_API_URL =
       "https://api2.sota.org.uk/api/spots/50";
+
+  FetchGroup fetches_;
 };
@@ -1,14 +1,16 @@
 #include "AuroraProvider.h"
+#include "../core/Tracer.h"
 
 AuroraProvider::AuroraProvider(NetworkManager &net) : net_(net) {}
 
-void AuroraProvider::fetch(bool north, DataCb cb) {
+FetchHandle AuroraProvider::fetch(bool north, DataCb cb) {
   const char *url = north ? "https://services.swpc.noaa.gov/images/"
                             "aurora-forecast-northern-hemisphere.jpg"
                           : "https://services.swpc.noaa.gov/images/"
                             "aurora-forecast-southern-hemisphere.jpg";
 
-  net_.fetchAsync(url, [cb](std::string body) {
+  return net_.fetchAsync(url, [cb](std::string body) {
+    TRACE_SCOPE("provider", "AuroraProvider::parse");
     if (!body.empty()) {
       cb(body);
     }
@@ -11,7 +11,7 @@ public:
   AuroraProvider(NetworkManager &net);
 
   // Fetch aurora forecast (North or South)
-  void fetch(bool north, DataCb cb);
+  [[nodiscard]] FetchHandle fetch(bool north, DataCb cb);
 
 private:
   NetworkManager &net_;
@@ -0,0 +1,59 @@
+#include "BandActivityProvider.h"
+#include "../core/LiveSpotData.h"
+#include "../core/Logger.h"
+#include "../core/Tracer.h"
+
+#include <chrono>
+#include <ctime>
+#include <string>
+
+BandActivityProvider::BandActivityProvider(
+    std::shared_ptr<BandActivityMatrix> matrix,
+    std::shared_ptr<BandActivityStore> store,
+    std::shared_ptr<WatchlistHitStore> hits, const AppConfig &config)
+    : matrix_(std::move(matrix)), store_(std::move(store)),
+      hits_(std::move(hits)), alerts_(config.openingAlerts) {
+  std::string filterError;
+  if (!alertFilter_.compile(config.spotFilterOpenings, &filterError))
+    LOG_W("BandActivity", "Ignoring opening filter: {}", filterError);
+}
+
+void BandActivityProvider::update() {
+  TRACE_SCOPE("provider", "BandActivityProvider::update");
+  int64_t now = std::time(nullptr);
+  std::vector<BandOpening> started;
+  matrix_->advance(now, &started);
+
+  for (const auto &o : started) {
+    LOG_I("BandActivity", "{} {}>{} open: {} spots, usually {:.1f} (z {:.1f})",
+          kBands[o.band].name, continentName(o.from), continentName(o.to),
+          o.count, o.baseline, o.z);
+    if (!alerts_ || !hits_)
+      continue;
+    SpotFilter::Fields f;
+    f.band = o.band;
+    f.dxCont = o.from;
+    f.deCont = o.to;
+    f.freqKhz = kBands[o.band].minKhz;
+    f.spottedAt = o.since;
+    if (!alertFilter_.matches(f, now))
+      continue;
+    WatchlistHit hit;
+    hit.call = std::string(kBands[o.band].name) + " " + continentName(o.from) +
+               ">" + continentName(o.to);
+    hit.freqKhz = static_cast<float>(kBands[o.band].minKhz);
+    hit.mode = "OPEN";
+    hit.source = "Opening";
+    hit.time = std::chrono::system_clock::from_time_t(o.since);
+    hits_->addHit(hit);
+  }
+
+  BandActivityData data;
+  matrix_->copyCounts(data.counts);
+  data.head = matrix_->head();
+  data.openings = matrix_->openings();
+  data.spots = matrix_->added();
+  data.valid = true;
+  store_->set(std::move(data));
+}
+
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "../core/BandActivityData.h"
+#include "../core/ConfigManager.h"
+#include "../core/SpotFilter.h"
+#include "../core/WatchlistHitStore.h"
+
+#include <memory>
+
+// Drives the BandActivityMatrix that the cluster and PSK providers feed:
+// moves it forward, publishes what it holds, and with
+// AppConfig::openingAlerts adds each new opening that passes
+// AppConfig::spotFilterOpenings to the watchlist hits.
+class BandActivityProvider {
+public:
+  BandActivityProvider(std::shared_ptr<BandActivityMatrix> matrix,
+                       std::shared_ptr<BandActivityStore> store,
+                       std::shared_ptr<WatchlistHitStore> hits,
+                       const AppConfig &config);
+
+  // Moves the matrix to the current time and publishes it. Called every
+  // 30 seconds, which is how fresh the bucket in progress is on screen.
+  void update();
+
+private:
+  std::shared_ptr<BandActivityMatrix> matrix_;
+  std::shared_ptr<BandActivityStore> store_;
+  std::shared_ptr<WatchlistHitStore> hits_;
+  bool alerts_;
+  SpotFilter alertFilter_;
+};
@@ -12,7 +12,8 @@ public:
 
   CallbookProvider(NetworkManager &net, std::shared_ptr<CallbookStore> store);
 
-  // Main entry point for a lookup
+  // Main entry point for a lookup. Starting a new lookup abandons any
+  // that is still in flight.
   void lookup(const std::string &callsign);
 
 private:
@@ -20,8 +21,12 @@ private:
   std::shared_ptr<CallbookStore> store_;
 
   // Aggregation steps
-  void fetchCallook(const std::string &callsign, CallbookData &result,
+  void fetchCallook(const std::string &callsign,
+                    std::shared_ptr<CallbookData> result,
                     std::function<void()> onDone);
-  void fetchHamDB(const std::string &callsign, CallbookData &result,
+  void fetchHamDB(const std::string &callsign,
+                  std::shared_ptr<CallbookData> result,
                   std::function<void()> onDone);
+
+  FetchGroup fetches_; // last: cancelled before the members above go away
 };
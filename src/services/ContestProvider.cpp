@@ -1,5 +1,6 @@
 #include "ContestProvider.h"
 #include "../core/Astronomy.h"
+#include "../core/Tracer.h"
 #include <chrono>
 #include <cstdio>
 #include <ctime>
@@ -10,11 +11,12 @@ ContestProvider::ContestProvider(NetworkManager &net,
     : net_(net), store_(std::move(store)) {}
 
 void ContestProvider::fetch() {
-  net_.fetchAsync(CONTEST_URL, [this](std::string body) {
+  fetches_.add(net_.fetchAsync(CONTEST_URL, [this](std::string body) {
+    TRACE_SCOPE("provider", "ContestProvider::parse");
     if (!body.empty()) {
       processData(body);
     }
-  });
+  }));
 }
 
 // Simple RSS parser for WA7BNM Contest Calendar
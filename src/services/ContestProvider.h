@@ -19,4 +19,6 @@ private:
 
   static constexpr const char *CONTEST_URL =
       "https://www.contestcalendar.com/calendar.rss";
+
+  FetchGroup fetches_;
 };
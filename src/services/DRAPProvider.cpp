@@ -1,14 +1,16 @@
 #include "DRAPProvider.h"
 #include "../core/Logger.h"
+#include "../core/Tracer.h"
 #include <sstream>
 
 DRAPProvider::DRAPProvider(NetworkManager &net) : net_(net) {}
 
-void DRAPProvider::fetch(DataCb cb) {
+FetchHandle DRAPProvider::fetch(DataCb cb) {
   const char *url =
       "https://services.swpc.noaa.gov/text/drap_global_frequencies.txt";
 
-  net_.fetchAsync(url, [cb](std::string body) {
+  return net_.fetchAsync(url, [cb](std::string body) {
+    TRACE_SCOPE("provider", "DRAPProvider::parse");
     if (body.empty()) {
       LOG_W("DRAPProvider", "Empty response from DRAP data source");
       return;
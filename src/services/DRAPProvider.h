@@ -10,7 +10,7 @@ public:
 
   DRAPProvider(NetworkManager &net);
 
-  void fetch(DataCb cb);
+  [[nodiscard]] FetchHandle fetch(DataCb cb);
 
 private:
   NetworkManager &net_;
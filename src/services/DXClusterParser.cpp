@@ -0,0 +1,194 @@
+#include "DXClusterParser.h"
+
+#include <charconv>
+#include <cstring>
+
+char *LineSplitter::writable() {
+  if (begin_ == end_) {
+    begin_ = end_ = scan_ = 0;
+  } else if (kCapacity - end_ < kMinRecv) {
+    if (begin_ == 0) {
+      // Nearly a whole buffer without a newline is garbage, not a line.
+      begin_ = end_ = scan_ = 0;
+    } else {
+      std::memmove(buf_.get(), buf_.get() + begin_, end_ - begin_);
+      end_ -= begin_;
+      scan_ = scan_ > begin_ ? scan_ - begin_ : 0;
+      begin_ = 0;
+    }
+  }
+  return buf_.get() + end_;
+}
+
+bool LineSplitter::next(std::string_view &line) {
+  if (scan_ < begin_)
+    scan_ = begin_;
+  const char *base = buf_.get();
+  const void *nl = std::memchr(base + scan_, '\n', end_ - scan_);
+  if (!nl) {
+    scan_ = end_;
+    return false;
+  }
+  size_t pos = static_cast<const char *>(nl) - base;
+  size_t len = pos - begin_;
+  while (len > 0 && base[begin_ + len - 1] == '\r')
+    len--;
+  line = {base + begin_, len};
+  begin_ = scan_ = pos + 1;
+  return true;
+}
+
+namespace {
+
+bool isSpace(char c) { return c == ' ' || c == '\t'; }
+bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+std::string_view trim(std::string_view s) {
+  while (!s.empty() && (isSpace(s.front()) || s.front() == '\r'))
+    s.remove_prefix(1);
+  while (!s.empty() && (isSpace(s.back()) || s.back() == '\r' ||
+                        s.back() == '\a' || s.back() == '\0'))
+    s.remove_suffix(1);
+  return s;
+}
+
+void skipSpaces(std::string_view &s) {
+  while (!s.empty() && isSpace(s.front()))
+    s.remove_prefix(1);
+}
+
+std::string_view takeToken(std::string_view &s) {
+  skipSpaces(s);
+  size_t n = 0;
+  while (n < s.size() && !isSpace(s[n]))
+    n++;
+  std::string_view tok = s.substr(0, n);
+  s.remove_prefix(n);
+  return tok;
+}
+
+// "14025.3" -> 14025.3 without locale-dependent strtod. Integer from_chars is
+// used because floating-point from_chars is missing from older libc++.
+bool parseFreq(std::string_view tok, double &out) {
+  long long whole = 0;
+  const char *p = tok.data();
+  const char *end = tok.data() + tok.size();
+  auto [next, ec] = std::from_chars(p, end, whole);
+  if (ec != std::errc() || whole <= 0)
+    return false;
+  double frac = 0, scale = 0.1;
+  if (next != end && *next == '.') {
+    for (++next; next != end && isDigit(*next); ++next) {
+      frac += (*next - '0') * scale;
+      scale *= 0.1;
+    }
+  }
+  if (next != end)
+    return false;
+  out = static_cast<double>(whole) + frac;
+  return true;
+}
+
+// "2156Z" -> 2156
+bool parseTime(std::string_view tok, int &hhmm) {
+  if (tok.size() != 5 || tok[4] != 'Z')
+    return false;
+  int v = 0;
+  auto [next, ec] = std::from_chars(tok.data(), tok.data() + 4, v);
+  if (ec != std::errc() || next != tok.data() + 4 || v < 0 ||
+      v % 100 > 59 || v / 100 > 23)
+    return false;
+  hhmm = v;
+  return true;
+}
+
+bool isModeWord(std::string_view w) {
+  static constexpr std::string_view kModes[] = {
+      "CW",   "SSB",  "USB",  "LSB",  "AM",     "FM",   "FT8",
+      "FT4",  "RTTY", "PSK31", "PSK63", "JT65", "JT9", "MSK144",
+      "OLIVIA", "SSTV", "DIGI", "DATA", "BPSK", "Q65"};
+  for (auto m : kModes) {
+    if (w.size() != m.size())
+      continue;
+    bool eq = true;
+    for (size_t i = 0; i < w.size() && eq; ++i) {
+      char c = w[i];
+      if (c >= 'a' && c <= 'z')
+        c = static_cast<char>(c - 'a' + 'A');
+      eq = c == m[i];
+    }
+    if (eq)
+      return true;
+  }
+  return false;
+}
+
+// RBN comments carry "<snr> dB" right after the mode.
+void parseRbnSnr(std::string_view comment, ParsedSpotLine &out) {
+  size_t db = comment.find(" dB");
+  if (db == std::string_view::npos)
+    return;
+  size_t start = db;
+  while (start > 0 &&
+         (isDigit(comment[start - 1]) || comment[start - 1] == '-'))
+    start--;
+  int v = 0;
+  auto [next, ec] =
+      std::from_chars(comment.data() + start, comment.data() + db, v);
+  if (ec == std::errc() && next == comment.data() + db && start != db) {
+    out.snr = v;
+    out.hasSnr = true;
+  }
+}
+
+} // namespace
+
+bool parseSpotLine(std::string_view line, ParsedSpotLine &out) {
+  size_t at = line.find("DX de ");
+  if (at == std::string_view::npos)
+    return false;
+  std::string_view rest = line.substr(at + 6);
+  out = ParsedSpotLine{};
+
+  // Spotter runs up to the colon; some nodes omit the space after it.
+  skipSpaces(rest);
+  size_t colon = rest.find(':');
+  if (colon == std::string_view::npos || colon == 0 || colon > 31)
+    return false;
+  out.spotter = rest.substr(0, colon);
+  if (out.spotter.size() > 2 &&
+      out.spotter.substr(out.spotter.size() - 2) == "-#")
+    out.spotter.remove_suffix(2);
+  rest.remove_prefix(colon + 1);
+
+  if (!parseFreq(takeToken(rest), out.freqKhz))
+    return false;
+  out.dxCall = takeToken(rest);
+  if (out.dxCall.empty() || out.dxCall.size() > 31)
+    return false;
+
+  // The time is the last "HHMMZ" token; a grid or state may follow it.
+  rest = trim(rest);
+  std::string_view tail = rest;
+  for (int i = 0; i < 2 && !tail.empty(); ++i) {
+    size_t sp = tail.find_last_of(" \t");
+    std::string_view tok =
+        sp == std::string_view::npos ? tail : tail.substr(sp + 1);
+    if (parseTime(tok, out.hhmm)) {
+      if (i == 1)
+        out.locator = trim(rest.substr(tail.size()));
+      rest = tail.substr(0, tail.size() - tok.size());
+      break;
+    }
+    tail = trim(tail.substr(0, sp == std::string_view::npos ? 0 : sp));
+  }
+
+  out.comment = trim(rest);
+  std::string_view words = out.comment;
+  std::string_view first = takeToken(words);
+  if (isModeWord(first)) {
+    out.mode = first;
+    parseRbnSnr(out.comment, out);
+  }
+  return true;
+}
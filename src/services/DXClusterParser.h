@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+// Incremental splitter for a line-oriented socket stream.
+//
+// recv() straight into writable(), commit() what arrived, then pull complete
+// lines with next(). Lines are views into the internal buffer and stay valid
+// until the next writable() call. The unread tail is moved to the front only
+// when free space runs out, so each byte is copied at most once per line.
+class LineSplitter {
+public:
+  static constexpr size_t kCapacity = 8192;
+  static constexpr size_t kMinRecv = 1024; // compact below this much space
+
+  LineSplitter() : buf_(std::make_unique<char[]>(kCapacity)) {}
+
+  // Space for the next recv(), at least kMinRecv bytes: a partial line too
+  // long to leave that much room is discarded. Call before writableSize(),
+  // which may grow as a result.
+  char *writable();
+  size_t writableSize() const { return kCapacity - end_; }
+  void commit(size_t n) { end_ += n; }
+
+  // Next complete line without its "\r\n" / "\n". Returns false when only a
+  // partial line is left.
+  bool next(std::string_view &line);
+
+  // The partial line received so far, e.g. a "login:" prompt that is never
+  // followed by a newline.
+  std::string_view pending() const {
+    return {buf_.get() + begin_, end_ - begin_};
+  }
+  void clear() { begin_ = end_ = 0; }
+
+private:
+  std::unique_ptr<char[]> buf_;
+  size_t begin_ = 0; // first unread byte
+  size_t end_ = 0;   // one past the last received byte
+  size_t scan_ = 0;  // bytes before this are known not to be '\n'
+};
+
+// One "DX de" spot as it appears on the wire. Views point into the line.
+struct ParsedSpotLine {
+  std::string_view spotter; // without an RBN "-#" suffix
+  std::string_view dxCall;
+  std::string_view comment; // between the call and the time, trimmed
+  std::string_view mode;    // leading mode word of the comment, if any
+  std::string_view locator; // grid or state after the time, if any
+  double freqKhz = 0;
+  int snr = 0;
+  bool hasSnr = false;
+  int hhmm = -1; // UTC time of the spot, -1 if absent
+};
+
+// Parses DX Spider, AR-Cluster, CC-Cluster and RBN spot lines, e.g.
+//   DX de KD0AA:     18100.0  JR1FYS       FT8 LOUD in FL!        2156Z
+//   DX de W3LPL-#:   14025.0  K1ABC        CW    23 dB  25 WPM  CQ  1200Z
+//   DX de K1TTT:     14025.0  K1ABC        cq cq                  1200Z FN32
+// Anything before "DX de " (bells, a node prefix) is skipped. Does not
+// allocate. Returns false if the line is not a spot.
+bool parseSpotLine(std::string_view line, ParsedSpotLine &out);
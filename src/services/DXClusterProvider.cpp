@@ -1,8 +1,11 @@
 #include "DXClusterProvider.h"
-#include "../core/Astronomy.h"
-#include "../core/HamClockState.h"
+#include "DXClusterParser.h"
+#include "../core/LiveSpotData.h"
 #include "../core/Logger.h"
 #include "../core/PrefixManager.h"
+#include "../core/ServiceHealth.h"
+#include "../core/Tracer.h"
+#include "../network/TcpConnect.h"
 #ifdef _WIN32
 #include <winsock2.h>
 #include <ws2tcpip.h>
@@ -15,15 +18,50 @@
 #include <sys/socket.h>
 #include <unistd.h>
 #endif
+#include <chrono>
 #include <cstring>
+#include <ctime>
+#include <cstdlib>
+#include <random>
 
-DXClusterProvider::DXClusterProvider(std::shared_ptr<DXClusterDataStore> store,
-                                     PrefixManager &pm,
-                                     std::shared_ptr<WatchlistStore> watchlist,
-                                     std::shared_ptr<WatchlistHitStore> hits,
-                                     HamClockState *state)
-    : store_(store), pm_(pm), watchlist_(watchlist), hits_(hits),
-      state_(state) {}
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+
+// Writes to the node. A peer that reset the connection gets EPIPE here, not
+// a SIGPIPE that would end the process; the next recv() reports the loss.
+void sendText(int sock, std::string_view text) {
+  send(sock, text.data(), text.size(), MSG_NOSIGNAL);
+}
+
+// Whether an ADIF "<EOR>" ends a record somewhere in 'data'.
+bool hasEndOfRecord(std::string_view data) {
+  for (size_t at = data.find('<'); at != std::string_view::npos;
+       at = data.find('<', at + 1)) {
+    std::string_view tag = data.substr(at, 5);
+    if (tag.size() == 5 && (tag[1] == 'e' || tag[1] == 'E') &&
+        (tag[2] == 'o' || tag[2] == 'O') && (tag[3] == 'r' || tag[3] == 'R') &&
+        tag[4] == '>')
+      return true;
+  }
+  return false;
+}
+
+} // namespace
+
+DXClusterProvider::DXClusterProvider(
+    std::shared_ptr<DXClusterDataStore> store,
+    std::shared_ptr<const SpotEnricher> enricher,
+    std::shared_ptr<WatchlistStore> watchlist,
+    std::shared_ptr<WatchlistHitStore> hits,
+    std::shared_ptr<BandActivityMatrix> activity,
+    std::shared_ptr<WsjtxStore> wsjtx,
+    std::shared_ptr<ContestLogStore> contestLog)
+    : store_(store), enricher_(std::move(enricher)), watchlist_(watchlist),
+      hits_(hits), activity_(std::move(activity)), wsjtx_(std::move(wsjtx)),
+      contestLog_(std::move(contestLog)) {}
 
 DXClusterProvider::~DXClusterProvider() { stop(); }
 
@@ -35,99 +73,146 @@ void DXClusterProvider::start(const AppConfig &config) {
   if (!config_.dxClusterEnabled)
     return;
 
+  std::string filterError;
+  if (!alertFilter_.compile(config_.spotFilterAlerts, &filterError))
+    LOG_W("DXCluster", "Ignoring alert filter: {}", filterError);
+
+  // The primary cluster keeps the "DXCluster" health entry it always had.
+  DXClusterSource primary;
+  primary.host = config_.dxClusterHost;
+  primary.port = config_.dxClusterPort;
+  primary.login = config_.dxClusterLogin;
+  primary.useWSJTX = config_.dxClusterUseWSJTX;
+  primary.name = primary.useWSJTX ? "UDP" : primary.host;
+  std::vector<DXClusterSource> configs = {primary};
+  for (DXClusterSource extra : config_.dxClusterExtraSources) {
+    if (configs.size() == kMaxSources) {
+      LOG_W("DXCluster", "Only {} cluster sources supported, ignoring rest",
+            kMaxSources);
+      break;
+    }
+    if (extra.login.empty())
+      extra.login = config_.dxClusterLogin;
+    if (extra.name.empty())
+      extra.name = extra.useWSJTX ? "UDP " + std::to_string(extra.port)
+                                  : extra.host;
+    configs.push_back(extra);
+  }
+
+  dedup_ = SpotDeduper(kDedupWindow);
+  lastStats_ = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < configs.size(); ++i) {
+    auto src = std::make_unique<Source>();
+    src->index = i;
+    src->cfg = configs[i];
+    src->healthName = i == 0 ? "DXCluster" : "DXCluster " + src->cfg.name;
+    sources_.push_back(std::move(src));
+  }
+  maybePublishStats(true);
+
   running_ = true;
   stopClicked_ = false;
-  thread_ = std::thread(&DXClusterProvider::run, this);
+  for (auto &src : sources_)
+    src->thread = std::thread(&DXClusterProvider::run, this, std::ref(*src));
 }
 
 void DXClusterProvider::stop() {
   stopClicked_ = true;
-  if (thread_.joinable()) {
-    thread_.join();
+  for (auto &src : sources_) {
+    if (src->thread.joinable())
+      src->thread.join();
   }
+  sources_.clear();
   running_ = false;
 }
 
-void DXClusterProvider::run() {
+void DXClusterProvider::run(Source &src) {
+  Tracer::instance().setThreadName("dxcluster " + src.cfg.name);
+  std::mt19937 rng(std::random_device{}());
+  int failures = 0;
   while (!stopClicked_) {
-    if (config_.dxClusterUseWSJTX) {
-      runUDP(config_.dxClusterPort);
-    } else {
-      runTelnet(config_.dxClusterHost, config_.dxClusterPort,
-                config_.dxClusterLogin);
-    }
+    auto started = std::chrono::steady_clock::now();
+    bool connected = src.cfg.useWSJTX ? runUDP(src) : runTelnet(src);
 
     if (stopClicked_)
       break;
 
-    // Retry delay
-    store_->setConnected(false, "Disconnected, retrying in 10s...");
-    std::this_thread::sleep_for(std::chrono::seconds(10));
+    // Back off exponentially while the source keeps failing; a session that
+    // stayed up for a while starts over from the shortest delay.
+    auto lasted = std::chrono::steady_clock::now() - started;
+    if (connected && lasted >= kStableSession)
+      failures = 0;
+    auto delay = kRetryMin * (1 << std::min(failures, 6));
+    if (delay > kRetryMax)
+      delay = kRetryMax;
+    failures++;
+    // Full jitter over the upper half, so sources that dropped together do
+    // not all reconnect in the same second.
+    std::uniform_int_distribution<long long> jitter(delay.count() / 2,
+                                                    delay.count());
+    auto wait = std::chrono::seconds(jitter(rng));
+
+    setConnected(src, false,
+                 "Disconnected, retrying in " + std::to_string(wait.count()) +
+                     "s...");
+    auto until = std::chrono::steady_clock::now() + wait;
+    while (!stopClicked_ && std::chrono::steady_clock::now() < until)
+      std::this_thread::sleep_for(std::chrono::milliseconds(250));
   }
 }
 
-void DXClusterProvider::runTelnet(const std::string &host, int port,
-                                  const std::string &login) {
-  LOG_I("DXCluster", "Connecting to {}:{}", host, port);
-  if (state_) {
-    auto &s = state_->services["DXCluster"];
-    s.ok = false;
-    s.lastError = "Connecting...";
-  }
-
-  int sock = socket(AF_INET, SOCK_STREAM, 0);
-  if (sock < 0) {
-    LOG_E("DXCluster", "Failed to create socket");
-    if (state_)
-      state_->services["DXCluster"].lastError = "Socket error";
-    return;
-  }
-
-  // Set non-blocking for connect timeout if needed, but for now just simple
-  struct hostent *he = gethostbyname(host.c_str());
-  if (!he) {
-    LOG_E("DXCluster", "Could not resolve {}", host);
-    if (state_)
-      state_->services["DXCluster"].lastError = "DNS failed";
-    close(sock);
-    return;
+void DXClusterProvider::setConnected(Source &src, bool connected,
+                                     const std::string &status) {
+  src.connected = connected;
+  if (sources_.size() == 1) {
+    store_->setConnected(connected, status);
+  } else {
+    size_t up = 0;
+    for (const auto &s : sources_)
+      up += s->connected ? 1 : 0;
+    store_->setConnected(up > 0, std::to_string(up) + "/" +
+                                     std::to_string(sources_.size()) +
+                                     " clusters connected");
   }
+  maybePublishStats(true);
+}
 
-  struct sockaddr_in server_addr{};
-  server_addr.sin_family = AF_INET;
-  server_addr.sin_port = htons(port);
-  std::memcpy(&server_addr.sin_addr, he->h_addr_list[0], he->h_length);
+bool DXClusterProvider::runTelnet(Source &src) {
+  const std::string &host = src.cfg.host;
+  const std::string &login = src.cfg.login;
+  int port = src.cfg.port;
+  LOG_I("DXCluster", "Connecting to {}:{}", host, port);
+  auto &health = ServiceHealthRegistry::instance().get(src.healthName);
+  health.setNote("Connecting...");
 
-  if (connect(sock, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
-    LOG_E("DXCluster", "Connect to {} failed: {}", host, std::strerror(errno));
-    if (state_)
-      state_->services["DXCluster"].lastError = "Connect failed";
-    close(sock);
-    return;
+  auto conn = TcpConnect::connect(host, port, stopClicked_);
+  if (conn.fd < 0) {
+    if (stopClicked_)
+      return false;
+    LOG_E("DXCluster", "Connect to {}:{} failed: {}", host, port, conn.error);
+    health.markFailure(conn.error);
+    return false;
   }
+  int sock = conn.fd;
+  TcpConnect::enableKeepAlive(sock);
 
-#ifdef _WIN32
-  unsigned long mode = 1;
-  ioctlsocket(sock, FIONBIO, &mode);
-#else
-  fcntl(sock, F_SETFL, O_NONBLOCK);
-#endif
+  LOG_I("DXCluster", "Connected to {} ({})", host, conn.address);
+  health.markSuccess();
+  health.setNote("Connected");
+  setConnected(src, true, "Connected to " + host);
 
-  LOG_I("DXCluster", "Connected to {}", host);
-  if (state_)
-    state_->services["DXCluster"].lastError = "Connected";
-  store_->setConnected(true, "Connected to " + host);
-
-  std::string buffer;
+  LineSplitter lines;
   bool loggedIn = login.empty();
   bool initialRequestSent = false;
   auto lastHeartbeat = std::chrono::system_clock::now();
+  // Keepalive only notices a dead peer; a node that stopped sending while
+  // the TCP session stays up is caught here.
+  auto lastRx = std::chrono::steady_clock::now();
 
   // Following original HamClock logic: send login immediately as prompts may
   // not have newlines
   if (!login.empty()) {
-    std::string cmd = login + "\r\n";
-    send(sock, cmd.c_str(), cmd.length(), 0);
+    sendText(sock, login + "\r\n");
     // Note: Don't set loggedIn = true yet, we want to see if we get a "Welcome"
     // or prompt
   }
@@ -148,98 +233,104 @@ void DXClusterProvider::runTelnet(const std::string &host, int port,
       break;
 
     if (ret > 0) {
-      char tmp[1024];
-      ssize_t n = recv(sock, tmp, sizeof(tmp) - 1, 0);
+      char *dst = lines.writable();
+      ssize_t n = recv(sock, dst, lines.writableSize(), 0);
       if (n <= 0) {
         LOG_W("DXCluster", "Connection lost");
-        if (state_) {
-          state_->services["DXCluster"].ok = false;
-          state_->services["DXCluster"].lastError = "Connection lost";
-        }
+        health.markFailure("Connection lost");
         break; // Error or closed
       }
-
-      tmp[n] = '\0';
-      buffer.append(tmp, n);
-
-      size_t pos;
-      while ((pos = buffer.find('\n')) != std::string::npos) {
-        std::string line = buffer.substr(0, pos);
-        buffer.erase(0, pos + 1);
-        while (!line.empty() && (line.back() == '\r' || line.back() == '\n'))
-          line.pop_back();
-
-        if (!line.empty()) {
-          processLine(line);
-
-          // Check for common indicators that we are in
-          if (line.find("Welcome") != std::string::npos ||
-              line.find("connected") != std::string::npos ||
-              line.find("Nodes") != std::string::npos ||
-              line.find(">") != std::string::npos ||
-              line.find("DX de ") !=
-                  std::string::npos) { // Spot line also means we are in
-            if (!loggedIn) {
-              loggedIn = true;
-              if (state_) {
-                auto &s = state_->services["DXCluster"];
-                s.ok = true;
-                s.lastSuccess = std::chrono::system_clock::now();
-              }
-              store_->setConnected(true, "Logged in as " + login);
-            }
-            if (!initialRequestSent) {
-              const char *req = "sh/dx 30\r\n";
-              send(sock, req, std::strlen(req), 0);
-              initialRequestSent = true;
-            }
-          }
-
+      lines.commit(n);
+      lastRx = std::chrono::steady_clock::now();
+
+      auto isLoginPrompt = [](std::string_view text) {
+        return text.find("login:") != std::string_view::npos ||
+               text.find("callsign:") != std::string_view::npos ||
+               text.find("Please enter your call:") != std::string_view::npos;
+      };
+
+      std::string_view line;
+      while (lines.next(line)) {
+        if (line.empty())
+          continue;
+        processLine(src, line);
+
+        // Check for common indicators that we are in
+        if (line.find("Welcome") != std::string_view::npos ||
+            line.find("connected") != std::string_view::npos ||
+            line.find("Nodes") != std::string_view::npos ||
+            line.find(">") != std::string_view::npos ||
+            line.find("DX de ") !=
+                std::string_view::npos) { // Spot line also means we are in
           if (!loggedIn) {
-            // Still check for login prompt just in case we didn't send it or it
-            // asked again
-            if (line.find("login:") != std::string::npos ||
-                line.find("callsign:") != std::string::npos ||
-                line.find("Please enter your call:") != std::string::npos) {
-              std::string cmd = login + "\r\n";
-              send(sock, cmd.c_str(), cmd.length(), 0);
-            }
+            loggedIn = true;
+            health.setNote("Logged in");
+            setConnected(src, true, "Logged in as " + login);
+          }
+          if (!initialRequestSent) {
+            sendText(sock, "sh/dx 30\r\n");
+            initialRequestSent = true;
           }
         }
-      }
 
-      // Check for prompt without newline at the end of buffer
-      if (!loggedIn && !buffer.empty()) {
-        if (buffer.find("login:") != std::string::npos ||
-            buffer.find("callsign:") != std::string::npos ||
-            buffer.find("Please enter your call:") != std::string::npos) {
-          std::string cmd = login + "\r\n";
-          send(sock, cmd.c_str(), cmd.length(), 0);
-          buffer.clear(); // Clear so we don't repeat
+        // Still check for login prompt just in case we didn't send it or it
+        // asked again
+        if (!loggedIn && isLoginPrompt(line)) {
+          sendText(sock, login + "\r\n");
         }
       }
 
-      // If still buffer too long without newline, clear it
-      if (buffer.length() > 4096)
-        buffer.clear();
+      // Check for prompt without newline at the end of buffer
+      if (!loggedIn && isLoginPrompt(lines.pending())) {
+        sendText(sock, login + "\r\n");
+        lines.clear(); // Clear so we don't repeat
+      }
     }
 
     // Heartbeat
     auto now = std::chrono::system_clock::now();
     if (now - lastHeartbeat > std::chrono::seconds(60)) {
-      send(sock, "\r\n", 2, 0);
+      sendText(sock, "\r\n");
       lastHeartbeat = now;
     }
+    if (std::chrono::steady_clock::now() - lastRx > kIdleTimeout) {
+      LOG_W("DXCluster", "No data from {} in {}s, reconnecting", host,
+            std::chrono::duration_cast<std::chrono::seconds>(kIdleTimeout)
+                .count());
+      health.markFailure("Idle timeout");
+      break;
+    }
+    maybePublishStats();
   }
 
-  std::fprintf(stderr, "DXCluster: telnet session ended\n");
+  LOG_I("DXCluster", "Telnet session to {} ended", host);
   close(sock);
+  return true;
 }
 
-void DXClusterProvider::runUDP(int port) {
+bool DXClusterProvider::runUDP(Source &src) {
+  int port = src.cfg.port;
+  auto &health = ServiceHealthRegistry::instance().get(src.healthName);
   int sock = socket(AF_INET, SOCK_DGRAM, 0);
-  if (sock < 0)
-    return;
+  if (sock < 0) {
+    health.markFailure("Socket error");
+    return false;
+  }
+
+  // WSJT-X can send to a multicast group so several programs hear it at
+  // once; they all bind the same port.
+  struct in_addr group{};
+  bool multicast = inet_pton(AF_INET, src.cfg.host.c_str(), &group) == 1 &&
+                   IN_MULTICAST(ntohl(group.s_addr));
+  if (multicast) {
+    int on = 1;
+    setsockopt(sock, SOL_SOCKET, SO_REUSEADDR,
+               reinterpret_cast<const char *>(&on), sizeof(on));
+#ifdef SO_REUSEPORT
+    setsockopt(sock, SOL_SOCKET, SO_REUSEPORT,
+               reinterpret_cast<const char *>(&on), sizeof(on));
+#endif
+  }
 
   struct sockaddr_in addr{};
   addr.sin_family = AF_INET;
@@ -247,8 +338,24 @@ void DXClusterProvider::runUDP(int port) {
   addr.sin_addr.s_addr = INADDR_ANY;
 
   if (bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+    health.markFailure("Bind failed");
     close(sock);
-    return;
+    return false;
+  }
+
+  if (multicast) {
+    struct ip_mreq mreq{};
+    mreq.imr_multiaddr = group;
+    mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+    if (setsockopt(sock, IPPROTO_IP, IP_ADD_MEMBERSHIP,
+                   reinterpret_cast<const char *>(&mreq), sizeof(mreq)) < 0) {
+      LOG_E("DXCluster", "Joining multicast group {} failed", src.cfg.host);
+      health.markFailure("Multicast join failed");
+      close(sock);
+      return false;
+    }
+    LOG_I("DXCluster", "Joined multicast group {} on port {}", src.cfg.host,
+          port);
   }
 
 #ifdef _WIN32
@@ -257,7 +364,13 @@ void DXClusterProvider::runUDP(int port) {
 #else
   fcntl(sock, F_SETFL, O_NONBLOCK);
 #endif
-  store_->setConnected(true, "Listening UDP on port " + std::to_string(port));
+  health.markSuccess();
+  health.setNote("Listening UDP");
+  setConnected(src, true, "Listening UDP on port " + std::to_string(port));
+
+  std::vector<char> buf(kMaxDatagram);
+  WsjtxPeers peers;
+  N1mmState n1mm;
 
   while (!stopClicked_) {
 #ifdef _WIN32
@@ -275,99 +388,370 @@ void DXClusterProvider::runUDP(int port) {
       break;
 
     if (ret > 0) {
-      char tmp[2048];
-      ssize_t n = recv(sock, tmp, sizeof(tmp), 0);
-      if (n > 0) {
-        // For UDP, we might have binary protocols (WSJT-X) or XML/ADIF
-        // For now, let's assume simple string lines or binary
-        // WSJT-X starts with 0xADBCCBDA
-        if (n >= 4 && (uint32_t)ntohl(*(uint32_t *)tmp) == 0xADBCCBDA) {
-          // TODO: WSJT-X parsing
-        } else {
-          std::string line(tmp, n);
-          processLine(line);
-        }
+      // Read everything queued, then publish the contest log once: every
+      // station of a multi-op network may log a QSO in the same second.
+      for (int i = 0; i < kMaxBurst && !stopClicked_; ++i) {
+        ssize_t n = recv(sock, buf.data(), static_cast<int>(buf.size()), 0);
+        if (n <= 0)
+          break;
+        processDatagram(src, std::string_view(buf.data(), n), peers, n1mm);
       }
+      if (contestLog_ && !n1mm.pending.empty())
+        contestLog_->apply(n1mm.pending, std::time(nullptr));
+      n1mm.pending.clear();
     }
+    maybePublishStats();
   }
 
   close(sock);
+  return true;
 }
 
-void DXClusterProvider::processLine(const std::string &line) {
+void DXClusterProvider::processDatagram(Source &src, std::string_view data,
+                                        WsjtxPeers &peers, N1mmState &n1mm) {
+  if (Wsjtx::isMessage(data.data(), data.size())) {
+    Wsjtx::Message msg;
+    src.wsjtxMessages++;
+    if (Wsjtx::parse(data.data(), data.size(), msg))
+      processWsjtx(src, msg, peers);
+    else
+      src.wsjtxErrors++;
+  } else if (N1mm::isMessage(data.data(), data.size())) {
+    N1mm::Message msg;
+    src.n1mmMessages++;
+    if (N1mm::parse(data.data(), data.size(), msg))
+      processN1mm(src, msg, n1mm);
+    else
+      src.n1mmErrors++;
+  } else if (hasEndOfRecord(data)) {
+    // Bare ADIF, as Log4OM and others send for each logged QSO.
+    if (wsjtx_)
+      wsjtx_->addLogged(std::string(data));
+  } else {
+    // A datagram may hold several lines.
+    while (!data.empty()) {
+      size_t nl = data.find('\n');
+      processLine(src, data.substr(0, nl));
+      if (nl == std::string_view::npos)
+        break;
+      data.remove_prefix(nl + 1);
+    }
+  }
+}
+
+void DXClusterProvider::processLine(Source &src, std::string_view line) {
   if (line.empty())
     return;
+  TRACE_SCOPE("provider", "DXClusterProvider::processLine");
 
-  // std::fprintf(stderr, "DXCluster: data: %s\n", line.c_str());
+  ParsedSpotLine parsed;
+  if (!parseSpotLine(line, parsed))
+    return;
+
+  DXClusterSpot spot;
+  spot.rxCall = parsed.spotter;
+  spot.txCall = parsed.dxCall;
+  spot.rxGrid = parsed.locator; // only used if it parses as a grid
+  spot.freqKhz = parsed.freqKhz;
+  spot.mode = parsed.mode;
+  if (parsed.hasSnr)
+    spot.snr = parsed.snr;
+
+  // Default to now if the line carries no time.
+  auto now = std::chrono::system_clock::now();
+  spot.spottedAt = now;
+  if (parsed.hhmm >= 0) {
+    std::time_t now_c = std::chrono::system_clock::to_time_t(now);
+    std::time_t spot_c = now_c - now_c % 86400 + (parsed.hhmm / 100) * 3600 +
+                         (parsed.hhmm % 100) * 60;
+    // A time later than now was sent yesterday.
+    if (spot_c > now_c)
+      spot_c -= 86400;
+    spot.spottedAt = std::chrono::system_clock::from_time_t(spot_c);
+  }
+
+  submit(src, spot, "Cluster");
+}
+
+void DXClusterProvider::processWsjtx(Source &src, const Wsjtx::Message &msg,
+                                     WsjtxPeers &peers) {
+  TRACE_SCOPE("provider", "DXClusterProvider::processWsjtx");
+  std::string id(msg.id);
+  auto now = std::chrono::system_clock::now();
+
+  switch (msg.type) {
+  case Wsjtx::Type::Status: {
+    const Wsjtx::Status &st = msg.status;
+    WsjtxInstance &peer = peers[id];
+    WsjtxInstance next = peer;
+    next.id = id;
+    next.dialHz = st.dialHz;
+    next.band = freqToBandIndex(st.dialHz / 1000.0);
+    next.mode = st.mode;
+    next.dxCall = st.dxCall;
+    next.dxGrid = st.dxGrid;
+    next.deCall = st.deCall;
+    next.deGrid = st.deGrid;
+    next.txEnabled = st.txEnabled;
+    next.transmitting = st.transmitting;
+    // Status comes at least twice a period (decoding starts and stops);
+    // only publish what the UI shows.
+    bool changed = next.dialHz != peer.dialHz || next.mode != peer.mode ||
+                   next.dxCall != peer.dxCall || next.dxGrid != peer.dxGrid ||
+                   next.deCall != peer.deCall ||
+                   next.txEnabled != peer.txEnabled ||
+                   next.transmitting != peer.transmitting;
+    next.updated = now;
+    peer = std::move(next);
+    if (changed && wsjtx_)
+      wsjtx_->updateInstance(peer);
+    break;
+  }
+  case Wsjtx::Type::Decode:
+  case Wsjtx::Type::WSPRDecode: {
+    auto it = peers.find(id);
+    // Without a Status yet there is no dial frequency or DE call.
+    if (it == peers.end() || it->second.dialHz == 0)
+      break;
+    const WsjtxInstance &peer = it->second;
 
-  // Example: DX de KD0AA:     18100.0  JR1FYS       FT8 LOUD in FL! 2156Z
-  if (line.find("DX de ") != std::string::npos) {
     DXClusterSpot spot;
-    char rxCall[32], txCall[32];
-    float freq;
-    // Attempt to skip leading prefix if any
-    const char *start = line.c_str();
-    const char *dxde = std::strstr(start, "DX de ");
-    if (dxde) {
-      if (sscanf(dxde, "DX de %31[^ :]: %f %31s", rxCall, &freq, txCall) == 3) {
-        spot.rxCall = rxCall;
-        spot.txCall = txCall;
-        spot.freqKhz = freq;
-        spot.spottedAt = std::chrono::system_clock::now(); // Default to now if
-                                                           // time parsing fails
-
-        // Extract time if possible (fixed position in standard cluster output)
-        if (line.length() >= 74 && line[74] == 'Z') {
-          int hr, mn;
-          if (sscanf(line.c_str() + 70, "%2d%2d", &hr, &mn) == 2) {
-            auto now = std::chrono::system_clock::now();
-            std::time_t now_c = std::chrono::system_clock::to_time_t(now);
-            struct tm tm_buf{};
-            struct tm *tm = Astronomy::portable_gmtime(&now_c, &tm_buf);
-            tm->tm_hour = hr;
-            tm->tm_min = mn;
-            tm->tm_sec = 0;
-            // Handle day wrap if needed (if hr:mn is in the future compared to
-            // now, it's likely yesterday)
-            std::time_t spot_c = Astronomy::portable_timegm(tm);
-            if (spot_c > now_c)
-              spot_c -= 86400;
-            spot.spottedAt = std::chrono::system_clock::from_time_t(spot_c);
-          }
-        }
+    if (msg.type == Wsjtx::Type::Decode) {
+      const Wsjtx::Decode &d = msg.decode;
+      std::string_view call, grid;
+      // Replayed and off-air decodes are not what the radio hears now.
+      if (!d.isNew || d.offAir || !Wsjtx::messageSender(d.message, call, grid))
+        break;
+      spot.txCall = call;
+      spot.txGrid = grid;
+      spot.freqKhz = (peer.dialHz + d.dfHz) / 1000.0;
+      spot.mode = peer.mode;
+      if (spot.mode.empty())
+        spot.mode = Wsjtx::modeFromCode(d.mode);
+      spot.snr = d.snr;
+      spot.dtSecs = static_cast<float>(d.dtSecs);
+    } else {
+      const Wsjtx::WSPRDecode &w = msg.wspr;
+      if (!w.isNew || w.offAir || w.call.empty())
+        break;
+      spot.txCall = w.call;
+      spot.txGrid = w.grid;
+      spot.freqKhz = w.freqHz / 1000.0;
+      spot.mode = "WSPR";
+      spot.snr = w.snr;
+      spot.dtSecs = static_cast<float>(w.dtSecs);
+    }
+    spot.rxCall = peer.deCall;
+    spot.rxGrid = peer.deGrid;
+    // New decodes are sent the moment they are made, within a period of
+    // the time they carry; arrival time also keeps replayed captures and
+    // a badly set shack PC clock from ageing spots out at once.
+    spot.spottedAt = now;
+    submit(src, spot, "WSJT-X");
+    break;
+  }
+  case Wsjtx::Type::QSOLogged:
+    LOG_I("DXCluster", "{} logged {} on {:.3f} MHz {}", id, msg.qso.dxCall,
+          msg.qso.txHz / 1e6, msg.qso.mode);
+    break;
+  case Wsjtx::Type::LoggedADIF:
+    if (wsjtx_ && !msg.adif.empty())
+      wsjtx_->addLogged(std::string(msg.adif));
+    break;
+  case Wsjtx::Type::Close:
+    peers.erase(id);
+    if (wsjtx_)
+      wsjtx_->removeInstance(id);
+    break;
+  default:
+    break;
+  }
+}
 
-        // Map location
-        LatLong ll;
-        if (pm_.findLocation(spot.txCall, ll)) {
-          spot.txLat = ll.lat;
-          spot.txLon = ll.lon;
-        }
-        if (pm_.findLocation(spot.rxCall, ll)) {
-          spot.rxLat = ll.lat;
-          spot.rxLon = ll.lon;
-        }
+void DXClusterProvider::processN1mm(Source &src, const N1mm::Message &msg,
+                                    N1mmState &state) {
+  TRACE_SCOPE("provider", "DXClusterProvider::processN1mm");
+  auto now = std::chrono::system_clock::now();
+
+  switch (msg.type) {
+  case N1mm::Type::Contact:
+  case N1mm::Type::ContactReplace:
+  case N1mm::Type::ContactDelete: {
+    const N1mm::Contact &c = msg.contact;
+    ContestQso q;
+    q.op = msg.type == N1mm::Type::Contact          ? ContestQso::Op::Add
+           : msg.type == N1mm::Type::ContactReplace ? ContestQso::Op::Replace
+                                                    : ContestQso::Op::Delete;
+    q.id = c.id;
+    if (q.op == ContestQso::Op::Delete ? q.id.empty() : c.call.empty())
+      break;
+    // Arrival time, as for WSJT-X decodes: the logging PC's clock may be
+    // off, and a replayed capture should still show a rate.
+    q.time = std::chrono::system_clock::to_time_t(now);
+    q.call = c.call;
+    // The frequency heard on; the band in MHz if the radio was not read.
+    q.freqKhz = c.rxKhz > 0 ? c.rxKhz : c.txKhz;
+    if (q.freqKhz <= 0 && !c.band.empty())
+      q.freqKhz = std::strtod(c.band.c_str(), nullptr) * 1000.0;
+    q.mode = c.mode;
+    q.contest = c.contest;
+    q.station = c.stationName;
+    q.operatorCall = c.operatorCall;
+    state.pending.qsos.push_back(std::move(q));
+    break;
+  }
+  case N1mm::Type::Radio: {
+    const N1mm::Radio &r = msg.radio;
+    std::string key = r.stationName + '#' + std::to_string(r.radioNr);
+    ContestRadio &last = state.radios[key];
+    ContestRadio next;
+    next.station = r.stationName;
+    next.radioNr = r.radioNr;
+    next.rxKhz = r.rxKhz;
+    next.txKhz = r.txKhz;
+    next.band = freqToBandIndex(r.rxKhz);
+    next.mode = r.mode;
+    next.opCall = r.opCall;
+    next.radioName = r.radioName;
+    next.running = r.running;
+    next.transmitting = r.transmitting;
+    next.connected = r.connected;
+    // RadioInfo repeats every few seconds per radio; only publish what the
+    // panel shows, and now and then to say the radio is still there.
+    bool changed = next.rxKhz != last.rxKhz || next.txKhz != last.txKhz ||
+                   next.mode != last.mode || next.opCall != last.opCall ||
+                   next.running != last.running ||
+                   next.transmitting != last.transmitting ||
+                   next.connected != last.connected;
+    if (!changed && now - last.updated < kRadioRefresh)
+      break;
+    next.updated = now;
+    last = next;
+    state.pending.radios.push_back(std::move(next));
+    break;
+  }
+  case N1mm::Type::Spot: {
+    const N1mm::Spot &s = msg.spot;
+    // Deletions are the logger's band map ageing spots out; ours does that.
+    if (s.remove || s.dxCall.empty() || s.freqKhz <= 0)
+      break;
+    DXClusterSpot spot;
+    spot.txCall = s.dxCall;
+    spot.rxCall = s.spotter;
+    spot.freqKhz = s.freqKhz;
+    spot.mode = s.mode;
+    spot.spottedAt = now;
+    submit(src, spot, "N1MM");
+    break;
+  }
+  case N1mm::Type::Score: {
+    const N1mm::Score &s = msg.score;
+    ContestScore &out = state.pending.score;
+    out.contest = s.contest;
+    out.call = s.call;
+    out.score = s.score;
+    out.qsos = s.qsos;
+    out.points = s.points;
+    out.mults = s.mults;
+    out.updated = now;
+    state.pending.hasScore = true;
+    break;
+  }
+  case N1mm::Type::Unknown:
+    break;
+  }
+}
 
-        store_->addSpot(spot);
-
-        // Watchlist Check
-        if (watchlist_ && hits_ && watchlist_->contains(spot.txCall)) {
-          WatchlistHit hit;
-          hit.call = spot.txCall;
-          hit.freqKhz = spot.freqKhz;
-          hit.mode = "DX"; // Cluster usually doesn't specify mode clearly
-                           // without parsing comment
-          hit.source = "Cluster";
-          hit.time = spot.spottedAt;
-          hits_->addHit(hit);
-        }
-      }
+void DXClusterProvider::submit(Source &src, DXClusterSpot &spot,
+                               const char *sourceName) {
+  if (!ingest(src, spot))
+    return;
+  if (activity_) {
+    activity_->add(spot.band, spot.txCont, spot.rxCont,
+                   std::chrono::system_clock::to_time_t(spot.spottedAt));
+  }
+
+  // Watchlist Check
+  if (watchlist_ && hits_ && watchlist_->contains(spot.txCall) &&
+      (alertFilter_.empty() ||
+       alertFilter_.matches(spot.filterFields(), std::time(nullptr)))) {
+    WatchlistHit hit;
+    hit.call = spot.txCall;
+    hit.freqKhz = spot.freqKhz;
+    // Most cluster spots carry no mode word in the comment.
+    hit.mode = spot.mode.empty() ? "DX" : spot.mode;
+    hit.source = sourceName;
+    hit.time = spot.spottedAt;
+    hits_->addHit(hit);
+  }
+}
+
+bool DXClusterProvider::ingest(Source &src, DXClusterSpot &spot) {
+  std::lock_guard<std::mutex> lock(ingestMutex_);
+  src.received++;
+  uint32_t bit = 1u << src.index;
+  auto seen = dedup_.check(spot.txCall, spot.freqKhz, bit);
+  if (seen.duplicate) {
+    src.duplicates++;
+    if (seen.newSource)
+      store_->addSourceReport(spot.txCall, spot.freqKhz, seen.sources);
+    return false;
+  }
+  spot.sources = bit;
+  // Only spots that get stored are worth the lookups.
+  enricher_->enrich(spot);
+  store_->addSpot(spot);
+  return true;
+}
+
+void DXClusterProvider::maybePublishStats(bool force) {
+  std::lock_guard<std::mutex> lock(ingestMutex_);
+  auto now = std::chrono::steady_clock::now();
+  bool rateDue = now - lastStats_ >= kStatsInterval;
+  if (!force && !rateDue)
+    return;
+
+  double minutes = std::chrono::duration<double>(now - lastStats_).count() / 60;
+  std::vector<DXClusterSourceStatus> out;
+  out.reserve(sources_.size());
+  for (auto &src : sources_) {
+    DXClusterSourceStatus st;
+    st.name = src->cfg.name;
+    st.connected = src->connected;
+    st.received = src->received;
+    st.duplicates = src->duplicates;
+    if (rateDue) {
+      src->spotsPerMin = (st.received - src->receivedAtLastStats) / minutes;
+      src->receivedAtLastStats = st.received;
     }
+    st.spotsPerMin = src->spotsPerMin;
+    out.push_back(st);
   }
+  if (rateDue)
+    lastStats_ = now;
+  store_->setSources(std::move(out));
 }
 
 nlohmann::json DXClusterProvider::getDebugData() const {
   nlohmann::json j;
   j["running"] = running_.load();
   j["config_host"] = config_.dxClusterHost;
+  std::lock_guard<std::mutex> lock(ingestMutex_);
+  j["dedupEntries"] = dedup_.size();
+  auto sources = nlohmann::json::array();
+  for (const auto &src : sources_) {
+    uint64_t received = src->received;
+    uint64_t dups = src->duplicates;
+    sources.push_back({{"name", src->cfg.name},
+                       {"connected", src->connected.load()},
+                       {"received", received},
+                       {"duplicates", dups},
+                       {"spotsPerMin", src->spotsPerMin},
+                       {"wsjtxMessages", src->wsjtxMessages.load()},
+                       {"wsjtxErrors", src->wsjtxErrors.load()},
+                       {"n1mmMessages", src->n1mmMessages.load()},
+                       {"n1mmErrors", src->n1mmErrors.load()}});
+  }
+  j["sources"] = sources;
   return j;
 }
@@ -1,25 +1,52 @@
 #pragma once
 
+#include "../core/BandActivity.h"
 #include "../core/ConfigManager.h"
+#include "../core/ContestLogData.h"
 #include "../core/DXClusterData.h"
-#include "../core/PrefixManager.h"
+#include "../core/SpotDeduper.h"
+#include "../core/SpotEnricher.h"
+#include "../core/SpotFilter.h"
 #include "../core/WatchlistHitStore.h"
 #include "../core/WatchlistStore.h"
+#include "../core/WsjtxData.h"
+#include "N1MMProtocol.h"
+#include "WsjtxProtocol.h"
 #include <atomic>
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include <nlohmann/json.hpp>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
-struct HamClockState;
-
+// Connects to the configured DX cluster plus any extra sources, each on its
+// own thread with its own reconnect loop. Spots from all of them go through
+// one SpotDeduper, so a spot relayed by several clusters is stored once and
+// tagged with every source that reported it. Each new spot then goes through
+// the SpotEnricher, once, before it is stored; with a BandActivityMatrix, it
+// is also counted there.
+//
+// A UDP source takes plain spot lines, the WSJT-X / JTDX binary protocol
+// and N1MM Logger+'s XML broadcasts. WSJT-X decodes become spots heard by
+// that instance's DE call; Status, QSO Logged and Logged ADIF messages go
+// to the WsjtxStore, if one is given, and so do bare ADIF records such as
+// Log4OM sends. N1MM spots are stored like cluster spots, and its QSOs,
+// radios and score go to the ContestLogStore once per burst of datagrams.
+// A multicast group in the source's host field is joined.
 class DXClusterProvider {
 public:
   explicit DXClusterProvider(
-      std::shared_ptr<DXClusterDataStore> store, PrefixManager &pm,
+      std::shared_ptr<DXClusterDataStore> store,
+      std::shared_ptr<const SpotEnricher> enricher,
       std::shared_ptr<WatchlistStore> watchlist = nullptr,
       std::shared_ptr<WatchlistHitStore> hits = nullptr,
-      HamClockState *state = nullptr);
+      std::shared_ptr<BandActivityMatrix> activity = nullptr,
+      std::shared_ptr<WsjtxStore> wsjtx = nullptr,
+      std::shared_ptr<ContestLogStore> contestLog = nullptr);
   ~DXClusterProvider();
 
   void start(const AppConfig &config);
@@ -29,20 +56,90 @@ public:
   nlohmann::json getDebugData() const;
 
 private:
-  void run();
-  void runTelnet(const std::string &host, int port, const std::string &login);
-  void runUDP(int port);
+  // Bits in DXClusterSpot::sources.
+  static constexpr size_t kMaxSources = 32;
+  static constexpr auto kDedupWindow = std::chrono::minutes(3);
+  static constexpr auto kStatsInterval = std::chrono::seconds(10);
+  // Reconnect delay doubles from kRetryMin up to kRetryMax, with jitter.
+  static constexpr auto kRetryMin = std::chrono::seconds(5);
+  static constexpr auto kRetryMax = std::chrono::seconds(300);
+  // A session that lasted this long resets the backoff.
+  static constexpr auto kStableSession = std::chrono::seconds(60);
+  // Reconnect if the node sends nothing for this long, despite heartbeats.
+  static constexpr auto kIdleTimeout = std::chrono::minutes(5);
+  // Big enough for any WSJT-X message, Logged ADIF included.
+  static constexpr size_t kMaxDatagram = 64 * 1024;
+  // Datagrams read back to back before the contest log is published.
+  static constexpr int kMaxBurst = 256;
+  // An unchanged N1MM radio is republished this often, so the panel can
+  // tell one still on the air from one whose station went away.
+  static constexpr auto kRadioRefresh = std::chrono::seconds(30);
+
+  struct Source {
+    size_t index = 0;
+    DXClusterSource cfg;
+    std::string healthName;
+    std::thread thread;
+
+    std::atomic<bool> connected{false};
+    std::atomic<uint64_t> received{0};
+    std::atomic<uint64_t> duplicates{0};
+    // Guarded by ingestMutex_.
+    uint64_t receivedAtLastStats = 0;
+    double spotsPerMin = 0;
+    std::atomic<uint64_t> wsjtxMessages{0};
+    std::atomic<uint64_t> wsjtxErrors{0};
+    std::atomic<uint64_t> n1mmMessages{0};
+    std::atomic<uint64_t> n1mmErrors{0};
+  };
 
-  void processLine(const std::string &line);
+  // Last Status of each WSJT-X instance heard on one UDP source, by id.
+  using WsjtxPeers = std::unordered_map<std::string, WsjtxInstance>;
+  // N1MM state of one UDP source: each radio as last published, by station
+  // and radio number, and what the current burst collected.
+  struct N1mmState {
+    std::unordered_map<std::string, ContestRadio> radios;
+    ContestLogUpdate pending;
+  };
+
+  void run(Source &src);
+  // Both return whether the source came up at all, for the backoff.
+  bool runTelnet(Source &src);
+  bool runUDP(Source &src);
+  void setConnected(Source &src, bool connected, const std::string &status);
+
+  // Hands one UDP datagram to the parser for whatever protocol it is in.
+  void processDatagram(Source &src, std::string_view data, WsjtxPeers &peers,
+                       N1mmState &n1mm);
+  void processLine(Source &src, std::string_view line);
+  void processWsjtx(Source &src, const Wsjtx::Message &msg,
+                    WsjtxPeers &peers);
+  void processN1mm(Source &src, const N1mm::Message &msg, N1mmState &state);
+  // Stores a parsed spot and raises watchlist hits for it.
+  void submit(Source &src, DXClusterSpot &spot, const char *sourceName);
+  // Dedups, enriches and queues a parsed spot. Returns false for a
+  // duplicate.
+  bool ingest(Source &src, DXClusterSpot &spot);
+  // Publishes per-source counters at most every kStatsInterval.
+  void maybePublishStats(bool force = false);
 
   std::shared_ptr<DXClusterDataStore> store_;
-  PrefixManager &pm_;
+  std::shared_ptr<const SpotEnricher> enricher_;
   std::shared_ptr<WatchlistStore> watchlist_;
   std::shared_ptr<WatchlistHitStore> hits_;
+  std::shared_ptr<BandActivityMatrix> activity_;
+  std::shared_ptr<WsjtxStore> wsjtx_;
+  std::shared_ptr<ContestLogStore> contestLog_;
   AppConfig config_;
-  HamClockState *state_;
 
-  std::thread thread_;
+  std::vector<std::unique_ptr<Source>> sources_;
+  // Serialises the dedup stage and the store's single-producer ring.
+  mutable std::mutex ingestMutex_;
+  SpotDeduper dedup_{kDedupWindow};
+  // Watchlist hits must also pass this; read-only while threads run.
+  SpotFilter alertFilter_;
+  std::chrono::steady_clock::time_point lastStats_;
+
   std::atomic<bool> running_{false};
   std::atomic<bool> stopClicked_{false};
 };
@@ -1,5 +1,6 @@
 #include "DstProvider.h"
 #include "../core/Astronomy.h"
+#include "../core/Tracer.h"
 #include <algorithm>
 #include <chrono>
 #include <ctime>
@@ -13,7 +14,8 @@ DstProvider::DstProvider(NetworkManager &net, std::shared_ptr<DstStore> store)
 void DstProvider::fetch() {
   const char *url = "https://services.swpc.noaa.gov/products/kyoto-dst.json";
 
-  net_.fetchAsync(url, [this](std::string body) {
+  fetches_.add(net_.fetchAsync(url, [this](std::string body) {
+    TRACE_SCOPE("provider", "DstProvider::parse");
     if (body.empty())
       return;
 
@@ -72,5 +74,5 @@ void DstProvider::fetch() {
       }
     } catch (...) {
     }
-  });
+  }));
 }
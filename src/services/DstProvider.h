@@ -12,4 +12,6 @@ public:
 private:
   NetworkManager &net_;
   std::shared_ptr<DstStore> store_;
+
+  FetchGroup fetches_;
 };
@@ -1,5 +1,6 @@
 #include "HistoryProvider.h"
 #include "../core/Astronomy.h"
+#include "../core/Tracer.h"
 #include <algorithm>
 #include <sstream>
 
@@ -8,24 +9,27 @@ HistoryProvider::HistoryProvider(NetworkManager &net,
     : net_(net), store_(std::move(store)) {}
 
 void HistoryProvider::fetchFlux() {
-  net_.fetchAsync(FLUX_URL, [this](std::string body) {
+  fetches_.add(net_.fetchAsync(FLUX_URL, [this](std::string body) {
+    TRACE_SCOPE("provider", "HistoryProvider::parseFlux");
     if (!body.empty())
       processFlux(body);
-  });
+  }));
 }
 
 void HistoryProvider::fetchSSN() {
-  net_.fetchAsync(FLUX_URL, [this](std::string body) {
+  fetches_.add(net_.fetchAsync(FLUX_URL, [this](std::string body) {
+    TRACE_SCOPE("provider", "HistoryProvider::parseSSN");
     if (!body.empty())
       processSSN(body);
-  });
+  }));
 }
 
 void HistoryProvider::fetchKp() {
-  net_.fetchAsync(KP_URL, [this](std::string body) {
+  fetches_.add(net_.fetchAsync(KP_URL, [this](std::string body) {
+    TRACE_SCOPE("provider", "HistoryProvider::parseKp");
     if (!body.empty())
       processKp(body);
-  });
+  }));
 }
 
 void HistoryProvider::processFlux(const std::string &body) {
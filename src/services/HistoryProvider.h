@@ -25,4 +25,6 @@ private:
       "https://services.swpc.noaa.gov/text/daily-solar-indices.txt";
   static constexpr const char *KP_URL =
       "https://services.swpc.noaa.gov/text/daily-geomagnetic-indices.txt";
+
+  FetchGroup fetches_;
 };
@@ -1,10 +1,14 @@
 #include "LiveSpotProvider.h"
-#include "../core/HamClockState.h"
 #include "../core/Logger.h"
+#include "../core/ServiceHealth.h"
+#include "../core/SpotFilter.h"
+#include "../core/Tracer.h"
 
+#include <algorithm>
 #include <chrono>
 #include <cstdlib>
 #include <ctime>
+#include <memory>
 #include <nlohmann/json.hpp>
 #include <spdlog/fmt/fmt.h>
 #include <string>
@@ -28,11 +32,20 @@ std::string extractAttr(const std::string &tag, const char *attr) {
 // and collecting individual spot records for map plotting.
 // If plotReceivers is true (DE mode), we map who heard us (ReceiverLocator,
 // ReceiverCallsign). If plotReceivers is false (DX mode), we map who we heard
-// (SenderLocator, SenderCallsign).
+// (SenderLocator, SenderCallsign). Every report goes through 'enricher', and
+// 'filter', with the mapped station as the DX and the other one as the
+// spotter; reports the filter rejects are skipped. Reports newer than
+// 'countedThrough' go into 'activity', and 'countedThrough' moves up to the
+// newest of them.
 void parsePSKReporter(const std::string &body, LiveSpotData &data,
-                      bool plotReceivers) {
+                      bool plotReceivers, const SpotFilter &filter,
+                      const SpotEnricher &enricher,
+                      BandActivityMatrix *activity, int64_t &countedThrough) {
   std::string::size_type pos = 0;
   int total = 0;
+  int filtered = 0;
+  int64_t now = std::time(nullptr);
+  int64_t newest = countedThrough;
 
   while (pos < body.size()) {
     auto tagStart = body.find("<receptionReport ", pos);
@@ -52,34 +65,75 @@ void parsePSKReporter(const std::string &body, LiveSpotData &data,
       double freqKhz = static_cast<double>(freqHz) / 1000.0;
       int idx = freqToBandIndex(freqKhz);
       if (idx >= 0) {
-        data.bandCounts[idx]++;
-        total++;
-
         std::string grid;
         std::string call;
+        std::string otherGrid;
+        std::string otherCall;
 
         if (plotReceivers) {
           // We are the sender. Map the receiver.
           grid = extractAttr(tag, "receiverLocator");
           call = extractAttr(tag, "receiverCallsign");
+          otherGrid = extractAttr(tag, "senderLocator");
+          otherCall = extractAttr(tag, "senderCallsign");
         } else {
           // We are the receiver. Map the sender.
           grid = extractAttr(tag, "senderLocator");
           call = extractAttr(tag, "senderCallsign");
+          otherGrid = extractAttr(tag, "receiverLocator");
+          otherCall = extractAttr(tag, "receiverCallsign");
         }
 
-        if (grid.size() >= 4) {
-          // Store in generic fields (SpotRecord uses receiverGrid for location)
-          data.spots.push_back({freqKhz, grid, call});
+        std::string modeName = extractAttr(tag, "mode");
+        SpotEnricher::Result r = enricher.enrich(
+            {call, grid, otherCall, otherGrid, modeName, freqKhz});
+
+        int64_t spottedAt =
+            std::atoll(extractAttr(tag, "flowStartSeconds").c_str());
+        if (activity && spottedAt > countedThrough) {
+          // The path runs from sender to receiver.
+          if (plotReceivers)
+            activity->add(idx, r.rx.cont, r.tx.cont, spottedAt);
+          else
+            activity->add(idx, r.tx.cont, r.rx.cont, spottedAt);
+          newest = std::max(newest, spottedAt);
         }
+
+        if (!filter.empty()) {
+          SpotFilter::Fields f;
+          f.band = idx;
+          f.mode = r.mode;
+          f.dxcc = r.tx.dxcc;
+          f.need = r.need;
+          f.dxCont = r.tx.cont;
+          f.deCont = r.rx.cont;
+          f.freqKhz = freqKhz;
+          f.spottedAt = spottedAt;
+          f.call = call;
+          f.spotter = otherCall;
+          if (!filter.matches(f, now)) {
+            filtered++;
+            pos = tagEnd + 1;
+            continue;
+          }
+        }
+
+        data.bandCounts[idx]++;
+        total++;
+
+        // Without a grid, the position is the entity's.
+        if (r.tx.from != SpotStation::From::None)
+          data.spots.push_back(freqKhz, idx, r.tx.lat, r.tx.lon, call, grid,
+                               r.need);
       }
     }
 
     pos = tagEnd + 1;
   }
+  countedThrough = newest;
 
-  LOG_I("LiveSpot", "Parsed {} spots ({} with grids)", total,
-        data.spots.size());
+  LOG_I("LiveSpot", "Parsed {} spots ({} located, {} filtered out)", total,
+        data.spots.size(), filtered);
 }
 
 } // namespace
@@ -87,8 +141,10 @@ void parsePSKReporter(const std::string &body, LiveSpotData &data,
 LiveSpotProvider::LiveSpotProvider(NetworkManager &net,
                                    std::shared_ptr<LiveSpotDataStore> store,
                                    const AppConfig &config,
-                                   HamClockState *state)
-    : net_(net), store_(std::move(store)), config_(config), state_(state) {}
+                                   std::shared_ptr<const SpotEnricher> enricher,
+                                   std::shared_ptr<BandActivityMatrix> activity)
+    : net_(net), store_(std::move(store)), config_(config),
+      enricher_(std::move(enricher)), activity_(std::move(activity)) {}
 
 void LiveSpotProvider::fetch() {
   std::string target;
@@ -126,44 +182,45 @@ void LiveSpotProvider::fetch() {
                                 param, target, windowStart);
 
   LOG_I("LiveSpot", "Fetching {}", url);
-  if (state_) {
-    state_->services["LiveSpot"].lastError = "Fetching...";
-  }
+  ServiceHealthRegistry::instance().get("LiveSpot").setNote("Fetching...");
 
   auto store = store_;
   auto grid = config_.grid;
-  auto state = state_;
   bool ofDe = config_.pskOfDe;
-
-  net_.fetchAsync(
+  auto enricher = enricher_;
+  auto activity = activity_;
+  auto countedThrough = countedThrough_;
+  auto filter = std::make_shared<SpotFilter>();
+  std::string filterError;
+  if (!filter->compile(config_.spotFilterPsk, &filterError))
+    LOG_W("LiveSpot", "Ignoring spot filter: {}", filterError);
+
+  fetches_.add(net_.fetchAsync(
       url,
-      [store, grid, state, ofDe](std::string body) {
+      [store, grid, ofDe, filter, enricher, activity,
+       countedThrough](std::string body) {
+        TRACE_SCOPE("provider", "LiveSpotProvider::parse");
         LiveSpotData data;
         data.grid = grid.substr(0, 4);
         data.windowMinutes = 30; // TODO: from config
+        auto &health = ServiceHealthRegistry::instance().get("LiveSpot");
 
         if (!body.empty()) {
-          parsePSKReporter(body, data, ofDe);
-          if (state) {
-            auto &s = state->services["LiveSpot"];
-            s.ok = true;
-            s.lastSuccess = std::chrono::system_clock::now();
-            s.lastError = "";
-          }
+          int64_t through = countedThrough->load();
+          parsePSKReporter(body, data, ofDe, *filter, *enricher,
+                           activity.get(), through);
+          countedThrough->store(through);
+          health.markSuccess();
         } else {
           LOG_W("LiveSpot", "Empty response from PSK Reporter");
-          if (state) {
-            auto &s = state->services["LiveSpot"];
-            s.ok = false;
-            s.lastError = "Empty response";
-          }
+          health.markFailure("Empty response");
         }
 
         data.lastUpdated = std::chrono::system_clock::now();
         data.valid = true;
         store->set(data);
       },
-      300); // 5 minute cache age
+      300)); // 5 minute cache age
 }
 
 nlohmann::json LiveSpotProvider::getDebugData() const {
@@ -1,21 +1,27 @@
 #pragma once
 
+#include "../core/BandActivity.h"
 #include "../core/ConfigManager.h"
 #include "../core/LiveSpotData.h"
+#include "../core/SpotEnricher.h"
 #include "../network/NetworkManager.h"
 
+#include <atomic>
 #include <memory>
 #include <nlohmann/json.hpp>
 #include <spdlog/fmt/fmt.h>
 #include <string>
 
-struct HamClockState;
-
 class LiveSpotProvider {
 public:
+  // Each report goes through 'enricher' for the mapped station's entity,
+  // position and what it would add to the log. With 'activity', reports not
+  // seen in an earlier fetch are counted there, filtered or not.
   LiveSpotProvider(NetworkManager &net,
                    std::shared_ptr<LiveSpotDataStore> store,
-                   const AppConfig &config, HamClockState *state = nullptr);
+                   const AppConfig &config,
+                   std::shared_ptr<const SpotEnricher> enricher,
+                   std::shared_ptr<BandActivityMatrix> activity = nullptr);
 
   void fetch();
   void updateConfig(const AppConfig &config) { config_ = config; }
@@ -25,5 +31,12 @@ private:
   NetworkManager &net_;
   std::shared_ptr<LiveSpotDataStore> store_;
   AppConfig config_;
-  HamClockState *state_;
+  std::shared_ptr<const SpotEnricher> enricher_;
+  std::shared_ptr<BandActivityMatrix> activity_;
+  // Newest report time already counted in 'activity_'; each fetch returns
+  // the whole window again.
+  std::shared_ptr<std::atomic<int64_t>> countedThrough_ =
+      std::make_shared<std::atomic<int64_t>>(0);
+
+  FetchGroup fetches_;
 };
@@ -1,6 +1,7 @@
 #include "MoonProvider.h"
 #include "../core/Astronomy.h"
 #include "../core/Logger.h"
+#include "../core/Tracer.h"
 #include <ctime>
 #include <iomanip>
 #include <nlohmann/json.hpp>
@@ -33,7 +34,8 @@ void MoonProvider::update(double lat, double lon) {
   std::string url = "https://svs.gsfc.nasa.gov/api/dialamoon/" + isoDate;
 
   auto store = store_;
-  net_.fetchAsync(url, [isoDate, store](std::string body) {
+  fetches_.add(net_.fetchAsync(url, [isoDate, store](std::string body) {
+    TRACE_SCOPE("provider", "MoonProvider::parse");
     if (body.empty()) {
       LOG_E("MoonProvider", "Failed to fetch NASA data for {}", isoDate);
       return;
@@ -79,5 +81,5 @@ void MoonProvider::update(double lat, double lon) {
     } catch (const std::exception &e) {
       LOG_E("MoonProvider", "JSON error: {}", e.what());
     }
-  });
+  }));
 }
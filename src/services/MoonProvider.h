@@ -13,4 +13,6 @@ public:
 private:
   NetworkManager &net_;
   std::shared_ptr<MoonStore> store_;
+
+  FetchGroup fetches_;
 };
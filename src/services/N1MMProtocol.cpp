@@ -0,0 +1,591 @@
+#include "N1MMProtocol.h"
+
+#include <charconv>
+#include <chrono>
+
+namespace N1mm {
+
+namespace {
+
+// Deepest element we follow: root, breakdown, qso.
+constexpr int kMaxDepth = 8;
+
+bool iequals(std::string_view a, std::string_view b) {
+  if (a.size() != b.size())
+    return false;
+  for (size_t i = 0; i < a.size(); ++i) {
+    char x = a[i], y = b[i];
+    if (x >= 'a' && x <= 'z')
+      x = static_cast<char>(x - 'a' + 'A');
+    if (y >= 'a' && y <= 'z')
+      y = static_cast<char>(y - 'a' + 'A');
+    if (x != y)
+      return false;
+  }
+  return true;
+}
+
+bool isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+std::string_view trim(std::string_view s) {
+  while (!s.empty() && isSpace(s.front()))
+    s.remove_prefix(1);
+  while (!s.empty() && isSpace(s.back()))
+    s.remove_suffix(1);
+  return s;
+}
+
+// Appends 'raw' with the predefined entities and character references
+// replaced. Anything else after '&' is kept as it was sent.
+void appendUnescaped(std::string &out, std::string_view raw) {
+  static constexpr struct {
+    std::string_view name;
+    char c;
+  } kEntities[] = {
+      {"amp;", '&'},  {"lt;", '<'},    {"gt;", '>'},
+      {"quot;", '"'}, {"apos;", '\''},
+  };
+
+  while (!raw.empty()) {
+    size_t amp = raw.find('&');
+    out.append(raw.substr(0, amp));
+    if (amp == std::string_view::npos)
+      return;
+    raw.remove_prefix(amp + 1);
+
+    bool done = false;
+    for (const auto &e : kEntities) {
+      if (raw.substr(0, e.name.size()) == e.name) {
+        out.push_back(e.c);
+        raw.remove_prefix(e.name.size());
+        done = true;
+        break;
+      }
+    }
+    size_t semi = raw.find(';');
+    if (!done && !raw.empty() && raw[0] == '#' &&
+        semi != std::string_view::npos) {
+      bool hex = semi > 1 && (raw[1] == 'x' || raw[1] == 'X');
+      const char *first = raw.data() + (hex ? 2 : 1);
+      uint32_t cp = 0;
+      auto [end, ec] =
+          std::from_chars(first, raw.data() + semi, cp, hex ? 16 : 10);
+      if (ec == std::errc() && end == raw.data() + semi && cp > 0 &&
+          cp <= 0x10FFFF) {
+        // As UTF-8.
+        if (cp < 0x80) {
+          out.push_back(static_cast<char>(cp));
+        } else if (cp < 0x800) {
+          out.push_back(static_cast<char>(0xC0 | cp >> 6));
+          out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        } else if (cp < 0x10000) {
+          out.push_back(static_cast<char>(0xE0 | cp >> 12));
+          out.push_back(static_cast<char>(0x80 | (cp >> 6 & 0x3F)));
+          out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        } else {
+          out.push_back(static_cast<char>(0xF0 | cp >> 18));
+          out.push_back(static_cast<char>(0x80 | (cp >> 12 & 0x3F)));
+          out.push_back(static_cast<char>(0x80 | (cp >> 6 & 0x3F)));
+          out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+        }
+        raw.remove_prefix(semi + 1);
+        done = true;
+      }
+    }
+    if (!done)
+      out.push_back('&');
+  }
+}
+
+void appendEscaped(std::string &out, std::string_view s) {
+  for (char c : s) {
+    switch (c) {
+    case '&':
+      out += "&amp;";
+      break;
+    case '<':
+      out += "&lt;";
+      break;
+    case '>':
+      out += "&gt;";
+      break;
+    default:
+      out.push_back(c);
+    }
+  }
+}
+
+// Pulls one tag or run of text at a time out of an XML document, without
+// building a tree or copying anything. Just enough XML for the loggers'
+// broadcasts: declarations, comments and DOCTYPE are skipped, CDATA is
+// text, and attribute values may be quoted either way.
+class XmlReader {
+public:
+  enum class Event { StartTag, EndTag, EmptyTag, Text, CData, End, Error };
+
+  explicit XmlReader(std::string_view doc) : doc_(doc) {}
+
+  Event next() {
+    for (;;) {
+      if (pos_ >= doc_.size())
+        return Event::End;
+      if (doc_[pos_] != '<') {
+        size_t lt = doc_.find('<', pos_);
+        if (lt == std::string_view::npos)
+          lt = doc_.size();
+        text_ = doc_.substr(pos_, lt - pos_);
+        pos_ = lt;
+        return Event::Text;
+      }
+
+      std::string_view rest = doc_.substr(pos_);
+      if (rest.starts_with("<?")) {
+        if (!skipPast("?>"))
+          return Event::Error;
+        continue;
+      }
+      if (rest.starts_with("<!--")) {
+        if (!skipPast("-->"))
+          return Event::Error;
+        continue;
+      }
+      if (rest.starts_with("<![CDATA[")) {
+        size_t end = doc_.find("]]>", pos_ + 9);
+        if (end == std::string_view::npos)
+          return Event::Error;
+        text_ = doc_.substr(pos_ + 9, end - pos_ - 9);
+        pos_ = end + 3;
+        return Event::CData;
+      }
+      if (rest.starts_with("<!")) {
+        if (!skipPast(">"))
+          return Event::Error;
+        continue;
+      }
+      return tag();
+    }
+  }
+
+  std::string_view name() const { return name_; }
+  std::string_view text() const { return text_; }
+
+  // The raw value of attribute 'key' of the last start or empty tag.
+  bool attribute(std::string_view key, std::string_view &value) const {
+    std::string_view a = attrs_;
+    for (;;) {
+      a = trim(a);
+      size_t eq = a.find('=');
+      if (eq == std::string_view::npos)
+        return false;
+      std::string_view k = trim(a.substr(0, eq));
+      a = trim(a.substr(eq + 1));
+      if (a.empty() || (a[0] != '"' && a[0] != '\''))
+        return false;
+      size_t close = a.find(a[0], 1);
+      if (close == std::string_view::npos)
+        return false;
+      if (iequals(k, key)) {
+        value = a.substr(1, close - 1);
+        return true;
+      }
+      a.remove_prefix(close + 1);
+    }
+  }
+
+private:
+  bool skipPast(std::string_view end) {
+    size_t at = doc_.find(end, pos_);
+    if (at == std::string_view::npos)
+      return false;
+    pos_ = at + end.size();
+    return true;
+  }
+
+  Event tag() {
+    // Find the closing '>' outside quoted attribute values.
+    size_t i = pos_ + 1;
+    char quote = 0;
+    for (; i < doc_.size(); ++i) {
+      char c = doc_[i];
+      if (quote) {
+        if (c == quote)
+          quote = 0;
+      } else if (c == '"' || c == '\'') {
+        quote = c;
+      } else if (c == '>') {
+        break;
+      }
+    }
+    if (i >= doc_.size())
+      return Event::Error;
+    std::string_view inner = doc_.substr(pos_ + 1, i - pos_ - 1);
+    pos_ = i + 1;
+
+    Event ev = Event::StartTag;
+    if (!inner.empty() && inner.front() == '/') {
+      ev = Event::EndTag;
+      inner.remove_prefix(1);
+    } else if (!inner.empty() && inner.back() == '/') {
+      ev = Event::EmptyTag;
+      inner.remove_suffix(1);
+    }
+    size_t n = 0;
+    while (n < inner.size() && !isSpace(inner[n]))
+      n++;
+    name_ = inner.substr(0, n);
+    attrs_ = inner.substr(n);
+    if (name_.empty())
+      return Event::Error;
+    return ev;
+  }
+
+  std::string_view doc_;
+  size_t pos_ = 0;
+  std::string_view name_;
+  std::string_view attrs_;
+  std::string_view text_;
+};
+
+// "14025.3" or "1402530"; locale-independent, like the cluster parser.
+bool parseDecimal(std::string_view s, double &out) {
+  s = trim(s);
+  bool negative = !s.empty() && s[0] == '-';
+  if (negative)
+    s.remove_prefix(1);
+  long long whole = 0;
+  const char *p = s.data();
+  const char *end = s.data() + s.size();
+  auto [next, ec] = std::from_chars(p, end, whole);
+  if (ec != std::errc())
+    return false;
+  double frac = 0, scale = 0.1;
+  if (next != end && *next == '.') {
+    for (++next; next != end && *next >= '0' && *next <= '9'; ++next) {
+      frac += (*next - '0') * scale;
+      scale *= 0.1;
+    }
+  }
+  if (next != end)
+    return false;
+  out = static_cast<double>(whole) + frac;
+  if (negative)
+    out = -out;
+  return true;
+}
+
+template <typename Int> void parseInt(std::string_view s, Int &out) {
+  s = trim(s);
+  Int v = 0;
+  auto [next, ec] = std::from_chars(s.data(), s.data() + s.size(), v);
+  if (ec == std::errc() && next == s.data() + s.size())
+    out = v;
+}
+
+// N1MM frequencies are in units of 10 Hz.
+void parseTensOfHz(std::string_view s, double &khz) {
+  double v;
+  if (parseDecimal(s, v))
+    khz = v / 100.0;
+}
+
+bool parseBool(std::string_view s) {
+  s = trim(s);
+  return iequals(s, "true") || s == "1";
+}
+
+Type typeOf(std::string_view root) {
+  if (iequals(root, "contactinfo"))
+    return Type::Contact;
+  if (iequals(root, "contactreplace"))
+    return Type::ContactReplace;
+  if (iequals(root, "contactdelete"))
+    return Type::ContactDelete;
+  if (iequals(root, "RadioInfo"))
+    return Type::Radio;
+  if (iequals(root, "spot"))
+    return Type::Spot;
+  if (iequals(root, "dynamicresults"))
+    return Type::Score;
+  return Type::Unknown;
+}
+
+void contactField(Contact &c, std::string_view name, std::string_view v) {
+  if (iequals(name, "ID"))
+    c.id = v;
+  else if (iequals(name, "timestamp"))
+    c.time = parseTimestamp(v);
+  else if (iequals(name, "call"))
+    c.call = v;
+  else if (iequals(name, "band"))
+    c.band = v;
+  else if (iequals(name, "rxfreq"))
+    parseTensOfHz(v, c.rxKhz);
+  else if (iequals(name, "txfreq"))
+    parseTensOfHz(v, c.txKhz);
+  else if (iequals(name, "mode"))
+    c.mode = v;
+  else if (iequals(name, "contestname"))
+    c.contest = v;
+  else if (iequals(name, "mycall"))
+    c.myCall = v;
+  else if (iequals(name, "operator"))
+    c.operatorCall = v;
+  else if (iequals(name, "StationName"))
+    c.stationName = v;
+  else if (iequals(name, "points"))
+    parseInt(v, c.points);
+}
+
+void radioField(Radio &r, std::string_view name, std::string_view v) {
+  if (iequals(name, "StationName"))
+    r.stationName = v;
+  else if (iequals(name, "RadioNr"))
+    parseInt(v, r.radioNr);
+  else if (iequals(name, "Freq"))
+    parseTensOfHz(v, r.rxKhz);
+  else if (iequals(name, "TXFreq"))
+    parseTensOfHz(v, r.txKhz);
+  else if (iequals(name, "Mode"))
+    r.mode = v;
+  else if (iequals(name, "OpCall"))
+    r.opCall = v;
+  else if (iequals(name, "RadioName"))
+    r.radioName = v;
+  else if (iequals(name, "IsRunning"))
+    r.running = parseBool(v);
+  else if (iequals(name, "IsTransmitting"))
+    r.transmitting = parseBool(v);
+  else if (iequals(name, "IsConnected"))
+    r.connected = parseBool(v);
+}
+
+void spotField(Spot &s, std::string_view name, std::string_view v) {
+  if (iequals(name, "dxcall"))
+    s.dxCall = v;
+  else if (iequals(name, "frequency"))
+    parseDecimal(v, s.freqKhz);
+  else if (iequals(name, "spottercall"))
+    s.spotter = v;
+  else if (iequals(name, "comment"))
+    s.comment = v;
+  else if (iequals(name, "mode"))
+    s.mode = v;
+  else if (iequals(name, "action"))
+    s.remove = iequals(trim(v), "delete");
+  else if (iequals(name, "StationName"))
+    s.stationName = v;
+}
+
+void scoreField(Score &s, std::string_view name, std::string_view v) {
+  if (iequals(name, "contest"))
+    s.contest = v;
+  else if (iequals(name, "call"))
+    s.call = v;
+  else if (iequals(name, "score"))
+    parseInt(v, s.score);
+}
+
+// <qso band="total" mode="ALL">35</qso> and its siblings.
+void breakdownTotal(Score &s, std::string_view name, std::string_view v) {
+  int n = 0;
+  parseInt(v, n);
+  if (iequals(name, "qso"))
+    s.qsos = n;
+  else if (iequals(name, "point"))
+    s.points = n;
+  else
+    s.mults += n;
+}
+
+} // namespace
+
+bool isMessage(const void *data, size_t size) {
+  std::string_view s(static_cast<const char *>(data), size);
+  if (s.starts_with("\xEF\xBB\xBF"))
+    s.remove_prefix(3);
+  while (!s.empty() && isSpace(s.front()))
+    s.remove_prefix(1);
+  if (s.starts_with("<?xml"))
+    return true;
+  // An element name, not an ADIF field such as <call:5>.
+  if (s.size() < 3 || s[0] != '<')
+    return false;
+  char c = s[1];
+  if (!((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z')))
+    return false;
+  size_t end = s.find_first_of(":> \t\r\n");
+  return end != std::string_view::npos && s[end] != ':';
+}
+
+bool parse(const void *data, size_t size, Message &out) {
+  std::string_view doc(static_cast<const char *>(data), size);
+  if (doc.starts_with("\xEF\xBB\xBF"))
+    doc.remove_prefix(3);
+  XmlReader r(doc);
+
+  std::string_view open[kMaxDepth];
+  bool total[kMaxDepth] = {};
+  int depth = 0;
+  bool rootSeen = false;
+  bool hasChild = false; // whether the innermost open element has children
+  std::string value;     // its text, unescaped
+
+  for (;;) {
+    XmlReader::Event ev = r.next();
+    switch (ev) {
+    case XmlReader::Event::End:
+      return rootSeen && depth == 0;
+    case XmlReader::Event::Error:
+      return false;
+
+    case XmlReader::Event::StartTag:
+    case XmlReader::Event::EmptyTag: {
+      if (depth == 0) {
+        // A second root element is not XML.
+        if (rootSeen)
+          return false;
+        rootSeen = true;
+        out.root = r.name();
+        out.type = typeOf(r.name());
+        switch (out.type) {
+        case Type::Contact:
+        case Type::ContactReplace:
+        case Type::ContactDelete:
+          out.contact = {};
+          break;
+        case Type::Radio:
+          out.radio = {};
+          break;
+        case Type::Spot:
+          out.spot = {};
+          break;
+        case Type::Score:
+          out.score = {};
+          break;
+        case Type::Unknown:
+          break;
+        }
+      }
+      if (ev == XmlReader::Event::EmptyTag)
+        break;
+      if (depth == kMaxDepth)
+        return false;
+      // Only the breakdown's all-band, all-mode totals are kept.
+      std::string_view band, mode;
+      total[depth] = r.attribute("band", band) && iequals(band, "total") &&
+                     (!r.attribute("mode", mode) || iequals(mode, "ALL"));
+      open[depth++] = r.name();
+      hasChild = false;
+      value.clear();
+      break;
+    }
+
+    case XmlReader::Event::EndTag: {
+      if (depth == 0 || r.name() != open[depth - 1])
+        return false;
+      depth--;
+      // A leaf: one of the message's fields.
+      if (!hasChild) {
+        std::string_view name = open[depth];
+        if (depth == 1) {
+          switch (out.type) {
+          case Type::Contact:
+          case Type::ContactReplace:
+          case Type::ContactDelete:
+            contactField(out.contact, name, value);
+            break;
+          case Type::Radio:
+            radioField(out.radio, name, value);
+            break;
+          case Type::Spot:
+            spotField(out.spot, name, value);
+            break;
+          case Type::Score:
+            scoreField(out.score, name, value);
+            break;
+          case Type::Unknown:
+            break;
+          }
+        } else if (depth == 2 && out.type == Type::Score && total[depth] &&
+                   iequals(open[1], "breakdown")) {
+          breakdownTotal(out.score, name, value);
+        }
+      }
+      hasChild = true; // for the parent
+      value.clear();
+      break;
+    }
+
+    case XmlReader::Event::Text:
+      if (depth == 0) {
+        if (!trim(r.text()).empty())
+          return false;
+        break;
+      }
+      appendUnescaped(value, r.text());
+      break;
+    case XmlReader::Event::CData:
+      if (depth == 0)
+        return false;
+      value.append(r.text());
+      break;
+    }
+  }
+}
+
+int64_t parseTimestamp(std::string_view s) {
+  s = trim(s);
+  // "2020-01-17 16:43:38", or with a 'T'.
+  if (s.size() < 19 || s[4] != '-' || s[7] != '-' ||
+      (s[10] != ' ' && s[10] != 'T') || s[13] != ':' || s[16] != ':')
+    return 0;
+  auto num = [&](size_t at, size_t len, int &v) {
+    auto [next, ec] = std::from_chars(s.data() + at, s.data() + at + len, v);
+    return ec == std::errc() && next == s.data() + at + len;
+  };
+  int y, mo, d, h, mi, sec;
+  if (!num(0, 4, y) || !num(5, 2, mo) || !num(8, 2, d) || !num(11, 2, h) ||
+      !num(14, 2, mi) || !num(17, 2, sec))
+    return 0;
+  std::chrono::year_month_day ymd{std::chrono::year{y},
+                                  std::chrono::month{static_cast<unsigned>(mo)},
+                                  std::chrono::day{static_cast<unsigned>(d)}};
+  if (!ymd.ok() || h > 23 || mi > 59 || sec > 60)
+    return 0;
+  auto days = std::chrono::sys_days{ymd}.time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::seconds>(days).count() +
+         h * 3600 + mi * 60 + sec;
+}
+
+Writer::Writer(std::string_view root) : root_(root) {
+  buf_ = "<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n<";
+  buf_ += root_;
+  buf_ += ">\r\n";
+}
+
+Writer &Writer::field(std::string_view name, std::string_view value) {
+  buf_ += '\t';
+  buf_ += '<';
+  buf_ += name;
+  buf_ += '>';
+  appendEscaped(buf_, value);
+  buf_ += "</";
+  buf_ += name;
+  buf_ += ">\r\n";
+  return *this;
+}
+
+Writer &Writer::field(std::string_view name, int64_t value) {
+  return field(name, std::to_string(value));
+}
+
+Writer &Writer::raw(std::string_view xml) {
+  buf_ += xml;
+  return *this;
+}
+
+std::string Writer::data() const { return buf_ + "</" + root_ + ">\r\n"; }
+
+} // namespace N1mm
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// The UDP broadcasts of N1MM Logger+, also sent by loggers that copy them
+// (DXLog, Log4OM's N1MM output). Each datagram is one small XML document
+// whose root element names the message:
+//
+//   <?xml version="1.0" encoding="utf-8"?>
+//   <contactinfo><app>N1MM</app><call>K1ABC</call>...</contactinfo>
+//
+// Frequencies in contactinfo and RadioInfo are in tens of hertz ("1402500"
+// is 14025.00 kHz); a spot's are in kHz. Every station of a multi-op
+// network broadcasts for itself and names itself in StationName.
+namespace N1mm {
+
+enum class Type : uint8_t {
+  Unknown,        // AppInfo, lookupinfo, and anything else we do not use
+  Contact,        // contactinfo: a QSO was logged
+  ContactReplace, // a logged QSO was edited
+  ContactDelete,
+  Radio, // RadioInfo
+  Spot,
+  Score, // dynamicresults
+};
+
+struct Contact {
+  std::string id;   // stays the same when the QSO is edited
+  int64_t time = 0; // Unix seconds; 0 if not sent
+  std::string call;
+  std::string band; // in MHz: "3.5", "14"
+  double rxKhz = 0;
+  double txKhz = 0;
+  std::string mode;
+  std::string contest;
+  std::string myCall;
+  std::string operatorCall;
+  std::string stationName;
+  int points = 0;
+};
+
+struct Radio {
+  std::string stationName;
+  int radioNr = 0;
+  double rxKhz = 0;
+  double txKhz = 0;
+  std::string mode;
+  std::string opCall;
+  std::string radioName;
+  bool running = false; // calling CQ rather than searching
+  bool transmitting = false;
+  bool connected = false;
+};
+
+struct Spot {
+  std::string dxCall;
+  double freqKhz = 0;
+  std::string spotter;
+  std::string comment;
+  std::string mode;
+  bool remove = false; // action "delete": the spot left the band map
+  std::string stationName;
+};
+
+// The score the logger would post to an online scoreboard.
+struct Score {
+  std::string contest;
+  std::string call;
+  int64_t score = 0;
+  // From the breakdown's all-band, all-mode totals; every total that is
+  // not QSOs or points is a multiplier.
+  int qsos = 0;
+  int points = 0;
+  int mults = 0;
+};
+
+// One decoded datagram. Only the member for 'type' is filled.
+struct Message {
+  Type type = Type::Unknown;
+  std::string root; // the root element's name
+  Contact contact;
+  Radio radio;
+  Spot spot;
+  Score score;
+};
+
+// True if 'data' starts with an XML declaration or element, after any
+// byte order mark and white space. ADIF starts with a field or header text.
+bool isMessage(const void *data, size_t size);
+
+// Parses one datagram. Returns false if the XML is malformed or cut short;
+// unknown root elements succeed with type Unknown. Element names are
+// matched without regard to case, since the loggers that copy N1MM do not
+// all spell them the same.
+bool parse(const void *data, size_t size, Message &out);
+
+// "2020-01-17 16:43:38" in UTC to Unix seconds, or 0 if it is not one.
+int64_t parseTimestamp(std::string_view s);
+
+// Builds messages the way N1MM does, for the replay tool and tests.
+class Writer {
+public:
+  explicit Writer(std::string_view root);
+
+  // <name>value</name>, with the value escaped.
+  Writer &field(std::string_view name, std::string_view value);
+  Writer &field(std::string_view name, int64_t value);
+  // Inserted as is, for nested elements.
+  Writer &raw(std::string_view xml);
+
+  // The document so far, closed.
+  std::string data() const;
+
+private:
+  std::string root_;
+  std::string buf_;
+};
+
+} // namespace N1mm
@@ -1,18 +1,19 @@
 #include "NOAAProvider.h"
 
 #include "../core/Astronomy.h"
-#include "../core/HamClockState.h"
 #include "../core/Logger.h"
+#include "../core/ServiceHealth.h"
+#include "../core/Tracer.h"
 #include <chrono>
 #include <cstdio>
+#include <optional>
 #include <nlohmann/json.hpp>
 
 NOAAProvider::NOAAProvider(NetworkManager &net,
                            std::shared_ptr<SolarDataStore> store,
-                           std::shared_ptr<AuroraHistoryStore> auroraStore,
-                           HamClockState *state)
-    : net_(net), store_(std::move(store)), auroraStore_(std::move(auroraStore)),
-      state_(state) {}
+                           std::shared_ptr<AuroraHistoryStore> auroraStore)
+    : net_(net), store_(std::move(store)),
+      auroraStore_(std::move(auroraStore)) {}
 
 void NOAAProvider::fetch() {
   LOG_I("NOAAProvider", "Starting solar data fetch cycle");
@@ -28,20 +29,16 @@ void NOAAProvider::fetch() {
 
 void NOAAProvider::fetchKIndex() {
   auto store = store_;
-  auto state = state_;
-  net_.fetchAsync(K_INDEX_URL, [store, state](std::string body) {
+  fetches_.add(net_.fetchAsync(K_INDEX_URL, [store](std::string body) {
+    TRACE_SCOPE("provider", "NOAAProvider::parseKIndex");
+    auto &health = ServiceHealthRegistry::instance().get("NOAA:KIndex");
     if (body.empty()) {
-      if (state) {
-        auto &s = state->services["NOAA:KIndex"];
-        s.ok = false;
-        s.lastError = "Empty response";
-      }
+      health.markFailure("Empty response");
       return;
     }
     auto j = nlohmann::json::parse(body, nullptr, false);
     if (j.is_discarded() || !j.is_array() || j.size() < 2) {
-      if (state)
-        state->services["NOAA:KIndex"].ok = false;
+      health.markFailure("Bad JSON");
       return;
     }
 
@@ -50,28 +47,27 @@ void NOAAProvider::fetchKIndex() {
       return;
 
     try {
-      auto data = store->get();
       double kp = std::stod(row[1].get<std::string>());
-      data.k_index = static_cast<int>(kp);
-      data.a_index = std::stoi(row[2].get<std::string>());
-      data.last_updated = std::chrono::system_clock::now();
-      data.valid = true;
-      store->set(data);
-      if (state) {
-        auto &s = state->services["NOAA:KIndex"];
-        s.ok = true;
-        s.lastSuccess = std::chrono::system_clock::now();
-      }
-      LOG_I("NOAAProvider", "Updated K-Index: K={}", data.k_index);
+      int aIndex = std::stoi(row[2].get<std::string>());
+      store->update([&](SolarData &data) {
+        data.k_index = static_cast<int>(kp);
+        data.a_index = aIndex;
+        data.last_updated = std::chrono::system_clock::now();
+        data.valid = true;
+      });
+      health.markSuccess();
+      LOG_I("NOAAProvider", "Updated K-Index: K={}", static_cast<int>(kp));
     } catch (const std::exception &e) {
+      health.markFailure(e.what());
       LOG_E("NOAAProvider", "KP parse error: {}", e.what());
     }
-  });
+  }));
 }
 
 void NOAAProvider::fetchSFI() {
   auto store = store_;
-  net_.fetchAsync(SFI_URL, [store](std::string body) {
+  fetches_.add(net_.fetchAsync(SFI_URL, [store](std::string body) {
+    TRACE_SCOPE("provider", "NOAAProvider::parseSFI");
     if (body.empty())
       return;
     auto j = nlohmann::json::parse(body, nullptr, false);
@@ -79,7 +75,6 @@ void NOAAProvider::fetchSFI() {
       return;
 
     try {
-      auto data = store->get();
       // Try to find the flux value. Some variants of the JSON use "Flux" or
       // index 1.
       double flux = 0;
@@ -89,19 +84,22 @@ void NOAAProvider::fetchSFI() {
         flux = std::stod(j.back()[1].get<std::string>());
       }
       if (flux > 0) {
-        data.sfi = static_cast<int>(flux);
-        data.valid = true;
-        store->set(data);
-        LOG_D("NOAAProvider", "SFI={}", data.sfi);
+        int sfi = static_cast<int>(flux);
+        store->update([sfi](SolarData &data) {
+          data.sfi = sfi;
+          data.valid = true;
+        });
+        LOG_D("NOAAProvider", "SFI={}", sfi);
       }
     } catch (...) {
     }
-  });
+  }));
 }
 
 void NOAAProvider::fetchSN() {
   auto store = store_;
-  net_.fetchAsync(SN_URL, [store](std::string body) {
+  fetches_.add(net_.fetchAsync(SN_URL, [store](std::string body) {
+    TRACE_SCOPE("provider", "NOAAProvider::parseSN");
     if (body.empty())
       return;
     auto j = nlohmann::json::parse(body, nullptr, false);
@@ -132,24 +130,25 @@ void NOAAProvider::fetchSN() {
       }
 
       if (ssn >= 0) {
-        auto data = store->get();
-        data.sunspot_number = static_cast<int>(ssn);
-        data.valid = true;
-        store->set(data);
-        LOG_D("NOAAProvider", "SN={} (Predicted for {})", data.sunspot_number,
-              current_month);
+        int sn = static_cast<int>(ssn);
+        store->update([sn](SolarData &data) {
+          data.sunspot_number = sn;
+          data.valid = true;
+        });
+        LOG_D("NOAAProvider", "SN={} (Predicted for {})", sn, current_month);
       } else {
         LOG_W("NOAAProvider", "No SN prediction found for {}", current_month);
       }
     } catch (const std::exception &e) {
       LOG_E("NOAAProvider", "SN parse error: {}", e.what());
     }
-  });
+  }));
 }
 
 void NOAAProvider::fetchPlasma() {
   auto store = store_;
-  net_.fetchAsync(PLASMA_URL, [store](std::string body) {
+  fetches_.add(net_.fetchAsync(PLASMA_URL, [store](std::string body) {
+    TRACE_SCOPE("provider", "NOAAProvider::parsePlasma");
     if (body.empty())
       return;
     auto j = nlohmann::json::parse(body, nullptr, false);
@@ -157,25 +156,31 @@ void NOAAProvider::fetchPlasma() {
       return;
 
     try {
-      auto data = store->get();
       const auto &row = j.back();
       // row: [time, density, speed, temp]
+      std::optional<double> density, speed;
       if (row[1].is_string())
-        data.solar_wind_density = std::stod(row[1].get<std::string>());
+        density = std::stod(row[1].get<std::string>());
       if (row[2].is_string())
-        data.solar_wind_speed = std::stod(row[2].get<std::string>());
-      data.valid = true;
-      store->set(data);
-      LOG_D("NOAAProvider", "Wind={:.1f} km/s, Dense={:.1f}",
-            data.solar_wind_speed, data.solar_wind_density);
+        speed = std::stod(row[2].get<std::string>());
+      store->update([&](SolarData &data) {
+        if (density)
+          data.solar_wind_density = *density;
+        if (speed)
+          data.solar_wind_speed = *speed;
+        data.valid = true;
+      });
+      LOG_D("NOAAProvider", "Wind={:.1f} km/s, Dense={:.1f}", speed.value_or(0),
+            density.value_or(0));
     } catch (...) {
     }
-  });
+  }));
 }
 
 void NOAAProvider::fetchMag() {
   auto store = store_;
-  net_.fetchAsync(MAG_URL, [store](std::string body) {
+  fetches_.add(net_.fetchAsync(MAG_URL, [store](std::string body) {
+    TRACE_SCOPE("provider", "NOAAProvider::parseMag");
     if (body.empty())
       return;
     auto j = nlohmann::json::parse(body, nullptr, false);
@@ -183,26 +188,30 @@ void NOAAProvider::fetchMag() {
       return;
 
     try {
-      auto data = store->get();
       const auto &row = j.back();
       // row: [time, bx, by, bz, lon, lat, bt]
+      std::optional<int> bz, bt;
       if (row[3].is_string())
-        data.bz =
-            static_cast<int>(std::round(std::stod(row[3].get<std::string>())));
+        bz = static_cast<int>(std::round(std::stod(row[3].get<std::string>())));
       if (row[6].is_string())
-        data.bt =
-            static_cast<int>(std::round(std::stod(row[6].get<std::string>())));
-      data.valid = true;
-      store->set(data);
-      LOG_D("NOAAProvider", "Bz={}, Bt={}", data.bz, data.bt);
+        bt = static_cast<int>(std::round(std::stod(row[6].get<std::string>())));
+      store->update([&](SolarData &data) {
+        if (bz)
+          data.bz = *bz;
+        if (bt)
+          data.bt = *bt;
+        data.valid = true;
+      });
+      LOG_D("NOAAProvider", "Bz={}, Bt={}", bz.value_or(0), bt.value_or(0));
     } catch (...) {
     }
-  });
+  }));
 }
 
 void NOAAProvider::fetchDST() {
   auto store = store_;
-  net_.fetchAsync(DST_URL, [store](std::string body) {
+  fetches_.add(net_.fetchAsync(DST_URL, [store](std::string body) {
+    TRACE_SCOPE("provider", "NOAAProvider::parseDst");
     if (body.empty())
       return;
     auto j = nlohmann::json::parse(body, nullptr, false);
@@ -210,20 +219,22 @@ void NOAAProvider::fetchDST() {
       return;
 
     try {
-      auto data = store->get();
-      data.dst = std::stoi(j.back()[1].get<std::string>());
-      data.valid = true;
-      store->set(data);
-      LOG_D("NOAAProvider", "DST={}", data.dst);
+      int dst = std::stoi(j.back()[1].get<std::string>());
+      store->update([dst](SolarData &data) {
+        data.dst = dst;
+        data.valid = true;
+      });
+      LOG_D("NOAAProvider", "DST={}", dst);
     } catch (...) {
     }
-  });
+  }));
 }
 
 void NOAAProvider::fetchAurora() {
   auto store = store_;
   auto auroraStore = auroraStore_;
-  net_.fetchAsync(AURORA_URL, [store, auroraStore](std::string body) {
+  auto onAurora = [store, auroraStore](std::string body) {
+    TRACE_SCOPE("provider", "NOAAProvider::parseAurora");
     if (body.empty())
       return;
 
@@ -262,10 +273,11 @@ void NOAAProvider::fetchAurora() {
       }
 
       if (found_any) {
-        auto data = store->get();
-        data.aurora = static_cast<int>(max_percent);
-        data.valid = true;
-        store->set(data);
+        int aurora = static_cast<int>(max_percent);
+        store->update([aurora](SolarData &data) {
+          data.aurora = aurora;
+          data.valid = true;
+        });
 
         // Also save to history store for graphing
         if (auroraStore) {
@@ -278,16 +290,18 @@ void NOAAProvider::fetchAurora() {
           auroraStore->addPoint(max_percent);
         }
 
-        LOG_D("NOAAProvider", "Aurora={} %", data.aurora);
+        LOG_D("NOAAProvider", "Aurora={} %", aurora);
       }
     } catch (...) {
     }
-  });
+  };
+  fetches_.add(net_.fetchAsync(AURORA_URL, std::move(onAurora)));
 }
 
 void NOAAProvider::fetchDRAP() {
   auto store = store_;
-  net_.fetchAsync(DRAP_URL, [store](std::string body) {
+  fetches_.add(net_.fetchAsync(DRAP_URL, [store](std::string body) {
+    TRACE_SCOPE("provider", "NOAAProvider::parseDRAP");
     if (body.empty())
       return;
 
@@ -315,16 +329,17 @@ void NOAAProvider::fetchDRAP() {
       }
 
       if (found_any) {
-        auto data = store->get();
         // Storing float frequency into int field (rounding) per existing
         // pattern
-        data.drap = static_cast<int>(std::round(max_freq));
-        data.valid = true;
-        store->set(data);
+        int drap = static_cast<int>(std::round(max_freq));
+        store->update([drap](SolarData &data) {
+          data.drap = drap;
+          data.valid = true;
+        });
         LOG_D("NOAAProvider", "DRAP={:.1f} MHz (stored as {})", max_freq,
-              data.drap);
+              drap);
       }
     } catch (...) {
     }
-  });
+  }));
 }
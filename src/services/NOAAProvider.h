@@ -6,13 +6,10 @@
 
 #include <memory>
 
-struct HamClockState;
-
 class NOAAProvider {
 public:
   NOAAProvider(NetworkManager &net, std::shared_ptr<SolarDataStore> store,
-               std::shared_ptr<AuroraHistoryStore> auroraStore = nullptr,
-               HamClockState *state = nullptr);
+               std::shared_ptr<AuroraHistoryStore> auroraStore = nullptr);
 
   void fetch();
 
@@ -47,5 +44,6 @@ private:
   NetworkManager &net_;
   std::shared_ptr<SolarDataStore> store_;
   std::shared_ptr<AuroraHistoryStore> auroraStore_;
-  HamClockState *state_;
+
+  FetchGroup fetches_;
 };
@@ -1,5 +1,6 @@
 #include "RSSProvider.h"
 #include "../core/Logger.h"
+#include "../core/Tracer.h"
 
 #include <chrono>
 #include <mutex>
@@ -190,26 +191,29 @@ void RSSProvider::fetch() {
   auto agg = std::make_shared<FeedAggregator>(store_);
 
   // Feed 0: HamWeekly (Atom)
-  net_.fetchAsync(kFeeds[0].url, [agg](std::string body) {
+  fetches_.add(net_.fetchAsync(kFeeds[0].url, [agg](std::string body) {
+    TRACE_SCOPE("provider", "RSSProvider::parseAtom");
     auto headlines = parseAtom(body);
     LOG_I("RSSProvider", "{} -> {} headlines", kFeeds[0].name,
           headlines.size());
     agg->update(0, std::move(headlines));
-  });
+  }));
 
   // Feed 1: ARNewsLine (RSS)
-  net_.fetchAsync(kFeeds[1].url, [agg](std::string body) {
+  fetches_.add(net_.fetchAsync(kFeeds[1].url, [agg](std::string body) {
+    TRACE_SCOPE("provider", "RSSProvider::parseRSS");
     auto headlines = parseRSS(body);
     LOG_I("RSSProvider", "{} -> {} headlines", kFeeds[1].name,
           headlines.size());
     agg->update(1, std::move(headlines));
-  });
+  }));
 
   // Feed 2: NG3K (HTML)
-  net_.fetchAsync(kFeeds[2].url, [agg](std::string body) {
+  fetches_.add(net_.fetchAsync(kFeeds[2].url, [agg](std::string body) {
+    TRACE_SCOPE("provider", "RSSProvider::parseNG3K");
     auto headlines = parseNG3K(body);
     LOG_I("RSSProvider", "{} -> {} headlines", kFeeds[2].name,
           headlines.size());
     agg->update(2, std::move(headlines));
-  });
+  }));
 }
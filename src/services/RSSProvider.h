@@ -14,4 +14,6 @@ public:
 private:
     NetworkManager& net_;
     std::shared_ptr<RSSDataStore> store_;
+
+    FetchGroup fetches_;
 };
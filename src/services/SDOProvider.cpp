@@ -1,15 +1,17 @@
 #include "SDOProvider.h"
+#include "../core/Tracer.h"
 #include <cstdio>
 
 SDOProvider::SDOProvider(NetworkManager &net) : net_(net) {}
 
-void SDOProvider::fetch(const std::string &wavelength, DataCb cb) {
+FetchHandle SDOProvider::fetch(const std::string &wavelength, DataCb cb) {
   char url[256];
   std::snprintf(url, sizeof(url),
                 "https://sdo.gsfc.nasa.gov/assets/img/latest/latest_512_%s.jpg",
                 wavelength.c_str());
 
-  net_.fetchAsync(url, [cb](std::string body) {
+  return net_.fetchAsync(url, [cb](std::string body) {
+    TRACE_SCOPE("provider", "SDOProvider::parse");
     if (!body.empty()) {
       cb(body);
     }
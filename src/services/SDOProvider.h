@@ -11,7 +11,7 @@ public:
   SDOProvider(NetworkManager &net);
 
   // Fetch latest SDO image (wavelength 0193, 304, etc)
-  void fetch(const std::string &wavelength, DataCb cb);
+  [[nodiscard]] FetchHandle fetch(const std::string &wavelength, DataCb cb);
 
 private:
   NetworkManager &net_;
@@ -0,0 +1,45 @@
+#include "SpotHistoryProvider.h"
+#include "../core/Tracer.h"
+
+#include <chrono>
+
+SpotHistoryProvider::SpotHistoryProvider(
+    std::shared_ptr<SpotArchive> archive,
+    std::shared_ptr<SpotHistoryStore> store)
+    : archive_(std::move(archive)), store_(std::move(store)) {}
+
+void SpotHistoryProvider::lookup(const DXClusterSpot &spot, Continent home) {
+  pending_.cancel();
+  pending_ = CancelToken::create();
+
+  SpotHistoryData req;
+  req.call = spot.txCall;
+  req.dxcc = spot.txDxcc;
+  req.band = spot.band;
+  req.from = spot.txCont;
+  req.to = home;
+  req.days = kDays;
+
+  // The task owns what it touches, so it may outlive this provider.
+  auto archive = archive_;
+  auto store = store_;
+  auto token = pending_;
+  WorkerPool::instance().submit(
+      WorkerPool::Queue::IO,
+      [archive, store, token, req = std::move(req)]() mutable {
+        TRACE_SCOPE("provider", "SpotHistoryProvider::lookup");
+        auto started = std::chrono::steady_clock::now();
+        req.history = archive->callHistory(req.call, req.days);
+        req.activity =
+            archive->hourlyActivity(req.band, req.from, req.to, req.days);
+        if (req.dxcc > 0)
+          req.entity = archive->lastSpotted(req.dxcc);
+        req.queryMs = std::chrono::duration<double, std::milli>(
+                          std::chrono::steady_clock::now() - started)
+                          .count();
+        req.valid = true;
+        if (!token.cancelled())
+          store->set(std::move(req));
+      },
+      WorkerPool::Priority::Normal, pending_);
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "../core/DXClusterData.h"
+#include "../core/SpotArchive.h"
+#include "../core/SpotHistoryData.h"
+#include "../core/WorkerPool.h"
+#include <memory>
+
+// Runs SpotArchive lookups for a selected spot on the IO workers and
+// publishes the result to a SpotHistoryStore.
+class SpotHistoryProvider {
+public:
+  static constexpr int kDays = 30;
+
+  SpotHistoryProvider(std::shared_ptr<SpotArchive> archive,
+                      std::shared_ptr<SpotHistoryStore> store);
+  ~SpotHistoryProvider() { pending_.cancel(); }
+
+  // Starting a new lookup abandons one that has not published yet. 'home'
+  // is the continent activity is counted into.
+  void lookup(const DXClusterSpot &spot, Continent home);
+
+private:
+  std::shared_ptr<SpotArchive> archive_;
+  std::shared_ptr<SpotHistoryStore> store_;
+  CancelToken pending_;
+};
@@ -1,4 +1,5 @@
 #include "WeatherProvider.h"
+#include "../core/Tracer.h"
 #include <chrono>
 #include <nlohmann/json.hpp>
 
@@ -17,11 +18,12 @@ void WeatherProvider::fetch(double lat, double lon) {
                 "direction_10m,weather_code",
                 lat, lon);
 
-  net_.fetchAsync(url, [this](std::string body) {
+  fetches_.add(net_.fetchAsync(url, [this](std::string body) {
+    TRACE_SCOPE("provider", "WeatherProvider::parse");
     if (!body.empty()) {
       processData(body);
     }
-  });
+  }));
 }
 
 // WMO Weather interpretation codes (WW)
@@ -0,0 +1,356 @@
+#include "WsjtxProtocol.h"
+
+#include <cstring>
+
+namespace Wsjtx {
+
+namespace {
+
+constexpr uint32_t kNullString = 0xFFFFFFFF;
+constexpr int64_t kUnixEpochJulianDay = 2440588;
+constexpr int64_t kMsPerDay = 86400000;
+// Days either side of 1970 a date may be; further out is taken as invalid,
+// which also keeps the milliseconds well inside int64_t.
+constexpr int64_t kMaxEpochDays = 1000000;
+
+// QDataStream reader over one datagram. Every read fails once the data runs
+// out, so a chain of reads stops at the first missing field.
+class Reader {
+public:
+  Reader(const void *data, size_t size)
+      : p_(static_cast<const unsigned char *>(data)), end_(p_ + size) {}
+
+  bool u8(uint8_t &v) {
+    if (end_ - p_ < 1)
+      return false;
+    v = *p_++;
+    return true;
+  }
+  bool boolean(bool &v) {
+    uint8_t b;
+    if (!u8(b))
+      return false;
+    v = b != 0;
+    return true;
+  }
+  bool u32(uint32_t &v) {
+    if (end_ - p_ < 4)
+      return false;
+    v = uint32_t{p_[0]} << 24 | uint32_t{p_[1]} << 16 | uint32_t{p_[2]} << 8 |
+        uint32_t{p_[3]};
+    p_ += 4;
+    return true;
+  }
+  bool i32(int32_t &v) {
+    uint32_t u;
+    if (!u32(u))
+      return false;
+    v = static_cast<int32_t>(u);
+    return true;
+  }
+  bool u64(uint64_t &v) {
+    uint32_t hi, lo;
+    if (end_ - p_ < 8 || !u32(hi) || !u32(lo))
+      return false;
+    v = uint64_t{hi} << 32 | lo;
+    return true;
+  }
+  bool i64(int64_t &v) {
+    uint64_t u;
+    if (!u64(u))
+      return false;
+    v = static_cast<int64_t>(u);
+    return true;
+  }
+  bool f64(double &v) {
+    uint64_t u;
+    if (!u64(u))
+      return false;
+    std::memcpy(&v, &u, sizeof(v));
+    return true;
+  }
+  bool utf8(std::string_view &v) {
+    uint32_t n;
+    if (!u32(n))
+      return false;
+    if (n == kNullString) {
+      v = {};
+      return true;
+    }
+    if (static_cast<size_t>(end_ - p_) < n)
+      return false;
+    v = {reinterpret_cast<const char *>(p_), n};
+    p_ += n;
+    return true;
+  }
+  // QDateTime: Julian day, milliseconds into the day, then the time spec
+  // (0 local, 1 UTC, 2 offset from UTC, 3 time zone). Local time is taken
+  // as UTC; a named time zone cannot be read without Qt, so it fails.
+  bool dateTime(int64_t &unixMs) {
+    int64_t day;
+    uint32_t ms;
+    uint8_t spec;
+    if (!i64(day) || !u32(ms) || !u8(spec))
+      return false;
+    int32_t offsetSecs = 0;
+    if (spec == 2 && !i32(offsetSecs))
+      return false;
+    if (spec > 2)
+      return false;
+    // A null QDate is INT64_MIN and an invalid QTime all ones.
+    if (day < kUnixEpochJulianDay - kMaxEpochDays ||
+        day > kUnixEpochJulianDay + kMaxEpochDays || ms >= kMsPerDay) {
+      unixMs = 0;
+      return true;
+    }
+    unixMs = (day - kUnixEpochJulianDay) * kMsPerDay + ms -
+             int64_t{offsetSecs} * 1000;
+    return true;
+  }
+
+private:
+  const unsigned char *p_;
+  const unsigned char *end_;
+};
+
+bool parseStatus(Reader &r, Status &s) {
+  if (!(r.u64(s.dialHz) && r.utf8(s.mode) && r.utf8(s.dxCall) &&
+        r.utf8(s.report) && r.utf8(s.txMode) && r.boolean(s.txEnabled) &&
+        r.boolean(s.transmitting)))
+    return false;
+  // Each of these was added in a later version.
+  (void)(r.boolean(s.decoding) && r.u32(s.rxDfHz) && r.u32(s.txDfHz) &&
+         r.utf8(s.deCall) && r.utf8(s.deGrid) && r.utf8(s.dxGrid) &&
+         r.boolean(s.txWatchdog) && r.utf8(s.subMode) &&
+         r.boolean(s.fastMode) && r.u8(s.specialOperation) &&
+         r.u32(s.frequencyTolerance) && r.u32(s.trPeriodSecs) &&
+         r.utf8(s.configurationName) && r.utf8(s.txMessage));
+  return true;
+}
+
+bool parseDecode(Reader &r, Decode &d) {
+  if (!(r.boolean(d.isNew) && r.u32(d.timeMs) && r.i32(d.snr) &&
+        r.f64(d.dtSecs) && r.u32(d.dfHz) && r.utf8(d.mode) &&
+        r.utf8(d.message)))
+    return false;
+  (void)(r.boolean(d.lowConfidence) && r.boolean(d.offAir));
+  return true;
+}
+
+bool parseQSOLogged(Reader &r, QSOLogged &q) {
+  if (!(r.dateTime(q.offMs) && r.utf8(q.dxCall) && r.utf8(q.dxGrid) &&
+        r.u64(q.txHz) && r.utf8(q.mode) && r.utf8(q.reportSent) &&
+        r.utf8(q.reportReceived) && r.utf8(q.txPower) &&
+        r.utf8(q.comments) && r.utf8(q.name)))
+    return false;
+  (void)(r.dateTime(q.onMs) && r.utf8(q.operatorCall) && r.utf8(q.myCall) &&
+         r.utf8(q.myGrid) && r.utf8(q.exchangeSent) &&
+         r.utf8(q.exchangeReceived) && r.utf8(q.propagationMode));
+  return true;
+}
+
+bool parseWSPRDecode(Reader &r, WSPRDecode &w) {
+  if (!(r.boolean(w.isNew) && r.u32(w.timeMs) && r.i32(w.snr) &&
+        r.f64(w.dtSecs) && r.u64(w.freqHz) && r.i32(w.driftHz) &&
+        r.utf8(w.call) && r.utf8(w.grid) && r.i32(w.powerDbm)))
+    return false;
+  (void)r.boolean(w.offAir);
+  return true;
+}
+
+bool isGrid(std::string_view t) {
+  return t.size() == 4 && t[0] >= 'A' && t[0] <= 'R' && t[1] >= 'A' &&
+         t[1] <= 'R' && t[2] >= '0' && t[2] <= '9' && t[3] >= '0' &&
+         t[3] <= '9' && t != "RR73";
+}
+
+// A call has a letter after a digit somewhere in its longest '/' part:
+// K1ABC, 4U1UN, 3DA0XYZ; not FN42, RR73, DX, POTA or 599.
+bool isCall(std::string_view t) {
+  if (t.size() < 3 || t.size() > 13)
+    return false;
+  std::string_view base;
+  size_t start = 0;
+  for (;;) {
+    size_t slash = t.find('/', start);
+    std::string_view part = t.substr(start, slash - start);
+    if (part.size() > base.size())
+      base = part;
+    if (slash == std::string_view::npos)
+      break;
+    start = slash + 1;
+  }
+  bool digit = false;
+  bool letterAfterDigit = false;
+  for (char c : t) {
+    bool isDigit = c >= '0' && c <= '9';
+    bool isLetter = c >= 'A' && c <= 'Z';
+    if (!isDigit && !isLetter && c != '/')
+      return false;
+  }
+  for (char c : base) {
+    if (c >= '0' && c <= '9')
+      digit = true;
+    else if (digit)
+      letterAfterDigit = true;
+  }
+  return letterAfterDigit;
+}
+
+// "<K1ABC>" is a call sent as a hash; "<...>" one the decoder did not know.
+std::string_view unbracket(std::string_view t) {
+  if (t.size() >= 2 && t.front() == '<' && t.back() == '>')
+    return t.substr(1, t.size() - 2);
+  return t;
+}
+
+} // namespace
+
+bool isMessage(const void *data, size_t size) {
+  Reader r(data, size);
+  uint32_t magic;
+  return r.u32(magic) && magic == kMagic;
+}
+
+bool parse(const void *data, size_t size, Message &out) {
+  Reader r(data, size);
+  uint32_t magic, type;
+  if (!r.u32(magic) || magic != kMagic || !r.u32(out.schema) ||
+      !r.u32(type) || !r.utf8(out.id))
+    return false;
+  out.type = static_cast<Type>(type);
+
+  switch (out.type) {
+  case Type::Heartbeat:
+    if (!r.u32(out.heartbeat.maxSchema))
+      return false;
+    (void)(r.utf8(out.heartbeat.version) && r.utf8(out.heartbeat.revision));
+    return true;
+  case Type::Status:
+    return parseStatus(r, out.status);
+  case Type::Decode:
+    return parseDecode(r, out.decode);
+  case Type::QSOLogged:
+    return parseQSOLogged(r, out.qso);
+  case Type::WSPRDecode:
+    return parseWSPRDecode(r, out.wspr);
+  case Type::LoggedADIF:
+    return r.utf8(out.adif);
+  default:
+    return true;
+  }
+}
+
+bool messageSender(std::string_view message, std::string_view &call,
+                   std::string_view &grid) {
+  constexpr int kMaxTokens = 4;
+  std::string_view tok[kMaxTokens];
+  int n = 0;
+  size_t pos = 0;
+  while (n < kMaxTokens) {
+    while (pos < message.size() && message[pos] == ' ')
+      pos++;
+    if (pos == message.size())
+      break;
+    size_t end = message.find(' ', pos);
+    if (end == std::string_view::npos)
+      end = message.size();
+    tok[n++] = message.substr(pos, end - pos);
+    pos = end;
+  }
+  if (n < 2)
+    return false;
+
+  int at; // index of the sender's call
+  if (tok[0] == "CQ" || tok[0] == "QRZ") {
+    // "CQ DX K1ABC", "CQ POTA K1ABC", "CQ 290 K1ABC"
+    at = 1;
+    if (!isCall(unbracket(tok[1])) && n > 2)
+      at = 2;
+  } else if (tok[0] == "DE") {
+    at = 1;
+  } else {
+    std::string_view to = unbracket(tok[0]);
+    if (!isCall(to) && to != "...")
+      return false;
+    at = 1;
+  }
+
+  std::string_view sender = unbracket(tok[at]);
+  if (!isCall(sender))
+    return false;
+  call = sender;
+  grid = at + 1 < n && isGrid(tok[at + 1]) ? tok[at + 1] : std::string_view();
+  return true;
+}
+
+std::string_view modeFromCode(std::string_view code) {
+  if (code.size() != 1)
+    return {};
+  switch (code[0]) {
+  case '~':
+    return "FT8";
+  case '+':
+    return "FT4";
+  case '#':
+    return "JT65";
+  case '@':
+    return "JT9";
+  case '$':
+    return "JT4";
+  case '&':
+    return "MSK144";
+  case ':':
+    return "Q65";
+  case '`':
+    return "FST4";
+  default:
+    return {};
+  }
+}
+
+Writer::Writer(Type type, std::string_view id, uint32_t schema) {
+  u32(kMagic).u32(schema).u32(static_cast<uint32_t>(type)).utf8(id);
+}
+
+Writer &Writer::u8(uint8_t v) {
+  buf_.push_back(static_cast<char>(v));
+  return *this;
+}
+
+Writer &Writer::u32(uint32_t v) {
+  for (int shift = 24; shift >= 0; shift -= 8)
+    buf_.push_back(static_cast<char>(v >> shift & 0xFF));
+  return *this;
+}
+
+Writer &Writer::u64(uint64_t v) {
+  u32(static_cast<uint32_t>(v >> 32));
+  return u32(static_cast<uint32_t>(v));
+}
+
+Writer &Writer::f64(double v) {
+  uint64_t u;
+  std::memcpy(&u, &v, sizeof(u));
+  return u64(u);
+}
+
+Writer &Writer::utf8(std::string_view s) {
+  u32(static_cast<uint32_t>(s.size()));
+  buf_.append(s);
+  return *this;
+}
+
+Writer &Writer::dateTime(int64_t unixMs) {
+  int64_t day = unixMs / kMsPerDay;
+  int64_t ms = unixMs % kMsPerDay;
+  if (ms < 0) {
+    ms += kMsPerDay;
+    day--;
+  }
+  i64(day + kUnixEpochJulianDay);
+  u32(static_cast<uint32_t>(ms));
+  return u8(1); // Qt::UTC
+}
+
+} // namespace Wsjtx
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// The WSJT-X UDP protocol (NetworkMessage.hpp in the WSJT-X sources), also
+// spoken by JTDX and MSHV. Every datagram is one message serialised with
+// Qt's QDataStream: big-endian integers, IEEE doubles, and strings as a
+// 32-bit byte count followed by UTF-8 (0xFFFFFFFF for a null string).
+//
+//   magic 0xADBCCBDA | schema | type | id | type-specific fields
+//
+// 'id' names the sending instance ("WSJT-X", "WSJT-X - IC7300", "JTDX"),
+// so several programs can share one port. Newer versions append fields to
+// the end of a message; older senders simply stop early.
+namespace Wsjtx {
+
+constexpr uint32_t kMagic = 0xADBCCBDA;
+constexpr uint32_t kSchema = 2; // what WSJT-X 2.x sends
+
+enum class Type : uint32_t {
+  Heartbeat = 0,
+  Status = 1,
+  Decode = 2,
+  Clear = 3,
+  Reply = 4,
+  QSOLogged = 5,
+  Close = 6,
+  Replay = 7,
+  HaltTx = 8,
+  FreeText = 9,
+  WSPRDecode = 10,
+  Location = 11,
+  LoggedADIF = 12,
+  HighlightCallsign = 13,
+  SwitchConfiguration = 14,
+  Configure = 15,
+};
+
+struct Heartbeat {
+  uint32_t maxSchema = 0;
+  std::string_view version;
+  std::string_view revision;
+};
+
+struct Status {
+  uint64_t dialHz = 0;
+  std::string_view mode; // "FT8", "FT4", "JT65", ...
+  std::string_view dxCall;
+  std::string_view report;
+  std::string_view txMode;
+  bool txEnabled = false;
+  bool transmitting = false;
+  bool decoding = false;
+  uint32_t rxDfHz = 0;
+  uint32_t txDfHz = 0;
+  std::string_view deCall;
+  std::string_view deGrid;
+  std::string_view dxGrid;
+  bool txWatchdog = false;
+  std::string_view subMode;
+  bool fastMode = false;
+  uint8_t specialOperation = 0;
+  uint32_t frequencyTolerance = 0;
+  uint32_t trPeriodSecs = 0;
+  std::string_view configurationName;
+  std::string_view txMessage;
+};
+
+struct Decode {
+  bool isNew = true; // false when re-sent in answer to a Replay request
+  uint32_t timeMs = 0; // UTC, since midnight
+  int32_t snr = 0;
+  double dtSecs = 0;
+  uint32_t dfHz = 0; // audio offset from the dial frequency
+  std::string_view mode; // one-character code, "~" for FT8
+  std::string_view message;
+  bool lowConfidence = false;
+  bool offAir = false; // decoded from a recording, not the radio
+};
+
+struct QSOLogged {
+  int64_t offMs = 0; // Unix milliseconds; 0 if invalid
+  std::string_view dxCall;
+  std::string_view dxGrid;
+  uint64_t txHz = 0;
+  std::string_view mode;
+  std::string_view reportSent;
+  std::string_view reportReceived;
+  std::string_view txPower;
+  std::string_view comments;
+  std::string_view name;
+  int64_t onMs = 0;
+  std::string_view operatorCall;
+  std::string_view myCall;
+  std::string_view myGrid;
+  std::string_view exchangeSent;
+  std::string_view exchangeReceived;
+  std::string_view propagationMode;
+};
+
+struct WSPRDecode {
+  bool isNew = true;
+  uint32_t timeMs = 0;
+  int32_t snr = 0;
+  double dtSecs = 0;
+  uint64_t freqHz = 0; // of the signal itself, not the dial
+  int32_t driftHz = 0;
+  std::string_view call;
+  std::string_view grid;
+  int32_t powerDbm = 0;
+  bool offAir = false;
+};
+
+// One decoded datagram. Only the member for 'type' is filled; views point
+// into the datagram.
+struct Message {
+  uint32_t schema = 0;
+  Type type = Type::Heartbeat;
+  std::string_view id;
+  Heartbeat heartbeat;
+  Status status;
+  Decode decode;
+  QSOLogged qso;
+  WSPRDecode wspr;
+  std::string_view adif; // LoggedADIF
+};
+
+// True if 'data' starts with the protocol's magic number.
+bool isMessage(const void *data, size_t size);
+
+// Parses one datagram. Returns false if it is not a WSJT-X message or is
+// cut short before the fields every version sends; types without fields
+// we use (Clear, Close, Replay, ...) succeed with only the header set.
+// Does not allocate.
+bool parse(const void *data, size_t size, Message &out);
+
+// The station that sent a decoded FT8/FT4/JT65 message, and its grid if
+// the message carries one:
+//   CQ K1ABC FN42        CQ DX K1ABC FN42       K1ABC W9XYZ EN52
+//   K1ABC W9XYZ -12      K1ABC W9XYZ R-05       <PJ4/K1ABC> W9XYZ RR73
+// Returns false for free text, telemetry and anything else without a call.
+bool messageSender(std::string_view message, std::string_view &call,
+                   std::string_view &grid);
+
+// Mode name for a Decode's one-character code ("~" is "FT8"), or an empty
+// view if unknown.
+std::string_view modeFromCode(std::string_view code);
+
+// Builds messages the way WSJT-X does, for the replay tool and tests.
+class Writer {
+public:
+  Writer(Type type, std::string_view id, uint32_t schema = kSchema);
+
+  Writer &u8(uint8_t v);
+  Writer &u32(uint32_t v);
+  Writer &i32(int32_t v) { return u32(static_cast<uint32_t>(v)); }
+  Writer &u64(uint64_t v);
+  Writer &i64(int64_t v) { return u64(static_cast<uint64_t>(v)); }
+  Writer &f64(double v);
+  Writer &boolean(bool v) { return u8(v ? 1 : 0); }
+  Writer &utf8(std::string_view s);
+  // QDateTime in UTC from Unix milliseconds.
+  Writer &dateTime(int64_t unixMs);
+
+  const std::string &data() const { return buf_; }
+
+private:
+  std::string buf_;
+};
+
+} // namespace Wsjtx
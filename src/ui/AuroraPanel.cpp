@@ -16,7 +16,7 @@ void AuroraPanel::update() {
   uint32_t now = SDL_GetTicks();
   if (now - lastFetch_ > 30 * 60 * 1000 || lastFetch_ == 0) { // 30 mins
     lastFetch_ = now;
-    provider_.fetch(north_, [](const std::string &data) {
+    fetch_ = provider_.fetch(north_, [](const std::string &data) {
       std::lock_guard<std::mutex> lock(auroraMutex);
       auroraPendingData = data;
       auroraDataReady = true;
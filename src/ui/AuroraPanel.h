@@ -17,6 +17,7 @@ private:
   FontManager &fontMgr_;
   TextureManager &texMgr_;
   AuroraProvider &provider_;
+  FetchHandle fetch_;
 
   bool imageReady_ = false;
   uint32_t lastFetch_ = 0;
@@ -0,0 +1,169 @@
+#include "BandActivityPanel.h"
+#include "../core/LiveSpotData.h"
+#include "../core/Theme.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+BandActivityPanel::BandActivityPanel(int x, int y, int w, int h,
+                                     FontManager &fontMgr,
+                                     std::shared_ptr<BandActivityStore> store,
+                                     const AppConfig &config)
+    : Widget(x, y, w, h), fontMgr_(fontMgr), store_(std::move(store)),
+      to_(continentAt(config.lat, config.lon)), data_(store_->snapshot()) {}
+
+void BandActivityPanel::update() {
+  if (store_->version() == seenVersion_)
+    return;
+  seenVersion_ = store_->version();
+  data_ = store_->snapshot();
+  rebuild();
+}
+
+void BandActivityPanel::rebuild() {
+  peak_ = 0;
+  for (int b = 0; b < kRows; ++b) {
+    for (int c = 0; c < kColumns; ++c) {
+      grid_[b][c] = data_->count(b, Continent::Unknown, to_, kColumns - 1 - c);
+      peak_ = std::max(peak_, grid_[b][c]);
+    }
+  }
+}
+
+bool BandActivityPanel::opening(int band) const {
+  for (const auto &o : data_->openings) {
+    if (o.band == band && (to_ == Continent::Unknown || o.to == to_))
+      return true;
+  }
+  return false;
+}
+
+void BandActivityPanel::render(SDL_Renderer *renderer) {
+  if (!fontMgr_.ready())
+    return;
+
+  ThemeColors themes = getThemeColors(theme_);
+  SDL_SetRenderDrawBlendMode(
+      renderer, (theme_ == "glass") ? SDL_BLENDMODE_BLEND : SDL_BLENDMODE_NONE);
+  SDL_SetRenderDrawColor(renderer, themes.bg.r, themes.bg.g, themes.bg.b,
+                         themes.bg.a);
+  SDL_Rect rect = {x_, y_, width_, height_};
+  SDL_RenderFillRect(renderer, &rect);
+  SDL_SetRenderDrawColor(renderer, themes.border.r, themes.border.g,
+                         themes.border.b, themes.border.a);
+  SDL_RenderDrawRect(renderer, &rect);
+
+  int pad = 6;
+  fontMgr_.drawText(renderer, "Band Activity", x_ + pad, y_ + 4, themes.accent,
+                    10, true);
+  std::string path = std::string("> ") +
+                     (to_ == Continent::Unknown ? "All" : continentName(to_));
+  int pathW = 0, pathH = 0;
+  if (SDL_Texture *tex = fontMgr_.renderText(renderer, path, themes.text, 10,
+                                             &pathW, &pathH, true)) {
+    SDL_Rect dst = {x_ + width_ - pad - pathW, y_ + 4, pathW, pathH};
+    SDL_RenderCopy(renderer, tex, nullptr, &dst);
+    SDL_DestroyTexture(tex);
+  }
+
+  if (!data_->valid) {
+    fontMgr_.drawText(renderer, "Waiting for spots", x_ + width_ / 2,
+                      y_ + height_ / 2, themes.textDim, 10, false, true);
+    return;
+  }
+
+  int top = y_ + 18;
+  int footerH = 22;
+  int labelW = 26;
+  int gridX = x_ + pad + labelW;
+  int gridW = width_ - 2 * pad - labelW;
+  int rowH = std::max(2, (y_ + height_ - footerH - top) / kRows);
+  float colW = gridW / static_cast<float>(kColumns);
+  int labelSize = std::clamp(rowH - 1, 6, 9);
+
+  // Counts on a log scale, so a quiet band still shows against a busy one.
+  float scale = peak_ ? 1.0f / std::log1p(static_cast<float>(peak_)) : 0.0f;
+  for (int b = 0; b < kRows; ++b) {
+    int ry = top + b * rowH;
+    bool open = opening(b);
+    const SDL_Color &bc = kBands[b].color;
+    for (int c = 0; c < kColumns; ++c) {
+      uint32_t n = grid_[b][c];
+      if (n == 0)
+        continue;
+      float level = 0.25f + 0.75f * std::log1p(static_cast<float>(n)) * scale;
+      auto mix = [level](Uint8 from, Uint8 to) {
+        return static_cast<Uint8>(from + (to - from) * level);
+      };
+      SDL_SetRenderDrawColor(renderer, mix(themes.bg.r, bc.r),
+                             mix(themes.bg.g, bc.g), mix(themes.bg.b, bc.b),
+                             255);
+      SDL_Rect cell = {gridX + static_cast<int>(c * colW), ry,
+                       std::max(1, static_cast<int>(colW) - 1),
+                       std::max(1, rowH - 1)};
+      SDL_RenderFillRect(renderer, &cell);
+    }
+    fontMgr_.drawText(renderer, kBands[b].name, x_ + pad, ry,
+                      open ? themes.accent : themes.textDim, labelSize, open);
+    if (open) {
+      SDL_SetRenderDrawColor(renderer, themes.accent.r, themes.accent.g,
+                             themes.accent.b, 255);
+      SDL_Rect mark = {gridX - 3, ry, 2, std::max(1, rowH - 1)};
+      SDL_RenderFillRect(renderer, &mark);
+    }
+  }
+
+  int axisY = top + kRows * rowH + 1;
+  fontMgr_.drawText(renderer, "-2h", gridX, axisY, themes.textDim, 8);
+  fontMgr_.drawText(renderer, "now", gridX + gridW - 16, axisY, themes.textDim,
+                    8);
+
+  // The strongest opening into this continent.
+  const BandOpening *best = nullptr;
+  for (const auto &o : data_->openings) {
+    if (to_ == Continent::Unknown || o.to == to_) {
+      best = &o;
+      break;
+    }
+  }
+  char line[80];
+  if (best) {
+    std::snprintf(line, sizeof(line), "Open: %s %s>%s %u/5m, usually %.1f",
+                  kBands[best->band].name, continentName(best->from),
+                  continentName(best->to), best->count, best->baseline);
+  } else {
+    std::snprintf(line, sizeof(line), "No openings");
+  }
+  fontMgr_.drawText(renderer, line, x_ + pad, y_ + height_ - 12,
+                    best ? themes.text : themes.textDim, 8);
+}
+
+bool BandActivityPanel::onMouseUp(int mx, int my, Uint16 /*mod*/) {
+  if (mx < x_ || mx >= x_ + width_ || my < y_ || my >= y_ + height_)
+    return false;
+  // Unknown stands for "all" and comes after AN.
+  int next = (static_cast<int>(to_) + 1) % static_cast<int>(Continent::Count);
+  to_ = static_cast<Continent>(next);
+  rebuild();
+  return true;
+}
+
+nlohmann::json BandActivityPanel::getDebugData() const {
+  nlohmann::json j = nlohmann::json::object();
+  j["to"] = to_ == Continent::Unknown ? "all" : continentName(to_);
+  j["spots"] = data_->spots;
+  j["peak"] = peak_;
+  nlohmann::json openings = nlohmann::json::array();
+  for (const auto &o : data_->openings) {
+    openings.push_back({{"band", kBands[o.band].name},
+                        {"from", continentName(o.from)},
+                        {"to", continentName(o.to)},
+                        {"since", o.since},
+                        {"count", o.count},
+                        {"baseline", o.baseline},
+                        {"z", o.z}});
+  }
+  j["openings"] = openings;
+  return j;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "../core/BandActivityData.h"
+#include "../core/ConfigManager.h"
+#include "FontManager.h"
+#include "Widget.h"
+
+#include <array>
+#include <memory>
+#include <string>
+
+// Heatmap of spots per band over the last two hours, as heard in one
+// continent (ours to begin with; a click moves on to the next one, then to
+// all of them). Bands with an opening into that continent are marked, and
+// the strongest one is spelled out underneath.
+class BandActivityPanel : public Widget {
+public:
+  BandActivityPanel(int x, int y, int w, int h, FontManager &fontMgr,
+                    std::shared_ptr<BandActivityStore> store,
+                    const AppConfig &config);
+
+  void update() override;
+  void render(SDL_Renderer *renderer) override;
+  bool onMouseUp(int mx, int my, Uint16 mod) override;
+
+  std::string getName() const override { return "BandActivityPanel"; }
+  nlohmann::json getDebugData() const override;
+
+private:
+  static constexpr int kColumns = 24; // 5-minute buckets, two hours
+  static constexpr int kRows = BandActivityMatrix::kNumBandSlots;
+
+  void rebuild();
+  bool opening(int band) const;
+
+  FontManager &fontMgr_;
+  std::shared_ptr<BandActivityStore> store_;
+  Continent to_;
+
+  BandActivityStore::Snapshot data_;
+  uint64_t seenVersion_ = 0;
+  // grid_[band][column], oldest column first, for 'to_'.
+  std::array<std::array<uint32_t, kColumns>, kRows> grid_{};
+  uint32_t peak_ = 0;
+};
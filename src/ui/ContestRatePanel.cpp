@@ -0,0 +1,153 @@
+#include "ContestRatePanel.h"
+#include "../core/Theme.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+
+ContestRatePanel::ContestRatePanel(int x, int y, int w, int h,
+                                   FontManager &fontMgr,
+                                   std::shared_ptr<ContestLogStore> store)
+    : Widget(x, y, w, h), fontMgr_(fontMgr), store_(std::move(store)),
+      data_(store_->snapshot()) {}
+
+void ContestRatePanel::update() {
+  int64_t now = std::time(nullptr);
+  if (store_->version() == seenVersion_ && now == builtAt_)
+    return;
+  seenVersion_ = store_->version();
+  data_ = store_->snapshot();
+  rebuild(now);
+}
+
+void ContestRatePanel::rebuild(int64_t now) {
+  builtAt_ = now;
+  rate10_ = data_->rate(now, 10);
+  rate60_ = data_->rate(now, 60);
+  buckets_.fill(0);
+  int64_t start = now - kColumns * 300;
+  for (const auto &e : data_->recent) {
+    if (e.time < start || e.time > now)
+      continue;
+    int c = static_cast<int>((e.time - start) / 300);
+    buckets_[std::min(c, kColumns - 1)]++;
+  }
+  peak_ = *std::max_element(buckets_.begin(), buckets_.end());
+}
+
+void ContestRatePanel::render(SDL_Renderer *renderer) {
+  if (!fontMgr_.ready())
+    return;
+
+  ThemeColors themes = getThemeColors(theme_);
+  SDL_SetRenderDrawBlendMode(
+      renderer, (theme_ == "glass") ? SDL_BLENDMODE_BLEND : SDL_BLENDMODE_NONE);
+  SDL_SetRenderDrawColor(renderer, themes.bg.r, themes.bg.g, themes.bg.b,
+                         themes.bg.a);
+  SDL_Rect rect = {x_, y_, width_, height_};
+  SDL_RenderFillRect(renderer, &rect);
+  SDL_SetRenderDrawColor(renderer, themes.border.r, themes.border.g,
+                         themes.border.b, themes.border.a);
+  SDL_RenderDrawRect(renderer, &rect);
+
+  int pad = 6;
+  fontMgr_.drawText(renderer, "Contest Rate", x_ + pad, y_ + 4, themes.accent,
+                    10, true);
+  const std::string &contest =
+      data_->hasScore ? data_->score.contest : data_->contest;
+  if (!contest.empty()) {
+    int w = 0, h = 0;
+    if (SDL_Texture *tex = fontMgr_.renderText(renderer, contest, themes.text,
+                                               9, &w, &h)) {
+      SDL_Rect dst = {x_ + width_ - pad - w, y_ + 5, w, h};
+      SDL_RenderCopy(renderer, tex, nullptr, &dst);
+      SDL_DestroyTexture(tex);
+    }
+  }
+
+  if (data_->loggedTotal == 0 && data_->radios.empty() && !data_->hasScore) {
+    fontMgr_.drawText(renderer, "Waiting for N1MM", x_ + width_ / 2,
+                      y_ + height_ / 2, themes.textDim, 10, false, true);
+    return;
+  }
+
+  // The two rates, side by side.
+  int top = y_ + 20;
+  int half = (width_ - 2 * pad) / 2;
+  char buf[80];
+  std::snprintf(buf, sizeof(buf), "%.0f", rate10_);
+  fontMgr_.drawText(renderer, buf, x_ + pad, top, themes.text, 18, true);
+  fontMgr_.drawText(renderer, "/h 10 min", x_ + pad, top + 22, themes.textDim,
+                    8);
+  std::snprintf(buf, sizeof(buf), "%.0f", rate60_);
+  fontMgr_.drawText(renderer, buf, x_ + pad + half, top, themes.text, 18, true);
+  fontMgr_.drawText(renderer, "/h 60 min", x_ + pad + half, top + 22,
+                    themes.textDim, 8);
+
+  // QSOs per 5 minutes over the last hour.
+  int barTop = top + 34;
+  int barH = std::clamp(height_ / 5, 12, 40);
+  float colW = (width_ - 2 * pad) / static_cast<float>(kColumns);
+  for (int c = 0; c < kColumns && peak_ > 0; ++c) {
+    if (buckets_[c] == 0)
+      continue;
+    int h = std::max(1, buckets_[c] * barH / peak_);
+    SDL_SetRenderDrawColor(renderer, themes.accent.r, themes.accent.g,
+                           themes.accent.b, 255);
+    SDL_Rect bar = {x_ + pad + static_cast<int>(c * colW), barTop + barH - h,
+                    std::max(1, static_cast<int>(colW) - 1), h};
+    SDL_RenderFillRect(renderer, &bar);
+  }
+  SDL_SetRenderDrawColor(renderer, themes.border.r, themes.border.g,
+                         themes.border.b, 255);
+  SDL_RenderDrawLine(renderer, x_ + pad, barTop + barH, x_ + width_ - pad,
+                     barTop + barH);
+
+  int curY = barTop + barH + 4;
+  if (data_->hasScore) {
+    const ContestScore &s = data_->score;
+    std::snprintf(buf, sizeof(buf), "%d Q  %d mult  %lld pts", s.qsos,
+                  s.mults, static_cast<long long>(s.score));
+  } else {
+    std::snprintf(buf, sizeof(buf), "%d QSOs heard", data_->qsos);
+  }
+  fontMgr_.drawText(renderer, buf, x_ + pad, curY, themes.text, 9);
+  curY += 13;
+
+  // One line per radio, as long as they fit.
+  auto now = std::chrono::system_clock::now();
+  for (const auto &r : data_->radios) {
+    if (curY + 11 > y_ + height_ - 2)
+      break;
+    bool stale = !r.connected || now - r.updated > kRadioStale;
+    std::snprintf(buf, sizeof(buf), "%.8s/%d %8.1f %-4.4s %-6.6s%s",
+                  r.station.c_str(), r.radioNr, r.rxKhz, r.mode.c_str(),
+                  r.opCall.c_str(),
+                  r.transmitting ? " TX"
+                  : r.running    ? " RUN"
+                                 : "");
+    fontMgr_.drawText(renderer, buf, x_ + pad, curY,
+                      stale ? themes.textDim
+                            : (r.transmitting ? themes.accent : themes.text),
+                      8);
+    curY += 11;
+  }
+}
+
+nlohmann::json ContestRatePanel::getDebugData() const {
+  nlohmann::json j = nlohmann::json::object();
+  j["contest"] = data_->contest;
+  j["qsos"] = data_->qsos;
+  j["loggedTotal"] = data_->loggedTotal;
+  j["rate10"] = rate10_;
+  j["rate60"] = rate60_;
+  j["radios"] = data_->radios.size();
+  if (data_->hasScore) {
+    j["score"] = {{"call", data_->score.call},
+                  {"score", data_->score.score},
+                  {"qsos", data_->score.qsos},
+                  {"mults", data_->score.mults},
+                  {"points", data_->score.points}};
+  }
+  return j;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "../core/ContestLogData.h"
+#include "FontManager.h"
+#include "Widget.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Live contest rate from N1MM Logger+ broadcasts: QSOs per hour over the
+// last 10 and 60 minutes for the whole network, a bar per 5 minutes of the
+// last hour, the score the logger reports, and what each radio is on.
+class ContestRatePanel : public Widget {
+public:
+  ContestRatePanel(int x, int y, int w, int h, FontManager &fontMgr,
+                   std::shared_ptr<ContestLogStore> store);
+
+  void update() override;
+  void render(SDL_Renderer *renderer) override;
+
+  std::string getName() const override { return "ContestRatePanel"; }
+  nlohmann::json getDebugData() const override;
+
+private:
+  static constexpr int kColumns = 12; // 5-minute buckets, one hour
+  // Radios not heard from for this long are greyed out.
+  static constexpr auto kRadioStale = std::chrono::minutes(2);
+
+  void rebuild(int64_t now);
+
+  FontManager &fontMgr_;
+  std::shared_ptr<ContestLogStore> store_;
+
+  ContestLogStore::Snapshot data_;
+  uint64_t seenVersion_ = 0;
+  int64_t builtAt_ = 0; // the rates move with the clock, not just the data
+  double rate10_ = 0;
+  double rate60_ = 0;
+  std::array<int, kColumns> buckets_{}; // oldest first
+  int peak_ = 0;
+};
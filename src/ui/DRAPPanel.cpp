@@ -17,7 +17,7 @@ void DRAPPanel::update() {
   uint32_t now = SDL_GetTicks();
   if (now - lastFetch_ > 15 * 60 * 1000 || lastFetch_ == 0) { // 15 mins
     lastFetch_ = now;
-    provider_.fetch([](const std::string &data) {
+    fetch_ = provider_.fetch([](const std::string &data) {
       std::lock_guard<std::mutex> lock(drapMutex);
       drapValue = data;
       drapDataReady = true;
@@ -19,6 +19,7 @@ private:
   FontManager &fontMgr_;
   TextureManager &texMgr_;
   DRAPProvider &provider_;
+  FetchHandle fetch_;
 
   bool dataReady_ = false;
   uint32_t lastFetch_ = 0;
@@ -1,68 +1,111 @@
 #include "DXClusterPanel.h"
+#include "../core/Logger.h"
+#include "../core/Theme.h"
 #include <iomanip>
 #include <sstream>
 
 DXClusterPanel::DXClusterPanel(int x, int y, int w, int h, FontManager &fontMgr,
                                std::shared_ptr<DXClusterDataStore> store)
-    : ListPanel(x, y, w, h, fontMgr, "DX Cluster", {}), store_(store) {}
+    : ListPanel(x, y, w, h, fontMgr, "DX Cluster", {}), store_(store) {
+  changeSub_ = ChangeBus::instance().subscribe(
+      ChangeBus::Topic::DXCluster,
+      [this](ChangeBus::Topic, uint64_t) { dirty_ = true; });
+}
 
-void DXClusterPanel::update() {
-  auto data = store_->get();
-  bool dataChanged = (data.lastUpdate != lastUpdate_);
+void DXClusterPanel::setFilter(const std::string &expr) {
+  std::string error;
+  if (!filter_.compile(expr, &error))
+    LOG_W("DXClusterPanel", "Ignoring spot filter: {}", error);
+  dirty_ = true;
+}
 
-  if (dataChanged) {
-    rebuildRows(data);
-    lastUpdate_ = data.lastUpdate;
+void DXClusterPanel::update() {
+  // Rows are only re-laid out after the store announced a change.
+  if (!dirty_)
+    return;
+  dirty_ = false;
+
+  rowsSnap_ = store_->snapshot();
+  const DXClusterData &data = *rowsSnap_;
+  rebuildRows(data);
+
+  // Ensure scroll offset is valid
+  if (allRows_.empty()) {
+    scrollOffset_ = 0;
+  } else {
+    int maxScroll = std::max(0, (int)allRows_.size() - MAX_VISIBLE_ROWS);
+    scrollOffset_ = std::min(scrollOffset_, maxScroll);
   }
 
-  // Re-render visible rows if data changed or scrolled (though ListPanel
-  // handles its own render tick, we update contents here)
-  if (dataChanged) {
-    // Ensure scroll offset is valid
-    if (allRows_.empty()) {
-      scrollOffset_ = 0;
-    } else {
-      int maxScroll = std::max(0, (int)allRows_.size() - MAX_VISIBLE_ROWS);
-      scrollOffset_ = std::min(scrollOffset_, maxScroll);
-    }
+  // Update ListPanel rows
+  if (!allRows_.empty()) {
+    showVisibleRows();
+  } else if (!data.spots.empty()) {
+    setRows({"No spots match filter"});
+  } else {
+    setRows({data.connected
+                 ? "Waiting for spots..."
+                 : (data.statusMsg.empty() ? "Disconnected" : data.statusMsg)});
+  }
+}
 
-    // Update ListPanel rows
-    std::vector<std::string> visible;
-    if (allRows_.empty()) {
-      visible.push_back(
-          data.connected
-              ? "Waiting for spots..."
-              : (data.statusMsg.empty() ? "Disconnected" : data.statusMsg));
-    } else {
-      for (int i = 0; i < MAX_VISIBLE_ROWS; ++i) {
-        if (scrollOffset_ + i < (int)allRows_.size()) {
-          visible.push_back(allRows_[scrollOffset_ + i]);
-        }
-      }
+void DXClusterPanel::showVisibleRows() {
+  // Spots the log still needs are coloured by what they would add.
+  SDL_Color normal = getThemeColors(theme_).text;
+  std::vector<std::string> visible;
+  std::vector<SDL_Color> colors;
+  for (int i = 0; i < MAX_VISIBLE_ROWS; ++i) {
+    if (scrollOffset_ + i < (int)allRows_.size()) {
+      visible.push_back(allRows_[scrollOffset_ + i]);
+      colors.push_back(
+          spotNeedColor(rowSpots_[scrollOffset_ + i].need(), normal));
     }
-    setRows(visible);
   }
+  setRows(visible);
+  setRowColors(std::move(colors));
 }
 
 void DXClusterPanel::rebuildRows(const DXClusterData &data) {
   allRows_.clear();
-  auto spots = data.spots;
-  // Most recent first
-  std::reverse(spots.begin(), spots.end());
+  allRows_.reserve(data.spots.size());
+  rowSpots_.clear();
+  rowSpots_.reserve(data.spots.size());
+  auto now = std::chrono::system_clock::to_time_t(
+      std::chrono::system_clock::now());
+
+  // With more than one cluster, suffix each row with a letter per source
+  // that reported it: A = the main cluster, B = the first extra source, ...
+  bool showSources = data.sources.size() > 1;
 
-  for (const auto &spot : spots) {
+  // Most recent first
+  for (size_t i = data.spots.size(); i-- > 0;) {
+    DXSpotRef spot = data.spots[i];
+    if (!filter_.empty() && !filter_.matches(spot.filterFields(), now))
+      continue;
+    rowSpots_.push_back(spot);
     std::stringstream ss;
     // Format: "14025.0 K1ABC      5m"
     // Freq: 8 chars
     // Call: 11 chars
     // Age:  4 chars (right aligned)
-    ss << std::fixed << std::setprecision(1) << std::setw(8) << spot.freqKhz
-       << " " << std::left << std::setw(11) << spot.txCall << std::right
-       << std::setw(4) << formatAge(spot.spottedAt);
+    ss << std::fixed << std::setprecision(1) << std::setw(8) << spot.freqKhz()
+       << " " << std::left << std::setw(11) << spot.txCall() << std::right
+       << std::setw(4) << formatAge(spot.spottedAt());
+    if (showSources)
+      ss << " " << sourceTags(spot.sources(), data.sources.size());
     allRows_.push_back(ss.str());
   }
 }
 
+std::string DXClusterPanel::sourceTags(uint32_t sources, size_t count) {
+  std::string tags;
+  for (size_t i = 0; i < count && i < 26; ++i) {
+    if (sources & (1u << i))
+      tags += static_cast<char>('A' + i);
+  }
+  return tags;
+}
+
 std::string DXClusterPanel::formatAge(
     const std::chrono::system_clock::time_point &spottedAt) const {
   auto now = std::chrono::system_clock::now();
@@ -92,13 +135,7 @@ bool DXClusterPanel::onMouseWheel(int scrollY) {
     scrollOffset_ = newOffset;
 
     // Immediate update of visible rows
-    std::vector<std::string> visible;
-    for (int i = 0; i < MAX_VISIBLE_ROWS; ++i) {
-      if (scrollOffset_ + i < (int)allRows_.size()) {
-        visible.push_back(allRows_[scrollOffset_ + i]);
-      }
-    }
-    setRows(visible);
+    showVisibleRows();
     return true;
   }
   return false;
@@ -122,26 +159,23 @@ bool DXClusterPanel::onMouseUp(int mx, int my, Uint16 /*mod*/) {
     int relY = my - y_;
     int clickedRow = relY / rowH;
 
-    auto data = store_->get();
-    // Reverse logic matches rebuildRows
-    // We need to access the sorted spots as displayed.
-    // Rebuilding them here is inefficient but safe.
-    auto spots = data.spots;
-    std::reverse(spots.begin(), spots.end());
+    auto snap = store_->snapshot();
+    const DXClusterData &data = *snap;
 
     if (clickedRow >= 0 && clickedRow < MAX_VISIBLE_ROWS) {
+      // Rows map to spots through rowSpots_, see rebuildRows().
       int idx = scrollOffset_ + clickedRow;
-      if (idx >= 0 && idx < (int)spots.size()) {
-        const auto &spot = spots[idx];
+      if (idx >= 0 && idx < (int)rowSpots_.size()) {
+        DXSpotRef spot = rowSpots_[idx];
         bool isSame = data.hasSelection &&
-                      data.selectedSpot.txCall == spot.txCall &&
-                      data.selectedSpot.freqKhz == spot.freqKhz &&
-                      data.selectedSpot.spottedAt == spot.spottedAt;
+                      data.selectedSpot.txCall == spot.txCall() &&
+                      data.selectedSpot.freqKhz == spot.freqKhz() &&
+                      data.selectedSpot.spottedAt == spot.spottedAt();
 
         if (isSame) {
           store_->clearSelection();
         } else {
-          store_->selectSpot(spot);
+          store_->selectSpot(spot.toSpot());
         }
         return true;
       }
@@ -179,13 +213,40 @@ SDL_Rect DXClusterPanel::getActionRect(const std::string &action) const {
 
 nlohmann::json DXClusterPanel::getDebugData() const {
   nlohmann::json j;
-  auto data = store_->get();
-  j["connected"] = data.connected;
-  j["spotCount"] = data.spots.size();
+  auto data = store_->snapshot();
+  j["connected"] = data->connected;
+  j["spotCount"] = data->spots.size();
   j["scrollOffset"] = scrollOffset_;
-  if (!data.spots.empty()) {
-    j["lastSpotFreq"] = data.spots.back().freqKhz;
-    j["lastSpotCall"] = data.spots.back().txCall;
+  j["filter"] = filter_.expression();
+  j["shownCount"] = rowSpots_.size();
+  size_t needed = 0;
+  for (DXSpotRef spot : rowSpots_)
+    needed += spot.need() != SpotNeed::None;
+  j["neededCount"] = needed;
+  if (!data->spots.empty()) {
+    j["lastSpotFreq"] = data->spots.back().freqKhz();
+    j["lastSpotCall"] = data->spots.back().txCall();
+  }
+  const Interner &strings = Interner::instance();
+  j["interned"] = {{"strings", strings.size()}, {"bytes", strings.bytes()}};
+  auto st = store_->ingestStats();
+  j["ingest"] = {{"queued", st.queued},
+                 {"dropped", st.dropped},
+                 {"written", st.written},
+                 {"batches", st.batches},
+                 {"pending", st.pending},
+                 {"lastBatchMs", st.lastBatchMs},
+                 {"lastLatencyMs", st.lastLatencyMs},
+                 {"maxLatencyMs", st.maxLatencyMs}};
+  auto sources = nlohmann::json::array();
+  for (const auto &src : data->sources) {
+    sources.push_back({{"name", src.name},
+                       {"connected", src.connected},
+                       {"received", src.received},
+                       {"duplicates", src.duplicates},
+                       {"dupRatio", src.dupRatio()},
+                       {"spotsPerMin", src.spotsPerMin}});
   }
+  j["sources"] = sources;
   return j;
 }
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "../core/ChangeBus.h"
 #include "../core/DXClusterData.h"
+#include "../core/SpotFilter.h"
 #include "ListPanel.h"
 #include <chrono>
 #include <memory>
@@ -14,6 +16,9 @@ public:
   bool onMouseUp(int mx, int my, Uint16 mod) override;
   bool onMouseWheel(int scrollY) override;
 
+  // Only spots matching 'expr' are listed; an invalid expression shows all.
+  void setFilter(const std::string &expr);
+
   bool isSetupRequested() const { return setupRequested_; }
   void clearSetupRequest() { setupRequested_ = false; }
 
@@ -24,13 +29,21 @@ public:
 
 private:
   void rebuildRows(const DXClusterData &data);
+  // Shows MAX_VISIBLE_ROWS of allRows_ from scrollOffset_.
+  void showVisibleRows();
+  static std::string sourceTags(uint32_t sources, size_t count);
   std::string
   formatAge(const std::chrono::system_clock::time_point &spottedAt) const;
 
   std::shared_ptr<DXClusterDataStore> store_;
-  std::chrono::system_clock::time_point lastUpdate_{};
+  ChangeBus::Subscription changeSub_;
+  bool dirty_ = true; // rows need rebuilding from the store
   bool setupRequested_ = false;
 
+  SpotFilter filter_;
+  // The snapshot the rows were built from, and the spot behind each row.
+  std::shared_ptr<const DXClusterData> rowsSnap_;
+  std::vector<DXSpotRef> rowSpots_;
   std::vector<std::string> allRows_;
   int scrollOffset_ = 0;
   static constexpr int MAX_VISIBLE_ROWS = 15;
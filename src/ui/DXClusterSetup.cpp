@@ -1,4 +1,5 @@
 #include "DXClusterSetup.h"
+#include "../core/SpotFilter.h"
 #include <algorithm>
 #include <cstring>
 
@@ -17,6 +18,24 @@ void DXClusterSetup::recalcLayout() {
 
 void DXClusterSetup::update() {}
 
+void DXClusterSetup::checkFilter() {
+  filterError_ = SpotFilter::validate(filterText_);
+}
+
+// Saving is refused while the filter does not compile; the error stays on
+// screen instead.
+bool DXClusterSetup::trySave() {
+  checkFilter();
+  if (!filterError_.empty()) {
+    activeField_ = 3;
+    cursorPos_ = filterText_.size();
+    return false;
+  }
+  complete_ = true;
+  saved_ = true;
+  return true;
+}
+
 static void renderField(SDL_Renderer *renderer, FontManager &fontMgr,
                         const std::string &text, const std::string &placeholder,
                         int fieldX, int &y, int fieldW, int fieldH,
@@ -79,6 +98,7 @@ void DXClusterSetup::render(SDL_Renderer *renderer) {
   SDL_Color gray = {150, 150, 150, 255};
   SDL_Color orange = {255, 165, 0, 255};
   SDL_Color cyan = {0, 200, 255, 255};
+  SDL_Color red = {255, 80, 80, 255};
 
   int y = y_ + height_ / 10;
 
@@ -122,6 +142,19 @@ void DXClusterSetup::render(SDL_Renderer *renderer) {
               cursorPos_, orange, gray, white, gray);
   y += pad;
 
+  // --- Spot filter ---
+  fontMgr_.drawText(renderer, "Spot Filter:", fieldX, y, white, labelSize_,
+                    true);
+  y += labelSize_ + 4;
+  renderField(renderer, fontMgr_, filterText_,
+              "e.g. band in (20m,17m) and mode=CW", fieldX, y, fieldW, fieldH,
+              fieldSize_, textPad, activeField_ == 3, cursorPos_,
+              filterError_.empty() ? orange : red, gray, white, gray);
+  y += 4;
+  if (!filterError_.empty())
+    fontMgr_.drawText(renderer, filterError_, fieldX, y, red, hintSize_);
+  y += hintSize_ + pad;
+
   // --- UDP / WSJT-X ---
   toggleRect_ = {fieldX, y, 24, 24};
   SDL_SetRenderDrawColor(renderer, 40, 40, 50, 255);
@@ -182,8 +215,7 @@ bool DXClusterSetup::onMouseUp(int mx, int my, Uint16) {
 
   if (mx >= saveRect_.x && mx < saveRect_.x + saveRect_.w &&
       my >= saveRect_.y && my < saveRect_.y + saveRect_.h) {
-    complete_ = true;
-    saved_ = true;
+    trySave();
     return true;
   }
 
@@ -236,6 +268,15 @@ bool DXClusterSetup::onMouseUp(int mx, int my, Uint16) {
     cursorPos_ = loginText_.size();
     return true;
   }
+  y += labelSize_ + 4 + fieldH + pad;
+
+  // Check Filter (Field 3)
+  if (mx >= fieldX && mx < fieldX + fieldW && my >= y + labelSize_ + 4 &&
+      my < y + labelSize_ + 4 + fieldH) {
+    activeField_ = 3;
+    cursorPos_ = filterText_.size();
+    return true;
+  }
 
   return true;
 }
@@ -256,6 +297,10 @@ bool DXClusterSetup::onKeyDown(SDL_Keycode key, Uint16) {
     text = &loginText_;
     maxLen = 32;
     break;
+  case 3:
+    text = &filterText_;
+    maxLen = 200;
+    break;
   }
   if (!text)
     return true;
@@ -272,6 +317,9 @@ bool DXClusterSetup::onKeyDown(SDL_Keycode key, Uint16) {
     case 2:
       cursorPos_ = loginText_.size();
       break;
+    case 3:
+      cursorPos_ = filterText_.size();
+      break;
     }
     return true;
   }
@@ -283,19 +331,22 @@ bool DXClusterSetup::onKeyDown(SDL_Keycode key, Uint16) {
   }
 
   if (key == SDLK_RETURN || key == SDLK_KP_ENTER) {
-    complete_ = true;
-    saved_ = true;
+    trySave();
     return true;
   }
 
   if (key == SDLK_BACKSPACE && cursorPos_ > 0) {
     text->erase(cursorPos_ - 1, 1);
     --cursorPos_;
+    if (text == &filterText_)
+      checkFilter();
     return true;
   }
 
   if (key == SDLK_DELETE && cursorPos_ < (int)text->size()) {
     text->erase(cursorPos_, 1);
+    if (text == &filterText_)
+      checkFilter();
     return true;
   }
 
@@ -336,6 +387,10 @@ bool DXClusterSetup::onTextInput(const char *inputText) {
     field = &loginText_;
     maxLen = 32;
     break;
+  case 3:
+    field = &filterText_;
+    maxLen = 200;
+    break;
   }
   if (!field)
     return true;
@@ -344,6 +399,8 @@ bool DXClusterSetup::onTextInput(const char *inputText) {
 
   field->insert(cursorPos_, inputText);
   cursorPos_ += strlen(inputText);
+  if (field == &filterText_)
+    checkFilter();
   return true;
 }
 
@@ -352,6 +409,8 @@ void DXClusterSetup::setConfig(const AppConfig &cfg) {
   portText_ = std::to_string(cfg.dxClusterPort);
   loginText_ = cfg.dxClusterLogin;
   useWSJTX_ = cfg.dxClusterUseWSJTX;
+  filterText_ = cfg.spotFilterCluster;
+  checkFilter();
   cursorPos_ = hostText_.size();
 }
 
@@ -362,5 +421,6 @@ AppConfig DXClusterSetup::updateConfig(AppConfig cfg) const {
     cfg.dxClusterPort = 7300;
   cfg.dxClusterLogin = loginText_;
   cfg.dxClusterUseWSJTX = useWSJTX_;
+  cfg.spotFilterCluster = filterText_;
   return cfg;
 }
@@ -24,15 +24,19 @@ public:
 
 private:
   void recalcLayout();
+  void checkFilter();
+  bool trySave();
 
   FontManager &fontMgr_;
 
-  // Fields: 0=host, 1=port, 2=login
-  static constexpr int kNumFields = 3;
+  // Fields: 0=host, 1=port, 2=login, 3=spot filter
+  static constexpr int kNumFields = 4;
   int activeField_ = 0;
   std::string hostText_;
   std::string portText_;
   std::string loginText_;
+  std::string filterText_;
+  std::string filterError_; // empty while filterText_ compiles
   bool useWSJTX_ = false;
 
   int cursorPos_ = 0;
@@ -12,9 +12,14 @@ ListPanel::ListPanel(int x, int y, int w, int h, FontManager &fontMgr,
 
 void ListPanel::setRows(const std::vector<std::string> &rows) {
   rows_ = rows;
+  rowColors_.clear();
   destroyCache();
 }
 
+void ListPanel::setRowColors(std::vector<SDL_Color> colors) {
+  rowColors_ = std::move(colors);
+}
+
 void ListPanel::destroyCache() {
   if (titleTex_) {
     SDL_DestroyTexture(titleTex_);
@@ -96,7 +101,6 @@ void ListPanel::render(SDL_Renderer *renderer) {
   int rowH =
       std::max(rowFontSize_ + 4, remaining / static_cast<int>(rows_.size()));
 
-  SDL_Color rowColor = themes.text;
   for (size_t i = 0; i < rows_.size(); ++i) {
     int rowY = curY + static_cast<int>(i) * rowH;
     if (rowY + rowH > y_ + height_)
@@ -109,7 +113,11 @@ void ListPanel::render(SDL_Renderer *renderer) {
                           stripeColor);
 
     // Render row text (cached)
-    if (rows_[i] != rowCache_[i].text) {
+    SDL_Color rowColor = i < rowColors_.size() ? rowColors_[i] : themes.text;
+    const SDL_Color &cached = rowCache_[i].color;
+    if (rows_[i] != rowCache_[i].text || rowColor.r != cached.r ||
+        rowColor.g != cached.g || rowColor.b != cached.b ||
+        rowColor.a != cached.a) {
       if (rowCache_[i].tex) {
         SDL_DestroyTexture(rowCache_[i].tex);
         rowCache_[i].tex = nullptr;
@@ -118,6 +126,7 @@ void ListPanel::render(SDL_Renderer *renderer) {
           fontMgr_.renderText(renderer, rows_[i], rowColor, rowFontSize_,
                               &rowCache_[i].w, &rowCache_[i].h);
       rowCache_[i].text = rows_[i];
+      rowCache_[i].color = rowColor;
     }
     if (rowCache_[i].tex) {
       int ty = rowY + (rowH - rowCache_[i].h) / 2;
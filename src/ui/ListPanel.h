@@ -16,6 +16,9 @@ public:
   void render(SDL_Renderer *renderer) override;
   void onResize(int x, int y, int w, int h) override;
   void setRows(const std::vector<std::string> &rows);
+  // Per-row text colours for the rows last set; missing entries use the
+  // theme's text colour. setRows() clears them.
+  void setRowColors(std::vector<SDL_Color> colors);
 
   std::string getName() const override { return "ListPanel:" + title_; }
   nlohmann::json getDebugData() const override;
@@ -26,6 +29,7 @@ protected:
   FontManager &fontMgr_;
   std::string title_;
   std::vector<std::string> rows_;
+  std::vector<SDL_Color> rowColors_;
 
   SDL_Texture *titleTex_ = nullptr;
   int titleW_ = 0, titleH_ = 0;
@@ -34,6 +38,7 @@ protected:
     SDL_Texture *tex = nullptr;
     int w = 0, h = 0;
     std::string text;
+    SDL_Color color = {};
   };
   std::vector<RowCache> rowCache_;
 
@@ -2,6 +2,7 @@
 #include "../core/Astronomy.h"
 #include "../core/LiveSpotData.h"
 #include "../core/Logger.h"
+#include "../core/Theme.h"
 #include "EmbeddedIcons.h"
 #include "RenderUtils.h"
 
@@ -41,6 +42,14 @@ MapWidget::MapWidget(int x, int y, int w, int h, TextureManager &texMgr,
   recalcMapRect();
 }
 
+void MapWidget::setSpotStore(std::shared_ptr<LiveSpotDataStore> store) {
+  spotStore_ = std::move(store);
+  spotPathsDirty_ = true;
+  spotSub_ = ChangeBus::instance().subscribe(
+      ChangeBus::Topic::LiveSpots,
+      [this](ChangeBus::Topic, uint64_t) { spotPathsDirty_ = true; });
+}
+
 MapWidget::~MapWidget() {
   if (nightOverlayTexture_) {
     SDL_DestroyTexture(nightOverlayTexture_);
@@ -125,7 +134,7 @@ void MapWidget::update() {
                   kMonthNames[month - 1], month);
 
     LOG_I("MapWidget", "Starting async fetch for {}", url);
-    netMgr_.fetchAsync(
+    fetches_.add(netMgr_.fetchAsync(
         url,
         [this, url_str = std::string(url)](std::string data) {
           if (!data.empty()) {
@@ -137,13 +146,13 @@ void MapWidget::update() {
             LOG_E("MapWidget", "Fetch failed or empty for {}", url_str);
           }
         },
-        86400 * 30); // Cache for a month
+        86400 * 30)); // Cache for a month
 
     // Also fetch night lights map (NASA Black Marble 2012)
     const char *nightUrl = "https://eoimages.gsfc.nasa.gov/images/imagerecords/"
                            "79000/79765/dnb_land_ocean_ice.2012.3600x1800.jpg";
     LOG_I("MapWidget", "Starting async fetch for Night Lights");
-    netMgr_.fetchAsync(
+    fetches_.add(netMgr_.fetchAsync(
         nightUrl,
         [this](std::string data) {
           if (!data.empty()) {
@@ -153,7 +162,7 @@ void MapWidget::update() {
             pendingNightMapData_ = std::move(data);
           }
         },
-        86400 * 365); // Cache for a year
+        86400 * 365)); // Cache for a year
   }
 }
 
@@ -233,20 +242,27 @@ void MapWidget::onMouseMove(int mx, int my) {
 
   // 5. Check DX Cluster spots
   if (tip.empty() && dxcStore_) {
-    auto data = dxcStore_->get();
-    for (const auto &spot : data.spots) {
-      if (spot.txLat == 0.0 && spot.txLon == 0.0)
+    auto data = dxcStore_->snapshot();
+    const DXSpotTable &spots = data->spots;
+    for (size_t i = 0; i < spots.size(); ++i) {
+      if (spots.txLat[i] == 0.0f && spots.txLon[i] == 0.0f)
         continue;
-      if (screenDist(spot.txLat, spot.txLon) < kHitRadius) {
-        tip = spot.txCall;
+      if (screenDist(spots.txLat[i], spots.txLon[i]) < kHitRadius) {
+        DXSpotRef spot = spots[i];
+        tip = spot.txCall();
         char buf[64];
-        std::snprintf(buf, sizeof(buf), " %.1f kHz", spot.freqKhz);
+        std::snprintf(buf, sizeof(buf), " %.1f kHz", spot.freqKhz());
         tip += buf;
-        int bi = freqToBandIndex(spot.freqKhz);
+        int bi = spot.band();
         if (bi >= 0)
           tip += std::string(" (") + kBands[bi].name + ")";
-        if (!spot.mode.empty())
-          tip += " " + spot.mode;
+        if (!spot.mode().empty())
+          tip += " " + std::string(spot.mode());
+        if (!std::isnan(spot.dtSecs())) {
+          std::snprintf(buf, sizeof(buf), " %+.0f dB DT %.1f", spot.snr(),
+                        spot.dtSecs());
+          tip += buf;
+        }
         break;
       }
     }
@@ -301,6 +317,17 @@ void MapWidget::renderMarker(SDL_Renderer *renderer, double lat, double lon,
   }
 }
 
+void MapWidget::renderNeedRing(SDL_Renderer *renderer, double lat,
+                               double lon, SpotNeed need) {
+  if (need == SpotNeed::None)
+    return;
+  SDL_FPoint pt = latLonToScreen(lat, lon);
+  float radius = std::max(5.0f, std::min(mapRect_.w, mapRect_.h) / 70.0f);
+  SDL_Color color = spotNeedColor(need, {255, 255, 255, 255});
+  RenderUtils::drawCircleOutline(renderer, pt.x, pt.y, radius, color);
+  RenderUtils::drawCircleOutline(renderer, pt.x, pt.y, radius + 1.0f, color);
+}
+
 void MapWidget::renderGreatCircle(SDL_Renderer *renderer) {
   if (!state_->dxActive || cachedGreatCircle_.empty())
     return;
@@ -692,12 +719,12 @@ void MapWidget::renderSatGroundTrack(SDL_Renderer *renderer) {
 void MapWidget::renderSpotOverlay(SDL_Renderer *renderer) {
   if (!spotStore_)
     return;
-  auto data = spotStore_->get();
-  if (!data.valid || data.spots.empty())
+  auto data = spotStore_->snapshot();
+  if (!data->valid || data->spots.empty())
     return;
   bool anySelected = false;
   for (int i = 0; i < kNumBands; ++i) {
-    if (data.selectedBands[i]) {
+    if (data->selectedBands[i]) {
       anySelected = true;
       break;
     }
@@ -705,40 +732,52 @@ void MapWidget::renderSpotOverlay(SDL_Renderer *renderer) {
   if (!anySelected)
     return;
 
-  SDL_RenderSetClipRect(renderer, &mapRect_);
   LatLon de = state_->deLocation;
-  SDL_Texture *lineTex = texMgr_.get(LINE_AA_KEY);
-
-  int renderedCount = 0;
-  const int MAX_MAP_SPOTS = 500;
-
-  for (const auto &spot : data.spots) {
-    if (renderedCount >= MAX_MAP_SPOTS) {
-      static uint32_t lastWarn = 0;
-      if (SDL_GetTicks() - lastWarn > 60000) {
-        LOG_W(
-            "MapWidget",
-            "Too many spots ({}). Truncating map display to {} for stability.",
-            data.spots.size(), MAX_MAP_SPOTS);
-        lastWarn = SDL_GetTicks();
+  if (spotPathsDirty_ || de.lat != spotPathsDE_.lat ||
+      de.lon != spotPathsDE_.lon) {
+    spotPathsDirty_ = false;
+    spotPathsDE_ = de;
+    cachedSpotPaths_.clear();
+
+    const int MAX_MAP_SPOTS = 500;
+    const LiveSpotTable &spots = data->spots;
+    for (size_t i = 0; i < spots.size(); ++i) {
+      if ((int)cachedSpotPaths_.size() >= MAX_MAP_SPOTS) {
+        static uint32_t lastWarn = 0;
+        if (SDL_GetTicks() - lastWarn > 60000) {
+          LOG_W("MapWidget",
+                "Too many spots ({}). Truncating map display to {} for "
+                "stability.",
+                data->spots.size(), MAX_MAP_SPOTS);
+          lastWarn = SDL_GetTicks();
+        }
+        break;
       }
-      break;
+
+      int bandIdx = spots.band[i];
+      if (bandIdx < 0 || !data->selectedBands[bandIdx])
+        continue;
+      double lat = spots.lat[i], lon = spots.lon[i];
+
+      // Reduce segments to 30 for performance; 100 is overkill for small map
+      // lines.
+      cachedSpotPaths_.push_back(
+          {bandIdx,
+           {lat, lon},
+           Astronomy::calculateGreatCirclePath(de, {lat, lon}, 30),
+           spots.need[i]});
     }
+  }
 
-    int bandIdx = freqToBandIndex(spot.freqKhz);
-    if (bandIdx < 0 || !data.selectedBands[bandIdx])
-      continue;
-    double lat, lon;
-    if (!Astronomy::gridToLatLon(spot.receiverGrid, lat, lon))
-      continue;
+  SDL_RenderSetClipRect(renderer, &mapRect_);
+  SDL_Texture *lineTex = texMgr_.get(LINE_AA_KEY);
 
-    renderedCount++;
-    const auto &bc = kBands[bandIdx].color;
-    // Reduce segments to 30 for performance; 100 is overkill for small map
-    // lines.
-    auto path = Astronomy::calculateGreatCirclePath(de, {lat, lon}, 30);
+  std::vector<SDL_FPoint> segment;
+  for (const auto &sp : cachedSpotPaths_) {
+    const auto &bc = kBands[sp.bandIdx].color;
+    const auto &path = sp.path;
     SDL_Color color = {bc.r, bc.g, bc.b, 180};
-    std::vector<SDL_FPoint> segment;
+    segment.clear();
     for (size_t i = 0; i < path.size(); ++i) {
       if (i > 0 && std::fabs(path[i].lon - path[i - 1].lon) > 180.0) {
         if (segment.size() >= 2) {
@@ -755,8 +794,9 @@ void MapWidget::renderSpotOverlay(SDL_Renderer *renderer) {
                                         static_cast<int>(segment.size()), 1.5f,
                                         color);
     }
-    renderMarker(renderer, lat, lon, bc.r, bc.g, bc.b, MarkerShape::Square,
-                 true);
+    renderMarker(renderer, sp.rx.lat, sp.rx.lon, bc.r, bc.g, bc.b,
+                 MarkerShape::Square, true);
+    renderNeedRing(renderer, sp.rx.lat, sp.rx.lon, sp.need);
   }
   SDL_RenderSetClipRect(renderer, nullptr);
 }
@@ -764,17 +804,17 @@ void MapWidget::renderSpotOverlay(SDL_Renderer *renderer) {
 void MapWidget::renderDXClusterSpots(SDL_Renderer *renderer) {
   if (!dxcStore_)
     return;
-  auto data = dxcStore_->get();
-  if (data.spots.empty())
+  auto data = dxcStore_->snapshot();
+  if (data->spots.empty())
     return;
 
   SDL_RenderSetClipRect(renderer, &mapRect_);
   SDL_Texture *lineTex = texMgr_.get(LINE_AA_KEY);
 
   // Filter spots to render
-  std::vector<DXClusterSpot> spotsToRender;
-  if (data.hasSelection) {
-    spotsToRender.push_back(data.selectedSpot);
+  std::vector<const DXClusterSpot *> spotsToRender;
+  if (data->hasSelection) {
+    spotsToRender.push_back(&data->selectedSpot);
   } else {
     // Default: Show None
     // If user wanted Show All, we'd copy all.
@@ -782,15 +822,15 @@ void MapWidget::renderDXClusterSpots(SDL_Renderer *renderer) {
     // clicked on" So default is empty.
   }
 
-  for (const auto &spot : spotsToRender) {
+  for (const DXClusterSpot *sp : spotsToRender) {
+    const auto &spot = *sp;
     if (spot.txLat == 0.0 && spot.txLon == 0.0)
       continue;
 
     // Determine color based on band
     SDL_Color color = {255, 255, 255, 255}; // Default white
-    int bandIdx = freqToBandIndex(spot.freqKhz);
-    if (bandIdx >= 0) {
-      color = kBands[bandIdx].color;
+    if (spot.band >= 0) {
+      color = kBands[spot.band].color;
     }
 
     // Draw path if RX location is known and different from TX
@@ -825,6 +865,7 @@ void MapWidget::renderDXClusterSpots(SDL_Renderer *renderer) {
     // Plot transmitter as a small circle with band color
     renderMarker(renderer, spot.txLat, spot.txLon, color.r, color.g, color.b,
                  MarkerShape::Circle, true);
+    renderNeedRing(renderer, spot.txLat, spot.txLon, spot.need);
   }
   SDL_RenderSetClipRect(renderer, nullptr);
 }
@@ -951,13 +992,13 @@ nlohmann::json MapWidget::getDebugData() const {
 
   // Spot counts
   if (spotStore_) {
-    auto sd = spotStore_->get();
-    j["live_spot_count"] = static_cast<int>(sd.spots.size());
+    auto sd = spotStore_->snapshot();
+    j["live_spot_count"] = static_cast<int>(sd->spots.size());
   }
   if (dxcStore_) {
-    auto dd = dxcStore_->get();
-    j["dxc_spot_count"] = static_cast<int>(dd.spots.size());
-    j["dxc_connected"] = dd.connected;
+    auto dd = dxcStore_->snapshot();
+    j["dxc_spot_count"] = static_cast<int>(dd->spots.size());
+    j["dxc_connected"] = dd->connected;
   }
 
   // Tooltip
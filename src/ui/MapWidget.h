@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../core/AuroraHistoryStore.h"
+#include "../core/ChangeBus.h"
 #include "../core/ConfigManager.h"
 #include "../core/DXClusterData.h"
 #include "../core/HamClockState.h"
@@ -36,9 +37,7 @@ public:
   void setPredictor(OrbitPredictor *pred) { predictor_ = pred; }
 
   // Set the live spot data store for map spot overlays.
-  void setSpotStore(std::shared_ptr<LiveSpotDataStore> store) {
-    spotStore_ = std::move(store);
-  }
+  void setSpotStore(std::shared_ptr<LiveSpotDataStore> store);
 
   void setDXClusterStore(std::shared_ptr<DXClusterDataStore> store) {
     dxcStore_ = std::move(store);
@@ -64,6 +63,9 @@ private:
   void renderMarker(SDL_Renderer *renderer, double lat, double lon, Uint8 r,
                     Uint8 g, Uint8 b, MarkerShape shape = MarkerShape::Circle,
                     bool outline = true);
+  // Ring around a spot marker in the colour of what the log needs.
+  void renderNeedRing(SDL_Renderer *renderer, double lat, double lon,
+                      SpotNeed need);
   void renderSatellite(SDL_Renderer *renderer);
   void renderSatFootprint(SDL_Renderer *renderer, double lat, double lon,
                           double footprintKm);
@@ -98,6 +100,19 @@ private:
   LatLon lastDE_ = {0, 0};
   LatLon lastDX_ = {0, 0};
 
+  // Great-circle paths for the live spot overlay, rebuilt only when the
+  // spot store announces a change or DE moves.
+  struct SpotPath {
+    int bandIdx;
+    LatLon rx;
+    std::vector<LatLon> path;
+    SpotNeed need;
+  };
+  std::vector<SpotPath> cachedSpotPaths_;
+  bool spotPathsDirty_ = true;
+  ChangeBus::Subscription spotSub_;
+  LatLon spotPathsDE_ = {0, 0};
+
   // Tooltip state
   struct Tooltip {
     bool visible = false;
@@ -113,4 +128,6 @@ private:
   SDL_Texture *nightOverlayTexture_ = nullptr;
   double lastUpdateSunLat_ = -999.0;
   double lastUpdateSunLon_ = -999.0;
+
+  FetchGroup fetches_;
 };
@@ -22,7 +22,7 @@ void MoonPanel::update() {
     lastImageUrl_ = url;
     imageLoading_ = true;
 
-    net_.fetchAsync(
+    fetches_.add(net_.fetchAsync(
         url,
         [this](std::string body) {
           if (!body.empty()) {
@@ -35,7 +35,7 @@ void MoonPanel::update() {
           }
           imageLoading_ = false;
         },
-        86400); // Cache for 24h
+        86400)); // Cache for 24h
   }
 }
 
@@ -36,4 +36,6 @@ private:
 
   int labelFontSize_ = 12;
   int valueFontSize_ = 14;
+
+  FetchGroup fetches_;
 };
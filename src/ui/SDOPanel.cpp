@@ -25,7 +25,7 @@ void SDOPanel::update() {
   // Hourly fetch or on ID change
   if (now - lastFetch_ > 60 * 60 * 1000 || lastFetch_ == 0) {
     lastFetch_ = now;
-    provider_.fetch(currentId_, [](const std::string &data) {
+    fetch_ = provider_.fetch(currentId_, [](const std::string &data) {
       std::lock_guard<std::mutex> lock(sdoMutex);
       sdoPendingData = data;
       sdoDataReady = true;
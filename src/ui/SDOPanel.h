@@ -34,6 +34,7 @@ private:
   FontManager &fontMgr_;
   TextureManager &texMgr_;
   SDOProvider &provider_;
+  FetchHandle fetch_; // replaced, and so cancelled, by the next fetch
   double obsLat_ = 0, obsLon_ = 0;
 
   struct Wavelength {
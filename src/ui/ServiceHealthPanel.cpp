@@ -0,0 +1,54 @@
+#include "ServiceHealthPanel.h"
+#include "../core/ServiceHealth.h"
+
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+ServiceHealthPanel::ServiceHealthPanel(int x, int y, int w, int h,
+                                       FontManager &fontMgr)
+    : ListPanel(x, y, w, h, fontMgr, "Service Health", {}) {}
+
+static std::string formatAge(std::chrono::system_clock::time_point tp) {
+  if (tp.time_since_epoch().count() == 0)
+    return "-";
+  auto secs = std::chrono::duration_cast<std::chrono::seconds>(
+                  std::chrono::system_clock::now() - tp)
+                  .count();
+  if (secs < 0)
+    secs = 0;
+  if (secs < 120)
+    return std::to_string(secs) + "s";
+  if (secs < 2 * 3600)
+    return std::to_string(secs / 60) + "m";
+  return std::to_string(secs / 3600) + "h";
+}
+
+void ServiceHealthPanel::update() {
+  // Ages only need second resolution; rebuilding the rows every frame would
+  // re-render their textures for nothing.
+  uint32_t nowTicks = SDL_GetTicks();
+  if (lastRefresh_ != 0 && nowTicks - lastRefresh_ < 1000)
+    return;
+  lastRefresh_ = nowTicks;
+
+  std::vector<std::string> rows;
+  // Format: "NAME            OK    12s" or "NAME            FAILx3 Timeout"
+  for (const auto &h : ServiceHealthRegistry::instance().snapshot()) {
+    std::stringstream ss;
+    ss << std::left << std::setw(16) << h.name.substr(0, 15);
+    if (!h.reported) {
+      ss << std::setw(7) << "--" << h.lastError;
+    } else if (h.ok) {
+      ss << std::setw(7) << "OK" << formatAge(h.lastSuccess);
+    } else {
+      ss << std::setw(7) << ("FAILx" + std::to_string(h.consecutiveFailures))
+         << h.lastError;
+    }
+    rows.push_back(ss.str());
+  }
+  if (rows.empty())
+    rows.push_back("No services reporting");
+  if (rows != rows_)
+    setRows(rows);
+}
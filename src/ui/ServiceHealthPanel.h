@@ -0,0 +1,17 @@
+#pragma once
+
+#include "ListPanel.h"
+#include <SDL.h>
+
+// One row per upstream service from the ServiceHealthRegistry.
+class ServiceHealthPanel : public ListPanel {
+public:
+  ServiceHealthPanel(int x, int y, int w, int h, FontManager &fontMgr);
+
+  void update() override;
+
+  std::string getName() const override { return "ServiceHealth"; }
+
+private:
+  uint32_t lastRefresh_ = 0;
+};
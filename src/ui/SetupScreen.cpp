@@ -431,7 +431,9 @@ void SetupScreen::renderTabWidgets(SDL_Renderer *renderer, int cx, int pad,
       WidgetType::HISTORY_FLUX, WidgetType::HISTORY_KP,
       WidgetType::HISTORY_SSN,  WidgetType::DRAP,
       WidgetType::AURORA,       WidgetType::ADIF,
-      WidgetType::COUNTDOWN};
+      WidgetType::COUNTDOWN,    WidgetType::SERVICE_HEALTH,
+      WidgetType::SPOT_HISTORY, WidgetType::BAND_ACTIVITY,
+      WidgetType::CONTEST_RATE};
 
   int totalItems = static_cast<int>(sizeof(allTypes) / sizeof(allTypes[0]));
   int leftColCount = (totalItems + 1) / 2;
@@ -0,0 +1,191 @@
+#include "SpotHistoryPanel.h"
+#include "../core/LiveSpotData.h"
+#include "../core/Theme.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+
+namespace {
+
+std::string formatAge(int64_t unixSecs) {
+  int64_t now = std::time(nullptr);
+  int64_t secs = std::max<int64_t>(0, now - unixSecs);
+  if (secs < 3600)
+    return std::to_string(secs / 60) + "m";
+  if (secs < 2 * 86400)
+    return std::to_string(secs / 3600) + "h";
+  return std::to_string(secs / 86400) + "d";
+}
+
+const char *bandName(int band) {
+  return band >= 0 && band < kNumBands ? kBands[band].name : "?";
+}
+
+} // namespace
+
+SpotHistoryPanel::SpotHistoryPanel(int x, int y, int w, int h,
+                                   FontManager &fontMgr,
+                                   SpotHistoryProvider &provider,
+                                   std::shared_ptr<SpotHistoryStore> store,
+                                   std::shared_ptr<DXClusterDataStore> dxcStore,
+                                   const AppConfig &config)
+    : Widget(x, y, w, h), fontMgr_(fontMgr), provider_(provider),
+      store_(std::move(store)), dxcStore_(std::move(dxcStore)),
+      config_(config), data_(store_->snapshot()) {}
+
+void SpotHistoryPanel::update() {
+  auto dx = dxcStore_->snapshot();
+  if (dx->hasSelection) {
+    const DXClusterSpot &spot = dx->selectedSpot;
+    if (spot.txCall != requestedCall_ || spot.band != requestedBand_) {
+      requestedCall_ = spot.txCall;
+      requestedBand_ = spot.band;
+      provider_.lookup(spot, continentAt(config_.lat, config_.lon));
+    }
+  }
+  if (store_->version() != seenVersion_) {
+    seenVersion_ = store_->version();
+    data_ = store_->snapshot();
+  }
+}
+
+void SpotHistoryPanel::render(SDL_Renderer *renderer) {
+  if (!fontMgr_.ready())
+    return;
+
+  ThemeColors themes = getThemeColors(theme_);
+  SDL_SetRenderDrawBlendMode(
+      renderer, (theme_ == "glass") ? SDL_BLENDMODE_BLEND : SDL_BLENDMODE_NONE);
+  SDL_SetRenderDrawColor(renderer, themes.bg.r, themes.bg.g, themes.bg.b,
+                         themes.bg.a);
+  SDL_Rect rect = {x_, y_, width_, height_};
+  SDL_RenderFillRect(renderer, &rect);
+  SDL_SetRenderDrawColor(renderer, themes.border.r, themes.border.g,
+                         themes.border.b, themes.border.a);
+  SDL_RenderDrawRect(renderer, &rect);
+
+  int pad = 8;
+  fontMgr_.drawText(renderer, "Spot History", x_ + pad, y_ + 5, themes.accent,
+                    10, true);
+
+  const SpotHistoryData &d = *data_;
+  if (!d.valid) {
+    const char *msg = requestedCall_.empty() ? "Select a cluster spot"
+                                             : "Searching...";
+    fontMgr_.drawText(renderer, msg, x_ + width_ / 2, y_ + height_ / 2,
+                      themes.textDim, 10, false, true);
+    return;
+  }
+
+  // The call, right-aligned.
+  int callW = 0, callH = 0;
+  if (SDL_Texture *tex = fontMgr_.renderText(renderer, d.call, themes.text,
+                                             10, &callW, &callH, true)) {
+    SDL_Rect dst = {x_ + width_ - pad - callW, y_ + 5, callW, callH};
+    SDL_RenderCopy(renderer, tex, nullptr, &dst);
+    SDL_DestroyTexture(tex);
+  }
+
+  int rowH = std::clamp(height_ / 11, 11, 16);
+  int y = y_ + 5 + rowH + 2;
+  char buf[96];
+
+  std::snprintf(buf, sizeof(buf), "%dd: %d days, %llu spots", d.days,
+                d.history.daysHeard,
+                static_cast<unsigned long long>(d.history.totalSpots));
+  fontMgr_.drawText(renderer, buf, x_ + pad, y, themes.text, 9);
+  y += rowH;
+
+  std::string bands = "Bands:";
+  for (int b = 0; b < kNumBands; ++b) {
+    if (d.history.bands & (1u << b))
+      bands += std::string(" ") + kBands[b].name;
+  }
+  fontMgr_.drawText(renderer, d.history.bands ? bands : "Bands: -", x_ + pad,
+                    y, themes.textDim, 9);
+  y += rowH;
+
+  // Entity: most recent bands first.
+  std::string entity = "Entity:";
+  if (d.entity.empty())
+    entity += " -";
+  for (size_t i = 0; i < d.entity.size() && i < 3; ++i) {
+    entity += std::string(" ") + bandName(d.entity[i].band) + " " +
+              formatAge(d.entity[i].spottedAt);
+  }
+  fontMgr_.drawText(renderer, entity, x_ + pad, y, themes.textDim, 9);
+  y += rowH + 2;
+
+  SDL_Rect chart = {x_ + pad, y, width_ - 2 * pad,
+                    y_ + height_ - pad - y};
+  if (chart.h > 20)
+    renderChart(renderer, chart);
+}
+
+void SpotHistoryPanel::renderChart(SDL_Renderer *renderer, SDL_Rect area) {
+  ThemeColors themes = getThemeColors(theme_);
+  const SpotHistoryData &d = *data_;
+
+  char label[64];
+  std::snprintf(label, sizeof(label), "%s %s>%s by UTC hour",
+                d.band >= 0 ? bandName(d.band) : "All",
+                continentName(d.from), continentName(d.to));
+  fontMgr_.drawText(renderer, label, area.x, area.y, themes.textDim, 8);
+  int labelH = 11;
+  int axisH = 10;
+  int barsY = area.y + labelH;
+  int barsH = area.h - labelH - axisH;
+  if (barsH < 6)
+    return;
+
+  uint64_t peak = *std::max_element(d.activity.hours.begin(),
+                                    d.activity.hours.end());
+  std::time_t now = std::time(nullptr);
+  int thisHour = static_cast<int>((now % 86400) / 3600);
+  SDL_Color barColor =
+      d.band >= 0 && d.band < kNumBands ? kBands[d.band].color : themes.accent;
+
+  float slot = area.w / 24.0f;
+  for (int h = 0; h < 24; ++h) {
+    int bh = peak ? static_cast<int>(d.activity.hours[h] * barsH / peak) : 0;
+    SDL_Color c = h == thisHour ? themes.text : barColor;
+    SDL_SetRenderDrawColor(renderer, c.r, c.g, c.b, 255);
+    SDL_Rect bar = {area.x + static_cast<int>(h * slot) + 1,
+                    barsY + barsH - bh, std::max(1, static_cast<int>(slot) - 1),
+                    std::max(bh, peak ? 1 : 0)};
+    SDL_RenderFillRect(renderer, &bar);
+  }
+  SDL_SetRenderDrawColor(renderer, themes.border.r, themes.border.g,
+                         themes.border.b, 255);
+  SDL_RenderDrawLine(renderer, area.x, barsY + barsH, area.x + area.w,
+                     barsY + barsH);
+  for (int h = 0; h < 24; h += 6) {
+    fontMgr_.drawText(renderer, std::to_string(h),
+                      area.x + static_cast<int>(h * slot), barsY + barsH + 1,
+                      themes.textDim, 8);
+  }
+  if (!peak) {
+    fontMgr_.drawText(renderer, "No spots on this path", area.x + area.w / 2,
+                      barsY + barsH / 2, themes.textDim, 9, false, true);
+  }
+}
+
+nlohmann::json SpotHistoryPanel::getDebugData() const {
+  nlohmann::json j = nlohmann::json::object();
+  const SpotHistoryData &d = *data_;
+  if (!d.valid)
+    return j;
+  j["call"] = d.call;
+  j["days"] = d.days;
+  j["daysHeard"] = d.history.daysHeard;
+  j["totalSpots"] = d.history.totalSpots;
+  j["recentSpots"] = d.history.spots.size();
+  j["band"] = d.band;
+  j["path"] = std::string(continentName(d.from)) + ">" + continentName(d.to);
+  j["activityTotal"] = d.activity.total;
+  j["entityBands"] = d.entity.size();
+  j["queryMs"] = d.queryMs;
+  return j;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "../core/ConfigManager.h"
+#include "../core/DXClusterData.h"
+#include "../core/SpotHistoryData.h"
+#include "../services/SpotHistoryProvider.h"
+#include "FontManager.h"
+#include "Widget.h"
+
+#include <memory>
+#include <string>
+
+// Archive view of the spot selected in the DX cluster list: how often the
+// call was spotted over the last month, when its entity was last spotted
+// on each band, and at which UTC hours the band opens from the DX
+// station's continent to ours.
+class SpotHistoryPanel : public Widget {
+public:
+  SpotHistoryPanel(int x, int y, int w, int h, FontManager &fontMgr,
+                   SpotHistoryProvider &provider,
+                   std::shared_ptr<SpotHistoryStore> store,
+                   std::shared_ptr<DXClusterDataStore> dxcStore,
+                   const AppConfig &config);
+
+  void update() override;
+  void render(SDL_Renderer *renderer) override;
+
+  std::string getName() const override { return "SpotHistoryPanel"; }
+  nlohmann::json getDebugData() const override;
+
+private:
+  void renderChart(SDL_Renderer *renderer, SDL_Rect area);
+
+  FontManager &fontMgr_;
+  SpotHistoryProvider &provider_;
+  std::shared_ptr<SpotHistoryStore> store_;
+  std::shared_ptr<DXClusterDataStore> dxcStore_;
+  const AppConfig &config_;
+
+  SpotHistoryStore::Snapshot data_;
+  uint64_t seenVersion_ = 0;
+  std::string requestedCall_;
+  int requestedBand_ = -1;
+};
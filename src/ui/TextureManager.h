@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../core/Logger.h"
+#include "../core/Tracer.h"
 #include <SDL.h>
 #include <SDL_image.h>
 
@@ -46,6 +47,7 @@ public:
     if (it != cache_.end())
       return it->second;
 
+    TRACE_SCOPE("texture", "TextureManager::loadImage");
     SDL_Surface *surface = IMG_Load(path.c_str());
     if (!surface) {
       LOG_E("TextureManager", "Failed to load {}: {}", path, IMG_GetError());
@@ -69,6 +71,7 @@ public:
   // Load an image from memory (e.g. embedded assets).
   SDL_Texture *loadFromMemory(SDL_Renderer *renderer, const std::string &key,
                               const unsigned char *data, unsigned int size) {
+    TRACE_SCOPE("texture", "TextureManager::loadFromMemory");
     SDL_RWops *rw = SDL_RWFromConstMem(data, static_cast<int>(size));
     if (!rw) {
       LOG_E("TextureManager", "SDL_RWFromConstMem failed");
@@ -167,7 +170,11 @@ public:
       }
     }
 
-    SDL_Texture *texture = SDL_CreateTextureFromSurface(renderer, finalSurface);
+    SDL_Texture *texture;
+    {
+      TRACE_SCOPE("texture", "upload");
+      texture = SDL_CreateTextureFromSurface(renderer, finalSurface);
+    }
     if (mustFreeFinal)
       SDL_FreeSurface(finalSurface);
     SDL_FreeSurface(surface);
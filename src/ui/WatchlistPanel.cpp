@@ -6,15 +6,21 @@ WatchlistPanel::WatchlistPanel(int x, int y, int w, int h, FontManager &fontMgr,
                                std::shared_ptr<WatchlistStore> watchlist,
                                std::shared_ptr<WatchlistHitStore> hits)
     : ListPanel(x, y, w, h, fontMgr, "Watchlist Hits", {}),
-      watchlist_(watchlist), hits_(hits) {}
+      watchlist_(watchlist), hits_(hits) {
+  // New hits and edits to the watched calls both change what is shown.
+  auto markDirty = [this](ChangeBus::Topic, uint64_t) { dirty_ = true; };
+  auto &bus = ChangeBus::instance();
+  changeSubs_.push_back(
+      bus.subscribe(ChangeBus::Topic::WatchlistHits, markDirty));
+  changeSubs_.push_back(bus.subscribe(ChangeBus::Topic::Watchlist, markDirty));
+}
 
 void WatchlistPanel::update() {
-  auto last = hits_->lastUpdate();
-  if (last != lastUpdate_) {
+  if (dirty_) {
     std::vector<std::string> rows;
-    auto hits = hits_->getHits();
+    auto hits = hits_->snapshot();
 
-    for (const auto &hit : hits) {
+    for (const auto &hit : *hits) {
       std::stringstream ss;
       ss << std::left << std::setw(10) << hit.call << std::setw(8) << std::fixed
          << std::setprecision(1) << hit.freqKhz << " [" << hit.source << "]";
@@ -34,6 +40,6 @@ void WatchlistPanel::update() {
     }
 
     setRows(rows);
-    lastUpdate_ = last;
+    dirty_ = false;
   }
 }
@@ -1,10 +1,11 @@
 #pragma once
 
+#include "../core/ChangeBus.h"
 #include "../core/WatchlistHitStore.h"
 #include "../core/WatchlistStore.h"
 #include "ListPanel.h"
-#include <chrono>
 #include <memory>
+#include <vector>
 
 class WatchlistPanel : public ListPanel {
 public:
@@ -17,5 +18,6 @@ public:
 private:
   std::shared_ptr<WatchlistStore> watchlist_;
   std::shared_ptr<WatchlistHitStore> hits_;
-  std::chrono::system_clock::time_point lastUpdate_{};
+  std::vector<ChangeBus::Subscription> changeSubs_;
+  bool dirty_ = true;
 };
@@ -0,0 +1,167 @@
+// WorkedMatrix on its own, then ADIFProvider reading a log the way a logger
+// writes it: a record cut in two between polls, lower-case tags, a QSO
+// with only FREQ, one with no DXCC field, and two rewrites, one shrinking
+// the file and one keeping its first records while it grows.
+
+#include "Check.h"
+
+#include "core/LiveSpotData.h"
+#include "core/Logger.h"
+#include "services/ADIFProvider.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace {
+
+const int k40m = freqToBandIndex(7025);
+const int k20m = freqToBandIndex(14025);
+const int k15m = freqToBandIndex(21025);
+const int k10m = freqToBandIndex(28074);
+
+void matrix() {
+  CHECK_EQ(WorkedMatrix::modeClass(SpotMode::Unknown), -1);
+  CHECK_EQ(WorkedMatrix::modeClass(SpotMode::CW), WorkedMatrix::CW);
+  CHECK_EQ(WorkedMatrix::modeClass(SpotMode::FM), WorkedMatrix::Phone);
+  CHECK_EQ(WorkedMatrix::modeClass(SpotMode::FT8), WorkedMatrix::Data);
+
+  WorkedMatrix w;
+  // Nothing is needed before the log has a QSO.
+  CHECK_EQ(w.need(291, k20m, SpotMode::CW), SpotNeed::None);
+
+  w.record(291, k20m, WorkedMatrix::CW);
+  CHECK_EQ(w.need(291, k20m, SpotMode::CW), SpotNeed::None);
+  CHECK_EQ(w.need(291, k20m, SpotMode::SSB), SpotNeed::NewMode);
+  CHECK_EQ(w.need(291, k20m, SpotMode::FT8), SpotNeed::NewMode);
+  CHECK_EQ(w.need(291, k40m, SpotMode::CW), SpotNeed::NewBand);
+  CHECK_EQ(w.need(339, k20m, SpotMode::CW), SpotNeed::NewDxcc);
+  CHECK_EQ(w.need(0, k20m, SpotMode::CW), SpotNeed::None);
+  // An unknown mode or band only checks the coarser slots.
+  CHECK_EQ(w.need(291, k20m, SpotMode::Unknown), SpotNeed::None);
+  CHECK_EQ(w.need(291, k40m, SpotMode::Unknown), SpotNeed::NewBand);
+  CHECK_EQ(w.need(291, -1, SpotMode::SSB), SpotNeed::None);
+
+  // A QSO with no band or mode still works the entity.
+  w.record(339, -1, -1);
+  CHECK(w.worked(339));
+  CHECK_EQ(w.need(339, k20m, SpotMode::CW), SpotNeed::NewBand);
+  w.record(339, k20m, -1);
+  CHECK_EQ(w.need(339, k20m, SpotMode::CW), SpotNeed::NewMode);
+  CHECK_EQ(w.need(339, k20m, SpotMode::Unknown), SpotNeed::None);
+
+  CHECK_EQ(w.entityCount(), 2);
+  CHECK_EQ(w.qsoCount(), uint64_t{3});
+  w.clear();
+  CHECK(!w.worked(291));
+  CHECK_EQ(w.need(339, k20m, SpotMode::CW), SpotNeed::None);
+}
+
+void writeFile(const std::filesystem::path &path, const std::string &text,
+               bool append) {
+  std::ofstream out(path, std::ios::binary |
+                              (append ? std::ios::app : std::ios::trunc));
+  out << text;
+}
+
+std::string field(const std::string &name, const std::string &value) {
+  return "<" + name + ":" + std::to_string(value.size()) + ">" + value;
+}
+
+std::string qso(const std::string &call, const std::string &band,
+                const std::string &mode, const std::string &dxcc) {
+  std::string r = field("CALL", call) + field("BAND", band) +
+                  field("MODE", mode);
+  if (!dxcc.empty())
+    r += field("DXCC", dxcc);
+  return r + "<EOR>\n";
+}
+
+const std::string kHeader =
+    "Exported log\n" + field("ADIF_VER", "3.1.4") + "<EOH>\n";
+
+void reader(const std::filesystem::path &dir) {
+  auto store = std::make_shared<ADIFStore>();
+  auto worked = std::make_shared<WorkedMatrix>();
+  PrefixManager pm;
+  ADIFProvider adif(store, worked, &pm);
+  auto log = dir / "log.adi";
+  auto total = [&] { return store->get().totalQSOs; };
+
+  // The logger is part way through its second record.
+  std::string second = qso("K1ABC", "40m", "SSB", "291");
+  writeFile(log, kHeader + qso("JA1ZZZ", "20m", "CW", "339") +
+                     second.substr(0, 20),
+            false);
+  CHECK(adif.fetch(log));
+  CHECK_EQ(total(), 1);
+  CHECK(worked->worked(339));
+  CHECK(!worked->worked(291));
+  // Still cut, now inside the <EOR> tag.
+  writeFile(log, second.substr(20, second.size() - 23), true);
+  CHECK(!adif.fetch(log));
+  CHECK_EQ(total(), 1);
+  writeFile(log, second.substr(second.size() - 3), true);
+  CHECK(adif.fetch(log));
+  CHECK_EQ(total(), 2);
+  CHECK_EQ(worked->need(291, k40m, SpotMode::SSB), SpotNeed::None);
+  CHECK_EQ(worked->need(291, k40m, SpotMode::CW), SpotNeed::NewMode);
+  CHECK(!adif.fetch(log));
+
+  // Lower-case tags and band; FREQ in MHz with no BAND; no DXCC, so the
+  // entity comes from the call.
+  writeFile(log,
+            "<call:5>VP8PJ<band:3>15M<mode:3>ft8<dxcc:3>240<eor>\n" +
+                field("CALL", "ZL1AA") + field("FREQ", "28.074000") +
+                field("MODE", "FT8") + field("DXCC", "170") + "<EOR>\n" +
+                qso("W6XYZ", "20m", "RTTY", ""),
+            true);
+  CHECK(adif.fetch(log));
+  CHECK_EQ(total(), 5);
+  CHECK_EQ(worked->need(240, k15m, SpotMode::FT8), SpotNeed::None);
+  CHECK_EQ(worked->need(170, k10m, SpotMode::FT4), SpotNeed::None);
+  CHECK_EQ(worked->need(170, k20m, SpotMode::FT8), SpotNeed::NewBand);
+  CHECK_EQ(worked->need(291, k20m, SpotMode::RTTY), SpotNeed::None);
+  CHECK_EQ(store->get().modeCounts["ft8"], 1);
+  CHECK_EQ(store->get().bandCounts.count("10m"), size_t{0});
+
+  // Rewritten shorter, e.g. after deleting QSOs: read again from scratch.
+  std::string first = kHeader + qso("G3ABC", "20m", "CW", "223");
+  writeFile(log, first, false);
+  CHECK(adif.fetch(log));
+  CHECK_EQ(total(), 1);
+  CHECK(!worked->worked(339));
+  CHECK(worked->worked(223));
+
+  // An append is read on from where it was.
+  writeFile(log, qso("DL1AB", "20m", "CW", "230"), true);
+  CHECK(adif.fetch(log));
+  CHECK_EQ(total(), 2);
+  CHECK(worked->worked(230));
+
+  // Rewritten longer with the same first record: the last QSO read was
+  // edited, so everything is read again rather than just the new bytes.
+  writeFile(log,
+            first + qso("F5ABC", "20m", "CW", "227") +
+                qso("EA1AB", "20m", "CW", "281"),
+            false);
+  CHECK(adif.fetch(log));
+  CHECK_EQ(total(), 3);
+  CHECK(!worked->worked(230));
+  CHECK(worked->worked(227));
+  CHECK(worked->worked(281));
+}
+
+} // namespace
+
+int main() {
+  auto dir = std::filesystem::temp_directory_path() / "hamclock-adif-test";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  Log::init(dir.string());
+  Log::get()->set_level(spdlog::level::warn);
+
+  matrix();
+  reader(dir);
+  return checkResult("test-adif-reader");
+}
@@ -0,0 +1,251 @@
+// BandActivityMatrix: the ring of counts, which buckets add() takes and how
+// advance() clears them, also while other threads add; then the detector
+// on a synthetic baseline, where one burst must give exactly one opening.
+
+#include "Check.h"
+
+#include "core/BandActivity.h"
+#include "core/LiveSpotData.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using M = BandActivityMatrix;
+constexpr int64_t kT0 = 1760000100; // inside a bucket, not at its start
+const int k20m = freqToBandIndex(14025);
+const int k15m = freqToBandIndex(21025);
+
+// Count of 'cell' in the bucket 'back' buckets before head.
+uint32_t countAt(const M &m, int cell, int back) {
+  std::vector<uint32_t> counts;
+  m.copyCounts(counts);
+  return counts[static_cast<size_t>(cell) * M::kHistory + M::kHistory - 1 -
+                back];
+}
+
+void ring() {
+  CHECK_EQ(M::cellOf(-1, Continent::EU, Continent::NA), -1);
+  CHECK_EQ(M::cellOf(k20m, Continent::Unknown, Continent::NA), -1);
+  CHECK_EQ(M::cellOf(M::kNumBandSlots - 1, Continent::AN, Continent::AN),
+           M::kCells - 1);
+  CHECK_EQ(M::bucketOf(-1), -1);
+  CHECK_EQ(M::bucketOf(M::kBucketSecs), 1);
+
+  M m(kT0);
+  int64_t h = m.head();
+  int64_t start = h * M::kBucketSecs;
+  int cell = M::cellOf(k20m, Continent::EU, Continent::NA);
+  auto add = [&](int64_t bucket, int n = 1) {
+    for (int i = 0; i < n; ++i)
+      m.add(k20m, Continent::EU, Continent::NA,
+            start + (bucket - h) * M::kBucketSecs);
+  };
+  add(h, 3);
+  add(h + 1);                    // the next bucket, for a fast clock
+  add(h - M::kAcceptBuckets, 2); // the oldest still taken
+  add(h + 2);
+  add(h - M::kAcceptBuckets - 1);
+  m.add(k20m, Continent::Unknown, Continent::NA, kT0);
+  CHECK_EQ(m.added(), uint64_t{6});
+  CHECK_EQ(m.ignored(), uint64_t{3});
+  CHECK_EQ(countAt(m, cell, 0), 3u);
+  CHECK_EQ(countAt(m, cell, M::kAcceptBuckets), 2u);
+
+  // Within the bucket: nothing moves.
+  m.advance(start + M::kBucketSecs - 1);
+  CHECK_EQ(m.head(), h);
+
+  // One bucket on: h + 1 is the head, and the slot h + 2 reuses was
+  // cleared. The oldest bucket taken shares its slot with h + 4.
+  m.advance(start + M::kBucketSecs);
+  CHECK_EQ(m.head(), h + 1);
+  CHECK_EQ(countAt(m, cell, 0), 1u);
+  CHECK_EQ(countAt(m, cell, 1), 3u);
+  add(h + 2);
+  add(h + 1 - M::kAcceptBuckets);
+  CHECK_EQ(countAt(m, cell, M::kAcceptBuckets), 1u);
+  m.advance(start + 2 * M::kBucketSecs);
+  CHECK_EQ(countAt(m, cell, 0), 1u);
+  CHECK_EQ(countAt(m, cell, 2), 3u);
+  // h + 3 and h + 4 start empty, not with the spots of h - 45 and h - 44.
+  m.advance(start + 3 * M::kBucketSecs);
+  CHECK_EQ(countAt(m, cell, 0), 0u);
+  m.advance(start + 4 * M::kBucketSecs);
+  CHECK_EQ(countAt(m, cell, 0), 0u);
+
+  // Ten buckets on keeps what is still in the window.
+  m.advance(start + 14 * M::kBucketSecs);
+  CHECK_EQ(m.head(), h + 14);
+  CHECK_EQ(countAt(m, cell, 14), 3u);
+  CHECK_EQ(countAt(m, cell, 13), 1u);
+  CHECK_EQ(countAt(m, cell, 12), 1u);
+  CHECK_EQ(countAt(m, cell, 10), 0u);
+  // A day on keeps nothing, and takes spots for the new time only.
+  m.advance(start + 300 * M::kBucketSecs);
+  CHECK_EQ(m.head(), h + 300);
+  std::vector<uint32_t> counts;
+  m.copyCounts(counts);
+  uint64_t sum = 0;
+  for (uint32_t n : counts)
+    sum += n;
+  CHECK_EQ(sum, uint64_t{0});
+  add(h + 12);
+  add(h + 300);
+  CHECK_EQ(countAt(m, cell, 0), 1u);
+}
+
+// While advance() moves several buckets at once, other threads keep adding
+// to the oldest buckets they see. None of those spots may turn up in the
+// buckets that were just cleared for reuse.
+void clearWhileAdding() {
+  constexpr int kSteps = 2000;
+  constexpr int kStep = 40;
+  M m(kT0);
+  int cell = M::cellOf(k15m, Continent::AS, Continent::EU);
+  std::atomic<bool> done{false};
+  std::vector<std::thread> adders;
+  for (int t = 0; t < 2; ++t) {
+    adders.emplace_back([&] {
+      while (!done.load(std::memory_order_relaxed)) {
+        int64_t oldest = m.head() - M::kAcceptBuckets;
+        m.add(k15m, Continent::AS, Continent::EU,
+              oldest * M::kBucketSecs);
+      }
+    });
+  }
+  int stale = 0;
+  int64_t now = kT0;
+  std::vector<uint32_t> counts;
+  for (int i = 0; i < kSteps; ++i) {
+    now += kStep * M::kBucketSecs;
+    m.advance(now);
+    // Buckets head - kStep + 2 .. head were cleared in this call; adders
+    // aiming at the oldest bucket never reach them.
+    m.copyCounts(counts);
+    for (int back = 0; back < kStep - 1; ++back)
+      stale += counts[static_cast<size_t>(cell) * M::kHistory +
+                      M::kHistory - 1 - back] != 0;
+  }
+  done = true;
+  for (auto &t : adders)
+    t.join();
+  std::printf("%d advances of %d buckets during %llu adds: %d stale "
+              "buckets\n",
+              kSteps, kStep, static_cast<unsigned long long>(m.added()),
+              stale);
+  CHECK_EQ(stale, 0);
+  CHECK(m.added() > 0);
+}
+
+// One cell with a steady 8 to 12 spots a bucket, every other cell quiet.
+class Sim {
+public:
+  Sim() : m_(kT0) {}
+
+  // Adds 'n' spots to 20m EU>NA and the steady load, then finishes the
+  // bucket. Returns the openings it started.
+  std::vector<BandOpening> bucket(uint32_t n) {
+    for (uint32_t i = 0; i < n; ++i)
+      m_.add(k20m, Continent::EU, Continent::NA, now_);
+    for (int i = 0; i < kSteady[step_ % 5]; ++i)
+      m_.add(k15m, Continent::AS, Continent::EU, now_);
+    step_++;
+    now_ += M::kBucketSecs;
+    std::vector<BandOpening> started;
+    m_.advance(now_, &started);
+    return started;
+  }
+  uint32_t steady() const { return kSteady[step_ % 5]; }
+  int64_t bucketStart() const {
+    return M::bucketOf(now_) * M::kBucketSecs;
+  }
+  const M &matrix() const { return m_; }
+
+private:
+  static constexpr int kSteady[5] = {9, 11, 10, 12, 8};
+  M m_;
+  int64_t now_ = kT0;
+  int step_ = 0;
+};
+
+void detector() {
+  Sim sim;
+  size_t fired = 0;
+  // Warm-up: a burst in the first hour is no opening, whatever its size.
+  for (int i = 0; i < M::kWarmupBuckets; ++i)
+    fired += sim.bucket(i == 3 || i == 4 ? 60 : sim.steady()).size();
+  CHECK_EQ(fired, size_t{0});
+  for (int i = 0; i < 60; ++i)
+    fired += sim.bucket(sim.steady()).size();
+  CHECK_EQ(fired, size_t{0});
+  CHECK(sim.matrix().openings().empty());
+
+  // A single busy bucket is not enough either.
+  fired += sim.bucket(40).size();
+  fired += sim.bucket(10).size();
+  CHECK_EQ(fired, size_t{0});
+  for (int i = 0; i < 4; ++i)
+    fired += sim.bucket(sim.steady()).size();
+
+  // The burst: opens once, on the bucket that confirms it.
+  int64_t burstStart = sim.bucketStart();
+  fired += sim.bucket(40).size();
+  CHECK_EQ(fired, size_t{0});
+  std::vector<BandOpening> started = sim.bucket(30);
+  CHECK_EQ(started.size(), size_t{1});
+  if (!started.empty()) {
+    const BandOpening &o = started[0];
+    CHECK_EQ(o.band, k20m);
+    CHECK(o.from == Continent::EU);
+    CHECK(o.to == Continent::NA);
+    CHECK_EQ(o.since, burstStart);
+    CHECK_EQ(o.count, 30u);
+    CHECK(o.baseline > 8 && o.baseline < 12);
+    CHECK(o.z >= M::kConfirmZ);
+  }
+  // Still open while busy, without starting again; closes after
+  // kCloseBuckets quiet ones.
+  for (int i = 0; i < 3; ++i)
+    CHECK(sim.bucket(35).empty());
+  CHECK_EQ(sim.matrix().openings().size(), size_t{1});
+  CHECK(sim.bucket(sim.steady()).empty());
+  CHECK_EQ(sim.matrix().openings().size(), size_t{1});
+  CHECK(sim.bucket(sim.steady()).empty());
+  CHECK(sim.matrix().openings().empty());
+
+  // The baseline was frozen while open, so the next burst opens as well.
+  for (int i = 0; i < 4; ++i)
+    CHECK(sim.bucket(sim.steady()).empty());
+  CHECK(sim.bucket(45).empty());
+  CHECK_EQ(sim.bucket(35).size(), size_t{1});
+}
+
+// A few spots on a cell that is usually empty are not an opening.
+void quietCell() {
+  M m(kT0);
+  int64_t now = kT0;
+  int fired = 0;
+  for (int i = 0; i < 40; ++i) {
+    uint32_t n = i >= 30 ? 3 : 0;
+    for (uint32_t k = 0; k < n; ++k)
+      m.add(k20m, Continent::OC, Continent::SA, now);
+    now += M::kBucketSecs;
+    std::vector<BandOpening> started;
+    m.advance(now, &started);
+    fired += static_cast<int>(started.size());
+  }
+  CHECK_EQ(fired, 0);
+}
+
+} // namespace
+
+int main() {
+  ring();
+  clearWhileAdding();
+  detector();
+  quietCell();
+  return checkResult("test-band-activity");
+}
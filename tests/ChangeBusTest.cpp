@@ -0,0 +1,99 @@
+// ChangeBus delivery: stores that share a topic, coalescing between
+// frames, and publishes racing in from other threads.
+
+#include "Check.h"
+
+#include "core/ChangeBus.h"
+#include "core/WeatherData.h"
+
+#include <thread>
+#include <vector>
+
+namespace {
+
+// DE and DX weather publish on the same topic with their own, unrelated
+// store versions. Every publish of either must reach the subscriber.
+void sharedTopic() {
+  auto &bus = ChangeBus::instance();
+  bus.dispatch();
+  WeatherStore de, dx;
+  int delivered = 0;
+  auto sub = bus.subscribe(ChangeBus::Topic::Weather,
+                           [&](ChangeBus::Topic, uint64_t) { delivered++; });
+
+  for (int i = 0; i < 5; ++i) {
+    de.update(WeatherData{});
+    bus.dispatch();
+  }
+  CHECK_EQ(delivered, 5);
+  CHECK(de.version() > dx.version());
+
+  // dx is now far behind de; its publish must still count.
+  dx.update(WeatherData{});
+  CHECK(bus.dispatch());
+  CHECK_EQ(delivered, 6);
+
+  // Nothing new: nothing delivered.
+  CHECK(!bus.dispatch());
+  CHECK_EQ(delivered, 6);
+}
+
+// Many publishes between two frames make one callback.
+void coalescing() {
+  auto &bus = ChangeBus::instance();
+  bus.dispatch();
+  WeatherStore store;
+  int delivered = 0;
+  uint64_t seen = 0;
+  auto sub = bus.subscribe(ChangeBus::Topic::Weather,
+                           [&](ChangeBus::Topic, uint64_t v) {
+                             delivered++;
+                             seen = v;
+                           });
+  uint64_t before = bus.version(ChangeBus::Topic::Weather);
+  for (int i = 0; i < 10; ++i)
+    store.update(WeatherData{});
+  bus.dispatch();
+  CHECK_EQ(delivered, 1);
+  CHECK_EQ(seen, before + 10);
+}
+
+// Publishes from many threads while the main thread dispatches: the topic
+// counts every one and the last dispatch sees the final number.
+void concurrentPublish() {
+  constexpr int kThreads = 4;
+  constexpr int kEach = 20000;
+  auto &bus = ChangeBus::instance();
+  bus.dispatch();
+  uint64_t before = bus.version(ChangeBus::Topic::Weather);
+  uint64_t last = 0;
+  auto sub = bus.subscribe(ChangeBus::Topic::Weather,
+                           [&](ChangeBus::Topic, uint64_t v) { last = v; });
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t)
+    threads.emplace_back([&] {
+      for (int i = 0; i < kEach; ++i)
+        bus.publish(ChangeBus::Topic::Weather);
+    });
+  int frames = 0;
+  while (bus.version(ChangeBus::Topic::Weather) <
+         before + static_cast<uint64_t>(kThreads) * kEach) {
+    bus.dispatch();
+    frames++;
+  }
+  for (auto &t : threads)
+    t.join();
+  bus.dispatch();
+  CHECK_EQ(last, before + static_cast<uint64_t>(kThreads) * kEach);
+  CHECK(frames > 0);
+}
+
+} // namespace
+
+int main() {
+  sharedTopic();
+  coalescing();
+  concurrentPublish();
+  return checkResult("test-change-bus");
+}
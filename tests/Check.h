@@ -0,0 +1,56 @@
+#pragma once
+
+// Minimal checks for the test programs. A failed CHECK prints where and
+// what, and the program carries on so one run shows every broken case;
+// main() returns checkResult() so ctest sees the outcome.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+inline int g_checks = 0;
+inline int g_failures = 0;
+
+#define CHECK(cond)                                                            \
+  do {                                                                         \
+    ++g_checks;                                                                \
+    if (!(cond)) {                                                             \
+      ++g_failures;                                                            \
+      std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__,   \
+                   #cond);                                                     \
+    }                                                                          \
+  } while (0)
+
+// As CHECK, with the two values printed when they differ.
+#define CHECK_EQ(a, b)                                                         \
+  do {                                                                         \
+    ++g_checks;                                                                \
+    auto check_a_ = (a);                                                       \
+    auto check_b_ = (b);                                                       \
+    if (!(check_a_ == check_b_)) {                                             \
+      ++g_failures;                                                            \
+      std::fprintf(stderr, "%s:%d: CHECK failed: %s == %s (%lld vs %lld)\n",  \
+                   __FILE__, __LINE__, #a, #b,                                 \
+                   static_cast<long long>(check_a_),                           \
+                   static_cast<long long>(check_b_));                          \
+    }                                                                          \
+  } while (0)
+
+inline int checkResult(const char *name) {
+  std::printf("%s: %d checks, %d failed\n", name, g_checks, g_failures);
+  return g_failures == 0 ? 0 : 1;
+}
+
+// True if argv has "--bench": the benchmarks run only when asked, so the
+// default ctest run stays quick.
+inline bool wantBench(int argc, char **argv) {
+  for (int i = 1; i < argc; ++i)
+    if (std::strcmp(argv[i], "--bench") == 0)
+      return true;
+  return false;
+}
+
+inline double secondsSince(std::chrono::steady_clock::time_point t0) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0)
+      .count();
+}
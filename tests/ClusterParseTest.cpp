@@ -0,0 +1,340 @@
+// parseSpotLine() and LineSplitter: every case of tests/data/
+// cluster-lines.txt, a fuzz loop of mutated and random lines that must
+// never crash or hand back views outside the line, and the splitter
+// reassembling a stream cut at random. --bench prints lines per second for
+// split + parse in 1 KB recv()-sized chunks, next to the find/erase and
+// sscanf path the parser replaced.
+//
+//   test-cluster-parse            corpus, 300k fuzz iterations, splitter
+//   test-cluster-parse --bench    also 3M fuzz iterations and lines/s
+
+#include "Check.h"
+
+#include "services/DXClusterParser.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifndef TEST_DATA_DIR
+#define TEST_DATA_DIR "tests/data"
+#endif
+
+namespace {
+
+struct Case {
+  int lineNo = 0;
+  bool ok = false;
+  std::string spotter, freq, dx, hhmm, mode, snr, locator, comment;
+  std::string line;
+};
+
+std::vector<std::string> splitTabs(const std::string &s) {
+  std::vector<std::string> out;
+  size_t start = 0;
+  for (;;) {
+    size_t tab = s.find('\t', start);
+    out.push_back(s.substr(start, tab - start));
+    if (tab == std::string::npos)
+      return out;
+    start = tab + 1;
+  }
+}
+
+std::string unescape(const std::string &s) {
+  std::string out;
+  for (size_t i = 0; i < s.size(); ++i) {
+    bool escape = s[i] == '\\' && i + 1 < s.size() &&
+                  (s[i + 1] == 'a' || s[i + 1] == 'r');
+    if (escape)
+      out += s[++i] == 'a' ? '\a' : '\r';
+    else
+      out += s[i];
+  }
+  return out;
+}
+
+std::vector<Case> loadCorpus() {
+  std::vector<Case> cases;
+  std::ifstream in(TEST_DATA_DIR "/cluster-lines.txt");
+  if (!in) {
+    std::fprintf(stderr, "cannot read %s/cluster-lines.txt\n", TEST_DATA_DIR);
+    return cases;
+  }
+  std::string text;
+  for (int n = 1; std::getline(in, text); ++n) {
+    if (text.empty() || text[0] == '#')
+      continue;
+    auto f = splitTabs(text);
+    Case c;
+    c.lineNo = n;
+    if (f.size() == 10 && f[0] == "ok") {
+      c.ok = true;
+      c.spotter = f[1];
+      c.freq = f[2];
+      c.dx = f[3];
+      c.hhmm = f[4];
+      c.mode = f[5];
+      c.snr = f[6];
+      c.locator = f[7];
+      c.comment = f[8];
+      c.line = unescape(f[9]);
+    } else if (f.size() == 2 && f[0] == "reject") {
+      c.line = unescape(f[1]);
+    } else {
+      std::fprintf(stderr, "cluster-lines.txt:%d: bad case\n", n);
+      ++g_failures;
+      continue;
+    }
+    cases.push_back(std::move(c));
+  }
+  return cases;
+}
+
+std::string orDash(std::string_view v) {
+  return v.empty() ? "-" : std::string(v);
+}
+
+void corpus(const std::vector<Case> &cases) {
+  CHECK(cases.size() >= 30);
+  for (const auto &c : cases) {
+    ParsedSpotLine p;
+    bool parsed = parseSpotLine(c.line, p);
+    if (parsed != c.ok) {
+      ++g_failures;
+      std::fprintf(stderr, "cluster-lines.txt:%d: %s\n", c.lineNo,
+                   c.ok ? "not parsed" : "parsed, should be rejected");
+      continue;
+    }
+    ++g_checks;
+    if (!c.ok)
+      continue;
+    char freq[32], hhmm[16];
+    std::snprintf(freq, sizeof(freq), "%.1f", p.freqKhz);
+    std::snprintf(hhmm, sizeof(hhmm), "%04d", p.hhmm);
+    std::string got[] = {orDash(p.spotter),
+                         freq,
+                         orDash(p.dxCall),
+                         p.hhmm < 0 ? "-" : hhmm,
+                         orDash(p.mode),
+                         p.hasSnr ? std::to_string(p.snr) : "-",
+                         orDash(p.locator),
+                         orDash(p.comment)};
+    const std::string *want[] = {&c.spotter, &c.freq, &c.dx,      &c.hhmm,
+                                 &c.mode,    &c.snr,  &c.locator, &c.comment};
+    static const char *kNames[] = {"spotter", "kHz", "dx",      "hhmm",
+                                   "mode",    "snr", "locator", "comment"};
+    for (int i = 0; i < 8; ++i) {
+      ++g_checks;
+      if (got[i] != *want[i]) {
+        ++g_failures;
+        std::fprintf(stderr, "cluster-lines.txt:%d: %s is '%s', want '%s'\n",
+                     c.lineNo, kNames[i], got[i].c_str(), want[i]->c_str());
+      }
+    }
+  }
+}
+
+// Mutates corpus lines (byte deletes, inserts, overwrites) and throws in
+// random garbage. Nothing may crash, and a parsed line's views must lie
+// inside it.
+void fuzz(const std::vector<Case> &cases, int iterations) {
+  std::vector<std::string> seeds;
+  for (const auto &c : cases)
+    seeds.push_back(c.line);
+  if (seeds.empty())
+    return;
+  std::mt19937 rng(1);
+  int parsed = 0, bad = 0;
+  ParsedSpotLine p;
+  for (int it = 0; it < iterations; ++it) {
+    std::string s = seeds[rng() % seeds.size()];
+    int muts = rng() % 6;
+    for (int m = 0; m < muts; ++m) {
+      size_t pos = rng() % (s.size() + 1);
+      switch (rng() % 3) {
+      case 0:
+        if (!s.empty())
+          s.erase(pos % s.size(), 1);
+        break;
+      case 1:
+        s.insert(pos, 1, static_cast<char>(rng() % 256));
+        break;
+      default:
+        if (!s.empty())
+          s[pos % s.size()] = static_cast<char>(rng() % 256);
+      }
+    }
+    if (rng() % 10 == 0) {
+      s.resize(rng() % 100);
+      for (auto &c : s)
+        c = static_cast<char>(rng() % 256);
+    }
+    if (!parseSpotLine(s, p))
+      continue;
+    parsed++;
+    auto inside = [&](std::string_view v) {
+      return v.empty() || (v.data() >= s.data() &&
+                           v.data() + v.size() <= s.data() + s.size());
+    };
+    if (!inside(p.spotter) || !inside(p.dxCall) || !inside(p.comment) ||
+        !inside(p.mode) || !inside(p.locator) || p.dxCall.empty() ||
+        p.spotter.empty() || p.hhmm >= 2400 || !(p.freqKhz > 0) ||
+        !std::isfinite(p.freqKhz))
+      bad++;
+  }
+  CHECK_EQ(bad, 0);
+  CHECK(parsed > 0);
+}
+
+// Feeds 'stream' to a splitter in chunks of 1..maxChunk bytes.
+std::vector<std::string> split(const std::string &stream, size_t maxChunk,
+                               std::mt19937 &rng) {
+  std::vector<std::string> lines;
+  LineSplitter ls;
+  size_t off = 0;
+  while (off < stream.size()) {
+    char *w = ls.writable();
+    size_t n = std::min<size_t>(
+        {ls.writableSize(), stream.size() - off, 1 + rng() % maxChunk});
+    std::memcpy(w, stream.data() + off, n);
+    ls.commit(n);
+    off += n;
+    std::string_view l;
+    while (ls.next(l))
+      lines.emplace_back(l);
+  }
+  return lines;
+}
+
+void splitter() {
+  std::mt19937 rng(2);
+  std::string stream;
+  std::vector<std::string> expect;
+  for (int i = 0; i < 50000; ++i) {
+    std::string l = "DX de K" + std::to_string(i) + ": 14025.0 X" +
+                    std::to_string(i) + " cq 1200Z";
+    stream += l + ((i % 3) ? "\r\n" : "\n");
+    expect.push_back(std::move(l));
+  }
+  for (size_t maxChunk : {7, 1500, 3000})
+    CHECK(split(stream, maxChunk, rng) == expect);
+
+  // A line longer than the buffer is dropped, and the next one still
+  // comes through.
+  LineSplitter ls;
+  std::string junk(3 * LineSplitter::kCapacity, 'x');
+  size_t off = 0;
+  std::string_view l;
+  bool early = false;
+  while (off < junk.size()) {
+    char *w = ls.writable();
+    size_t n = std::min(ls.writableSize(), junk.size() - off);
+    std::memcpy(w, junk.data() + off, n);
+    ls.commit(n);
+    off += n;
+    early = early || ls.next(l);
+  }
+  CHECK(!early);
+  const char tail[] = "\nDX de A: 1.0 B\n";
+  std::memcpy(ls.writable(), tail, sizeof(tail) - 1);
+  ls.commit(sizeof(tail) - 1);
+  bool found = false;
+  while (ls.next(l))
+    found = found || l == "DX de A: 1.0 B";
+  CHECK(found);
+
+  // The login prompt never ends in a newline.
+  LineSplitter prompt;
+  std::memcpy(prompt.writable(), "login: ", 7);
+  prompt.commit(7);
+  CHECK(!prompt.next(l));
+  CHECK(prompt.pending() == "login: ");
+}
+
+// The pre-LineSplitter path: append to a string, find/erase each line,
+// sscanf the fields into temporaries.
+size_t oldPath(const std::string &big) {
+  size_t ok = 0;
+  std::string buffer;
+  for (size_t off = 0; off < big.size();) {
+    size_t n = std::min<size_t>(1024, big.size() - off);
+    buffer.append(big.data() + off, n);
+    off += n;
+    size_t pos;
+    while ((pos = buffer.find('\n')) != std::string::npos) {
+      std::string line = buffer.substr(0, pos);
+      buffer.erase(0, pos + 1);
+      while (!line.empty() && line.back() == '\r')
+        line.pop_back();
+      const char *d = std::strstr(line.c_str(), "DX de ");
+      char rx[32], tx[32];
+      float f;
+      if (d && std::sscanf(d, "DX de %31[^ :]: %f %31s", rx, &f, tx) == 3) {
+        std::string a = rx, b = tx;
+        int hr, mn;
+        if (line.length() >= 75 && line[74] == 'Z')
+          std::sscanf(line.c_str() + 70, "%2d%2d", &hr, &mn);
+        ok++;
+      }
+    }
+  }
+  return ok;
+}
+
+size_t newPath(const std::string &big) {
+  size_t ok = 0;
+  LineSplitter ls;
+  ParsedSpotLine p;
+  for (size_t off = 0; off < big.size();) {
+    char *w = ls.writable();
+    size_t n =
+        std::min<size_t>({ls.writableSize(), size_t{1024}, big.size() - off});
+    std::memcpy(w, big.data() + off, n);
+    ls.commit(n);
+    off += n;
+    std::string_view l;
+    while (ls.next(l))
+      ok += parseSpotLine(l, p);
+  }
+  return ok;
+}
+
+void bench(const std::vector<Case> &cases) {
+  std::vector<const std::string *> lines;
+  for (const auto &c : cases)
+    if (c.ok)
+      lines.push_back(&c.line);
+  std::string big;
+  const size_t kLines = 500000;
+  for (size_t i = 0; i < kLines; ++i)
+    big += *lines[i % lines.size()] + "\r\n";
+
+  for (int pass = 0; pass < 2; ++pass) {
+    auto t0 = std::chrono::steady_clock::now();
+    size_t ok = pass == 0 ? newPath(big) : oldPath(big);
+    double secs = secondsSince(t0);
+    std::printf("%-28s %6.2f M lines/s (%zu of %zu parsed)\n",
+                pass == 0 ? "LineSplitter + parseSpotLine"
+                          : "find/erase + sscanf (old)",
+                kLines / secs / 1e6, ok, kLines);
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  bool benchmarks = wantBench(argc, argv);
+  auto cases = loadCorpus();
+  corpus(cases);
+  fuzz(cases, benchmarks ? 3000000 : 300000);
+  splitter();
+  if (benchmarks)
+    bench(cases);
+  return checkResult("test-cluster-parse");
+}
@@ -0,0 +1,241 @@
+// DXClusterProvider against a stand-in telnet node that misbehaves the way
+// real ones do. The first session is reset by the node while the client is
+// still answering its login prompts, which raises SIGPIPE in a process that
+// writes without MSG_NOSIGNAL; the second is closed as soon as it is
+// accepted; the third waits before the prompt. The client must survive all
+// three, space its reconnects by the backoff (2-5 s, then 5-10 s), log in on
+// the slow one and ingest the spot it sends.
+//
+// Takes 10-20 s: the delays are the real ones.
+
+#include "Check.h"
+
+#include "core/DXClusterData.h"
+#include "core/DatabaseManager.h"
+#include "core/Logger.h"
+#include "core/PrefixManager.h"
+#include "core/SpotEnricher.h"
+#include "core/WorkerPool.h"
+#include "services/DXClusterProvider.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <filesystem>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr const char *kLogin = "K1TEST";
+// No time, so it is stamped on arrival and never too old to keep.
+constexpr const char *kSpot = "DX de W1AW:   14025.0  JA1ZZZ   cq up 5\r\n";
+
+enum class Step { Reset, Drop, Slow };
+constexpr Step kScript[] = {Step::Reset, Step::Drop, Step::Slow};
+
+// Reads one line, without its CR LF; false on close or receive timeout.
+bool readLine(int fd, std::string &line) {
+  line.clear();
+  char c;
+  while (recv(fd, &c, 1, 0) == 1) {
+    if (c == '\n')
+      return true;
+    if (c != '\r')
+      line += c;
+  }
+  return false;
+}
+
+void sendText(int fd, const std::string &text) {
+  send(fd, text.data(), text.size(), MSG_NOSIGNAL);
+}
+
+class StandIn {
+public:
+  bool listen() {
+    fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t len = sizeof(addr);
+    if (fd_ < 0 ||
+        bind(fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0 ||
+        ::listen(fd_, 4) < 0 ||
+        getsockname(fd_, reinterpret_cast<sockaddr *>(&addr), &len) < 0)
+      return false;
+    port_ = ntohs(addr.sin_port);
+    thread_ = std::thread(&StandIn::run, this);
+    return true;
+  }
+
+  void stop() {
+    shutdown(fd_, SHUT_RDWR);
+    close(fd_);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (session_ >= 0)
+      shutdown(session_, SHUT_RDWR);
+  }
+
+  void join() {
+    if (thread_.joinable())
+      thread_.join();
+  }
+
+  int port() const { return port_; }
+
+  // When each scripted connection was accepted, and the lines the client
+  // sent on the slow one.
+  std::vector<Clock::time_point> accepted;
+  std::vector<std::string> slowLines;
+
+private:
+  void run() {
+    for (Step step : kScript) {
+      int c = accept(fd_, nullptr, nullptr);
+      if (c < 0)
+        return;
+      accepted.push_back(Clock::now());
+      switch (step) {
+      case Step::Reset: {
+        // Once the client is in its read loop: prompts, then RST. It reads
+        // them after the reset and answers each one into a dead socket.
+        std::string line;
+        readLine(c, line);
+        sendText(c, "login: \r\nlogin: \r\nlogin: \r\nlogin: \r\n");
+        linger hard{1, 0};
+        setsockopt(c, SOL_SOCKET, SO_LINGER, &hard, sizeof(hard));
+        close(c);
+        break;
+      }
+      case Step::Drop:
+        close(c);
+        break;
+      case Step::Slow:
+        slow(c);
+        break;
+      }
+    }
+  }
+
+  void slow(int c) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      session_ = c;
+    }
+    timeval tv{5, 0};
+    setsockopt(c, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+    sendText(c, "login: ");
+    std::string line;
+    bool greeted = false;
+    while (readLine(c, line)) {
+      slowLines.push_back(line);
+      if (line == kLogin && !greeted) {
+        sendText(c, std::string("Hello ") + kLogin + "\r\n" + kLogin +
+                        " de SIM-2 >\r\n");
+        greeted = true;
+      } else if (line.rfind("sh/dx", 0) == 0) {
+        sendText(c, kSpot);
+      }
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    close(c);
+    session_ = -1;
+  }
+
+  int fd_ = -1;
+  int port_ = 0;
+  std::thread thread_;
+  std::mutex mutex_;
+  int session_ = -1;
+};
+
+double secondsBetween(Clock::time_point a, Clock::time_point b) {
+  return std::chrono::duration<double>(b - a).count();
+}
+
+bool hasSpot(const DXClusterDataStore &store) {
+  auto snap = store.snapshot();
+  for (DXSpotRef s : snap->spots)
+    if (s.txCall() == "JA1ZZZ" && s.rxCall() == "W1AW")
+      return true;
+  return false;
+}
+
+void reconnects() {
+  StandIn node;
+  if (!node.listen()) {
+    std::perror("listen");
+    CHECK(false);
+    return;
+  }
+
+  PrefixManager prefixes;
+  auto store = std::make_shared<DXClusterDataStore>();
+  auto enricher = std::make_shared<SpotEnricher>(prefixes, 41.7, -72.7);
+  DXClusterProvider provider(store, enricher);
+  AppConfig cfg;
+  cfg.dxClusterHost = "127.0.0.1";
+  cfg.dxClusterPort = node.port();
+  cfg.dxClusterLogin = kLogin;
+  provider.start(cfg);
+
+  auto start = Clock::now();
+  while (!hasSpot(*store) && secondsSince(start) < 25)
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  CHECK(hasSpot(*store));
+
+  auto stopping = Clock::now();
+  provider.stop();
+  // The retry sleep and the session loop both look at the stop flag.
+  CHECK(secondsSince(stopping) < 2);
+  node.stop();
+  node.join();
+
+  CHECK_EQ(node.accepted.size(), std::size(kScript));
+  if (node.accepted.size() == std::size(kScript)) {
+    double first = secondsBetween(node.accepted[0], node.accepted[1]);
+    double second = secondsBetween(node.accepted[1], node.accepted[2]);
+    std::printf("reconnected after %.1f s, then %.1f s\n", first, second);
+    // kRetryMin with jitter over its upper half, then twice that; a little
+    // slack for the 250 ms sleep steps and the connect itself.
+    CHECK(first >= 1.9 && first <= 5.6);
+    CHECK(second >= 4.9 && second <= 10.6);
+  }
+  bool loggedIn = false, requested = false;
+  for (const auto &l : node.slowLines) {
+    loggedIn = loggedIn || l == kLogin;
+    requested = requested || (loggedIn && l == "sh/dx 30");
+  }
+  CHECK(loggedIn);
+  CHECK(requested);
+}
+
+} // namespace
+
+int main() {
+  auto dir = std::filesystem::temp_directory_path() / "hamclock-reconnect";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  Log::init(dir.string());
+  Log::get()->set_level(spdlog::level::warn);
+  if (!DatabaseManager::instance().init(dir / "test.db")) {
+    std::fprintf(stderr, "cannot open %s\n", (dir / "test.db").c_str());
+    return 1;
+  }
+
+  // SIGPIPE keeps its default action: a send into the reset session would
+  // end the test here.
+  reconnects();
+  WorkerPool::instance().shutdown();
+  return checkResult("test-cluster-reconnect");
+}
@@ -0,0 +1,494 @@
+// N1mm: every datagram the provider reads (contactinfo, contactreplace,
+// contactdelete, RadioInfo, spot and dynamicresults) built with Writer the
+// way the replay tool builds them and read back by parse(); the same
+// datagrams applied to a ContestLogStore the way DXClusterProvider applies
+// them, for the QSO count, the 10- and 60-minute rates, edits and deletes
+// by id and repeated broadcasts; and documents that are not XML, from a
+// mismatched end tag to every truncation of a contactinfo.
+
+#include "Check.h"
+
+#include "core/ContestLogData.h"
+#include "services/N1MMProtocol.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace N1mm;
+
+constexpr int64_t kStamp = 1760000123; // 2025-10-09 08:55:23 UTC
+constexpr int64_t kNow = 1760000400;
+
+bool parsed(const std::string &d, Message &m) {
+  m = Message();
+  return parse(d.data(), d.size(), m);
+}
+
+std::string contact(std::string_view root, std::string_view id,
+                    std::string_view call, int64_t rxfreq) {
+  return Writer(root)
+      .field("app", "N1MM")
+      .field("contestname", "CQ-WW-CW")
+      .field("contestnr", 7)
+      .field("timestamp", "2025-10-09 08:55:23")
+      .field("mycall", "K1TEST")
+      .field("band", "14")
+      .field("rxfreq", rxfreq)
+      .field("txfreq", rxfreq)
+      .field("operator", "W1OP")
+      .field("mode", "CW")
+      .field("call", call)
+      .field("snt", "599")
+      .field("sntnr", 5)
+      .field("rcv", "599")
+      .field("rcvnr", 25)
+      .field("points", 3)
+      .field("StationName", "RUN1")
+      .field("ID", id)
+      .field("IsClaimedQso", "True")
+      .data();
+}
+
+std::string radio(std::string_view station, int radioNr, int64_t freq,
+                  std::string_view running) {
+  return Writer("RadioInfo")
+      .field("app", "N1MM")
+      .field("StationName", station)
+      .field("RadioNr", radioNr)
+      .field("Freq", freq)
+      .field("TXFreq", freq + 100)
+      .field("Mode", "CW")
+      .field("OpCall", "W1OP")
+      .field("IsRunning", running)
+      .field("FocusRadioNr", 1)
+      .field("IsStereo", "False")
+      .field("IsSplit", "False")
+      .field("ActiveRadioNr", 1)
+      .field("IsTransmitting", "False")
+      .field("FunctionKeyCaption", "")
+      .field("RadioName", "K3")
+      .field("AuxAntSelected", -1)
+      .field("AuxAntSelectedName", "")
+      .field("IsConnected", "True")
+      .data();
+}
+
+std::string spot(std::string_view action) {
+  return Writer("spot")
+      .field("app", "N1MM")
+      .field("StationName", "RUN1")
+      .field("dxcall", "JA1ZZZ")
+      .field("frequency", "14025.3")
+      .field("spottercall", "W3LPL")
+      .field("comment", "cq up 5 & <loud>")
+      .field("action", action)
+      .field("mode", "CW")
+      .field("status", "")
+      .field("timestamp", "2025-10-09 08:55:23")
+      .data();
+}
+
+std::string score() {
+  return Writer("dynamicresults")
+      .field("app", "N1MM")
+      .field("contest", "CQ-WW-CW")
+      .field("call", "K1TEST")
+      .field("ops", "K1TEST W1OP")
+      .raw("\t<class power=\"HIGH\" assisted=\"ASSISTED\" "
+           "transmitter=\"ONE\" ops=\"MULTI\" bands=\"ALL\" mode=\"CW\"/>\r\n"
+           "\t<breakdown>\r\n"
+           "\t\t<qso band=\"total\" mode=\"ALL\">312</qso>\r\n"
+           "\t\t<point band=\"total\" mode=\"ALL\">901</point>\r\n"
+           "\t\t<zone band=\"total\" mode=\"ALL\">58</zone>\r\n"
+           "\t\t<country band=\"total\" mode=\"ALL\">121</country>\r\n"
+           "\t\t<qso band=\"14\" mode=\"CW\">140</qso>\r\n"
+           "\t\t<country band=\"total\" mode=\"CW\">99</country>\r\n"
+           "\t</breakdown>\r\n")
+      .field("score", 161273)
+      .field("timestamp", "2025-10-09 08:55:23")
+      .data();
+}
+
+void contacts() {
+  Message m;
+  CHECK(parsed(contact("contactinfo", "a1b2c3", "JA1ZZZ", 1402530), m));
+  CHECK(m.type == Type::Contact);
+  CHECK(m.root == "contactinfo");
+  const Contact &c = m.contact;
+  CHECK(c.id == "a1b2c3");
+  CHECK_EQ(c.time, kStamp);
+  CHECK(c.call == "JA1ZZZ");
+  CHECK(c.band == "14");
+  CHECK(c.rxKhz == 14025.3);
+  CHECK(c.txKhz == 14025.3);
+  CHECK(c.mode == "CW");
+  CHECK(c.contest == "CQ-WW-CW");
+  CHECK(c.myCall == "K1TEST");
+  CHECK(c.operatorCall == "W1OP");
+  CHECK(c.stationName == "RUN1");
+  CHECK_EQ(c.points, 3);
+
+  CHECK(parsed(contact("contactreplace", "a1b2c3", "JA1ZZY", 1402530), m));
+  CHECK(m.type == Type::ContactReplace);
+  CHECK(m.contact.id == "a1b2c3");
+  CHECK(m.contact.call == "JA1ZZY");
+
+  // A delete carries the whole QSO too; only the id matters.
+  CHECK(parsed(contact("contactdelete", "a1b2c3", "JA1ZZY", 1402530), m));
+  CHECK(m.type == Type::ContactDelete);
+  CHECK(m.contact.id == "a1b2c3");
+
+  // Other loggers spell the names their own way.
+  std::string odd = "<ContactInfo><CALL>DL1ABC</CALL><Id>x</Id>"
+                    "<RxFreq>705000</RxFreq></ContactInfo>";
+  CHECK(parsed(odd, m));
+  CHECK(m.type == Type::Contact);
+  CHECK(m.contact.call == "DL1ABC");
+  CHECK(m.contact.id == "x");
+  CHECK(m.contact.rxKhz == 7050.0);
+}
+
+void radios() {
+  Message m;
+  CHECK(parsed(radio("RUN1", 2, 2102500, "True"), m));
+  CHECK(m.type == Type::Radio);
+  const Radio &r = m.radio;
+  CHECK(r.stationName == "RUN1");
+  CHECK_EQ(r.radioNr, 2);
+  CHECK(r.rxKhz == 21025.0);
+  CHECK(r.txKhz == 21026.0);
+  CHECK(r.mode == "CW");
+  CHECK(r.opCall == "W1OP");
+  CHECK(r.radioName == "K3");
+  CHECK(r.running);
+  CHECK(!r.transmitting);
+  CHECK(r.connected);
+
+  CHECK(parsed(radio("RUN1", 2, 2102500, "False"), m));
+  CHECK(!m.radio.running);
+}
+
+void spots() {
+  Message m;
+  CHECK(parsed(spot("add"), m));
+  CHECK(m.type == Type::Spot);
+  const Spot &s = m.spot;
+  CHECK(s.dxCall == "JA1ZZZ");
+  CHECK(s.freqKhz == 14025.3); // in kHz, unlike the other messages
+  CHECK(s.spotter == "W3LPL");
+  CHECK(s.comment == "cq up 5 & <loud>");
+  CHECK(s.mode == "CW");
+  CHECK(s.stationName == "RUN1");
+  CHECK(!s.remove);
+
+  CHECK(parsed(spot("delete"), m));
+  CHECK(m.spot.remove);
+
+  std::string escaped = "<spot><dxcall>K1ABC</dxcall>"
+                        "<comment>&#x41;&#66;&quot;&apos;&amp;amp;</comment>"
+                        "<action><![CDATA[delete]]></action></spot>";
+  CHECK(parsed(escaped, m));
+  CHECK(m.spot.comment == "AB\"'&amp;");
+  CHECK(m.spot.remove);
+}
+
+void scores() {
+  Message m;
+  CHECK(parsed(score(), m));
+  CHECK(m.type == Type::Score);
+  const Score &s = m.score;
+  CHECK(s.contest == "CQ-WW-CW");
+  CHECK(s.call == "K1TEST");
+  CHECK_EQ(s.score, int64_t{161273});
+  // Only the all-band, all-mode totals; zones and countries are the mults.
+  CHECK_EQ(s.qsos, 312);
+  CHECK_EQ(s.points, 901);
+  CHECK_EQ(s.mults, 58 + 121);
+}
+
+void others() {
+  Message m;
+  std::string info = Writer("AppInfo")
+                         .field("app", "N1MM")
+                         .field("dbname", "contest.s3db")
+                         .field("contestname", "CQ-WW-CW")
+                         .data();
+  CHECK(parsed(info, m));
+  CHECK(m.type == Type::Unknown);
+  CHECK(m.root == "AppInfo");
+
+  std::string bom = "\xEF\xBB\xBF" + contact("contactinfo", "b", "K1ABC", 0);
+  CHECK(parsed(bom, m));
+  CHECK(m.contact.call == "K1ABC");
+
+  auto is = [](std::string_view s) { return isMessage(s.data(), s.size()); };
+  CHECK(is(info));
+  CHECK(is(bom));
+  CHECK(is("  <contactinfo><call>K1ABC</call></contactinfo>"));
+  CHECK(is("<spot/>"));
+  CHECK(!is("<call:5>K1ABC<band:3>20m<eor>"));
+  CHECK(!is("ADIF export\n<adif_ver:5>3.1.0<eoh>"));
+  CHECK(!is("DX de W1AW:   14025.0  JA1ZZZ"));
+  CHECK(!is(""));
+
+  CHECK_EQ(parseTimestamp("2025-10-09 08:55:23"), kStamp);
+  CHECK_EQ(parseTimestamp("2025-10-09T08:55:23"), kStamp);
+  CHECK_EQ(parseTimestamp("2025-02-30 08:55:23"), 0);
+  CHECK_EQ(parseTimestamp("2025-10-09 24:00:00"), 0);
+  CHECK_EQ(parseTimestamp("2025-10-09"), 0);
+}
+
+struct Bad {
+  const char *what;
+  const char *xml;
+};
+
+constexpr Bad kBad[] = {
+    {"mismatched end tag", "<contactinfo><call>K1ABC</cal></contactinfo>"},
+    {"end tags crossed", "<contactinfo><a><b></a></b></contactinfo>"},
+    {"second root",
+     "<contactinfo><call>K1ABC</call></contactinfo><contactinfo/>"},
+    {"second empty root", "<spot/><spot/>"},
+    {"end tag after the root", "<spot></spot></spot>"},
+    {"unterminated CDATA", "<spot><comment><![CDATA[cq up 5</comment></spot>"},
+    {"unterminated comment", "<spot><!-- cq up 5</spot>"},
+    {"unterminated declaration", "<?xml version=\"1.0\""},
+    {"tag without >", "<spot><dxcall K1ABC</dxcall></spot>"},
+    {"empty element name", "<spot><>K1ABC</></spot>"},
+    {"unclosed root", "<contactinfo><call>K1ABC</call>"},
+    {"text outside the root", "<spot></spot>K1ABC"},
+    {"CDATA outside the root", "<![CDATA[x]]><spot></spot>"},
+    {"too deep", "<a><b><c><d><e><f><g><h><i>x</i></h></g></f></e></d></c>"
+                 "</b></a>"},
+    {"declaration only", "<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n"},
+    {"empty", ""},
+};
+
+void malformed() {
+  Message m;
+  for (const Bad &b : kBad) {
+    ++g_checks;
+    if (parsed(b.xml, m)) {
+      ++g_failures;
+      std::fprintf(stderr, "%s: parsed \"%s\"\n", b.what, b.xml);
+    }
+  }
+
+  // Eight levels are allowed: one more than the deepest test above fails.
+  CHECK(parsed("<a><b><c><d><e><f><g><h>x</h></g></f></e></d></c></b></a>", m));
+
+  // A datagram cut anywhere before its closing root tag is not a message;
+  // only the line end after it may go.
+  std::vector<std::string> full = {
+      contact("contactinfo", "a1b2c3", "JA1ZZZ", 1402530),
+      radio("RUN1", 1, 1402530, "True"), spot("add"), score()};
+  for (const std::string &d : full) {
+    CHECK(d.ends_with(">\r\n"));
+    size_t closed = d.size() - 2;
+    for (size_t n = 0; n <= d.size(); ++n) {
+      std::string cut = d.substr(0, n);
+      bool ok = parsed(cut, m);
+      ++g_checks;
+      if (ok != (n >= closed)) {
+        ++g_failures;
+        std::fprintf(stderr, "cut at %zu of %zu: parse %s\n", n, d.size(),
+                     ok ? "succeeded" : "failed");
+      }
+    }
+  }
+}
+
+// What DXClusterProvider::processN1mm makes of a contact message, stamped
+// 'now' as on arrival.
+ContestQso toQso(const Message &m, int64_t now) {
+  ContestQso q;
+  q.op = m.type == Type::Contact          ? ContestQso::Op::Add
+         : m.type == Type::ContactReplace ? ContestQso::Op::Replace
+                                          : ContestQso::Op::Delete;
+  q.id = m.contact.id;
+  q.time = now;
+  q.call = m.contact.call;
+  q.freqKhz = m.contact.rxKhz > 0 ? m.contact.rxKhz : m.contact.txKhz;
+  if (q.freqKhz <= 0 && !m.contact.band.empty())
+    q.freqKhz = std::strtod(m.contact.band.c_str(), nullptr) * 1000.0;
+  q.mode = m.contact.mode;
+  q.contest = m.contact.contest;
+  q.station = m.contact.stationName;
+  q.operatorCall = m.contact.operatorCall;
+  return q;
+}
+
+// Parses 'datagrams' and applies them as one burst at 'now'.
+void receive(ContestLogStore &store, const std::vector<std::string> &datagrams,
+             int64_t now) {
+  ContestLogUpdate u;
+  for (const std::string &d : datagrams) {
+    Message m;
+    CHECK(parsed(d, m));
+    switch (m.type) {
+    case Type::Contact:
+    case Type::ContactReplace:
+    case Type::ContactDelete:
+      u.qsos.push_back(toQso(m, now));
+      break;
+    case Type::Radio: {
+      ContestRadio r;
+      r.station = m.radio.stationName;
+      r.radioNr = m.radio.radioNr;
+      r.rxKhz = m.radio.rxKhz;
+      r.txKhz = m.radio.txKhz;
+      r.mode = m.radio.mode;
+      r.running = m.radio.running;
+      u.radios.push_back(r);
+      break;
+    }
+    case Type::Score:
+      u.score.contest = m.score.contest;
+      u.score.call = m.score.call;
+      u.score.score = m.score.score;
+      u.score.qsos = m.score.qsos;
+      u.score.points = m.score.points;
+      u.score.mults = m.score.mults;
+      u.hasScore = true;
+      break;
+    default:
+      break;
+    }
+  }
+  store.apply(u, now);
+}
+
+std::string add(std::string_view id, std::string_view call) {
+  return contact("contactinfo", id, call, 1402530);
+}
+
+void contestLog() {
+  ContestLogStore store;
+  // Two QSOs 80 minutes ago, three 30 and four 5.
+  receive(store, {add("q1", "JA1AAA"), add("q2", "JA1BBB")}, kNow - 80 * 60);
+  receive(store, {add("q3", "JA1CCC"), add("q4", "JA1DDD")}, kNow - 30 * 60);
+  receive(store, {add("q5", "JA1EEE")}, kNow - 30 * 60);
+  receive(store,
+          {add("q6", "JA1FFF"), add("q7", "JA1GGG"), add("q8", "JA1HHH"),
+           add("q9", "JA1III")},
+          kNow - 5 * 60);
+
+  auto d = store.snapshot();
+  CHECK_EQ(d->qsos, 9);
+  CHECK_EQ(d->loggedTotal, uint64_t{9});
+  CHECK_EQ(d->logged.size(), size_t{9});
+  CHECK(d->contest == "CQ-WW-CW");
+  // The first two left the window with the last burst.
+  CHECK_EQ(d->recent.size(), size_t{7});
+  CHECK(d->rate(kNow, 10) == 24.0);
+  CHECK(d->rate(kNow, 60) == 7.0);
+  const ContestQso &first = d->logged.front();
+  CHECK(first.op == ContestQso::Op::Add);
+  CHECK(first.id == "q1");
+  CHECK(first.call == "JA1AAA");
+  CHECK_EQ(first.time, kNow - 80 * 60);
+  CHECK(first.freqKhz == 14025.3);
+  CHECK(first.mode == "CW");
+  CHECK(first.station == "RUN1");
+  CHECK(first.operatorCall == "W1OP");
+
+  // Every station of a multi-op network repeats what it hears; the same id
+  // again is not another QSO.
+  receive(store, {add("q6", "JA1FFF"), add("q9", "JA1III")}, kNow);
+  d = store.snapshot();
+  CHECK_EQ(d->qsos, 9);
+  CHECK_EQ(d->loggedTotal, uint64_t{9});
+  CHECK_EQ(d->recent.size(), size_t{7});
+  CHECK(d->rate(kNow, 10) == 24.0);
+
+  // An edit keeps its QSO's time and count and is logged again.
+  receive(store, {contact("contactreplace", "q3", "JA1CCX", 2102500)}, kNow);
+  d = store.snapshot();
+  CHECK_EQ(d->qsos, 9);
+  CHECK_EQ(d->loggedTotal, uint64_t{10});
+  CHECK(d->rate(kNow, 10) == 24.0);
+  CHECK(d->rate(kNow, 60) == 7.0);
+  CHECK(d->logged.back().op == ContestQso::Op::Replace);
+  CHECK(d->logged.back().id == "q3");
+  CHECK(d->logged.back().call == "JA1CCX");
+  CHECK(d->logged.back().freqKhz == 21025.0);
+
+  // An edit of a QSO from before the window is logged and counts nothing.
+  receive(store, {contact("contactreplace", "q1", "JA1AAX", 1402530)}, kNow);
+  d = store.snapshot();
+  CHECK_EQ(d->qsos, 9);
+  CHECK_EQ(d->loggedTotal, uint64_t{11});
+  CHECK_EQ(d->recent.size(), size_t{7});
+
+  // A delete takes its QSO out of the count and the rates, once.
+  receive(store, {contact("contactdelete", "q8", "JA1HHH", 1402530)}, kNow);
+  d = store.snapshot();
+  CHECK_EQ(d->qsos, 8);
+  CHECK_EQ(d->loggedTotal, uint64_t{11});
+  CHECK(d->rate(kNow, 10) == 18.0);
+  CHECK(d->rate(kNow, 60) == 6.0);
+  receive(store,
+          {contact("contactdelete", "q8", "JA1HHH", 1402530),
+           contact("contactdelete", "zz", "JA1ZZZ", 1402530)},
+          kNow);
+  d = store.snapshot();
+  CHECK_EQ(d->qsos, 8);
+  CHECK(d->rate(kNow, 60) == 6.0);
+
+  // A deleted id logged again is a new QSO.
+  receive(store, {add("q8", "JA1HHH")}, kNow);
+  d = store.snapshot();
+  CHECK_EQ(d->qsos, 9);
+  CHECK(d->rate(kNow, 10) == 24.0);
+
+  // Radios by station and radio number; the score as last sent.
+  receive(store,
+          {radio("RUN1", 1, 1402530, "True"),
+           radio("RUN1", 2, 2102500, "False"),
+           radio("MULT", 1, 705000, "False"), score()},
+          kNow);
+  receive(store, {radio("RUN1", 1, 1403000, "False")}, kNow);
+  d = store.snapshot();
+  CHECK_EQ(d->radios.size(), size_t{3});
+  CHECK(d->radios[0].station == "RUN1");
+  CHECK_EQ(d->radios[0].radioNr, 1);
+  CHECK(d->radios[0].rxKhz == 14030.0);
+  CHECK(!d->radios[0].running);
+  CHECK_EQ(d->radios[1].radioNr, 2);
+  CHECK(d->radios[2].station == "MULT");
+  CHECK(d->hasScore);
+  CHECK_EQ(d->score.score, int64_t{161273});
+  CHECK_EQ(d->score.qsos, 312);
+  CHECK_EQ(d->score.mults, 179);
+  CHECK_EQ(d->qsos, 9);
+
+  // The newest kMaxLogged stay for readers; the total counts them all.
+  std::vector<std::string> burst;
+  for (int i = 0; i < 100; ++i)
+    burst.push_back(add("b" + std::to_string(i), "JA1ZZZ"));
+  receive(store, burst, kNow + 60);
+  d = store.snapshot();
+  CHECK_EQ(d->qsos, 109);
+  CHECK_EQ(d->loggedTotal, uint64_t{112});
+  CHECK_EQ(d->logged.size(), ContestLogStore::kMaxLogged);
+  CHECK(d->logged.back().id == "b99");
+  CHECK(d->rate(kNow + 60, 10) == (100 + 4) * 6.0);
+}
+
+} // namespace
+
+int main() {
+  contacts();
+  radios();
+  spots();
+  scores();
+  others();
+  malformed();
+  contestLog();
+  return checkResult("test-n1mm-protocol");
+}
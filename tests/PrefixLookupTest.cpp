@@ -0,0 +1,322 @@
+// PrefixManager against the flat-table lookup it replaced. The flat table
+// is rebuilt from the trie in PrefixData.h, exact calls under their old
+// "=CALL" keys, and searched the old way: upper_bound under a mutex, then
+// a backwards scan for the longest prefix.
+//
+// - A synthetic call for every prefix must land where it did before.
+// - Every exact-call entry must resolve to its own location; the old
+//   lookup could not match them and fell back to the prefix.
+// - Portable calls, operating suffixes and /MM /AM give the entity listed
+//   for them below.
+// - Calls in entities with more than one zone get the call area's CQ and
+//   ITU zones.
+//
+// --bench prints lookups per second for the old table, the trie and the
+// trie behind its cache, with 500 hot calls and with every synthetic call.
+//
+//   test-prefix-lookup            checks
+//   test-prefix-lookup --bench    also lookups/s
+
+#include "Check.h"
+
+#include "core/PrefixData.h"
+#include "core/PrefixManager.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+// The pre-trie PrefixManager::findLocation, on a table of copied strings.
+class FlatLookup {
+public:
+  FlatLookup() {
+    walk(0, "");
+    std::sort(entries_.begin(), entries_.end(),
+              [](const Entry &a, const Entry &b) { return a.call < b.call; });
+  }
+
+  bool findLocation(const std::string &call, LatLong &ll, int *dxcc) {
+    if (call.empty())
+      return false;
+    std::string upperCall = call;
+    for (auto &c : upperCall)
+      c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    Entry key;
+    key.call = upperCall;
+    auto it = std::upper_bound(
+        entries_.begin(), entries_.end(), key,
+        [](const Entry &a, const Entry &b) { return a.call < b.call; });
+    while (it != entries_.begin()) {
+      --it;
+      const std::string &entCall = it->call;
+      if (entCall.length() > upperCall.length()) {
+        if (entCall[0] != upperCall[0])
+          break;
+        continue;
+      }
+      if (upperCall.compare(0, entCall.length(), entCall) == 0) {
+        ll.lat = it->lat;
+        ll.lon = it->lon;
+        if (dxcc)
+          *dxcc = it->dxcc;
+        return true;
+      }
+      if (!entCall.empty() && entCall[0] != upperCall[0])
+        break;
+    }
+    return false;
+  }
+
+  // Plain prefixes and exact calls (without their '='), from the trie.
+  std::vector<std::string> prefixes, exactCalls;
+
+private:
+  struct Entry {
+    std::string call;
+    double lat = 0, lon = 0;
+    int dxcc = 0;
+  };
+
+  void add(std::string call, uint16_t loc) {
+    const StaticPrefixLocation &where = g_PrefixLocations[loc - 1];
+    entries_.push_back({std::move(call), where.lat, where.lon, where.dxcc});
+  }
+
+  void walk(uint32_t index, const std::string &path) {
+    const StaticPrefixNode &node = g_PrefixTrie[index];
+    if (node.prefixLoc) {
+      add(path, node.prefixLoc);
+      prefixes.push_back(path);
+    }
+    if (node.exactLoc) {
+      add("=" + path, node.exactLoc);
+      exactCalls.push_back(path);
+    }
+    for (uint32_t c = node.firstChild; c < node.firstChild + node.numChildren;
+         ++c)
+      walk(c, path + g_PrefixTrie[c].label);
+  }
+
+  std::mutex mutex_;
+  std::vector<Entry> entries_;
+};
+
+struct Answer {
+  bool found = false;
+  LatLong ll{};
+  int dxcc = 0;
+
+  bool operator==(const Answer &o) const {
+    return found == o.found &&
+           (!found ||
+            (ll.lat == o.ll.lat && ll.lon == o.ll.lon && dxcc == o.dxcc));
+  }
+};
+
+Answer oldAnswer(FlatLookup &flat, const std::string &call) {
+  Answer a;
+  a.found = flat.findLocation(call, a.ll, &a.dxcc);
+  return a;
+}
+
+Answer newAnswer(PrefixManager &pm, const std::string &call) {
+  Answer a;
+  a.found = pm.findLocation(call, a.ll, &a.dxcc);
+  return a;
+}
+
+// Calls built on every prefix, leaving out any that are exact-call
+// entries themselves.
+std::vector<std::string> syntheticCalls(const FlatLookup &flat) {
+  static const char *kTails[] = {"1ZZ", "ZZ", "9QQ", "AQX", "0A", "W"};
+  std::unordered_set<std::string> exact(flat.exactCalls.begin(),
+                                        flat.exactCalls.end());
+  std::vector<std::string> calls;
+  for (const auto &p : flat.prefixes)
+    for (const char *tail : kTails)
+      if (!exact.count(p + tail))
+        calls.push_back(p + tail);
+  return calls;
+}
+
+void samePrefixAnswers(FlatLookup &flat, PrefixManager &pm,
+                       const std::vector<std::string> &calls) {
+  size_t differ = 0;
+  for (const auto &call : calls) {
+    Answer before = oldAnswer(flat, call);
+    Answer now = newAnswer(pm, call);
+    CHECK(now.found);
+    if (!(before == now)) {
+      if (++differ <= 10)
+        std::fprintf(stderr, "%s: dxcc %d before, %d now\n", call.c_str(),
+                     before.dxcc, now.dxcc);
+    }
+    // Cached and uncached agree.
+    Answer uncached;
+    uncached.found =
+        PrefixManager::findLocationUncached(call, uncached.ll, &uncached.dxcc);
+    CHECK(uncached == now);
+  }
+  std::printf("%zu synthetic calls from plain prefixes, %zu answered "
+              "differently\n",
+              calls.size(), differ);
+  CHECK(calls.size() > 40000);
+  CHECK_EQ(differ, static_cast<size_t>(0));
+}
+
+void exactCallsResolve(FlatLookup &flat, PrefixManager &pm) {
+  size_t fixed = 0, wrong = 0;
+  for (const auto &call : flat.exactCalls) {
+    // Look the entry up in the trie directly for its own location.
+    const StaticPrefixNode *node = &g_PrefixTrie[0];
+    for (char c : call) {
+      const StaticPrefixNode *child = nullptr;
+      for (uint32_t i = node->firstChild;
+           i < node->firstChild + node->numChildren; ++i)
+        if (g_PrefixTrie[i].label == c)
+          child = &g_PrefixTrie[i];
+      if (!child)
+        break;
+      node = child;
+    }
+    const StaticPrefixLocation &want = g_PrefixLocations[node->exactLoc - 1];
+
+    Answer now = newAnswer(pm, call);
+    bool own = now.found && now.dxcc == want.dxcc && now.ll.lat == want.lat &&
+               now.ll.lon == want.lon;
+    if (!own && ++wrong <= 10)
+      std::fprintf(stderr, "%s: not resolved to its own entry\n",
+                   call.c_str());
+    if (!(oldAnswer(flat, call) == now))
+      fixed++;
+  }
+  std::printf("%zu exact-call entries, %zu answered differently by the old "
+              "lookup\n",
+              flat.exactCalls.size(), fixed);
+  CHECK(flat.exactCalls.size() > 10000);
+  CHECK_EQ(wrong, static_cast<size_t>(0));
+  CHECK(fixed > 0);
+}
+
+struct PortableCase {
+  const char *call;
+  int dxcc; // 0 = no entity
+};
+
+const PortableCase kPortableCases[] = {
+    {"K1ABC", 291},       {"K1ABC/P", 291},     {"K1ABC/M", 291},
+    {"K1ABC/QRP", 291},   {"K1ABC/4", 291},     {"k1abc/p", 291},
+    {"/K1ABC", 291},      {"K1ABC/", 291},      {"VP2E/K1ABC", 12},
+    {"K1ABC/VP2E", 12},   {"vp2e/k1abc", 12},   {"DL/K1ABC", 230},
+    {"K1ABC/DL", 230},    {"F/G3ABC/P", 227},   {"G3ABC/P/QRP", 223},
+    {"EA8/DL1ABC", 29},   {"KH6/K1ABC", 110},   {"K1ABC/KH6", 110},
+    {"OH0/DL1ABC", 5},    {"3D2/K1ABC", 176},   {"VE3ABC/W4", 291},
+    {"K1ABC/MM", 0},      {"G3ABC/AM", 0},      {"DL1ABC/MM/P", 0},
+    {"", 0},
+};
+
+void portableCalls(PrefixManager &pm) {
+  for (const auto &c : kPortableCases) {
+    Answer a = newAnswer(pm, c.call);
+    int got = a.found ? a.dxcc : 0;
+    ++g_checks;
+    if (got != c.dxcc) {
+      ++g_failures;
+      std::fprintf(stderr, "\"%s\": dxcc %d, want %d\n", c.call, got,
+                   c.dxcc);
+    }
+  }
+}
+
+struct ZoneCase {
+  const char *call;
+  int cqZone;
+  int ituZone;
+};
+
+const ZoneCase kZoneCases[] = {
+    {"K1ABC", 5, 8},    {"W6XYZ", 3, 6},    {"KH6/K1ABC", 31, 61},
+    {"JA1ABC", 25, 45}, {"VK2ABC", 30, 59}, {"VK6ABC", 29, 58},
+    {"VE3ABC", 4, 4},   {"VE7ABC", 3, 2},   {"G3ABC", 14, 27},
+};
+
+void knownZones(PrefixManager &pm) {
+  for (const auto &c : kZoneCases) {
+    PrefixInfo info;
+    bool found = pm.findEntity(c.call, info);
+    ++g_checks;
+    if (!found || info.cqZone != c.cqZone || info.ituZone != c.ituZone) {
+      ++g_failures;
+      std::fprintf(stderr, "\"%s\": zones %d/%d, want %d/%d\n", c.call,
+                   info.cqZone, info.ituZone, c.cqZone, c.ituZone);
+    }
+  }
+}
+
+template <typename Fn>
+double lookupsPerSecond(const std::vector<std::string> &calls, size_t total,
+                        Fn lookup) {
+  LatLong ll;
+  int dxcc = 0;
+  size_t found = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < total; ++i)
+    found += lookup(calls[i % calls.size()], ll, &dxcc);
+  double secs = secondsSince(t0);
+  CHECK(found > 0);
+  return total / secs;
+}
+
+void bench(FlatLookup &flat, const std::vector<std::string> &all) {
+  std::mt19937 rng(7);
+  std::vector<std::string> hot;
+  for (int i = 0; i < 500; ++i)
+    hot.push_back(all[rng() % all.size()]);
+  std::vector<std::string> shuffled = all;
+  std::shuffle(shuffled.begin(), shuffled.end(), rng);
+
+  std::printf("%-26s %13s %13s\n", "", "500 hot", "all distinct");
+  static const char *kNames[] = {"flat table (old)", "trie", "trie + cache"};
+  for (int kind = 0; kind < 3; ++kind) {
+    double rate[2];
+    for (int set = 0; set < 2; ++set) {
+      const auto &calls = set == 0 ? hot : shuffled;
+      PrefixManager pm;
+      rate[set] = lookupsPerSecond(
+          calls, 2000000, [&](const std::string &c, LatLong &ll, int *d) {
+            if (kind == 0)
+              return flat.findLocation(c, ll, d);
+            if (kind == 1)
+              return PrefixManager::findLocationUncached(c, ll, d);
+            return pm.findLocation(c, ll, d);
+          });
+    }
+    std::printf("%-26s %10.1fM/s %10.1fM/s\n", kNames[kind], rate[0] / 1e6,
+                rate[1] / 1e6);
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  FlatLookup flat;
+  PrefixManager pm;
+  auto calls = syntheticCalls(flat);
+
+  samePrefixAnswers(flat, pm, calls);
+  exactCallsResolve(flat, pm);
+  portableCalls(pm);
+  knownZones(pm);
+  if (wantBench(argc, argv))
+    bench(flat, calls);
+  return checkResult("test-prefix-lookup");
+}
@@ -0,0 +1,124 @@
+// ServiceHealth from many threads at once, the way providers report. Three
+// writers replace the status text with strings of one repeated letter, each
+// a different length, while readers take snapshots. A torn read, bytes of
+// one message under the length of another, shows up as a string that is
+// not one of the messages. Counts must be exact afterwards, and registry
+// lookups from several threads must agree on one entry per name.
+
+#include "Check.h"
+
+#include "core/ServiceHealth.h"
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int kWriters = 3;
+constexpr int kReaders = 3;
+constexpr int kReportsPerWriter = 400000;
+
+// Writer w writes only 'a' + w, ServiceHealth::kTextSize - 1 long for the
+// first, shorter for the others, so any mix of two is recognisable.
+std::string message(int w) {
+  static const size_t kLengths[kWriters] = {127, 40, 5};
+  return std::string(kLengths[w], static_cast<char>('a' + w));
+}
+
+bool isMessage(const std::string &s) {
+  if (s.empty())
+    return true; // markSuccess() clears the text
+  int w = s[0] - 'a';
+  return w >= 0 && w < kWriters && s == message(w);
+}
+
+void tornText() {
+  ServiceHealth health;
+  std::atomic<bool> done{false};
+  std::atomic<int> torn{0};
+  std::atomic<uint64_t> reads{0};
+
+  std::vector<std::thread> readers;
+  for (int r = 0; r < kReaders; ++r) {
+    readers.emplace_back([&] {
+      while (!done.load(std::memory_order_acquire)) {
+        ServiceHealthSnapshot s = health.snapshot();
+        if (!isMessage(s.lastError))
+          torn++;
+        reads++;
+      }
+    });
+  }
+
+  std::vector<std::thread> writers;
+  for (int w = 0; w < kWriters; ++w) {
+    writers.emplace_back([&health, w] {
+      std::string text = message(w);
+      for (int n = 0; n < kReportsPerWriter; ++n) {
+        switch (n % 4) {
+        case 0:
+          health.markFailure(text);
+          break;
+        case 1:
+          health.markSuccess(std::chrono::milliseconds(n % 500));
+          break;
+        default:
+          health.setNote(text);
+        }
+      }
+    });
+  }
+  for (auto &t : writers)
+    t.join();
+  done.store(true, std::memory_order_release);
+  for (auto &t : readers)
+    t.join();
+
+  std::printf("%llu snapshots during %d reports, %d torn\n",
+              static_cast<unsigned long long>(reads.load()),
+              kWriters * kReportsPerWriter, torn.load());
+  CHECK_EQ(torn.load(), 0);
+  CHECK(reads.load() > 0);
+  ServiceHealthSnapshot s = health.snapshot();
+  CHECK_EQ(s.failures, uint64_t{kWriters} * kReportsPerWriter / 4);
+  CHECK_EQ(s.successes, uint64_t{kWriters} * kReportsPerWriter / 4);
+  CHECK(s.reported);
+  CHECK(isMessage(s.lastError));
+}
+
+void registry() {
+  constexpr int kThreads = 4;
+  constexpr int kNames = 20;
+  auto &reg = ServiceHealthRegistry::instance();
+  std::vector<std::vector<ServiceHealth *>> seen(kThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&reg, &seen, t] {
+      for (int i = 0; i < kNames; ++i) {
+        ServiceHealth &h = reg.get("svc" + std::to_string(i));
+        h.markSuccess();
+        seen[t].push_back(&h);
+      }
+    });
+  }
+  for (auto &t : threads)
+    t.join();
+
+  for (int t = 1; t < kThreads; ++t)
+    CHECK(seen[t] == seen[0]);
+  auto all = reg.snapshot();
+  CHECK_EQ(all.size(), static_cast<size_t>(kNames));
+  for (const auto &s : all)
+    CHECK_EQ(s.successes, uint64_t{kThreads});
+}
+
+} // namespace
+
+int main() {
+  tornText();
+  registry();
+  return checkResult("test-service-health");
+}
@@ -0,0 +1,281 @@
+// SpotArchive over a synthetic history: a few weeks of spots checked
+// against counts kept on the side, then --bench builds a year at 20000
+// spots a day (30000 calls, one in every 20 spots VP8PJ) and times every
+// query shape the pane and /api/archive ask for.
+//
+//   test-spot-archive            checks on 40 days at 2000 spots/day
+//   test-spot-archive --bench    also the synthetic year and query times
+
+#include "Check.h"
+
+#include "core/DXClusterData.h"
+#include "core/DatabaseManager.h"
+#include "core/Logger.h"
+#include "core/SpotArchive.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Sys = std::chrono::system_clock;
+constexpr int64_t kDay = 86400;
+constexpr int kBatch = 500;
+
+Sys::time_point at(int64_t unixSecs) {
+  return Sys::time_point(std::chrono::seconds(unixSecs));
+}
+
+// Counts per (band, tx continent, rx continent), each 24 hours, summed
+// over all appended days; what hourlyActivity() must give back.
+struct Expected {
+  std::map<std::array<int, 3>, std::array<uint64_t, 24>> paths;
+  std::map<std::string, uint64_t> perCall;
+
+  HourlyActivity activity(int band, Continent from, Continent to) const {
+    HourlyActivity out;
+    for (const auto &[key, hours] : paths) {
+      if ((band >= 0 && key[0] != band) ||
+          (from != Continent::Unknown && key[1] != static_cast<int>(from)) ||
+          (to != Continent::Unknown && key[2] != static_cast<int>(to)))
+        continue;
+      for (int h = 0; h < 24; ++h) {
+        out.hours[h] += hours[h];
+        out.total += hours[h];
+      }
+    }
+    return out;
+  }
+};
+
+class History {
+public:
+  History(int perDay, int days) : perDay_(perDay), days_(days) {
+    for (int i = 0; i < 30000; ++i)
+      calls_.push_back("K" + std::to_string(i));
+    calls_[0] = "VP8PJ";
+    start_ = 1760000000 / kDay * kDay - int64_t{days} * kDay;
+  }
+
+  // Appends every day and runs maintenance after each, as the app does.
+  // Returns append and maintain time in ms.
+  std::pair<double, double> build(SpotArchive &archive, Expected *expect) {
+    double appendMs = 0, maintainMs = 0;
+    for (int d = 0; d < days_; ++d) {
+      int64_t day0 = start_ + int64_t{d} * kDay;
+      for (int b = 0; b < perDay_ / kBatch; ++b) {
+        std::vector<DXClusterSpot> batch(kBatch);
+        for (size_t i = 0; i < batch.size(); ++i) {
+          auto &s = batch[i];
+          // min() of two draws favours the low calls.
+          s.txCall = i % 20 == 0 ? calls_[0]
+                                 : calls_[std::min(rng_() % calls_.size(),
+                                                   rng_() % calls_.size())];
+          s.rxCall = "W" + std::to_string(rng_() % 500);
+          s.band = static_cast<int>(rng_() % 13) - 1;
+          s.freqKhz = 14000 + rng_() % 300;
+          s.modeId = static_cast<SpotMode>(rng_() % 10);
+          s.txCont = static_cast<Continent>(1 + rng_() % 7);
+          s.rxCont = static_cast<Continent>(1 + rng_() % 3);
+          s.txDxcc = 1 + static_cast<int>(rng_() % 340);
+          int64_t t = day0 + rng_() % kDay;
+          s.spottedAt = at(t);
+          if (expect) {
+            expect->paths[{s.band, static_cast<int>(s.txCont),
+                           static_cast<int>(s.rxCont)}][(t % kDay) / 3600]++;
+            expect->perCall[s.txCall]++;
+          }
+        }
+        auto t0 = std::chrono::steady_clock::now();
+        archive.append(batch);
+        appendMs += secondsSince(t0) * 1000;
+      }
+      auto t0 = std::chrono::steady_clock::now();
+      // Inside the grace hour: this rolls up the day before.
+      archive.maintain(at(day0 + kDay + 1800));
+      maintainMs += secondsSince(t0) * 1000;
+    }
+    return {appendMs, maintainMs};
+  }
+
+  // Just after the last maintain(), so the last day is still raw.
+  Sys::time_point now() const {
+    return at(start_ + int64_t{days_} * kDay + 1800);
+  }
+
+private:
+  int perDay_, days_;
+  int64_t start_;
+  std::vector<std::string> calls_;
+  std::mt19937 rng_{1};
+};
+
+void resetArchive() {
+  auto &db = DatabaseManager::instance();
+  db.exec("DELETE FROM spot_archive; DELETE FROM spot_hourly; "
+          "DELETE FROM spot_band_hourly; DELETE FROM call_days; "
+          "DELETE FROM entity_last; DELETE FROM archive_meta;");
+}
+
+bool sameActivity(const HourlyActivity &a, const HourlyActivity &b) {
+  return a.total == b.total && a.hours == b.hours;
+}
+
+struct Query {
+  int band;
+  Continent from, to;
+};
+
+const Query kQueries[] = {
+    {-1, Continent::Unknown, Continent::Unknown},
+    {5, Continent::Unknown, Continent::Unknown},
+    {-1, Continent::EU, Continent::NA},
+    {5, Continent::EU, Continent::NA},
+    {7, Continent::AS, Continent::Unknown},
+    {-1, Continent::Unknown, Continent::SA},
+};
+
+void sameCounts(SpotArchive &archive, const Expected &expect,
+                SpotArchive::TimePoint now) {
+  for (const auto &q : kQueries) {
+    HourlyActivity got = archive.hourlyActivity(q.band, q.from, q.to, 400, now);
+    HourlyActivity want = expect.activity(q.band, q.from, q.to);
+    ++g_checks;
+    if (!sameActivity(got, want)) {
+      ++g_failures;
+      std::fprintf(stderr,
+                   "hourlyActivity(%d, %s, %s): total %llu, want %llu\n",
+                   q.band, continentName(q.from), continentName(q.to),
+                   static_cast<unsigned long long>(got.total),
+                   static_cast<unsigned long long>(want.total));
+    }
+  }
+}
+
+// Rolled-up days, whose raw rows are gone past kRawDays, must count the
+// same as the counts kept on the side, through either rollup table.
+void checks() {
+  constexpr int kDays = 40;
+  resetArchive();
+  SpotArchive archive;
+  History history(2000, kDays);
+  Expected expect;
+  history.build(archive, &expect);
+  auto now = history.now();
+
+  // The last day is still raw.
+  int64_t today = SpotArchive::dayOf(
+      std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch())
+          .count());
+  CHECK_EQ(archive.rolledThrough(), today - 2);
+
+  sameCounts(archive, expect, now);
+  CHECK_EQ(archive.hourlyActivity(-1, Continent::Unknown, Continent::Unknown,
+                                  400, now)
+               .total,
+           uint64_t{2000} * kDays);
+
+  CallHistory vp8 = archive.callHistory("VP8PJ", 400, 50, now);
+  CHECK_EQ(vp8.totalSpots, expect.perCall["VP8PJ"]);
+  CHECK_EQ(vp8.daysHeard, kDays);
+  CHECK_EQ(vp8.spots.size(), static_cast<size_t>(50));
+  CHECK(!archive.lastSpotted(291).empty());
+
+  // A database rolled up before spot_band_hourly existed gets it filled in
+  // by the next maintain().
+  auto &db = DatabaseManager::instance();
+  db.exec("DELETE FROM spot_band_hourly; "
+          "DELETE FROM archive_meta WHERE key = 'band_rollup';");
+  SpotArchive reopened;
+  CHECK_EQ(reopened.maintain(now), 0);
+  sameCounts(reopened, expect, now);
+  int64_t bandRows = 0;
+  db.query("SELECT COUNT(*) FROM spot_band_hourly", {},
+           [&bandRows](const DatabaseManager::Cursor &row) {
+             bandRows = row.getInt(0);
+             return false;
+           });
+  CHECK_EQ(bandRows, 13 * (kDays - 1));
+}
+
+void bench() {
+  resetArchive();
+  SpotArchive archive;
+  constexpr int kPerDay = 20000, kDays = 365;
+  History history(kPerDay, kDays);
+  auto [appendMs, maintainMs] = history.build(archive, nullptr);
+  std::printf("%d spots/day x %d days: append %.1f us/spot, maintain "
+              "%.1f ms/day\n",
+              kPerDay, kDays, appendMs * 1000 / (double(kPerDay) * kDays),
+              maintainMs / kDays);
+  auto now = history.now();
+
+  uint64_t sink = 0;
+  auto time = [&](const char *name, auto fn) {
+    fn();
+    double best = 1e9, sum = 0;
+    for (int i = 0; i < 20; ++i) {
+      auto t0 = std::chrono::steady_clock::now();
+      fn();
+      double ms = secondsSince(t0) * 1000;
+      sum += ms;
+      best = std::min(best, ms);
+    }
+    std::printf("%-36s avg %6.2f ms  min %6.2f ms\n", name, sum / 20, best);
+    return sum / 20;
+  };
+  time("callHistory(VP8PJ, 30d)",
+       [&] { sink += archive.callHistory("VP8PJ", 30, 200, now).totalSpots; });
+  time("callHistory(VP8PJ, 365d)",
+       [&] { sink += archive.callHistory("VP8PJ", 365, 200, now).totalSpots; });
+  time("callHistory(K29999, 365d)", [&] {
+    sink += archive.callHistory("K29999", 365, 200, now).totalSpots;
+  });
+  // Every band and path shape /api/archive/activity takes, within 50 ms.
+  const Query kShapes[] = {
+      {7, Continent::EU, Continent::NA},
+      {7, Continent::Unknown, Continent::Unknown},
+      {-1, Continent::EU, Continent::NA},
+      {-1, Continent::EU, Continent::Unknown},
+      {-1, Continent::Unknown, Continent::Unknown},
+  };
+  for (const auto &q : kShapes) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "hourlyActivity(%s %s>%s, 365d)",
+                  q.band < 0 ? "all" : "15m",
+                  q.from == Continent::Unknown ? "any" : continentName(q.from),
+                  q.to == Continent::Unknown ? "any" : continentName(q.to));
+    double ms = time(name, [&] {
+      sink += archive.hourlyActivity(q.band, q.from, q.to, 365, now).total;
+    });
+    CHECK(ms < 50);
+  }
+  time("lastSpotted(291)",
+       [&] { sink += archive.lastSpotted(291).size(); });
+  std::printf("(%llu)\n", static_cast<unsigned long long>(sink));
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  auto dir = std::filesystem::temp_directory_path() / "hamclock-archive-test";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  Log::init(dir.string());
+  Log::get()->set_level(spdlog::level::warn);
+  if (!DatabaseManager::instance().init(dir / "test.db")) {
+    std::fprintf(stderr, "cannot open %s\n", (dir / "test.db").c_str());
+    return 1;
+  }
+
+  checks();
+  if (wantBench(argc, argv))
+    bench();
+  return checkResult("test-spot-archive");
+}
@@ -0,0 +1,158 @@
+// SpotDeduper: matching across cluster rounding, the time window, the
+// per-source bits, and a table that stays bounded over a long run of
+// unique spots. Then DXClusterDataStore merging a later source's report
+// into the stored spot with the same kHz match as the deduper.
+
+#include "Check.h"
+
+#include "core/DXClusterData.h"
+#include "core/DatabaseManager.h"
+#include "core/Logger.h"
+#include "core/SpotDeduper.h"
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+namespace {
+
+using Clock = SpotDeduper::Clock;
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+
+constexpr auto kWindow = seconds(180);
+constexpr uint32_t kA = 1, kB = 2, kC = 4;
+
+void rounding() {
+  SpotDeduper d(kWindow);
+  auto t = Clock::now();
+  CHECK(!d.check("JA1ZZZ", 14025.4, kA, t).duplicate);
+  // Clusters round differently: .4 and .6 fall either side of a kHz.
+  CHECK(d.check("JA1ZZZ", 14025.6, kB, t).duplicate);
+  CHECK(d.check("ja1zzz", 14025.0, kB, t).duplicate);
+  CHECK(d.check("JA1ZZZ", 14026.4, kB, t).duplicate);
+  CHECK(d.check("JA1ZZZ", 14024.4, kB, t).duplicate);
+  // Two kHz away is another spot, as is another call.
+  CHECK(!d.check("JA1ZZZ", 14027.0, kA, t).duplicate);
+  CHECK(!d.check("JA1ZZY", 14025.0, kA, t).duplicate);
+  CHECK(!d.check("JA1ZZZ", 7025.0, kA, t).duplicate);
+  CHECK_EQ(d.size(), static_cast<size_t>(4));
+}
+
+void window() {
+  SpotDeduper d(kWindow);
+  auto t = Clock::now();
+  CHECK(!d.check("VP8PJ", 18075, kA, t).duplicate);
+  CHECK(d.check("VP8PJ", 18075, kB, t + seconds(179)).duplicate);
+  // A repeat does not extend the window: it runs from the first report.
+  CHECK(d.check("VP8PJ", 18075, kA, t + seconds(180)).duplicate);
+  auto later = t + seconds(181);
+  SpotDeduper::Result r = d.check("VP8PJ", 18075, kC, later);
+  CHECK(!r.duplicate);
+  CHECK_EQ(r.sources, kC);
+  // The new entry starts its own window.
+  CHECK(d.check("VP8PJ", 18075, kA, later + seconds(100)).duplicate);
+}
+
+void sources() {
+  SpotDeduper d(kWindow);
+  auto t = Clock::now();
+  SpotDeduper::Result r = d.check("K1ABC", 3525, kA, t);
+  CHECK(!r.duplicate);
+  CHECK(!r.newSource);
+  CHECK_EQ(r.sources, kA);
+  r = d.check("K1ABC", 3525, kB, t);
+  CHECK(r.duplicate);
+  CHECK(r.newSource);
+  CHECK_EQ(r.sources, kA | kB);
+  r = d.check("K1ABC", 3525, kB, t);
+  CHECK(r.duplicate);
+  CHECK(!r.newSource);
+  r = d.check("K1ABC", 3525.7, kA, t);
+  CHECK(!r.newSource);
+  r = d.check("K1ABC", 3524.6, kC, t);
+  CHECK(r.newSource);
+  CHECK_EQ(r.sources, kA | kB | kC);
+}
+
+// 200000 unique spots at 10 a second: about 1800 live at any time, so the
+// table must settle at 4096 slots however long it runs.
+void bounded() {
+  SpotDeduper d(kWindow);
+  auto t = Clock::now();
+  size_t worst = 0, dups = 0;
+  for (int i = 0; i < 200000; ++i) {
+    dups += d.check("U" + std::to_string(i), 14000 + i % 300, kA,
+                    t + milliseconds(100) * i)
+                .duplicate;
+    worst = std::max(worst, d.capacity());
+    CHECK(d.size() <= d.capacity());
+  }
+  std::printf("200000 unique spots: table at most %zu slots\n", worst);
+  CHECK_EQ(dups, static_cast<size_t>(0));
+  CHECK(worst <= 4096);
+}
+
+bool waitFor(DXClusterDataStore &store, size_t spots) {
+  auto t0 = std::chrono::steady_clock::now();
+  while (secondsSince(t0) < 5) {
+    if (store.snapshot()->spots.size() >= spots)
+      return true;
+    std::this_thread::sleep_for(milliseconds(20));
+  }
+  return false;
+}
+
+uint32_t sourcesOf(DXClusterDataStore &store, const std::string &call) {
+  auto snap = store.snapshot();
+  for (DXSpotRef s : snap->spots)
+    if (s.txCall() == call)
+      return s.sources();
+  return 0;
+}
+
+// A report merges only where the deduper would have matched.
+void storeReports() {
+  DXClusterDataStore store;
+  DXClusterSpot spot;
+  spot.txCall = "JA1ZZZ";
+  spot.rxCall = "W1AW";
+  spot.freqKhz = 14024.6; // 14025 to the deduper
+  spot.sources = kA;
+  spot.spottedAt = std::chrono::system_clock::now();
+  store.addSpot(spot);
+  CHECK(waitFor(store, 1));
+
+  // 14026, within a kHz of 14025, though 1.8 kHz away as sent.
+  store.addSourceReport("JA1ZZZ", 14026.4, kB);
+  // 14023: the deduper would not have called this a repeat, though it is
+  // only 1.2 kHz away as sent.
+  store.addSourceReport("JA1ZZZ", 14023.4, kC);
+  // Flushed in order with a spot, so once it shows both reports are in.
+  spot.txCall = "K1ABC";
+  store.addSpot(spot);
+  CHECK(waitFor(store, 2));
+  CHECK_EQ(sourcesOf(store, "JA1ZZZ"), kA | kB);
+}
+
+} // namespace
+
+int main() {
+  rounding();
+  window();
+  sources();
+  bounded();
+
+  auto dir = std::filesystem::temp_directory_path() / "hamclock-deduper";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  Log::init(dir.string());
+  Log::get()->set_level(spdlog::level::warn);
+  if (!DatabaseManager::instance().init(dir / "test.db")) {
+    std::fprintf(stderr, "cannot open %s\n", (dir / "test.db").c_str());
+    return 1;
+  }
+  storeReports();
+  return checkResult("test-spot-deduper");
+}
@@ -0,0 +1,252 @@
+// SpotFilter: expressions run against four sample spots, each with the
+// spots it must match, and malformed expressions with the exact error
+// (column included) compile() must give. --bench prints evaluations per
+// second for a band/mode/continent/age filter and a call-glob/dxcc one.
+//
+//   test-spot-filter            grammar and error cases
+//   test-spot-filter --bench    also evaluations/s
+
+#include "Check.h"
+
+#include "core/SpotFilter.h"
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int64_t kNow = 1700000000;
+
+SpotFilter::Fields spot(int band, SpotMode mode, Continent dx, Continent de,
+                        int dxcc, SpotNeed need, double freqKhz, int64_t age,
+                        std::string_view call, std::string_view spotter) {
+  SpotFilter::Fields f;
+  f.band = band;
+  f.mode = mode;
+  f.dxCont = dx;
+  f.deCont = de;
+  f.dxcc = dxcc;
+  f.need = need;
+  f.freqKhz = freqKhz;
+  f.spottedAt = kNow - age;
+  f.call = call;
+  f.spotter = spotter;
+  return f;
+}
+
+// Band indexes into kBands: 3 = 40m, 5 = 20m, 6 = 17m.
+const SpotFilter::Fields kSpots[] = {
+    spot(5, SpotMode::CW, Continent::AS, Continent::NA, 339, SpotNeed::None,
+         14025, 300, "JA1ZZZ", "W1AW"),
+    spot(6, SpotMode::FT8, Continent::EU, Continent::EU, 230,
+         SpotNeed::NewBand, 18100, 1200, "DL1ABC", "G4XYZ"),
+    spot(3, SpotMode::SSB, Continent::NA, Continent::NA, 291,
+         SpotNeed::NewMode, 7200, 90, "K1ABC/P", "VE3AAA"),
+    spot(-1, SpotMode::Unknown, Continent::Unknown, Continent::Unknown, 0,
+         SpotNeed::NewDxcc, 5000, 3 * 3600, "VP2E/K1ABC", "DL9Q"),
+};
+
+struct MatchCase {
+  const char *expr;
+  const char *want; // '1' or '0' for each of kSpots
+};
+
+const MatchCase kMatchCases[] = {
+    {"", "1111"},
+    {"band=20m", "1000"},
+    {"band = 20", "1000"},
+    {"BAND=20M", "1000"},
+    {"band==40m", "0010"},
+    {"band!=20m", "0111"},
+    {"band in (20m,17m)", "1100"},
+    {"band in ( 20m , 17m , 40 )", "1110"},
+    {"mode=cw", "1000"},
+    {"mode=USB", "0010"},
+    {"mode in (FT8,FT4,JT65)", "0100"},
+    {"mode!=CW", "0111"},
+    {"cont=EU", "0100"},
+    {"dxcont in (AS,NA)", "1010"},
+    {"decont=NA", "1010"},
+    {"cont!=EU", "1011"},
+    {"dxcc=339", "1000"},
+    {"dxcc in (291, 230)", "0110"},
+    {"dxcc!=339", "0111"},
+    {"freq>14000", "1100"},
+    {"freq>=7200 and freq<=14025", "1010"},
+    {"freq=14025", "1000"},
+    {"freq!=14025", "0111"},
+    {"freq<7000.5", "0001"},
+    {"age<15m", "1010"},
+    {"age<=300s", "1010"},
+    {"age<15", "1010"},
+    {"age>2h", "0001"},
+    {"age>=1d", "0000"},
+    {"call=JA1ZZZ", "1000"},
+    {"call=ja1*", "1000"},
+    {"dx=*/P", "0010"},
+    {"call=*", "1111"},
+    {"call in (DL?ABC, VP2E/*)", "0101"},
+    {"call!=K*", "1101"},
+    {"spotter=W1AW", "1000"},
+    {"de in (G*, VE*)", "0110"},
+    {"need=dxcc", "0001"},
+    {"need in (band,dxcc)", "0101"},
+    {"need!=none", "0111"},
+    {"band=20m and mode=CW", "1000"},
+    {"band=20m or band=17m", "1100"},
+    {"not band=20m", "0111"},
+    {"not not band=20m", "1000"},
+    // 'and' binds tighter than 'or'.
+    {"band=20m or mode=FT8 and cont=AS", "1000"},
+    {"(band=20m or mode=FT8) and cont=EU", "0100"},
+    {"not (band=20m or band=17m)", "0011"},
+    {"((band=20m))", "1000"},
+    {"band=40m AND mode=SSB OR need=dxcc", "0011"},
+    {"band in (20m,17m) and mode=CW and not cont=EU and age<15m", "1000"},
+};
+
+struct ErrorCase {
+  const char *expr;
+  const char *error;
+};
+
+const ErrorCase kErrorCases[] = {
+    {"band", "column 5: expected '=', '!=', '<', '>' or 'in'"},
+    {"band=", "column 6: expected a value"},
+    {"bnd=20m", "column 1: unknown field at 'bnd'"},
+    {"=20m", "column 1: expected a field name at '='"},
+    {"band=21m", "column 6: unknown band at '21m'"},
+    {"mode=XYZ", "column 6: unknown mode at 'XYZ'"},
+    {"cont=XX", "column 6: unknown continent at 'XX'"},
+    {"need=all", "column 6: expected none, mode, band or dxcc at 'all'"},
+    {"dxcc=abc", "column 6: expected a DXCC entity number at 'abc'"},
+    {"dxcc in (291,0)", "column 14: expected a DXCC entity number at '0'"},
+    {"freq=14k", "column 6: expected a frequency in kHz at '14k'"},
+    {"age<soon", "column 5: expected an age like 30s, 15m or 2h at 'soon'"},
+    {"age in (5m)", "column 8: 'in' does not apply to this field at '('"},
+    {"band<20m",
+     "column 5: only '=', '!=' and 'in' apply to this field at '<'"},
+    {"band in 20m", "column 9: expected '(' after 'in' at '20m'"},
+    {"band in (20m", "column 13: expected ',' or ')'"},
+    {"band in (20m,)", "column 14: expected a value at ')'"},
+    {"(band=20m", "column 10: expected ')'"},
+    {"band=20m)", "column 9: expected 'and', 'or' or end of filter at ')'"},
+    {"band=20m and", "column 13: expected a field name"},
+    {"band=20m mode=CW",
+     "column 10: expected 'and', 'or' or end of filter at 'mode'"},
+    {"band ! 20m", "column 6: expected '=', '!=', '<', '>' or 'in' at '!'"},
+    {"band=20m & mode=CW",
+     "column 10: expected 'and', 'or' or end of filter at '&'"},
+    {"not", "column 4: expected a field name"},
+    {"()", "column 2: expected a field name at ')'"},
+};
+
+void matchCases() {
+  for (const auto &c : kMatchCases) {
+    SpotFilter f;
+    std::string err;
+    if (!f.compile(c.expr, &err)) {
+      ++g_failures;
+      std::fprintf(stderr, "\"%s\": %s\n", c.expr, err.c_str());
+      continue;
+    }
+    std::string got;
+    for (const auto &s : kSpots)
+      got += f.matches(s, kNow) ? '1' : '0';
+    ++g_checks;
+    if (got != c.want) {
+      ++g_failures;
+      std::fprintf(stderr, "\"%s\": matches %s, want %s\n", c.expr,
+                   got.c_str(), c.want);
+    }
+  }
+}
+
+void errorCases() {
+  for (const auto &c : kErrorCases) {
+    SpotFilter f;
+    std::string err;
+    bool ok = f.compile(c.expr, &err);
+    ++g_checks;
+    if (ok || err != c.error) {
+      ++g_failures;
+      std::fprintf(stderr, "\"%s\": error \"%s\", want \"%s\"\n", c.expr,
+                   err.c_str(), c.error);
+    }
+    // A filter that failed to compile is empty and lets everything through.
+    CHECK(f.empty() && f.matches(kSpots[3], kNow));
+    CHECK(SpotFilter::validate(c.expr) == c.error);
+  }
+}
+
+void program() {
+  SpotFilter f;
+  // Any band, mode or continent list is one mask test.
+  CHECK(f.compile("band in (160m,80m,40m,20m,15m,10m)"));
+  CHECK_EQ(f.instructionCount(), static_cast<size_t>(1));
+  CHECK(f.compile("mode!=CW"));
+  CHECK_EQ(f.instructionCount(), static_cast<size_t>(1));
+  // A failed compile drops the previous program.
+  CHECK(!f.compile("band=99m"));
+  CHECK(f.empty());
+  CHECK(f.expression() == "band=99m");
+  CHECK(SpotFilter::validate("band=20m and age<15m").empty());
+}
+
+// Spots drawn from a spread of bands, modes, entities and calls, so the
+// mask tests and jumps do not all go the same way.
+std::vector<SpotFilter::Fields> randomSpots(size_t n) {
+  static const char *kCalls[] = {"JA1ZZZ", "DL1ABC", "K1ABC/P",
+                                 "VP2E/K1ABC", "G4XYZ", "VK2DEF",
+                                 "PY2AA", "ZL1BQ"};
+  static const int kDxcc[] = {339, 230, 291, 0, 223, 150, 108, 170};
+  std::mt19937 rng(3);
+  std::vector<SpotFilter::Fields> out;
+  for (size_t i = 0; i < n; ++i) {
+    int k = rng() % 8;
+    out.push_back(spot(
+        static_cast<int>(rng() % 13) - 1,
+        static_cast<SpotMode>(rng() % static_cast<int>(SpotMode::Count)),
+        static_cast<Continent>(rng() % static_cast<int>(Continent::Count)),
+        static_cast<Continent>(rng() % static_cast<int>(Continent::Count)),
+        kDxcc[k], static_cast<SpotNeed>(rng() % 4), 1800 + rng() % 50000,
+        rng() % 3600, kCalls[k], kCalls[rng() % 8]));
+  }
+  return out;
+}
+
+void bench() {
+  const auto spots = randomSpots(4096);
+  const char *kFilters[] = {
+      "band in (20m,17m) and mode=CW and not cont=EU and age<15m",
+      "call in (JA*, DL?ABC, */P) or dxcc in (1, 100, 108, 150, 170, 223, "
+      "291, 339)",
+  };
+  for (const char *expr : kFilters) {
+    SpotFilter f;
+    f.compile(expr);
+    constexpr int kRounds = 5000;
+    size_t hits = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < kRounds; ++r)
+      for (const auto &s : spots)
+        hits += f.matches(s, kNow);
+    double secs = secondsSince(t0);
+    std::printf("%6.1f M evaluations/s, %5.1f%% match: %s\n",
+                kRounds * spots.size() / secs / 1e6,
+                100.0 * hits / (kRounds * spots.size()), expr);
+  }
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  matchCases();
+  errorCases();
+  program();
+  if (wantBench(argc, argv))
+    bench();
+  return checkResult("test-spot-filter");
+}
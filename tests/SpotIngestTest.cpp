@@ -0,0 +1,192 @@
+// The DX spot ingest path: SpscRing on its own, then a load test that
+// pushes thousands of spots a second through DXClusterDataStore while a
+// reader polls snapshots and ingest stats, as the panel and the debug
+// endpoint do. Every spot must be published and persisted; none dropped.
+//
+//   test-spot-ingest            checks, 5000 spots/s for 3 s
+//   test-spot-ingest --bench    also 20000 spots/s for 5 s, with timings
+
+#include "Check.h"
+
+#include "core/DXClusterData.h"
+#include "core/DatabaseManager.h"
+#include "core/Logger.h"
+#include "core/SpscRing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+void ringBasics() {
+  SpscRing<int, 8> ring;
+  int v = 0;
+  CHECK(!ring.tryPop(v));
+  for (int i = 0; i < 8; ++i)
+    CHECK(ring.tryPush(i));
+  CHECK(!ring.tryPush(8));
+  CHECK_EQ(ring.size(), static_cast<size_t>(8));
+  for (int i = 0; i < 8; ++i) {
+    CHECK(ring.tryPop(v));
+    CHECK_EQ(v, i);
+  }
+  CHECK_EQ(ring.size(), static_cast<size_t>(0));
+}
+
+// size() from a third thread while both ends run flat out: it must stay
+// within the capacity, and everything pushed comes out in order.
+void ringConcurrentSize() {
+  constexpr int kItems = 200000;
+  SpscRing<int, 64> ring;
+  std::atomic<bool> done{false};
+  std::atomic<size_t> worst{0};
+
+  std::thread producer([&] {
+    for (int i = 0; i < kItems;) {
+      if (ring.tryPush(i))
+        ++i;
+      else
+        std::this_thread::yield();
+    }
+  });
+  bool ordered = true;
+  std::thread consumer([&] {
+    int expect = 0, v = 0;
+    while (expect < kItems) {
+      if (ring.tryPop(v))
+        ordered = ordered && v == expect++;
+      else
+        std::this_thread::yield();
+    }
+  });
+  std::thread observer([&] {
+    while (!done.load(std::memory_order_relaxed)) {
+      size_t s = ring.size();
+      if (s > worst.load(std::memory_order_relaxed))
+        worst.store(s, std::memory_order_relaxed);
+      std::this_thread::yield();
+    }
+  });
+  producer.join();
+  consumer.join();
+  done = true;
+  observer.join();
+  CHECK(ordered);
+  CHECK(worst.load() <= ring.capacity());
+}
+
+DXClusterSpot makeSpot(int n) {
+  static const char *kModes[] = {"CW", "FT8", "SSB", "RTTY"};
+  DXClusterSpot s;
+  s.txCall = "K" + std::to_string(n);
+  s.rxCall = "W" + std::to_string(n % 97) + "SKM";
+  s.mode = kModes[n % 4];
+  s.freqKhz = 7000 + (n % 20000) * 1.1;
+  s.snr = n % 30;
+  s.spottedAt = std::chrono::system_clock::now();
+  return s;
+}
+
+struct LoadResult {
+  DXSpotIngestStats stats;
+  size_t published = 0;
+  int64_t persisted = 0;
+  size_t worstPending = 0;
+  double worstReadUs = 0;
+  double drainSecs = 0; // last push until everything was written
+};
+
+LoadResult runLoad(int rate, int seconds) {
+  DatabaseManager::instance().exec("DELETE FROM dx_spots");
+  LoadResult r;
+  const int total = rate * seconds;
+  {
+    DXClusterDataStore store;
+    std::atomic<bool> done{false};
+    std::thread reader([&] {
+      while (!done.load(std::memory_order_relaxed)) {
+        auto t0 = Clock::now();
+        auto snap = store.snapshot();
+        size_t n = snap->spots.size();
+        double us = secondsSince(t0) * 1e6;
+        r.worstReadUs = std::max(r.worstReadUs, us);
+        r.worstPending = std::max(r.worstPending, store.ingestStats().pending);
+        (void)n;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      }
+    });
+
+    // One producer, paced in 1 ms steps like a busy telnet reader.
+    auto start = Clock::now();
+    for (int sent = 0; sent < total;) {
+      double due = secondsSince(start) * rate;
+      for (; sent < total && sent < due; ++sent)
+        store.addSpot(makeSpot(sent));
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    auto pushed = Clock::now();
+    while (store.ingestStats().written < store.ingestStats().queued &&
+           secondsSince(pushed) < 10)
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    r.drainSecs = secondsSince(pushed);
+    done = true;
+    reader.join();
+
+    r.stats = store.ingestStats();
+    r.published = store.snapshot()->spots.size();
+  }
+  DatabaseManager::instance().query(
+      "SELECT COUNT(*) FROM dx_spots", {},
+      [&](const DatabaseManager::Cursor &row) {
+        r.persisted = row.getInt(0);
+        return false;
+      });
+  return r;
+}
+
+void checkLoad(int rate, int seconds, bool report) {
+  LoadResult r = runLoad(rate, seconds);
+  const uint64_t total = static_cast<uint64_t>(rate) * seconds;
+  CHECK_EQ(r.stats.dropped, 0u);
+  CHECK_EQ(r.stats.queued, total);
+  CHECK_EQ(r.stats.written, total);
+  CHECK_EQ(r.published, static_cast<size_t>(total));
+  CHECK_EQ(r.persisted, static_cast<int64_t>(total));
+  CHECK(r.worstPending <= 4096);
+  if (report)
+    std::printf("%6d spots/s x %ds: %llu written in %llu batches, "
+                "last batch %.1f ms, max latency %.0f ms, worst snapshot "
+                "read %.0f us, worst backlog %zu, drained %.2f s after the "
+                "last push\n",
+                rate, seconds, static_cast<unsigned long long>(r.stats.written),
+                static_cast<unsigned long long>(r.stats.batches),
+                r.stats.lastBatchMs, r.stats.maxLatencyMs, r.worstReadUs,
+                r.worstPending, r.drainSecs);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  auto dir = std::filesystem::temp_directory_path() / "hamclock-spot-ingest";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+  Log::init(dir.string());
+  Log::get()->set_level(spdlog::level::warn);
+  if (!DatabaseManager::instance().init(dir / "test.db")) {
+    std::fprintf(stderr, "cannot open %s\n", (dir / "test.db").c_str());
+    return 1;
+  }
+
+  ringBasics();
+  ringConcurrentSize();
+  checkLoad(5000, 3, true);
+  if (wantBench(argc, argv))
+    checkLoad(20000, 5, true);
+  return checkResult("test-spot-ingest");
+}
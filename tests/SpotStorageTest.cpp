@@ -0,0 +1,404 @@
+// Spot storage: the Interner and the column tables the stores copy on every
+// update. Interned strings must come back as they went in, from several
+// threads at once, and a spot read back from a DXSpotTable must equal the
+// spot pushed. --bench builds a synthetic load the old way, a vector of
+// DXClusterSpot and of the PSK record with its own strings, and the new
+// way, and prints the memory each takes and the time to copy and scan it.
+//
+//   test-spot-storage            round trips
+//   test-spot-storage --bench    also memory, copy and scan times
+
+#include "Check.h"
+
+#include "core/DXClusterData.h"
+#include "core/Interner.h"
+#include "core/LiveSpotData.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <malloc.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+using Sys = std::chrono::system_clock;
+
+void interner() {
+  Interner &strings = Interner::instance();
+  CHECK_EQ(strings.intern(""), Interner::kEmpty);
+  CHECK(strings.view(Interner::kEmpty).empty());
+  CHECK_EQ(strings.find("NEVER/SEEN"), Interner::kEmpty);
+
+  Interner::Id k1 = strings.intern("K1ABC");
+  CHECK(k1 != Interner::kEmpty);
+  CHECK_EQ(strings.intern("K1ABC"), k1);
+  CHECK_EQ(strings.find("K1ABC"), k1);
+  CHECK(strings.view(k1) == "K1ABC");
+  // Case matters: interning is not a callsign lookup.
+  CHECK(strings.intern("k1abc") != k1);
+
+  // Views stay where they are while the table grows, through new arenas
+  // and id blocks, and strings too big for an arena go in on their own.
+  std::string_view early = strings.view(k1);
+  std::string big(20000, 'x');
+  Interner::Id bigId = strings.intern(big);
+  std::vector<Interner::Id> ids;
+  for (int i = 0; i < 20000; ++i)
+    ids.push_back(strings.intern("RT" + std::to_string(i)));
+  bool same = true;
+  for (int i = 0; i < 20000; ++i)
+    same = same && strings.view(ids[i]) == "RT" + std::to_string(i) &&
+           strings.find("RT" + std::to_string(i)) == ids[i];
+  CHECK(same);
+  CHECK(strings.view(bigId) == big);
+  CHECK(strings.view(k1).data() == early.data());
+}
+
+// Threads interning the same strings in different orders must agree on
+// one id per string, and add each string once.
+void concurrentIntern() {
+  constexpr int kThreads = 4;
+  constexpr int kStrings = 5000;
+  Interner &strings = Interner::instance();
+  size_t before = strings.size();
+  std::vector<std::vector<Interner::Id>> seen(
+      kThreads, std::vector<Interner::Id>(kStrings));
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&seen, &strings, t] {
+      std::mt19937 rng(t);
+      std::vector<int> order(kStrings);
+      for (int i = 0; i < kStrings; ++i)
+        order[i] = i;
+      std::shuffle(order.begin(), order.end(), rng);
+      for (int i : order)
+        seen[t][i] = strings.intern("CC" + std::to_string(i));
+    });
+  }
+  for (auto &t : threads)
+    t.join();
+
+  for (int t = 1; t < kThreads; ++t)
+    CHECK(seen[t] == seen[0]);
+  std::vector<Interner::Id> sorted = seen[0];
+  std::sort(sorted.begin(), sorted.end());
+  CHECK(std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+  CHECK_EQ(strings.size(), before + kStrings);
+  CHECK(strings.view(seen[0][1234]) == "CC1234");
+}
+
+bool sameSpot(const DXClusterSpot &a, const DXClusterSpot &b) {
+  return a.txCall == b.txCall && a.txGrid == b.txGrid &&
+         a.rxCall == b.rxCall && a.rxGrid == b.rxGrid &&
+         a.txDxcc == b.txDxcc && a.rxDxcc == b.rxDxcc &&
+         a.txCqZone == b.txCqZone && a.txItuZone == b.txItuZone &&
+         a.mode == b.mode && a.freqKhz == b.freqKhz && a.snr == b.snr &&
+         (a.dtSecs == b.dtSecs ||
+          (std::isnan(a.dtSecs) && std::isnan(b.dtSecs))) &&
+         a.txLat == b.txLat && a.txLon == b.txLon && a.rxLat == b.rxLat &&
+         a.rxLon == b.rxLon && a.spottedAt == b.spottedAt &&
+         a.sources == b.sources && a.band == b.band && a.modeId == b.modeId &&
+         a.txCont == b.txCont && a.rxCont == b.rxCont &&
+         a.distanceKm == b.distanceKm && a.bearingDeg == b.bearingDeg &&
+         a.need == b.need;
+}
+
+// Values the columns hold exactly: positions and SNR as floats, times in
+// whole seconds.
+DXClusterSpot sampleSpot(int i) {
+  DXClusterSpot s;
+  s.txCall = "JA" + std::to_string(i) + "ZZ";
+  s.txGrid = i % 2 ? "PM95" : "";
+  s.rxCall = "W1AW";
+  s.rxGrid = "FN31pr";
+  s.txDxcc = 339;
+  s.rxDxcc = 291;
+  s.txCqZone = 25;
+  s.txItuZone = 45;
+  s.mode = i % 3 ? "FT8" : "CW";
+  s.freqKhz = 14074.5 + i;
+  s.snr = -12;
+  if (i % 2)
+    s.dtSecs = 0.25f;
+  s.txLat = 35.5;
+  s.txLon = 139.75;
+  s.rxLat = 41.625;
+  s.rxLon = -72.75;
+  s.spottedAt = Sys::time_point(std::chrono::seconds(1760000000 + i));
+  s.sources = 5;
+  s.band = 5;
+  s.modeId = i % 3 ? SpotMode::FT8 : SpotMode::CW;
+  s.txCont = Continent::AS;
+  s.rxCont = Continent::NA;
+  s.distanceKm = 10850.5f;
+  s.bearingDeg = 331.25f;
+  s.need = SpotNeed::NewBand;
+  return s;
+}
+
+void tableRoundTrip() {
+  DXSpotTable t;
+  for (int i = 0; i < 10; ++i)
+    t.push_back(sampleSpot(i));
+  CHECK_EQ(t.size(), size_t{10});
+  bool same = true;
+  for (DXSpotRef s : t)
+    same = same &&
+           sameSpot(s.toSpot(), sampleSpot(static_cast<int>(s.index())));
+  CHECK(same);
+
+  // Removing rows keeps every column in step and in order.
+  t.eraseIf([](DXSpotRef s) { return s.index() % 3 == 0; });
+  CHECK_EQ(t.size(), size_t{6});
+  const int kept[] = {1, 2, 4, 5, 7, 8};
+  same = true;
+  for (size_t i = 0; i < t.size(); ++i)
+    same = same && sameSpot(t[i].toSpot(), sampleSpot(kept[i]));
+  CHECK(same);
+  CHECK(t.back().txCall() == "JA8ZZ");
+}
+
+// --- Benchmark --------------------------------------------------------
+
+// The PSK Reporter record LiveSpotData held before LiveSpotTable.
+struct OldSpotRecord {
+  double freqKhz;
+  std::string receiverGrid;
+  std::string senderCallsign;
+  SpotNeed need = SpotNeed::None;
+};
+
+// 20000 cluster spots and 10000 PSK reports among 8000 calls, 600
+// spotters and 3000 grids; the same sequence every time.
+class Load {
+public:
+  static constexpr int kClusterSpots = 20000;
+  static constexpr int kPskSpots = 10000;
+
+  Load() {
+    static const char *const kPrefixes[] = {"K", "W", "N", "JA", "DL", "G",
+                                            "VK", "ZL", "PY", "UA", "EA",
+                                            "F", "I", "VE", "LU", "ZS"};
+    for (int i = 0; i < 8000; ++i)
+      calls_.push_back(std::string(kPrefixes[i % 16]) +
+                       std::to_string(i % 10) + letters(i, 3));
+    for (int i = 0; i < 600; ++i)
+      spotters_.push_back(std::string(kPrefixes[i % 16]) +
+                          std::to_string(i % 10) + letters(i * 7, 2) + "-#");
+    for (int i = 0; i < 3000; ++i) {
+      std::string g = grid(i);
+      grids_.push_back(i % 3 ? g : g + letters(i, 2));
+    }
+  }
+
+  DXClusterSpot spot() {
+    DXClusterSpot s;
+    s.txCall = pick(calls_);
+    s.rxCall = pick(spotters_);
+    s.txGrid = rng_() % 4 ? pick(grids_) : "";
+    s.rxGrid = pick(grids_);
+    static const char *const kModes[] = {"CW", "FT8", "SSB", "", "RTTY"};
+    s.mode = kModes[rng_() % 5];
+    s.freqKhz = 14000 + rng_() % 350 + 0.1 * (rng_() % 10);
+    s.snr = static_cast<int>(rng_() % 40) - 20;
+    s.txLat = static_cast<int>(rng_() % 180) - 90;
+    s.txLon = static_cast<int>(rng_() % 360) - 180;
+    s.rxLat = static_cast<int>(rng_() % 180) - 90;
+    s.rxLon = static_cast<int>(rng_() % 360) - 180;
+    s.spottedAt = Sys::time_point(std::chrono::seconds(1760000000 + n_++));
+    s.classify();
+    return s;
+  }
+
+  OldSpotRecord psk() {
+    OldSpotRecord r;
+    r.freqKhz = 14074 + rng_() % 3;
+    r.receiverGrid = pick(grids_);
+    r.senderCallsign = pick(calls_);
+    return r;
+  }
+
+private:
+  static std::string letters(int n, int count) {
+    std::string s;
+    for (int i = 0; i < count; ++i, n /= 26)
+      s += static_cast<char>('A' + n % 26);
+    return s;
+  }
+  static std::string grid(int n) {
+    return {static_cast<char>('A' + n % 18),
+            static_cast<char>('A' + n / 18 % 18),
+            static_cast<char>('0' + n / 324 % 10),
+            static_cast<char>('0' + n / 3240 % 10 + n % 7)};
+  }
+  const std::string &pick(const std::vector<std::string> &from) {
+    return from[rng_() % from.size()];
+  }
+
+  std::vector<std::string> calls_, spotters_, grids_;
+  std::mt19937 rng_{7};
+  int n_ = 0;
+};
+
+// Resident set size in bytes, or 0 where it cannot be read.
+size_t rssBytes() {
+#ifdef __linux__
+  FILE *f = std::fopen("/proc/self/statm", "r");
+  if (!f)
+    return 0;
+  unsigned long pages = 0, resident = 0;
+  int n = std::fscanf(f, "%lu %lu", &pages, &resident);
+  std::fclose(f);
+  return n == 2 ? resident * static_cast<size_t>(sysconf(_SC_PAGESIZE)) : 0;
+#else
+  return 0;
+#endif
+}
+
+template <typename Fn> double msPerRun(Fn fn) {
+  constexpr int kRuns = 200;
+  fn();
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < kRuns; ++i)
+    fn();
+  return secondsSince(t0) * 1000 / kRuns;
+}
+
+void bench() {
+#ifdef __linux__
+  // Otherwise freeing each copy can hand the heap top back, and every copy
+  // pays for page faults on both layouts alike.
+  mallopt(M_TRIM_THRESHOLD, 256 << 20);
+#endif
+  // Built one after the other, each kept, so each grows the heap afresh.
+  size_t rss0 = rssBytes();
+  std::vector<DXClusterSpot> oldSpots;
+  std::vector<OldSpotRecord> oldPsk;
+  {
+    Load load;
+    for (int i = 0; i < Load::kClusterSpots; ++i)
+      oldSpots.push_back(load.spot());
+    for (int i = 0; i < Load::kPskSpots; ++i)
+      oldPsk.push_back(load.psk());
+  }
+  size_t rss1 = rssBytes();
+  size_t stringsBefore = Interner::instance().size();
+  size_t bytesBefore = Interner::instance().bytes();
+  DXSpotTable spots;
+  LiveSpotTable psk;
+  {
+    Load load;
+    for (int i = 0; i < Load::kClusterSpots; ++i)
+      spots.push_back(load.spot());
+    for (int i = 0; i < Load::kPskSpots; ++i) {
+      OldSpotRecord r = load.psk();
+      psk.push_back(r.freqKhz, freqToBandIndex(r.freqKhz), 40.5, -74.25,
+                    r.senderCallsign, r.receiverGrid, r.need);
+    }
+  }
+  size_t rss2 = rssBytes();
+  CHECK_EQ(spots.size(), oldSpots.size());
+  CHECK(spots.back().toSpot().txCall == oldSpots.back().txCall);
+
+  std::printf("%d cluster + %d PSK spots, %zu strings interned (%.0f KB)\n",
+              Load::kClusterSpots, Load::kPskSpots,
+              Interner::instance().size() - stringsBefore,
+              (Interner::instance().bytes() - bytesBefore) / 1024.0);
+  if (rss0 && rss1 && rss2) {
+    double n = Load::kClusterSpots + Load::kPskSpots;
+    double oldMb = (rss1 - rss0) / 1048576.0;
+    double newMb = (rss2 - rss1) / 1048576.0;
+    std::printf("RSS growth: %.1f MB (%.0f B/spot) before, %.1f MB "
+                "(%.0f B/spot) after, interner growth included\n",
+                oldMb, oldMb * 1048576 / n, newMb, newMb * 1048576 / n);
+    CHECK(rss2 - rss1 < rss1 - rss0);
+  } else {
+    std::printf("RSS not available here\n");
+  }
+
+  size_t sink = 0;
+  double oldCopy = msPerRun([&] {
+    std::vector<DXClusterSpot> copy = oldSpots;
+    sink += copy.size();
+  });
+  double newCopy = msPerRun([&] {
+    DXSpotTable copy = spots;
+    sink += copy.size();
+  });
+  std::printf("DXClusterData spots copy:   %.3f ms before, %.3f ms after\n",
+              oldCopy, newCopy);
+  double oldPskCopy = msPerRun([&] {
+    std::vector<OldSpotRecord> copy = oldPsk;
+    sink += copy.size();
+  });
+  double newPskCopy = msPerRun([&] {
+    LiveSpotTable copy = psk;
+    sink += copy.size();
+  });
+  std::printf("LiveSpotData spots copy:    %.3f ms before, %.3f ms after\n",
+              oldPskCopy, newPskCopy);
+
+  // The map's hit test: nearest DX station to a point.
+  auto nearestOld = [&] {
+    float best = 1e9f;
+    size_t at = 0;
+    for (size_t i = 0; i < oldSpots.size(); ++i) {
+      float dx = static_cast<float>(oldSpots[i].txLat) - 51.5f;
+      float dy = static_cast<float>(oldSpots[i].txLon) + 0.25f;
+      if (dx * dx + dy * dy < best) {
+        best = dx * dx + dy * dy;
+        at = i;
+      }
+    }
+    sink += at;
+  };
+  auto nearestNew = [&] {
+    float best = 1e9f;
+    size_t at = 0;
+    for (size_t i = 0; i < spots.size(); ++i) {
+      float dx = spots.txLat[i] - 51.5f;
+      float dy = spots.txLon[i] + 0.25f;
+      if (dx * dx + dy * dy < best) {
+        best = dx * dx + dy * dy;
+        at = i;
+      }
+    }
+    sink += at;
+  };
+  std::printf("position scan:              %.3f ms before, %.3f ms after\n",
+              msPerRun(nearestOld), msPerRun(nearestNew));
+
+  // A panel looking for one call, reading the string of every row.
+  const std::string want = oldSpots[Load::kClusterSpots / 2].txCall;
+  auto callOld = [&] {
+    for (const auto &s : oldSpots)
+      sink += s.txCall == want;
+  };
+  auto callNew = [&] {
+    for (DXSpotRef s : spots)
+      sink += s.txCall() == want;
+  };
+  std::printf("call scan:                  %.3f ms before, %.3f ms after\n",
+              msPerRun(callOld), msPerRun(callNew));
+  std::printf("(%zu)\n", sink);
+  CHECK(newCopy < oldCopy);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  interner();
+  concurrentIntern();
+  tableRoundTrip();
+  if (wantBench(argc, argv))
+    bench();
+  return checkResult("test-spot-storage");
+}
@@ -0,0 +1,150 @@
+// Hammers SolarDataStore and ActivityDataStore from many threads, each
+// writer owning a different field, the way the NOAA and activity fetches
+// do. Every update must survive: the final counts are exact, and readers
+// never see a field or the version go backwards.
+
+#include "Check.h"
+
+#include "core/ActivityData.h"
+#include "core/SolarData.h"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int kSolarFields = 8;
+constexpr int kUpdatesPerWriter = 20000;
+constexpr int kReaders = 2;
+
+int &solarField(SolarData &d, int i) {
+  switch (i) {
+  case 0:
+    return d.sfi;
+  case 1:
+    return d.k_index;
+  case 2:
+    return d.a_index;
+  case 3:
+    return d.sunspot_number;
+  case 4:
+    return d.bz;
+  case 5:
+    return d.bt;
+  case 6:
+    return d.aurora;
+  default:
+    return d.dst;
+  }
+}
+
+int solarField(const SolarData &d, int i) {
+  return solarField(const_cast<SolarData &>(d), i);
+}
+
+void solarStress() {
+  SolarDataStore store;
+  uint64_t startVersion = store.version();
+  std::atomic<bool> done{false};
+  std::atomic<int> backwards{0};
+
+  std::vector<std::thread> readers;
+  for (int r = 0; r < kReaders; ++r) {
+    readers.emplace_back([&] {
+      int last[kSolarFields] = {};
+      uint64_t lastVersion = 0;
+      while (!done.load(std::memory_order_acquire)) {
+        uint64_t v = store.version();
+        auto snap = store.snapshot();
+        if (v < lastVersion)
+          backwards++;
+        lastVersion = v;
+        for (int i = 0; i < kSolarFields; ++i) {
+          int f = solarField(*snap, i);
+          if (f < last[i])
+            backwards++;
+          last[i] = f;
+        }
+      }
+    });
+  }
+
+  std::vector<std::thread> writers;
+  for (int i = 0; i < kSolarFields; ++i) {
+    writers.emplace_back([&store, i] {
+      for (int n = 0; n < kUpdatesPerWriter; ++n)
+        store.update([i](SolarData &d) {
+          solarField(d, i)++;
+          d.valid = true;
+        });
+    });
+  }
+  for (auto &t : writers)
+    t.join();
+  done.store(true, std::memory_order_release);
+  for (auto &t : readers)
+    t.join();
+
+  auto snap = store.snapshot();
+  for (int i = 0; i < kSolarFields; ++i)
+    CHECK_EQ(solarField(*snap, i), kUpdatesPerWriter);
+  CHECK(snap->valid);
+  CHECK_EQ(store.version() - startVersion,
+           static_cast<uint64_t>(kSolarFields) * kUpdatesPerWriter);
+  CHECK_EQ(backwards.load(), 0);
+}
+
+// Two writers append to their own list, a third stamps lastUpdated.
+void activityStress() {
+  constexpr int kPerList = 5000;
+  ActivityDataStore store;
+
+  std::thread peds([&] {
+    for (int n = 0; n < kPerList; ++n)
+      store.update([n](ActivityData &d) {
+        DXPedition p;
+        p.call = "DX" + std::to_string(n);
+        d.dxpeds.push_back(std::move(p));
+      });
+  });
+  std::thread spots([&] {
+    for (int n = 0; n < kPerList; ++n)
+      store.update([n](ActivityData &d) {
+        ONTASpot s;
+        s.call = "K" + std::to_string(n);
+        s.freqKhz = 14000 + n;
+        d.ontaSpots.push_back(std::move(s));
+      });
+  });
+  std::thread stamps([&] {
+    for (int n = 0; n < kPerList; ++n)
+      store.update([](ActivityData &d) {
+        d.lastUpdated = std::chrono::system_clock::now();
+        d.valid = true;
+      });
+  });
+  peds.join();
+  spots.join();
+  stamps.join();
+
+  auto snap = store.snapshot();
+  CHECK_EQ(snap->dxpeds.size(), static_cast<size_t>(kPerList));
+  CHECK_EQ(snap->ontaSpots.size(), static_cast<size_t>(kPerList));
+  CHECK(snap->valid);
+  // Each writer's own entries stay in its order.
+  bool ordered = true;
+  for (int n = 0; n < kPerList && n < static_cast<int>(snap->dxpeds.size());
+       ++n)
+    ordered = ordered && snap->dxpeds[n].call == "DX" + std::to_string(n);
+  CHECK(ordered);
+}
+
+} // namespace
+
+int main() {
+  solarStress();
+  activityStress();
+  return checkResult("test-store-stress");
+}
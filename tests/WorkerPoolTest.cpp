@@ -0,0 +1,64 @@
+// WorkerPool queue isolation: a resolve must not wait behind IO workers
+// that are all blocked in slow transfers.
+
+#include "Check.h"
+
+#include "core/Logger.h"
+#include "core/WorkerPool.h"
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+
+namespace {
+
+void resolveBypassesBusyIo() {
+  auto &pool = WorkerPool::instance();
+  std::atomic<bool> release{false};
+  std::atomic<int> blocked{0};
+  // Every IO worker busy, and more fetches queued behind them.
+  for (size_t i = 0; i < WorkerPool::kIoWorkers * 2; ++i)
+    pool.submit(WorkerPool::Queue::IO, [&] {
+      blocked++;
+      while (!release.load())
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+  while (blocked.load() < static_cast<int>(WorkerPool::kIoWorkers))
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  // A long maintenance job on the resolve queue leaves the other worker
+  // free, and a resolve goes ahead of anything queued at lower priority.
+  std::atomic<bool> maintaining{false};
+  pool.submit(
+      WorkerPool::Queue::Resolve,
+      [&] {
+        maintaining = true;
+        while (!release.load())
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      },
+      WorkerPool::Priority::Low);
+  while (!maintaining.load())
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  std::atomic<bool> resolved{false};
+  auto t0 = std::chrono::steady_clock::now();
+  pool.submit(
+      WorkerPool::Queue::Resolve, [&] { resolved = true; },
+      WorkerPool::Priority::High);
+  while (!resolved.load() && secondsSince(t0) < 2)
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  CHECK(resolved.load());
+  CHECK(secondsSince(t0) < 0.5);
+
+  release = true;
+}
+
+} // namespace
+
+int main() {
+  Log::init(std::filesystem::temp_directory_path().string());
+  resolveBypassesBusyIo();
+  WorkerPool::instance().shutdown();
+  return checkResult("test-worker-pool");
+}
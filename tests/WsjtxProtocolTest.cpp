@@ -0,0 +1,404 @@
+// Wsjtx: every message type built with Writer and read back by parse(),
+// the shorter messages older schema-2 senders send, every truncation of
+// each message, QDateTime values from a null date to one far past int64_t
+// milliseconds, and messageSender() on the messages WSJT-X decodes.
+
+#include "Check.h"
+
+#include "services/WsjtxProtocol.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace Wsjtx;
+
+constexpr int64_t kOffMs = 1760000123456; // 2025-10-09 08:55:23.456 UTC
+constexpr int64_t kOnMs = kOffMs - 95000;
+constexpr int64_t kUnixEpochJulianDay = 2440588;
+
+bool parsed(const std::string &d, Message &m) {
+  m = Message();
+  return parse(d.data(), d.size(), m);
+}
+
+constexpr const char *kAdif = "<call:6>JA1ZZZ<band:3>20m<mode:3>FT8<eor>";
+
+void checkHeartbeat(const Message &m) {
+  CHECK_EQ(m.heartbeat.maxSchema, 3u);
+  CHECK(m.heartbeat.version == "2.7.0");
+  CHECK(m.heartbeat.revision == "a1b2c3");
+}
+
+void checkStatus(const Message &m) {
+  const Status &s = m.status;
+  CHECK_EQ(s.dialHz, uint64_t{14074000});
+  CHECK(s.mode == "FT8");
+  CHECK(s.dxCall == "JA1ZZZ");
+  CHECK(s.report == "-12");
+  CHECK(s.txEnabled);
+  CHECK(!s.transmitting);
+  CHECK(s.decoding);
+  CHECK_EQ(s.rxDfHz, 1500u);
+  CHECK_EQ(s.txDfHz, 1200u);
+  CHECK(s.deCall == "K1ABC");
+  CHECK(s.deGrid == "FN42");
+  CHECK(s.dxGrid == "PM95");
+  CHECK_EQ(s.frequencyTolerance, 10u);
+  CHECK_EQ(s.trPeriodSecs, 15u);
+  CHECK(s.configurationName == "IC7300");
+  CHECK(s.txMessage == "JA1ZZZ K1ABC FN42");
+}
+
+void checkDecode(const Message &m) {
+  const Decode &d = m.decode;
+  CHECK(d.isNew);
+  CHECK_EQ(d.timeMs, 31245000u);
+  CHECK_EQ(d.snr, -17);
+  CHECK(d.dtSecs == 0.3);
+  CHECK_EQ(d.dfHz, 1234u);
+  CHECK(d.mode == "~");
+  CHECK(d.message == "CQ JA1ZZZ PM95");
+  CHECK(d.lowConfidence);
+  CHECK(!d.offAir);
+}
+
+void checkQSOLogged(const Message &m) {
+  const QSOLogged &q = m.qso;
+  CHECK_EQ(q.offMs, kOffMs);
+  CHECK(q.dxCall == "JA1ZZZ");
+  CHECK(q.dxGrid == "PM95");
+  CHECK_EQ(q.txHz, uint64_t{14075234});
+  CHECK(q.mode == "FT8");
+  CHECK(q.reportSent == "-12");
+  CHECK(q.reportReceived == "-08");
+  CHECK(q.txPower == "100");
+  CHECK(q.comments == "tnx");
+  CHECK(q.name == "Taro");
+  CHECK_EQ(q.onMs, kOnMs);
+  CHECK(q.operatorCall == "K1ABC");
+  CHECK(q.myGrid == "FN42");
+  CHECK(q.exchangeSent == "599 MA");
+  CHECK(q.exchangeReceived == "599 13");
+  CHECK(q.propagationMode.empty());
+}
+
+void checkWSPRDecode(const Message &m) {
+  const WSPRDecode &w = m.wspr;
+  CHECK(!w.isNew);
+  CHECK_EQ(w.timeMs, 3600000u);
+  CHECK_EQ(w.snr, -24);
+  CHECK(w.dtSecs == -1.1);
+  CHECK_EQ(w.freqHz, uint64_t{14097063});
+  CHECK_EQ(w.driftHz, -1);
+  CHECK(w.call == "VK6ABC");
+  CHECK(w.grid == "OF87");
+  CHECK_EQ(w.powerDbm, 37);
+  CHECK(w.offAir);
+}
+
+void checkLoggedADIF(const Message &m) { CHECK(m.adif == kAdif); }
+
+// A datagram twice: as the newest WSJT-X sends it and cut after the fields
+// every version sends, with what parse() must give for the full one.
+struct Case {
+  Type type;
+  std::string full;
+  std::string required;
+  void (*check)(const Message &);
+};
+
+std::vector<Case> cases() {
+  std::vector<Case> all;
+
+  Writer hb(Type::Heartbeat, "WSJT-X");
+  hb.u32(3);
+  std::string hbRequired = hb.data();
+  hb.utf8("2.7.0").utf8("a1b2c3");
+  all.push_back({Type::Heartbeat, hb.data(), hbRequired, checkHeartbeat});
+
+  Writer st(Type::Status, "WSJT-X - IC7300");
+  st.u64(14074000).utf8("FT8").utf8("JA1ZZZ").utf8("-12").utf8("FT8");
+  st.boolean(true).boolean(false);
+  std::string stRequired = st.data();
+  st.boolean(true).u32(1500).u32(1200).utf8("K1ABC").utf8("FN42");
+  st.utf8("PM95").boolean(false).utf8("").boolean(false).u8(0);
+  st.u32(10).u32(15).utf8("IC7300").utf8("JA1ZZZ K1ABC FN42");
+  all.push_back({Type::Status, st.data(), stRequired, checkStatus});
+
+  Writer de(Type::Decode, "JTDX");
+  de.boolean(true).u32(31245000).i32(-17).f64(0.3).u32(1234).utf8("~");
+  de.utf8("CQ JA1ZZZ PM95");
+  std::string deRequired = de.data();
+  de.boolean(true).boolean(false);
+  all.push_back({Type::Decode, de.data(), deRequired, checkDecode});
+
+  std::string clear = Writer(Type::Clear, "WSJT-X").data();
+  all.push_back({Type::Clear, clear, clear, nullptr});
+
+  // Reply, Replay and the rest go from a server to WSJT-X; only their
+  // header is read.
+  Writer re(Type::Reply, "WSJT-X");
+  std::string reRequired = re.data();
+  re.u32(31245000).i32(-17).f64(0.3).u32(1234).utf8("~");
+  re.utf8("CQ JA1ZZZ PM95").boolean(false).u8(0);
+  all.push_back({Type::Reply, re.data(), reRequired, nullptr});
+
+  Writer qso(Type::QSOLogged, "WSJT-X");
+  qso.dateTime(kOffMs).utf8("JA1ZZZ").utf8("PM95").u64(14075234);
+  qso.utf8("FT8").utf8("-12").utf8("-08").utf8("100").utf8("tnx");
+  qso.utf8("Taro");
+  std::string qsoRequired = qso.data();
+  qso.dateTime(kOnMs).utf8("K1ABC").utf8("K1ABC").utf8("FN42");
+  qso.utf8("599 MA").utf8("599 13").utf8("");
+  all.push_back({Type::QSOLogged, qso.data(), qsoRequired, checkQSOLogged});
+
+  for (Type t : {Type::Close, Type::Replay, Type::HaltTx}) {
+    std::string header = Writer(t, "WSJT-X").data();
+    all.push_back({t, header, header, nullptr});
+  }
+
+  Writer ft(Type::FreeText, "WSJT-X");
+  std::string ftRequired = ft.data();
+  ft.utf8("TNX 73 GL").boolean(true);
+  all.push_back({Type::FreeText, ft.data(), ftRequired, nullptr});
+
+  Writer ws(Type::WSPRDecode, "WSJT-X");
+  ws.boolean(false).u32(3600000).i32(-24).f64(-1.1).u64(14097063);
+  ws.i32(-1).utf8("VK6ABC").utf8("OF87").i32(37);
+  std::string wsRequired = ws.data();
+  ws.boolean(true);
+  all.push_back({Type::WSPRDecode, ws.data(), wsRequired, checkWSPRDecode});
+
+  for (Type t : {Type::Location, Type::HighlightCallsign,
+                 Type::SwitchConfiguration, Type::Configure}) {
+    Writer w(t, "WSJT-X");
+    std::string header = w.data();
+    w.utf8("FN42").utf8("IC7300");
+    all.push_back({t, w.data(), header, nullptr});
+  }
+
+  Writer ad(Type::LoggedADIF, "WSJT-X");
+  ad.utf8(kAdif);
+  all.push_back({Type::LoggedADIF, ad.data(), ad.data(), checkLoggedADIF});
+  return all;
+}
+
+const Case &caseOf(const std::vector<Case> &all, Type type) {
+  for (const Case &c : all)
+    if (c.type == type)
+      return c;
+  return all.front();
+}
+
+void roundTrip(const std::vector<Case> &all) {
+  for (const Case &c : all) {
+    Message m;
+    bool ok = parsed(c.full, m);
+    CHECK(ok);
+    CHECK(isMessage(c.full.data(), c.full.size()));
+    if (!ok)
+      continue;
+    CHECK_EQ(m.schema, kSchema);
+    CHECK_EQ(m.type, c.type);
+    CHECK(!m.id.empty());
+    if (c.check)
+      c.check(m);
+  }
+}
+
+// What a WSJT-X 1.x sender stops at: the fields added since read as their
+// defaults.
+void shortMessages(const std::vector<Case> &all) {
+  for (const Case &c : all) {
+    Message m;
+    CHECK(parsed(c.required, m));
+  }
+  Message m;
+  CHECK(parsed(caseOf(all, Type::Heartbeat).required, m));
+  CHECK_EQ(m.heartbeat.maxSchema, 3u);
+  CHECK(m.heartbeat.version.empty());
+
+  CHECK(parsed(caseOf(all, Type::Status).required, m));
+  CHECK(m.status.dxCall == "JA1ZZZ");
+  CHECK(!m.status.decoding);
+  CHECK(m.status.deCall.empty());
+  CHECK_EQ(m.status.trPeriodSecs, 0u);
+
+  CHECK(parsed(caseOf(all, Type::Decode).required, m));
+  CHECK(m.decode.message == "CQ JA1ZZZ PM95");
+  CHECK(!m.decode.lowConfidence);
+
+  CHECK(parsed(caseOf(all, Type::QSOLogged).required, m));
+  CHECK_EQ(m.qso.offMs, kOffMs);
+  CHECK(m.qso.name == "Taro");
+  CHECK_EQ(m.qso.onMs, int64_t{0});
+  CHECK(m.qso.myCall.empty());
+
+  // A null string is an empty view, not a failure.
+  Writer w(Type::Decode, "WSJT-X");
+  w.boolean(true).u32(0).i32(0).f64(0).u32(0).u32(0xFFFFFFFF);
+  w.utf8("CQ K1ABC FN42");
+  CHECK(parsed(w.data(), m));
+  CHECK(m.decode.mode.empty());
+  CHECK(m.decode.message == "CQ K1ABC FN42");
+}
+
+// Every datagram cut at every length: parse() succeeds exactly when the
+// required fields are all there, and never reads past the end (run under
+// ASan to see that).
+void truncation(const std::vector<Case> &all) {
+  size_t wrong = 0, tried = 0;
+  for (const Case &c : all) {
+    for (size_t n = 0; n < c.full.size(); ++n) {
+      std::string cut = c.full.substr(0, n);
+      Message m;
+      bool ok = parse(cut.data(), cut.size(), m);
+      tried++;
+      if (ok != (n >= c.required.size())) {
+        wrong++;
+        std::fprintf(stderr, "type %u cut to %zu of %zu bytes: parse() %s\n",
+                     static_cast<unsigned>(c.type), n, c.full.size(),
+                     ok ? "true" : "false");
+      }
+    }
+  }
+  std::printf("%zu truncated datagrams, %zu answered wrongly\n", tried,
+              wrong);
+  CHECK_EQ(wrong, size_t{0});
+
+  const char bad[] = "\xAD\xBC\xCB\xDB\0\0\0\2\0\0\0\0\0\0\0\0";
+  Message m;
+  CHECK(!isMessage(bad, sizeof(bad) - 1));
+  CHECK(!parse(bad, sizeof(bad) - 1, m));
+  CHECK(!isMessage(bad, 3));
+}
+
+// offMs of a QSOLogged whose time is the raw QDateTime given.
+bool offTime(int64_t julianDay, uint32_t ms, uint8_t spec, int32_t offset,
+             int64_t &offMs) {
+  Writer w(Type::QSOLogged, "WSJT-X");
+  w.i64(julianDay).u32(ms).u8(spec);
+  if (spec == 2)
+    w.i32(offset);
+  w.utf8("JA1ZZZ").utf8("").u64(0);
+  for (int i = 0; i < 6; ++i)
+    w.utf8("");
+  Message m;
+  bool ok = parsed(w.data(), m);
+  offMs = m.qso.offMs;
+  return ok;
+}
+
+void dateTimes() {
+  int64_t t = -1;
+  CHECK(offTime(kUnixEpochJulianDay, 0, 1, 0, t));
+  CHECK_EQ(t, int64_t{0});
+  CHECK(offTime(kUnixEpochJulianDay + 20370, 32123456, 1, 0, t));
+  CHECK_EQ(t, kOffMs);
+  // Before 1970, as Writer::dateTime() puts it.
+  Message m;
+  Writer early(Type::QSOLogged, "WSJT-X");
+  early.dateTime(-86400000LL * 365 + 5).utf8("W1AW").utf8("").u64(0);
+  for (int i = 0; i < 6; ++i)
+    early.utf8("");
+  CHECK(parsed(early.data(), m));
+  CHECK_EQ(m.qso.offMs, -86400000LL * 365 + 5);
+  // Local time is taken as UTC; an offset is taken off.
+  CHECK(offTime(kUnixEpochJulianDay + 1, 1000, 0, 0, t));
+  CHECK_EQ(t, int64_t{86401000});
+  CHECK(offTime(kUnixEpochJulianDay + 1, 1000, 2, 3600, t));
+  CHECK_EQ(t, int64_t{86401000 - 3600000});
+  // A named time zone cannot be read.
+  CHECK(!offTime(kUnixEpochJulianDay, 0, 3, 0, t));
+
+  // Null dates, invalid times and days no clock reaches read as 0, not as
+  // a time computed from them.
+  constexpr int64_t kMax = std::numeric_limits<int64_t>::max();
+  constexpr int64_t kMin = std::numeric_limits<int64_t>::min();
+  for (int64_t day : {kMin, kMax, kMax / 86400000 + kUnixEpochJulianDay,
+                      kUnixEpochJulianDay + 2000000,
+                      kUnixEpochJulianDay - 2000000}) {
+    t = -1;
+    CHECK(offTime(day, 0, 1, 0, t));
+    CHECK_EQ(t, int64_t{0});
+  }
+  t = -1;
+  CHECK(offTime(kUnixEpochJulianDay, 0xFFFFFFFF, 1, 0, t));
+  CHECK_EQ(t, int64_t{0});
+}
+
+struct SenderCase {
+  const char *message;
+  const char *call; // nullptr = no sender
+  const char *grid;
+};
+
+const SenderCase kSenderCases[] = {
+    {"CQ K1ABC FN42", "K1ABC", "FN42"},
+    {"CQ DX K1ABC FN42", "K1ABC", "FN42"},
+    {"CQ POTA K1ABC FN42", "K1ABC", "FN42"},
+    {"CQ 290 K1ABC", "K1ABC", ""},
+    {"QRZ K1ABC FN42", "K1ABC", "FN42"},
+    {"CQ 4U1UN JN36", "4U1UN", "JN36"},
+    {"CQ K1ABC/P", "K1ABC/P", ""},
+    {"  CQ   K1ABC  FN42 ", "K1ABC", "FN42"},
+    {"K1ABC W9XYZ EN52", "W9XYZ", "EN52"},
+    {"K1ABC W9XYZ -12", "W9XYZ", ""},
+    {"K1ABC W9XYZ R-05", "W9XYZ", ""},
+    {"K1ABC W9XYZ RR73", "W9XYZ", ""},
+    {"K1ABC W9XYZ 73", "W9XYZ", ""},
+    {"<PJ4/K1ABC> W9XYZ RR73", "W9XYZ", ""},
+    {"W9XYZ <PJ4/K1ABC> RR73", "PJ4/K1ABC", ""},
+    {"<...> K1ABC", "K1ABC", ""},
+    {"<...> K1ABC FN42", "K1ABC", "FN42"},
+    {"DE K1ABC", "K1ABC", ""},
+    {"RR73", nullptr, nullptr},
+    {"CQ", nullptr, nullptr},
+    {"CQ DX", nullptr, nullptr},
+    {"", nullptr, nullptr},
+    {"TNX 73 GL", nullptr, nullptr},
+    {"K1ABC 599", nullptr, nullptr},
+    {"FN42 K1ABC", nullptr, nullptr},
+    {"k1abc w9xyz", nullptr, nullptr},
+};
+
+void senders() {
+  for (const auto &c : kSenderCases) {
+    std::string_view call = "x", grid = "x";
+    bool ok = messageSender(c.message, call, grid);
+    bool right = c.call ? ok && call == c.call && grid == c.grid : !ok;
+    ++g_checks;
+    if (!right) {
+      ++g_failures;
+      std::fprintf(stderr, "\"%s\": %s \"%.*s\" \"%.*s\", want %s\n",
+                   c.message, ok ? "true" : "false",
+                   static_cast<int>(call.size()), call.data(),
+                   static_cast<int>(grid.size()), grid.data(),
+                   c.call ? c.call : "false");
+    }
+  }
+
+  CHECK(modeFromCode("~") == "FT8");
+  CHECK(modeFromCode("+") == "FT4");
+  CHECK(modeFromCode("`") == "FST4");
+  CHECK(modeFromCode("").empty());
+  CHECK(modeFromCode("~~").empty());
+  CHECK(modeFromCode("x").empty());
+}
+
+} // namespace
+
+int main() {
+  std::vector<Case> all = cases();
+  roundTrip(all);
+  shortMessages(all);
+  truncation(all);
+  dateTimes();
+  senders();
+  return checkResult("test-wsjtx-protocol");
+}
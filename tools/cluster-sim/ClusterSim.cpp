@@ -0,0 +1,638 @@
+// Local DX cluster for load and soak testing.
+//
+// Serves generated spots over telnet (DX Spider or AR-Cluster login and line
+// format) and, optionally, as UDP datagrams, at a configurable rate with
+// injected faults. --drop and --login-delay play a node that refuses or
+// stalls new sessions, and each reconnect is logged with the time since the
+// same peer's previous one, so the client's backoff can be read off. With
+// --app it polls the app's /debug/widgets endpoint and
+// reports ingest latency and lost spots; with --pid, resident memory growth.
+//
+//   hamclock-cluster-sim --rate 50 --garbage 0.01 --partial 0.05
+//       --disconnect 300 --burst 500@60 --app http://127.0.0.1:8080
+//       --pid $(pidof hamclock-next)
+//   hamclock-cluster-sim --drop 0.5 --login-delay 3000
+
+#include "SpotGenerator.h"
+
+#include <nlohmann/json.hpp>
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Options {
+  int port = 7300;
+  Dialect dialect = Dialect::Spider;
+  double rate = 10;           // spots per second
+  std::string udpTarget;      // host:port
+  double garbage = 0;         // probability per spot
+  double partial = 0;         // probability a write ends mid-line
+  int disconnectSecs = 0;     // drop one client this often
+  double drop = 0;            // probability a new connection is closed
+  int loginDelayMs = 0;       // wait before the login prompt
+  int burstSpots = 0;         // extra spots ...
+  int burstSecs = 0;          // ... every this many seconds
+  int reportSecs = 10;
+  std::string app;            // http://host:port of a debug API build
+  int pid = 0;
+  int durationSecs = 0;       // 0 = until interrupted
+  uint32_t seed = 1;
+  size_t pool = 2000;         // active DX stations
+};
+
+struct Counters {
+  std::atomic<uint64_t> spots{0};
+  std::atomic<uint64_t> delivered{0}; // spot lines written, all clients
+  std::atomic<uint64_t> garbage{0};
+  std::atomic<uint64_t> partials{0};
+  std::atomic<uint64_t> disconnects{0};
+  std::atomic<uint64_t> udpSent{0};
+};
+
+struct Client {
+  int fd = -1;
+  std::string peer;
+  std::string call;
+  std::atomic<bool> loggedIn{false};
+  std::atomic<bool> closed{false};
+  std::mutex writeMutex;
+  std::string held; // tail of a line cut short by --partial
+};
+
+std::atomic<bool> g_stop{false};
+
+void usage() {
+  std::fprintf(
+      stderr,
+      "usage: hamclock-cluster-sim [options]\n"
+      "  --port N           telnet port (7300)\n"
+      "  --dialect D        spider | arcluster (spider)\n"
+      "  --rate R           spots per second, may be fractional (10)\n"
+      "  --udp HOST:PORT    also send each spot as a UDP datagram\n"
+      "  --garbage P        probability of a garbage line per spot (0)\n"
+      "  --partial P        probability a write ends mid-line (0)\n"
+      "  --disconnect S     drop one client every S seconds (off)\n"
+      "  --drop P           probability a new connection is closed (0)\n"
+      "  --login-delay MS   wait MS before the login prompt (0)\n"
+      "  --burst N@S        send N extra spots every S seconds (off)\n"
+      "  --report S         report interval in seconds (10)\n"
+      "  --app URL          poll URL/debug/widgets for ingest stats\n"
+      "  --pid PID          report resident memory of PID\n"
+      "  --duration S       stop after S seconds (run until ^C)\n"
+      "  --seed N           random seed (1)\n"
+      "  --pool N           active DX stations (2000)\n");
+}
+
+bool parseOptions(int argc, char **argv, Options &o) {
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (i + 1 >= argc) {
+      usage();
+      return false;
+    }
+    std::string v = argv[++i];
+    if (arg == "--port") {
+      o.port = std::atoi(v.c_str());
+    } else if (arg == "--dialect") {
+      if (v == "spider")
+        o.dialect = Dialect::Spider;
+      else if (v == "arcluster")
+        o.dialect = Dialect::ARCluster;
+      else
+        return usage(), false;
+    } else if (arg == "--rate") {
+      o.rate = std::atof(v.c_str());
+    } else if (arg == "--udp") {
+      o.udpTarget = v;
+    } else if (arg == "--garbage") {
+      o.garbage = std::atof(v.c_str());
+    } else if (arg == "--partial") {
+      o.partial = std::atof(v.c_str());
+    } else if (arg == "--disconnect") {
+      o.disconnectSecs = std::atoi(v.c_str());
+    } else if (arg == "--drop") {
+      o.drop = std::atof(v.c_str());
+    } else if (arg == "--login-delay") {
+      o.loginDelayMs = std::max(0, std::atoi(v.c_str()));
+    } else if (arg == "--burst") {
+      if (std::sscanf(v.c_str(), "%d@%d", &o.burstSpots, &o.burstSecs) != 2)
+        return usage(), false;
+    } else if (arg == "--report") {
+      o.reportSecs = std::max(1, std::atoi(v.c_str()));
+    } else if (arg == "--app") {
+      o.app = v;
+    } else if (arg == "--pid") {
+      o.pid = std::atoi(v.c_str());
+    } else if (arg == "--duration") {
+      o.durationSecs = std::atoi(v.c_str());
+    } else if (arg == "--seed") {
+      o.seed = static_cast<uint32_t>(std::strtoul(v.c_str(), nullptr, 10));
+    } else if (arg == "--pool") {
+      o.pool = std::max<size_t>(1, std::strtoul(v.c_str(), nullptr, 10));
+    } else {
+      usage();
+      return false;
+    }
+  }
+  return true;
+}
+
+bool splitHostPort(const std::string &s, std::string &host,
+                   std::string &port) {
+  size_t colon = s.rfind(':');
+  if (colon == std::string::npos || colon == 0)
+    return false;
+  host = s.substr(0, colon);
+  port = s.substr(colon + 1);
+  return true;
+}
+
+int connectTcp(const std::string &host, const std::string &port) {
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo *res = nullptr;
+  if (getaddrinfo(host.c_str(), port.c_str(), &hints, &res) != 0)
+    return -1;
+  int fd = -1;
+  for (addrinfo *ai = res; ai; ai = ai->ai_next) {
+    fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    if (fd < 0)
+      continue;
+    if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0)
+      break;
+    close(fd);
+    fd = -1;
+  }
+  freeaddrinfo(res);
+  return fd;
+}
+
+bool sendAll(int fd, const std::string &data) {
+  size_t off = 0;
+  while (off < data.size()) {
+    ssize_t n = send(fd, data.data() + off, data.size() - off, MSG_NOSIGNAL);
+    if (n <= 0)
+      return false;
+    off += static_cast<size_t>(n);
+  }
+  return true;
+}
+
+// Reads one line of input, dropping telnet IAC sequences.
+bool readLine(int fd, std::string &line) {
+  line.clear();
+  char c;
+  while (recv(fd, &c, 1, 0) == 1) {
+    if (static_cast<unsigned char>(c) == 0xff) {
+      char opt[2];
+      if (recv(fd, opt, 2, MSG_WAITALL) != 2)
+        return false;
+      continue;
+    }
+    if (c == '\n')
+      return true;
+    if (c != '\r' && line.size() < 256)
+      line += c;
+  }
+  return false;
+}
+
+class Server {
+public:
+  explicit Server(const Options &opt)
+      : opt_(opt), dropRng_(opt.seed ^ 0xd50) {}
+
+  bool listen() {
+    listenFd_ = socket(AF_INET6, SOCK_STREAM, 0);
+    if (listenFd_ < 0)
+      return false;
+    int on = 1, off = 0;
+    setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    setsockopt(listenFd_, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+    sockaddr_in6 addr{};
+    addr.sin6_family = AF_INET6;
+    addr.sin6_addr = in6addr_any;
+    addr.sin6_port = htons(static_cast<uint16_t>(opt_.port));
+    if (bind(listenFd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) <
+            0 ||
+        ::listen(listenFd_, 16) < 0) {
+      std::perror("listen");
+      return false;
+    }
+    acceptThread_ = std::thread(&Server::acceptLoop, this);
+    return true;
+  }
+
+  void stop() {
+    shutdown(listenFd_, SHUT_RDWR);
+    close(listenFd_);
+    if (acceptThread_.joinable())
+      acceptThread_.join();
+    std::lock_guard<std::mutex> lock(clientsMutex_);
+    for (auto &c : clients_)
+      shutdown(c->fd, SHUT_RDWR);
+    for (auto &t : sessionThreads_)
+      if (t.joinable())
+        t.join();
+  }
+
+  // Sends one line to every logged-in client. 'cut' is where to end this
+  // write early, or 0 to send the whole line. Returns the number of clients
+  // written to.
+  int broadcast(const std::string &line, size_t cut) {
+    int sent = 0;
+    std::vector<std::shared_ptr<Client>> targets = liveClients();
+    for (auto &c : targets) {
+      if (!c->loggedIn)
+        continue;
+      std::lock_guard<std::mutex> lock(c->writeMutex);
+      std::string out = std::move(c->held);
+      c->held.clear();
+      out += line;
+      out += "\r\n";
+      if (cut > 0 && cut < line.size()) {
+        size_t keep = line.size() + 2 - cut;
+        c->held = out.substr(out.size() - keep);
+        out.resize(out.size() - keep);
+      }
+      if (sendAll(c->fd, out))
+        sent++;
+      else
+        drop(*c);
+    }
+    return sent;
+  }
+
+  // Closes one connected client, as a cluster node restart would.
+  bool disconnectOne(std::mt19937 &rng) {
+    std::vector<std::shared_ptr<Client>> targets = liveClients();
+    if (targets.empty())
+      return false;
+    auto &c = targets[rng() % targets.size()];
+    std::fprintf(stderr, "disconnecting %s (%s)\n", c->peer.c_str(),
+                 c->call.c_str());
+    drop(*c);
+    return true;
+  }
+
+  size_t clientCount() { return liveClients().size(); }
+  uint64_t refused() const { return refused_; }
+
+private:
+  std::vector<std::shared_ptr<Client>> liveClients() {
+    std::lock_guard<std::mutex> lock(clientsMutex_);
+    std::vector<std::shared_ptr<Client>> out;
+    for (auto &c : clients_)
+      if (!c->closed)
+        out.push_back(c);
+    return out;
+  }
+
+  static void drop(Client &c) {
+    if (!c.closed.exchange(true))
+      shutdown(c.fd, SHUT_RDWR);
+  }
+
+  void acceptLoop() {
+    while (!g_stop) {
+      sockaddr_storage peer{};
+      socklen_t len = sizeof(peer);
+      int fd = accept(listenFd_, reinterpret_cast<sockaddr *>(&peer), &len);
+      if (fd < 0)
+        break;
+      char host[NI_MAXHOST] = "?";
+      getnameinfo(reinterpret_cast<sockaddr *>(&peer), len, host,
+                  sizeof(host), nullptr, 0, NI_NUMERICHOST);
+      // The time since this peer's last connection is the client's
+      // reconnect delay, whether that one was refused or dropped later.
+      auto now = std::chrono::steady_clock::now();
+      auto last = lastConnect_.find(host);
+      if (last != lastConnect_.end())
+        std::fprintf(stderr, "%s reconnected after %.1fs\n", host,
+                     std::chrono::duration<double>(now - last->second)
+                         .count());
+      lastConnect_[host] = now;
+      if (opt_.drop > 0 && dropDist_(dropRng_) < opt_.drop) {
+        std::fprintf(stderr, "refusing %s\n", host);
+        refused_++;
+        close(fd);
+        continue;
+      }
+      auto c = std::make_shared<Client>();
+      c->fd = fd;
+      c->peer = host;
+      std::lock_guard<std::mutex> lock(clientsMutex_);
+      // Forget clients whose sessions have ended.
+      std::erase_if(clients_, [](const auto &x) { return x->closed.load(); });
+      clients_.push_back(c);
+      sessionThreads_.emplace_back(&Server::session, this, c);
+    }
+  }
+
+  void send(Client &c, const std::string &text) {
+    std::lock_guard<std::mutex> lock(c.writeMutex);
+    if (!sendAll(c.fd, text))
+      drop(c);
+  }
+
+  void session(std::shared_ptr<Client> c) {
+    bool spider = opt_.dialect == Dialect::Spider;
+    // A slow node: the client must wait for the prompt, not give up.
+    auto promptAt = std::chrono::steady_clock::now() +
+                    std::chrono::milliseconds(opt_.loginDelayMs);
+    while (!c->closed && !g_stop &&
+           std::chrono::steady_clock::now() < promptAt)
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    send(*c, spider ? "Please enter your call: " : "login: ");
+    std::string line;
+    while (c->call.empty()) {
+      if (!readLine(c->fd, line))
+        break;
+      c->call = line;
+    }
+    if (!c->call.empty()) {
+      std::fprintf(stderr, "%s logged in as %s\n", c->peer.c_str(),
+                   c->call.c_str());
+      send(*c, "Hello " + c->call + ", this is SIM-2 in the sandbox\r\n" +
+                   (spider ? c->call + " de SIM-2 >\r\n"
+                           : "AR-Cluster node SIM-2\r\n"));
+      c->loggedIn = true;
+    }
+
+    // Commands: only sh/dx gets an answer, as Spider formats it.
+    while (!c->closed && readLine(c->fd, line)) {
+      if (line.rfind("sh/dx", 0) == 0) {
+        int n = std::max(1, std::min(100, std::atoi(line.c_str() + 5)));
+        std::lock_guard<std::mutex> lock(genMutex_);
+        std::string out;
+        std::time_t now = std::time(nullptr);
+        for (int i = 0; i < n; ++i) {
+          std::string s = gen_.next(Dialect::Spider, now);
+          // "  14025.0  K1ABC   01-Jan-2026 1200Z  comment  <K1TTT>"
+          out += "  " + s.substr(s.find(':') + 1) + "\r\n";
+        }
+        send(*c, out);
+      } else if (!line.empty()) {
+        send(*c, c->call + " de SIM-2 >\r\n");
+      }
+    }
+    drop(*c);
+    close(c->fd);
+  }
+
+  const Options &opt_;
+  int listenFd_ = -1;
+  std::thread acceptThread_;
+  std::mutex clientsMutex_;
+  std::vector<std::shared_ptr<Client>> clients_;
+  std::vector<std::thread> sessionThreads_;
+  // Accept thread only.
+  std::map<std::string, std::chrono::steady_clock::time_point> lastConnect_;
+  std::mt19937 dropRng_;
+  std::uniform_real_distribution<double> dropDist_{0.0, 1.0};
+  std::atomic<uint64_t> refused_{0};
+  std::mutex genMutex_;
+  SpotGenerator gen_{0xC0FFEE, 500}; // sh/dx replies only
+};
+
+class UdpSender {
+public:
+  bool open(const std::string &target) {
+    std::string host, port;
+    if (!splitHostPort(target, host, port))
+      return false;
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo *res = nullptr;
+    if (getaddrinfo(host.c_str(), port.c_str(), &hints, &res) != 0)
+      return false;
+    fd_ = socket(res->ai_family, SOCK_DGRAM, 0);
+    std::memcpy(&addr_, res->ai_addr, res->ai_addrlen);
+    addrLen_ = res->ai_addrlen;
+    freeaddrinfo(res);
+    return fd_ >= 0;
+  }
+  bool send(const std::string &line) {
+    std::string dgram = line + "\r\n";
+    return sendto(fd_, dgram.data(), dgram.size(), 0,
+                  reinterpret_cast<sockaddr *>(&addr_), addrLen_) > 0;
+  }
+  bool isOpen() const { return fd_ >= 0; }
+
+private:
+  int fd_ = -1;
+  sockaddr_storage addr_{};
+  socklen_t addrLen_ = 0;
+};
+
+// GET url/debug/widgets and return the DX Cluster panel's data, or null.
+nlohmann::json fetchIngest(const std::string &url) {
+  std::string rest = url.rfind("http://", 0) == 0 ? url.substr(7) : url;
+  rest = rest.substr(0, rest.find('/'));
+  std::string host, port;
+  if (!splitHostPort(rest, host, port)) {
+    host = rest;
+    port = "80";
+  }
+  int fd = connectTcp(host, port);
+  if (fd < 0)
+    return nullptr;
+  timeval tv{5, 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+  sendAll(fd, "GET /debug/widgets HTTP/1.0\r\nHost: " + host +
+                  "\r\nConnection: close\r\n\r\n");
+  std::string resp;
+  char buf[8192];
+  ssize_t n;
+  while ((n = recv(fd, buf, sizeof(buf), 0)) > 0)
+    resp.append(buf, static_cast<size_t>(n));
+  close(fd);
+
+  size_t body = resp.find("\r\n\r\n");
+  if (body == std::string::npos)
+    return nullptr;
+  auto j = nlohmann::json::parse(resp.substr(body + 4), nullptr, false);
+  if (!j.is_object())
+    return nullptr;
+  for (auto &[id, widget] : j.items()) {
+    if (widget.contains("data") && widget["data"].is_object() &&
+        widget["data"].contains("ingest"))
+      return widget["data"];
+  }
+  return nullptr;
+}
+
+// Resident set size of 'pid' in kB, or 0.
+long residentKb(int pid) {
+  std::ifstream f("/proc/" + std::to_string(pid) + "/status");
+  std::string line;
+  while (std::getline(f, line)) {
+    if (line.rfind("VmRSS:", 0) == 0)
+      return std::atol(line.c_str() + 6);
+  }
+  return 0;
+}
+
+class Reporter {
+public:
+  Reporter(const Options &opt, Counters &counters, Server &server)
+      : opt_(opt), counters_(counters), server_(server) {}
+
+  void report(double elapsed) {
+    uint64_t sent = counters_.spots;
+    std::printf("[%6.0fs] sent %llu (%.1f/s) garbage %llu partial %llu "
+                "disconnects %llu refused %llu udp %llu clients %zu\n",
+                elapsed, static_cast<unsigned long long>(sent),
+                (sent - lastSent_) / double(opt_.reportSecs),
+                static_cast<unsigned long long>(counters_.garbage.load()),
+                static_cast<unsigned long long>(counters_.partials.load()),
+                static_cast<unsigned long long>(counters_.disconnects.load()),
+                static_cast<unsigned long long>(server_.refused()),
+                static_cast<unsigned long long>(counters_.udpSent.load()),
+                server_.clientCount());
+    lastSent_ = sent;
+
+    if (!opt_.app.empty()) {
+      nlohmann::json d = fetchIngest(opt_.app);
+      if (d.is_null()) {
+        std::printf("         app: no DX Cluster panel data at %s\n",
+                    opt_.app.c_str());
+      } else {
+        uint64_t received = 0;
+        for (const auto &s : d.value("sources", nlohmann::json::array()))
+          received += s.value("received", 0ull);
+        const auto &in = d["ingest"];
+        // Spots the app never counted: dropped on disconnect, garbled by
+        // a fault we injected, or still in flight.
+        long long lost =
+            static_cast<long long>(counters_.delivered + counters_.udpSent) -
+            static_cast<long long>(received);
+        std::printf("         app: received %llu lost %lld dropped %llu "
+                    "written %llu pending %llu latency %.1f ms (max %.1f)\n",
+                    static_cast<unsigned long long>(received), lost,
+                    in.value("dropped", 0ull), in.value("written", 0ull),
+                    in.value("pending", 0ull), in.value("lastLatencyMs", 0.0),
+                    in.value("maxLatencyMs", 0.0));
+      }
+    }
+
+    if (opt_.pid) {
+      long kb = residentKb(opt_.pid);
+      if (firstKb_ == 0)
+        firstKb_ = kb;
+      std::printf("         rss: %ld kB (%+ld kB since start)\n", kb,
+                  kb - firstKb_);
+    }
+    std::fflush(stdout);
+  }
+
+private:
+  const Options &opt_;
+  Counters &counters_;
+  Server &server_;
+  uint64_t lastSent_ = 0;
+  long firstKb_ = 0;
+};
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Options opt;
+  if (!parseOptions(argc, argv, opt))
+    return 2;
+  std::signal(SIGINT, [](int) { g_stop = true; });
+  std::signal(SIGTERM, [](int) { g_stop = true; });
+
+  SpotGenerator gen(opt.seed, opt.pool);
+  std::fprintf(stderr, "%zu prefixes, %zu exact calls, %zu cities\n",
+               gen.prefixCount(), gen.exactCallCount(), gen.cityCount());
+
+  Counters counters;
+  Server server(opt);
+  if (!server.listen())
+    return 1;
+  UdpSender udp;
+  if (!opt.udpTarget.empty() && !udp.open(opt.udpTarget)) {
+    std::fprintf(stderr, "bad --udp target %s\n", opt.udpTarget.c_str());
+    return 2;
+  }
+  std::fprintf(stderr, "listening on port %d, %.2f spots/s\n", opt.port,
+               opt.rate);
+
+  Reporter reporter(opt, counters, server);
+  std::mt19937 rng(opt.seed ^ 0x5eed);
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  using Clock = std::chrono::steady_clock;
+  const auto start = Clock::now();
+  double owed = 0; // spots due but not yet sent
+  double lastTick = 0, nextBurst = opt.burstSecs, nextDisconnect =
+                                                      opt.disconnectSecs;
+  double nextReport = opt.reportSecs;
+
+  while (!g_stop) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    double now =
+        std::chrono::duration<double>(Clock::now() - start).count();
+    owed += opt.rate * (now - lastTick);
+    lastTick = now;
+    if (opt.burstSecs > 0 && now >= nextBurst) {
+      owed += opt.burstSpots;
+      nextBurst += opt.burstSecs;
+    }
+
+    std::time_t wall = std::time(nullptr);
+    for (; owed >= 1; owed -= 1) {
+      if (opt.garbage > 0 && u(rng) < opt.garbage) {
+        server.broadcast(gen.garbage(), 0);
+        counters.garbage++;
+      }
+      std::string line = gen.next(opt.dialect, wall);
+      size_t cut = 0;
+      if (opt.partial > 0 && u(rng) < opt.partial) {
+        cut = 1 + rng() % (line.size() - 1);
+        counters.partials++;
+      }
+      counters.delivered += server.broadcast(line, cut);
+      counters.spots++;
+      if (udp.isOpen() && udp.send(line))
+        counters.udpSent++;
+    }
+
+    if (opt.disconnectSecs > 0 && now >= nextDisconnect) {
+      if (server.disconnectOne(rng))
+        counters.disconnects++;
+      nextDisconnect += opt.disconnectSecs;
+    }
+    if (now >= nextReport) {
+      reporter.report(now);
+      nextReport += opt.reportSecs;
+    }
+    if (opt.durationSecs > 0 && now >= opt.durationSecs)
+      break;
+  }
+
+  g_stop = true;
+  server.stop();
+  return 0;
+}
@@ -0,0 +1,283 @@
+#include "SpotGenerator.h"
+
+#include "core/CitiesData.h"
+#include "core/PrefixData.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+namespace {
+
+struct Band {
+  double cwStart; // CW and RTTY segments start here
+  double ft8Dial;
+  double ft4Dial;
+  double ssbStart; // 0 = no phone on this band
+  double weight;   // share of spots on a contest weekend
+};
+
+constexpr Band kSimBands[] = {
+    {1800, 1840, 1843, 1843, 2},         // 160m
+    {3500, 3573, 3575, 3600, 6},         // 80m
+    {7000, 7074, 7047.5, 7150, 18},      // 40m
+    {10100, 10136, 10140, 0, 4},         // 30m
+    {14000, 14074, 14080, 14150, 25},    // 20m
+    {18068, 18100, 18104, 18110, 6},     // 17m
+    {21000, 21074, 21140, 21200, 16},    // 15m
+    {24890, 24915, 24919, 24931, 3},     // 12m
+    {28000, 28074, 28180, 28300, 15},    // 10m
+    {50000, 50313, 50318, 50100, 5},     // 6m
+};
+
+enum Mode { CW, SSB, FT8, RTTY, FT4 };
+constexpr const char *kModes[] = {"CW", "SSB", "FT8", "RTTY", "FT4"};
+constexpr double kModeWeights[] = {45, 25, 20, 6, 4};
+
+constexpr const char *kCwComments[] = {"",        "599",      "TU",
+                                       "CQ TEST", "QSX UP 2", "tnx qso",
+                                       "loud",    "CW 5NN"};
+constexpr const char *kSsbComments[] = {"",           "59",    "CQ contest",
+                                        "up 5",       "SSB",   "thanks QSO",
+                                        "USB strong", "QRZ?"};
+
+// "Pop 3.8M" at the end of a city name -> 3800000.
+double cityPopulation(const char *name) {
+  const char *pop = std::strstr(name, "Pop ");
+  if (!pop)
+    return 1000;
+  char *end = nullptr;
+  double n = std::strtod(pop + 4, &end);
+  if (end && *end == 'K')
+    n *= 1e3;
+  else if (end && *end == 'M')
+    n *= 1e6;
+  return std::max(n, 1000.0);
+}
+
+std::string maidenhead4(double lat, double lon) {
+  double x = std::clamp(lon + 180.0, 0.0, 359.999);
+  double y = std::clamp(lat + 90.0, 0.0, 179.999);
+  char g[5] = {static_cast<char>('A' + static_cast<int>(x / 20)),
+               static_cast<char>('A' + static_cast<int>(y / 10)),
+               static_cast<char>('0' + static_cast<int>(std::fmod(x, 20) / 2)),
+               static_cast<char>('0' + static_cast<int>(std::fmod(y, 10))),
+               '\0'};
+  return g;
+}
+
+bool isAlnumUpper(const std::string &s) {
+  return std::all_of(s.begin(), s.end(), [](char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+  });
+}
+
+} // namespace
+
+SpotGenerator::SpotGenerator(uint32_t seed, size_t poolSize) : rng_(seed) {
+  loadPrefixes();
+  loadCities();
+  pool_.reserve(poolSize);
+  for (size_t i = 0; i < poolSize; ++i)
+    pool_.push_back(newStation());
+}
+
+void SpotGenerator::loadPrefixes() {
+  prefixesByLoc_.assign(g_PrefixLocationCount + 1, {});
+  // Depth-first walk; each entry carries the path to its node.
+  std::vector<std::pair<uint32_t, std::string>> stack = {{0, ""}};
+  while (!stack.empty()) {
+    auto [index, path] = std::move(stack.back());
+    stack.pop_back();
+    const StaticPrefixNode &node = g_PrefixTrie[index];
+    if (!path.empty() && isAlnumUpper(path)) {
+      // Skip "RK9H"-style prefixes, which would make calls like RK9H7WY.
+      bool digitInside = path.find_first_of("0123456789") < path.size() - 1 &&
+                         !std::isdigit(static_cast<unsigned char>(path.back()));
+      if (node.prefixLoc && path.size() <= 4 && !digitInside) {
+        prefixesByLoc_[node.prefixLoc].push_back(
+            static_cast<uint32_t>(prefixes_.size()));
+        prefixes_.push_back({path, node.prefixLoc});
+      }
+      if (node.exactLoc && path.size() >= 4)
+        exactCalls_.push_back(path);
+    }
+    for (uint32_t c = 0; c < node.numChildren; ++c) {
+      uint32_t child = node.firstChild + c;
+      stack.push_back({child, path + g_PrefixTrie[child].label});
+    }
+  }
+}
+
+void SpotGenerator::loadCities() {
+  std::vector<double> weights;
+  cities_.reserve(std::size(g_CityData));
+  weights.reserve(std::size(g_CityData));
+  for (const auto &c : g_CityData) {
+    // Nearest location that has prefixes to build calls from.
+    double best = 1e30;
+    uint16_t bestLoc = 0;
+    for (size_t i = 0; i < g_PrefixLocationCount; ++i) {
+      if (prefixesByLoc_[i + 1].empty())
+        continue;
+      double dLat = g_PrefixLocations[i].lat - c.lat;
+      double dLon = std::fabs(g_PrefixLocations[i].lon - c.lon);
+      dLon = std::min(dLon, 360.0 - dLon) * std::cos(c.lat * M_PI / 180.0);
+      double d = dLat * dLat + dLon * dLon;
+      if (d < best) {
+        best = d;
+        bestLoc = static_cast<uint16_t>(i + 1);
+      }
+    }
+    if (!bestLoc)
+      continue;
+    cities_.push_back({maidenhead4(c.lat, c.lon), bestLoc});
+    weights.push_back(cityPopulation(c.name));
+  }
+  cityPick_ = std::discrete_distribution<size_t>(weights.begin(),
+                                                 weights.end());
+}
+
+std::string SpotGenerator::makeCall(const Prefix &p) {
+  std::string call = p.text;
+  if (call.back() < '0' || call.back() > '9')
+    call += static_cast<char>('0' + rng_() % 10);
+  // Mostly 2x2 and 1x3 style suffixes.
+  int letters = std::discrete_distribution<int>({0, 10, 50, 40})(rng_);
+  for (int i = 0; i < letters; ++i)
+    call += static_cast<char>('A' + rng_() % 26);
+  return call;
+}
+
+SpotGenerator::Station SpotGenerator::newStation() {
+  static std::discrete_distribution<size_t> bandPick = [] {
+    std::vector<double> w;
+    for (const auto &b : kSimBands)
+      w.push_back(b.weight);
+    return std::discrete_distribution<size_t>(w.begin(), w.end());
+  }();
+  static std::discrete_distribution<int> modePick(std::begin(kModeWeights),
+                                                  std::end(kModeWeights));
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+
+  Station st;
+  if (!exactCalls_.empty() && u(rng_) < 0.1)
+    st.call = exactCalls_[rng_() % exactCalls_.size()];
+  else
+    st.call = makeCall(prefixes_[rng_() % prefixes_.size()]);
+
+  const Band &band = kSimBands[bandPick(rng_)];
+  st.mode = modePick(rng_);
+  if (st.mode == SSB && band.ssbStart == 0)
+    st.mode = CW;
+  switch (st.mode) {
+  case CW:
+    st.freqKhz = band.cwStart + 1 + std::round(u(rng_) * 600) / 10;
+    break;
+  case RTTY:
+    st.freqKhz = band.cwStart + 70 + std::round(u(rng_) * 300) / 10;
+    break;
+  case SSB:
+    st.freqKhz = band.ssbStart + std::round(u(rng_) * 150);
+    break;
+  case FT8:
+    st.freqKhz = band.ft8Dial + std::round(2 + u(rng_) * 28) / 10;
+    break;
+  default:
+    st.freqKhz = band.ft4Dial + std::round(2 + u(rng_) * 28) / 10;
+    break;
+  }
+  return st;
+}
+
+std::string SpotGenerator::spotter(const City &city, bool skimmer) {
+  const auto &candidates = prefixesByLoc_[city.loc];
+  std::string call = makeCall(prefixes_[candidates[rng_() % candidates.size()]]);
+  if (skimmer)
+    call += "-#";
+  return call;
+}
+
+std::string SpotGenerator::next(Dialect dialect, std::time_t now) {
+  std::uniform_real_distribution<double> u(0.0, 1.0);
+  // Stations come and go; the rest keep getting spotted.
+  size_t slot = static_cast<size_t>(pool_.size() * u(rng_) * u(rng_));
+  if (u(rng_) < 0.05)
+    pool_[slot] = newStation();
+  const Station &st = pool_[slot];
+
+  const City &city = cities_[cityPick_(rng_)];
+  bool skimmer = (st.mode == CW || st.mode == RTTY) && u(rng_) < 0.5;
+
+  char comment[64];
+  if (skimmer && st.mode == CW) {
+    std::snprintf(comment, sizeof(comment), "CW   %3d dB  %2d WPM  CQ",
+                  static_cast<int>(3 + rng_() % 35),
+                  static_cast<int>(18 + rng_() % 20));
+  } else if (skimmer) {
+    std::snprintf(comment, sizeof(comment), "RTTY %3d dB  45 BPS  CQ",
+                  static_cast<int>(3 + rng_() % 30));
+  } else if (st.mode == FT8 || st.mode == FT4) {
+    std::snprintf(comment, sizeof(comment), "%s %+d dB %d Hz",
+                  kModes[st.mode], -20 + static_cast<int>(rng_() % 30),
+                  static_cast<int>(300 + rng_() % 2400));
+  } else if (st.mode == RTTY) {
+    std::snprintf(comment, sizeof(comment), "RTTY CQ TEST");
+  } else if (st.mode == CW) {
+    std::snprintf(comment, sizeof(comment), "%s",
+                  kCwComments[rng_() % std::size(kCwComments)]);
+  } else {
+    std::snprintf(comment, sizeof(comment), "%s",
+                  kSsbComments[rng_() % std::size(kSsbComments)]);
+  }
+
+  std::tm tm{};
+  gmtime_r(&now, &tm);
+
+  // DX Spider:  "DX de KD0AA:     18100.0  JR1FYS       FT8 LOUD    2156Z"
+  // AR-Cluster appends the spotter's grid after the time.
+  std::string left = "DX de " + spotter(city, skimmer) + ":";
+  char freq[16];
+  std::snprintf(freq, sizeof(freq), "%.1f", st.freqKhz);
+  int pad = std::max(1, 24 - static_cast<int>(left.size() + std::strlen(freq)));
+  char line[160];
+  std::snprintf(line, sizeof(line), "%s%*s%s  %-12s %-30.30s %02d%02dZ",
+                left.c_str(), pad, "", freq, st.call.c_str(), comment,
+                tm.tm_hour, tm.tm_min);
+  std::string out = line;
+  if (dialect == Dialect::ARCluster)
+    out += " " + city.grid;
+  return out;
+}
+
+std::string SpotGenerator::garbage() {
+  std::string out;
+  switch (rng_() % 5) {
+  case 0: // binary noise, no line breaks
+    for (int n = 10 + rng_() % 190; n > 0; --n) {
+      char c = static_cast<char>(rng_() % 256);
+      out += c == '\n' || c == '\r' ? '?' : c;
+    }
+    break;
+  case 1: { // a spot cut short
+    std::string spot = next(Dialect::Spider, std::time(nullptr));
+    out = spot.substr(0, 6 + rng_() % (spot.size() - 6));
+    break;
+  }
+  case 2: // unparsable frequency
+    out = "DX de K1TTT:     14O25.x  K1ABC        CW 599   1200Z";
+    break;
+  case 3: // longer than the client's line buffer
+    out.assign(10000 + rng_() % 4000, 'X');
+    break;
+  default: // telnet option negotiation and a bare prefix
+    out = "\xff\xfb\x01\xff\xfb\x03DX de ";
+    break;
+  }
+  return out;
+}
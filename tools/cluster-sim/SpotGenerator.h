@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <random>
+#include <string>
+#include <vector>
+
+// Cluster spot line flavours the simulator can speak.
+enum class Dialect { Spider, ARCluster };
+
+// Makes plausible "DX de" lines from the built-in prefix and city tables.
+//
+// DX stations come from a pool of active stations, each sitting on one
+// frequency, so the same station is spotted again by different spotters the
+// way it is on a real contest weekend. Calls are built from real prefixes
+// (or are real calls from the exact-call list); spotters are placed in
+// cities weighted by population and get a prefix from the nearest entity.
+// About half the CW and RTTY spots come from skimmers ("-#" spotters with
+// the RBN comment format).
+class SpotGenerator {
+public:
+  SpotGenerator(uint32_t seed, size_t poolSize);
+
+  // A complete spot line without the line ending.
+  std::string next(Dialect dialect, std::time_t now);
+
+  // A line the client has to survive: binary noise, a truncated spot, a
+  // spot with a bad frequency, or a line longer than any receive buffer.
+  std::string garbage();
+
+  size_t prefixCount() const { return prefixes_.size(); }
+  size_t exactCallCount() const { return exactCalls_.size(); }
+  size_t cityCount() const { return cities_.size(); }
+
+private:
+  struct Prefix {
+    std::string text;
+    uint16_t loc; // 1-based index into g_PrefixLocations
+  };
+  struct Station {
+    std::string call;
+    double freqKhz;
+    int mode; // index into kModes
+  };
+  struct City {
+    std::string grid;
+    uint16_t loc; // nearest prefix location with usable prefixes
+  };
+
+  void loadPrefixes();
+  void loadCities();
+  std::string makeCall(const Prefix &p);
+  Station newStation();
+  std::string spotter(const City &city, bool skimmer);
+
+  std::mt19937 rng_;
+  std::vector<Prefix> prefixes_;
+  std::vector<std::string> exactCalls_;
+  std::vector<std::vector<uint32_t>> prefixesByLoc_; // indexes into prefixes_
+  std::vector<City> cities_;
+  std::discrete_distribution<size_t> cityPick_;
+  std::vector<Station> pool_;
+};
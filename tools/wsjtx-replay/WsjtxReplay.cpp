@@ -0,0 +1,1011 @@
+// Records, generates, replays and benchmarks WSJT-X and N1MM Logger+ UDP
+// traffic.
+//
+//   record FILE    save datagrams arriving on a port (what WSJT-X, JTDX or
+//                  N1MM sends to HamClock) with their timing
+//   synth FILE     write a generated capture: Status, Decode, WSPRDecode,
+//                  QSO Logged and Logged ADIF from one or more instances
+//   contest FILE   write a generated N1MM capture: contactinfo (with some
+//                  edits and deletions), RadioInfo, spot and score from a
+//                  multi-op network, with bursts from every station at once
+//   play FILE      send a capture to a port at the recorded pace
+//   bench FILE     time the parsers over a capture
+//
+//   hamclock-wsjtx-replay synth ft8.cap --minutes 30 --instances 2
+//   hamclock-wsjtx-replay contest cq.cap --stations 6 --rate 150
+//   hamclock-wsjtx-replay play ft8.cap --to 127.0.0.1:2237 --speed 20
+//
+// A capture is "WSJTXCAP" followed by records of a little-endian uint64
+// (microseconds since the first datagram), a little-endian uint32 length
+// and the datagram itself.
+
+#include "services/N1MMProtocol.h"
+#include "services/WsjtxProtocol.h"
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr char kFileMagic[8] = {'W', 'S', 'J', 'T', 'X', 'C', 'A', 'P'};
+
+struct Options {
+  std::string command;
+  std::string file;
+  int port = 2237;
+  std::string group; // multicast group to join when recording
+  std::string to = "127.0.0.1:2237";
+  double speed = 1;
+  bool loop = false;
+  int minutes = 10;
+  int instances = 1;
+  int decodes = 15; // per instance per 15 s period
+  int stations = 4;  // N1MM network
+  int rate = 120;    // QSOs per hour per station
+  uint32_t seed = 1;
+  int iterations = 200;
+};
+
+struct Datagram {
+  uint64_t atUs = 0;
+  std::string data;
+};
+
+std::atomic<bool> g_stop{false};
+
+void usage() {
+  std::fprintf(
+      stderr,
+      "usage: hamclock-wsjtx-replay COMMAND FILE [options]\n"
+      "  record FILE   save datagrams received on a port\n"
+      "      --port N          UDP port (2237)\n"
+      "      --group ADDR      join this multicast group\n"
+      "  synth FILE    write a generated capture\n"
+      "      --minutes N       length (10)\n"
+      "      --instances N     WSJT-X instances (1)\n"
+      "      --decodes N       decodes per instance per period (15)\n"
+      "      --seed N          random seed (1)\n"
+      "  contest FILE  write a generated N1MM capture\n"
+      "      --minutes N       length (10)\n"
+      "      --stations N      stations in the network (4)\n"
+      "      --rate N          QSOs per hour per station (120)\n"
+      "      --seed N          random seed (1)\n"
+      "  play FILE     send a capture\n"
+      "      --to HOST:PORT    destination (127.0.0.1:2237)\n"
+      "      --speed X         replay X times faster (1)\n"
+      "      --loop            start over at the end, until ^C\n"
+      "  bench FILE    time the parsers over a capture\n"
+      "      --iterations N    passes over the capture (200)\n");
+}
+
+bool parseOptions(int argc, char **argv, Options &o) {
+  if (argc < 3) {
+    usage();
+    return false;
+  }
+  o.command = argv[1];
+  o.file = argv[2];
+  for (int i = 3; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--loop") {
+      o.loop = true;
+      continue;
+    }
+    if (i + 1 >= argc) {
+      usage();
+      return false;
+    }
+    std::string v = argv[++i];
+    if (arg == "--port") {
+      o.port = std::atoi(v.c_str());
+    } else if (arg == "--group") {
+      o.group = v;
+    } else if (arg == "--to") {
+      o.to = v;
+    } else if (arg == "--speed") {
+      o.speed = std::max(0.001, std::atof(v.c_str()));
+    } else if (arg == "--minutes") {
+      o.minutes = std::max(1, std::atoi(v.c_str()));
+    } else if (arg == "--instances") {
+      o.instances = std::clamp(std::atoi(v.c_str()), 1, 16);
+    } else if (arg == "--decodes") {
+      o.decodes = std::max(0, std::atoi(v.c_str()));
+    } else if (arg == "--stations") {
+      o.stations = std::clamp(std::atoi(v.c_str()), 1, 32);
+    } else if (arg == "--rate") {
+      o.rate = std::clamp(std::atoi(v.c_str()), 1, 1000);
+    } else if (arg == "--seed") {
+      o.seed = static_cast<uint32_t>(std::strtoul(v.c_str(), nullptr, 10));
+    } else if (arg == "--iterations") {
+      o.iterations = std::max(1, std::atoi(v.c_str()));
+    } else {
+      usage();
+      return false;
+    }
+  }
+  return true;
+}
+
+// --- Capture files ---
+
+void putLE(std::string &out, uint64_t v, int bytes) {
+  for (int i = 0; i < bytes; ++i)
+    out.push_back(static_cast<char>(v >> (8 * i) & 0xFF));
+}
+
+uint64_t getLE(const unsigned char *p, int bytes) {
+  uint64_t v = 0;
+  for (int i = bytes - 1; i >= 0; --i)
+    v = v << 8 | p[i];
+  return v;
+}
+
+bool writeCapture(const std::string &path,
+                  const std::vector<Datagram> &datagrams) {
+  std::string out(kFileMagic, sizeof(kFileMagic));
+  for (const auto &d : datagrams) {
+    putLE(out, d.atUs, 8);
+    putLE(out, d.data.size(), 4);
+    out += d.data;
+  }
+  std::ofstream file(path, std::ios::binary);
+  return file.write(out.data(), out.size()).good();
+}
+
+bool readCapture(const std::string &path, std::vector<Datagram> &datagrams) {
+  std::ifstream file(path, std::ios::binary);
+  std::string in((std::istreambuf_iterator<char>(file)),
+                 std::istreambuf_iterator<char>());
+  if (in.size() < sizeof(kFileMagic) ||
+      in.compare(0, sizeof(kFileMagic), kFileMagic, sizeof(kFileMagic)) != 0)
+    return false;
+  auto p = reinterpret_cast<const unsigned char *>(in.data());
+  size_t pos = sizeof(kFileMagic);
+  while (in.size() - pos >= 12) {
+    Datagram d;
+    d.atUs = getLE(p + pos, 8);
+    size_t len = getLE(p + pos + 8, 4);
+    pos += 12;
+    if (in.size() - pos < len)
+      return false;
+    d.data.assign(in, pos, len);
+    pos += len;
+    datagrams.push_back(std::move(d));
+  }
+  return pos == in.size();
+}
+
+// --- synth ---
+
+struct Area {
+  const char *prefix;
+  const char *fields; // pairs of Maidenhead field letters
+};
+
+// Where calls with each prefix usually are.
+constexpr Area kAreas[] = {
+    {"K", "FNEMDMCNENEL"}, {"W", "FNEMDMCNENEL"}, {"N", "FNEMDMCNEN"},
+    {"VE", "FNENDOCN"},    {"G", "IOJO"},         {"DL", "JOJN"},
+    {"F", "JNIN"},         {"I", "JNJM"},         {"EA", "INIM"},
+    {"SP", "JOKO"},        {"OH", "KPKO"},        {"UA", "KOLONO"},
+    {"JA", "PMQMQN"},      {"HL", "PM"},          {"VK", "QFQGPF"},
+    {"ZL", "RFRE"},        {"PY", "GGGHHG"},      {"LU", "FFGF"},
+    {"ZS", "KFKG"},        {"YB", "OIPI"},
+};
+
+class Synth {
+public:
+  explicit Synth(uint32_t seed) : rng_(seed) {}
+
+  int pick(int n) {
+    return std::uniform_int_distribution<int>(0, n - 1)(rng_);
+  }
+
+  void station(std::string &call, std::string &grid) {
+    const Area &a = kAreas[pick(std::size(kAreas))];
+    call = a.prefix;
+    call += static_cast<char>('0' + pick(10));
+    int letters = 1 + pick(3);
+    for (int i = 0; i < letters; ++i)
+      call += static_cast<char>('A' + pick(26));
+    int fields = static_cast<int>(std::strlen(a.fields)) / 2;
+    int f = pick(fields);
+    grid.assign(a.fields + 2 * f, 2);
+    grid += static_cast<char>('0' + pick(10));
+    grid += static_cast<char>('0' + pick(10));
+  }
+
+  // An FT8 message someone else sent, in one of the usual shapes.
+  std::string message(const std::string &deCall) {
+    std::string call, grid, other, otherGrid;
+    station(call, grid);
+    station(other, otherGrid);
+    switch (pick(8)) {
+    case 0:
+    case 1:
+      return "CQ " + call + " " + grid;
+    case 2:
+      return "CQ DX " + call + " " + grid;
+    case 3:
+      return other + " " + call + " " + grid;
+    case 4:
+      return other + " " + call + " " + report();
+    case 5:
+      return other + " " + call + " R" + report();
+    case 6:
+      return other + " " + call + (pick(2) ? " RR73" : " 73");
+    default:
+      // Someone answering us.
+      return deCall + " " + call + " " + grid;
+    }
+  }
+
+  std::string report() {
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "%+03d", pick(45) - 24);
+    return buf;
+  }
+
+  std::mt19937 &rng() { return rng_; }
+
+private:
+  std::mt19937 rng_;
+};
+
+struct SynthInstance {
+  std::string id;
+  std::string deCall;
+  std::string deGrid;
+  uint64_t dialHz;
+  std::string dxCall;
+  std::string dxGrid;
+};
+
+constexpr uint64_t kFT8Dials[] = {3573000,  7074000,  10136000, 14074000,
+                                  18100000, 21074000, 28074000};
+
+std::string statusMessage(const SynthInstance &in, bool decoding) {
+  Wsjtx::Writer w(Wsjtx::Type::Status, in.id);
+  w.u64(in.dialHz)
+      .utf8("FT8")
+      .utf8(in.dxCall)
+      .utf8("-10")
+      .utf8("FT8")
+      .boolean(!in.dxCall.empty())
+      .boolean(false)
+      .boolean(decoding)
+      .u32(1200)
+      .u32(1500)
+      .utf8(in.deCall)
+      .utf8(in.deGrid)
+      .utf8(in.dxGrid)
+      .boolean(false)
+      .utf8("")
+      .boolean(false)
+      .u8(0)
+      .u32(0xFFFFFFFF)
+      .u32(15)
+      .utf8("Default")
+      .utf8("");
+  return w.data();
+}
+
+std::string adifRecord(const SynthInstance &in, const std::string &when) {
+  auto field = [](const char *name, const std::string &v) {
+    return "<" + std::string(name) + ":" + std::to_string(v.size()) + ">" + v +
+           " ";
+  };
+  char freq[32];
+  std::snprintf(freq, sizeof(freq), "%.6f", (in.dialHz + 1500) / 1e6);
+  return "\n<adif_ver:5>3.1.0\n<programid:6>WSJT-X\n<EOH>\n" +
+         field("call", in.dxCall) + field("gridsquare", in.dxGrid) +
+         field("mode", "FT8") + field("rst_sent", "-10") +
+         field("rst_rcvd", "-12") + field("qso_date", when.substr(0, 8)) +
+         field("time_on", when.substr(8)) + field("freq", freq) +
+         field("station_callsign", in.deCall) +
+         field("my_gridsquare", in.deGrid) + "<EOR>";
+}
+
+int synth(const Options &o) {
+  Synth s(o.seed);
+  std::vector<SynthInstance> instances;
+  for (int i = 0; i < o.instances; ++i) {
+    SynthInstance in;
+    in.id = i == 0 ? "WSJT-X" : "WSJT-X - rig" + std::to_string(i + 1);
+    s.station(in.deCall, in.deGrid);
+    in.dialHz = kFT8Dials[s.pick(std::size(kFT8Dials))];
+    instances.push_back(in);
+  }
+
+  std::vector<Datagram> out;
+  auto add = [&](uint64_t atUs, std::string data) {
+    out.push_back({atUs, std::move(data)});
+  };
+  // Midnight-relative times start at 12:00:00 UTC.
+  constexpr uint32_t kStartMs = 12 * 3600 * 1000;
+  std::time_t day = std::time(nullptr) / 86400 * 86400;
+  int periods = o.minutes * 4;
+  for (int p = 0; p < periods; ++p) {
+    uint64_t periodUs = static_cast<uint64_t>(p) * 15000000;
+    uint32_t periodMs = kStartMs + static_cast<uint32_t>(p) * 15000;
+    for (size_t i = 0; i < instances.size(); ++i) {
+      SynthInstance &in = instances[i];
+      uint64_t base = periodUs + i * 1000;
+      add(base, Wsjtx::Writer(Wsjtx::Type::Heartbeat, in.id)
+                    .u32(3)
+                    .utf8("2.6.1")
+                    .utf8("synth")
+                    .data());
+      // Now and then the operator changes band or starts working someone.
+      if (p > 0 && s.pick(40) == 0)
+        in.dialHz = kFT8Dials[s.pick(std::size(kFT8Dials))];
+      if (s.pick(8) == 0) {
+        s.station(in.dxCall, in.dxGrid);
+      }
+      add(base + 100, statusMessage(in, true));
+
+      // Decodes arrive about 13 s into the period.
+      for (int d = 0; d < o.decodes; ++d) {
+        add(base + 13000000 + static_cast<uint64_t>(d) * 2000,
+            Wsjtx::Writer(Wsjtx::Type::Decode, in.id)
+                .boolean(true)
+                .u32(periodMs)
+                .i32(s.pick(45) - 24)
+                .f64((s.pick(25) - 5) / 10.0)
+                .u32(200 + s.pick(2800))
+                .utf8("~")
+                .utf8(s.message(in.deCall))
+                .boolean(false)
+                .boolean(false)
+                .data());
+      }
+      add(base + 14000000, statusMessage(in, false));
+
+      if (!in.dxCall.empty() && s.pick(6) == 0) {
+        int64_t whenMs = static_cast<int64_t>(day) * 1000 + periodMs + 14500;
+        std::time_t whenSecs = static_cast<std::time_t>(whenMs / 1000);
+        char when[16];
+        std::strftime(when, sizeof(when), "%Y%m%d%H%M%S",
+                      std::gmtime(&whenSecs));
+        add(base + 14500000, Wsjtx::Writer(Wsjtx::Type::QSOLogged, in.id)
+                                 .dateTime(whenMs)
+                                 .utf8(in.dxCall)
+                                 .utf8(in.dxGrid)
+                                 .u64(in.dialHz + 1500)
+                                 .utf8("FT8")
+                                 .utf8("-10")
+                                 .utf8("-12")
+                                 .utf8("100")
+                                 .utf8("")
+                                 .utf8("")
+                                 .dateTime(whenMs - 60000)
+                                 .utf8("")
+                                 .utf8(in.deCall)
+                                 .utf8(in.deGrid)
+                                 .utf8("")
+                                 .utf8("")
+                                 .utf8("")
+                                 .data());
+        add(base + 14501000, Wsjtx::Writer(Wsjtx::Type::LoggedADIF, in.id)
+                                 .utf8(adifRecord(in, when))
+                                 .data());
+        in.dxCall.clear();
+        in.dxGrid.clear();
+      }
+    }
+    // A WSPR spot every other minute, from the first instance.
+    if (p % 8 == 0) {
+      std::string call, grid;
+      s.station(call, grid);
+      add(periodUs + 14800000,
+          Wsjtx::Writer(Wsjtx::Type::WSPRDecode, instances[0].id)
+              .boolean(true)
+              .u32(kStartMs + static_cast<uint32_t>(p) * 15000)
+              .i32(s.pick(30) - 28)
+              .f64(0.5)
+              .u64(14097000 + s.pick(200))
+              .i32(0)
+              .utf8(call)
+              .utf8(grid)
+              .i32(37)
+              .boolean(false)
+              .data());
+    }
+  }
+  for (const auto &in : instances)
+    add(periods * uint64_t{15000000},
+        Wsjtx::Writer(Wsjtx::Type::Close, in.id).data());
+
+  std::stable_sort(out.begin(), out.end(),
+                   [](const Datagram &a, const Datagram &b) {
+                     return a.atUs < b.atUs;
+                   });
+  if (!writeCapture(o.file, out)) {
+    std::fprintf(stderr, "cannot write %s\n", o.file.c_str());
+    return 1;
+  }
+  std::printf("wrote %zu datagrams, %d minutes, %zu instance(s) to %s\n",
+              out.size(), o.minutes, instances.size(), o.file.c_str());
+  return 0;
+}
+
+// --- contest ---
+
+struct ContestBand {
+  const char *mhz; // as N1MM writes the band
+  double lowKhz;
+};
+
+constexpr ContestBand kContestBands[] = {{"3.5", 3500},   {"7", 7000},
+                                         {"14", 14000},   {"21", 21000},
+                                         {"28", 28000}};
+
+constexpr const char *kContestCall = "K1ZZ";
+
+struct SynthStation {
+  std::string name; // StationName
+  std::string op;
+  int band = 0;
+  double khz = 0;
+  bool running = false;
+  int qsos = 0;
+};
+
+// N1MM frequencies are in tens of hertz.
+int64_t tensOfHz(double khz) { return std::llround(khz * 100); }
+
+std::string n1mmTimestamp(std::time_t t) {
+  char buf[24];
+  std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", std::gmtime(&t));
+  return buf;
+}
+
+std::string contactMessage(const char *root, const SynthStation &st,
+                           const std::string &id, const std::string &call,
+                           std::time_t when) {
+  return N1mm::Writer(root)
+      .field("app", "N1MM")
+      .field("contestname", "CQWWCW")
+      .field("contestnr", 42)
+      .field("timestamp", n1mmTimestamp(when))
+      .field("mycall", kContestCall)
+      .field("band", kContestBands[st.band].mhz)
+      .field("rxfreq", tensOfHz(st.khz))
+      .field("txfreq", tensOfHz(st.khz))
+      .field("operator", st.op)
+      .field("mode", "CW")
+      .field("call", call)
+      .field("snt", "599")
+      .field("sntnr", st.qsos)
+      .field("rcv", "599")
+      .field("rcvnr", 0)
+      .field("points", 3)
+      .field("StationName", st.name)
+      .field("ID", id)
+      .field("IsClaimedQso", "True")
+      .data();
+}
+
+std::string radioMessage(const SynthStation &st) {
+  return N1mm::Writer("RadioInfo")
+      .field("app", "N1MM")
+      .field("StationName", st.name)
+      .field("RadioNr", 1)
+      .field("Freq", tensOfHz(st.khz))
+      .field("TXFreq", tensOfHz(st.khz))
+      .field("Mode", "CW")
+      .field("OpCall", st.op)
+      .field("IsRunning", st.running ? "True" : "False")
+      .field("FocusEntry", 0)
+      .field("Antenna", 1)
+      .field("Rotors", "")
+      .field("FocusRadioNr", 1)
+      .field("IsStereo", "False")
+      .field("IsSplit", "False")
+      .field("ActiveRadioNr", 1)
+      .field("IsTransmitting", "False")
+      .field("FunctionKeyCaption", "")
+      .field("RadioName", "K3")
+      .field("AuxAntSelected", -1)
+      .field("AuxAntSelectedName", "")
+      .field("IsConnected", "True")
+      .data();
+}
+
+int contest(const Options &o) {
+  Synth s(o.seed);
+  auto chance = [&](double p) {
+    return std::uniform_real_distribution<double>(0, 1)(s.rng()) < p;
+  };
+  std::vector<SynthStation> stations;
+  for (int i = 0; i < o.stations; ++i) {
+    SynthStation st;
+    st.name = "OP" + std::to_string(i + 1) + "-PC";
+    std::string grid;
+    s.station(st.op, grid);
+    st.band = i % static_cast<int>(std::size(kContestBands));
+    st.khz = kContestBands[st.band].lowKhz + 5 + s.pick(40);
+    st.running = i % 2 == 0;
+    stations.push_back(st);
+  }
+
+  std::vector<Datagram> out;
+  auto add = [&](uint64_t atUs, std::string data) {
+    out.push_back({atUs, std::move(data)});
+  };
+  std::time_t start = std::time(nullptr);
+  uint64_t ids = 0;
+  auto newId = [&] {
+    char buf[40];
+    std::snprintf(buf, sizeof(buf), "%08x%024llx", o.seed,
+                  static_cast<unsigned long long>(++ids));
+    return std::string(buf);
+  };
+
+  for (const auto &st : stations) {
+    add(0, N1mm::Writer("AppInfo")
+               .field("app", "N1MM")
+               .field("dbname", "C:\\N1MM Logger+\\Databases\\cq.s3db")
+               .field("contestnr", 42)
+               .field("contestname", "CQWWCW")
+               .field("StationName", st.name)
+               .data());
+  }
+
+  int seconds = o.minutes * 60;
+  double perSecond = o.rate / 3600.0;
+  int total = 0, deleted = 0;
+  for (int t = 0; t < seconds; ++t) {
+    uint64_t secUs = static_cast<uint64_t>(t) * 1000000;
+    std::time_t now = start + t;
+    // A burst: every station logs a QSO in the same few milliseconds.
+    bool burst = t % 600 == 300;
+
+    for (size_t i = 0; i < stations.size(); ++i) {
+      SynthStation &st = stations[i];
+      uint64_t base = secUs + i * 37000;
+      if (t % 5 == 0) {
+        if (chance(0.01)) {
+          st.band = s.pick(std::size(kContestBands));
+          st.khz = kContestBands[st.band].lowKhz + 5 + s.pick(40);
+        } else if (!st.running) {
+          st.khz += 0.1 * (1 + s.pick(20));
+        }
+        add(base, radioMessage(st));
+      }
+
+      if (!burst && !chance(perSecond))
+        continue;
+      uint64_t at = burst ? secUs + 200000 + i * 500 : base + 500000;
+      std::string call, grid;
+      s.station(call, grid);
+      std::string id = newId();
+      st.qsos++;
+      total++;
+      add(at, contactMessage("contactinfo", st, id, call, now));
+      // Now and then the call was miscopied, or the QSO was a dupe.
+      if (chance(0.03)) {
+        std::string fixed = call;
+        fixed.back() = static_cast<char>('A' + s.pick(26));
+        add(at + 20000000,
+            contactMessage("contactreplace", st, id, fixed, now));
+      } else if (chance(0.01)) {
+        add(at + 40000000, N1mm::Writer("contactdelete")
+                               .field("app", "N1MM")
+                               .field("timestamp", n1mmTimestamp(now))
+                               .field("call", call)
+                               .field("contestnr", 42)
+                               .field("StationName", st.name)
+                               .field("ID", id)
+                               .data());
+        deleted++;
+      }
+    }
+
+    if (t % 12 == 6) {
+      const SynthStation &st = stations[s.pick(stations.size())];
+      std::string call, grid, spotter, spotterGrid;
+      s.station(call, grid);
+      s.station(spotter, spotterGrid);
+      char freq[16];
+      std::snprintf(freq, sizeof(freq), "%.1f",
+                    kContestBands[s.pick(std::size(kContestBands))].lowKhz +
+                        s.pick(600) / 10.0);
+      add(secUs + 700000, N1mm::Writer("spot")
+                              .field("app", "N1MM")
+                              .field("StationName", st.name)
+                              .field("dxcall", call)
+                              .field("frequency", freq)
+                              .field("spottercall", spotter + "-#")
+                              .field("comment", "CW 28 dB 25 WPM CQ")
+                              .field("action", "add")
+                              .field("mode", "CW")
+                              .field("status", "")
+                              .field("timestamp", n1mmTimestamp(now))
+                              .data());
+    }
+
+    if (t % 60 == 59) {
+      int qsos = total - deleted;
+      int zones = std::min(40, qsos / 6);
+      int countries = std::min(200, qsos / 3);
+      char breakdown[512];
+      std::snprintf(
+          breakdown, sizeof(breakdown),
+          "\t<class power=\"HIGH\" assisted=\"ASSISTED\" "
+          "transmitter=\"UNLIMITED\" ops=\"MULTI-OP\" bands=\"ALL\" "
+          "mode=\"CW\" overlay=\"\"/>\r\n"
+          "\t<breakdown>\r\n"
+          "\t\t<qso band=\"total\" mode=\"ALL\">%d</qso>\r\n"
+          "\t\t<point band=\"total\" mode=\"ALL\">%d</point>\r\n"
+          "\t\t<zone band=\"total\" mode=\"ALL\">%d</zone>\r\n"
+          "\t\t<country band=\"total\" mode=\"ALL\">%d</country>\r\n"
+          "\t\t<qso band=\"14\" mode=\"CW\">%d</qso>\r\n"
+          "\t</breakdown>\r\n",
+          qsos, qsos * 3, zones, countries, qsos / 4);
+      add(secUs + 900000,
+          N1mm::Writer("dynamicresults")
+              .field("contest", "CQ-WW-CW")
+              .field("call", kContestCall)
+              .field("ops", stations[0].op)
+              .raw(breakdown)
+              .field("score", int64_t{qsos} * 3 * (zones + countries))
+              .field("timestamp", n1mmTimestamp(now))
+              .data());
+    }
+  }
+
+  std::stable_sort(out.begin(), out.end(),
+                   [](const Datagram &a, const Datagram &b) {
+                     return a.atUs < b.atUs;
+                   });
+  if (!writeCapture(o.file, out)) {
+    std::fprintf(stderr, "cannot write %s\n", o.file.c_str());
+    return 1;
+  }
+  std::printf("wrote %zu datagrams, %d minutes, %zu station(s), %d QSOs "
+              "(%d deleted) to %s\n",
+              out.size(), o.minutes, stations.size(), total, deleted,
+              o.file.c_str());
+  return 0;
+}
+
+// --- record / play ---
+
+int record(const Options &o) {
+  int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  if (fd < 0)
+    return std::perror("socket"), 1;
+  int on = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+#ifdef SO_REUSEPORT
+  setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+#endif
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(static_cast<uint16_t>(o.port));
+  addr.sin_addr.s_addr = INADDR_ANY;
+  if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0)
+    return std::perror("bind"), 1;
+  if (!o.group.empty()) {
+    ip_mreq mreq{};
+    if (inet_pton(AF_INET, o.group.c_str(), &mreq.imr_multiaddr) != 1)
+      return std::fprintf(stderr, "bad group %s\n", o.group.c_str()), 1;
+    mreq.imr_interface.s_addr = htonl(INADDR_ANY);
+    if (setsockopt(fd, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) <
+        0)
+      return std::perror("IP_ADD_MEMBERSHIP"), 1;
+  }
+  timeval tv{0, 250000};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+  std::printf("recording port %d to %s, ^C to stop\n", o.port,
+              o.file.c_str());
+  std::vector<Datagram> got;
+  std::vector<char> buf(64 * 1024);
+  std::chrono::steady_clock::time_point first;
+  while (!g_stop) {
+    ssize_t n = recv(fd, buf.data(), buf.size(), 0);
+    if (n <= 0)
+      continue;
+    auto now = std::chrono::steady_clock::now();
+    if (got.empty())
+      first = now;
+    Datagram d;
+    d.atUs = std::chrono::duration_cast<std::chrono::microseconds>(now - first)
+                 .count();
+    d.data.assign(buf.data(), static_cast<size_t>(n));
+    got.push_back(std::move(d));
+  }
+  close(fd);
+  if (!writeCapture(o.file, got)) {
+    std::fprintf(stderr, "cannot write %s\n", o.file.c_str());
+    return 1;
+  }
+  std::printf("\nwrote %zu datagrams to %s\n", got.size(), o.file.c_str());
+  return 0;
+}
+
+int play(const Options &o) {
+  std::vector<Datagram> datagrams;
+  if (!readCapture(o.file, datagrams) || datagrams.empty()) {
+    std::fprintf(stderr, "%s is not a capture or is empty\n", o.file.c_str());
+    return 1;
+  }
+  size_t colon = o.to.rfind(':');
+  if (colon == std::string::npos)
+    return usage(), 1;
+  std::string host = o.to.substr(0, colon);
+  std::string port = o.to.substr(colon + 1);
+  addrinfo hints{};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_DGRAM;
+  addrinfo *res = nullptr;
+  if (getaddrinfo(host.c_str(), port.c_str(), &hints, &res) != 0 || !res) {
+    std::fprintf(stderr, "cannot resolve %s\n", o.to.c_str());
+    return 1;
+  }
+  int fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+  if (fd < 0) {
+    freeaddrinfo(res);
+    return std::perror("socket"), 1;
+  }
+  // Multicast destinations stay on the local network.
+  unsigned char ttl = 1;
+  setsockopt(fd, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+
+  uint64_t sent = 0;
+  uint64_t failed = 0;
+  auto start = std::chrono::steady_clock::now();
+  double offsetUs = 0; // of the current pass, for --loop
+  uint64_t lengthUs = datagrams.back().atUs + 1000000;
+  do {
+    for (const auto &d : datagrams) {
+      if (g_stop)
+        break;
+      auto due =
+          start + std::chrono::microseconds(static_cast<int64_t>(
+                      (offsetUs + static_cast<double>(d.atUs)) / o.speed));
+      std::this_thread::sleep_until(due);
+      if (sendto(fd, d.data.data(), d.data.size(), 0, res->ai_addr,
+                 res->ai_addrlen) < 0)
+        failed++;
+      else
+        sent++;
+    }
+    offsetUs += static_cast<double>(lengthUs);
+  } while (o.loop && !g_stop);
+
+  double secs = std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+  std::printf("sent %llu datagrams (%llu failed) in %.1f s to %s\n",
+              static_cast<unsigned long long>(sent),
+              static_cast<unsigned long long>(failed), secs, o.to.c_str());
+  close(fd);
+  freeaddrinfo(res);
+  return failed ? 1 : 0;
+}
+
+// --- bench ---
+
+const char *typeName(Wsjtx::Type t) {
+  switch (t) {
+  case Wsjtx::Type::Heartbeat:
+    return "Heartbeat";
+  case Wsjtx::Type::Status:
+    return "Status";
+  case Wsjtx::Type::Decode:
+    return "Decode";
+  case Wsjtx::Type::QSOLogged:
+    return "QSO Logged";
+  case Wsjtx::Type::Close:
+    return "Close";
+  case Wsjtx::Type::WSPRDecode:
+    return "WSPRDecode";
+  case Wsjtx::Type::LoggedADIF:
+    return "Logged ADIF";
+  default:
+    return "other";
+  }
+}
+
+const char *typeName(N1mm::Type t) {
+  switch (t) {
+  case N1mm::Type::Contact:
+    return "contactinfo";
+  case N1mm::Type::ContactReplace:
+    return "contactreplace";
+  case N1mm::Type::ContactDelete:
+    return "contactdelete";
+  case N1mm::Type::Radio:
+    return "RadioInfo";
+  case N1mm::Type::Spot:
+    return "spot";
+  case N1mm::Type::Score:
+    return "dynamicresults";
+  default:
+    return "other";
+  }
+}
+
+// Nanoseconds per datagram for 'fn' over 'datagrams', 'iterations' times.
+template <typename Fn>
+double timePerDatagram(const std::vector<const Datagram *> &datagrams,
+                       int iterations, Fn &&fn) {
+  if (datagrams.empty())
+    return 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    for (const Datagram *d : datagrams)
+      fn(*d);
+  }
+  double secs =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - t0)
+          .count();
+  return secs / (static_cast<double>(datagrams.size()) * iterations) * 1e9;
+}
+
+int bench(const Options &o) {
+  std::vector<Datagram> datagrams;
+  if (!readCapture(o.file, datagrams) || datagrams.empty()) {
+    std::fprintf(stderr, "%s is not a capture or is empty\n", o.file.c_str());
+    return 1;
+  }
+  size_t bytes = 0;
+  std::vector<const Datagram *> wsjtx, n1mm;
+  for (const auto &d : datagrams) {
+    bytes += d.data.size();
+    if (N1mm::isMessage(d.data.data(), d.data.size()))
+      n1mm.push_back(&d);
+    else
+      wsjtx.push_back(&d);
+  }
+
+  // What the capture holds, and whether every message parses.
+  constexpr int kTypes = 16;
+  uint64_t perType[kTypes + 1] = {};
+  uint64_t perN1mmType[kTypes] = {};
+  uint64_t failures = 0;
+  uint64_t senders = 0;
+  uint64_t decodes = 0;
+  for (const Datagram *d : wsjtx) {
+    Wsjtx::Message m;
+    if (!Wsjtx::parse(d->data.data(), d->data.size(), m)) {
+      failures++;
+      continue;
+    }
+    perType[std::min<uint32_t>(static_cast<uint32_t>(m.type), kTypes)]++;
+    if (m.type == Wsjtx::Type::Decode) {
+      decodes++;
+      std::string_view call, grid;
+      senders += Wsjtx::messageSender(m.decode.message, call, grid);
+    }
+  }
+  N1mm::Message nm;
+  for (const Datagram *d : n1mm) {
+    if (!N1mm::parse(d->data.data(), d->data.size(), nm)) {
+      failures++;
+      continue;
+    }
+    perN1mmType[static_cast<int>(nm.type)]++;
+  }
+  std::printf("%zu datagrams, %zu bytes, %llu failed to parse\n",
+              datagrams.size(), bytes,
+              static_cast<unsigned long long>(failures));
+  for (int t = 0; t <= kTypes; ++t) {
+    if (perType[t])
+      std::printf("  %-14s %llu\n", typeName(static_cast<Wsjtx::Type>(t)),
+                  static_cast<unsigned long long>(perType[t]));
+  }
+  for (int t = 0; t < kTypes; ++t) {
+    if (perN1mmType[t])
+      std::printf("  %-14s %llu\n", typeName(static_cast<N1mm::Type>(t)),
+                  static_cast<unsigned long long>(perN1mmType[t]));
+  }
+  if (decodes)
+    std::printf("  sender found in %llu of %llu decodes\n",
+                static_cast<unsigned long long>(senders),
+                static_cast<unsigned long long>(decodes));
+
+  // Every truncation of every datagram must be rejected or parsed without
+  // reading past the end. A WSJT-X message may stop at a field older
+  // versions omit; an XML document is only whole once its root is closed.
+  uint64_t cut = 0;
+  uint64_t badCuts = 0;
+  for (const auto &d : datagrams) {
+    bool xml = N1mm::isMessage(d.data.data(), d.data.size());
+    size_t closed = d.data.rfind('>') + 1;
+    for (size_t n = 0; n < d.data.size(); ++n) {
+      std::vector<char> copy(d.data.begin(), d.data.begin() + n);
+      bool ok;
+      if (xml) {
+        ok = N1mm::parse(copy.data(), copy.size(), nm);
+        badCuts += ok && n < closed;
+      } else {
+        Wsjtx::Message m;
+        ok = Wsjtx::parse(copy.data(), copy.size(), m);
+      }
+      cut += ok;
+    }
+  }
+  std::printf("  %llu of the truncated copies still parse (older-version "
+              "tails, trailing white space), %llu wrongly\n",
+              static_cast<unsigned long long>(cut),
+              static_cast<unsigned long long>(badCuts));
+
+  uint64_t sink = 0;
+  double wsjtxNs = timePerDatagram(wsjtx, o.iterations, [&](const Datagram &d) {
+    Wsjtx::Message m;
+    if (Wsjtx::parse(d.data.data(), d.data.size(), m))
+      sink += static_cast<uint32_t>(m.type) + m.id.size();
+  });
+  double senderNs =
+      timePerDatagram(wsjtx, o.iterations, [&](const Datagram &d) {
+        Wsjtx::Message m;
+        std::string_view call, grid;
+        if (Wsjtx::parse(d.data.data(), d.data.size(), m) &&
+            m.type == Wsjtx::Type::Decode &&
+            Wsjtx::messageSender(m.decode.message, call, grid))
+          sink += call.size() + grid.size();
+      });
+  double n1mmNs = timePerDatagram(n1mm, o.iterations, [&](const Datagram &d) {
+    N1mm::Message m;
+    if (N1mm::parse(d.data.data(), d.data.size(), m))
+      sink += static_cast<uint32_t>(m.type) + m.root.size();
+  });
+
+  if (!wsjtx.empty()) {
+    std::printf("WSJT-X parse:          %8.1f ns/message\n", wsjtxNs);
+    std::printf("WSJT-X parse + sender: %8.1f ns/message\n", senderNs);
+  }
+  if (!n1mm.empty()) {
+    size_t n1mmBytes = 0;
+    for (const Datagram *d : n1mm)
+      n1mmBytes += d->data.size();
+    std::printf("N1MM parse:            %8.1f ns/message  %7.1f MB/s\n",
+                n1mmNs, n1mmBytes / (n1mmNs * n1mm.size()) * 1e3);
+  }
+  std::printf("(checksum %llu)\n", static_cast<unsigned long long>(sink));
+  return failures || badCuts ? 1 : 0;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  Options o;
+  if (!parseOptions(argc, argv, o))
+    return 2;
+  std::signal(SIGINT, [](int) { g_stop = true; });
+  std::signal(SIGTERM, [](int) { g_stop = true; });
+
+  if (o.command == "record")
+    return record(o);
+  if (o.command == "synth")
+    return synth(o);
+  if (o.command == "contest")
+    return contest(o);
+  if (o.command == "play")
+    return play(o);
+  if (o.command == "bench")
+    return bench(o);
+  usage();
+  return 2;
+}